@@ -6,6 +6,8 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 
 #include "config.h"
@@ -15,7 +17,101 @@ using namespace genleg;
 using namespace pgutils;
 using ArgPair = std::pair<std::string, enum Argument>;
 
-Config::Config() : m_opts_set(), m_opts_supp() {
+/*!
+ * \brief           Reads options from a configuration file.
+ * \ingroup         config
+ * \param filename  The name of the configuration file.
+ * \param opts      The map in which to store the options.
+ * \throws          ConfigCouldNotOpenFile If the configuration
+ * file cannot be opened.
+ * \throws          ConfigBadConfigFile If the
+ * configuration file is badly formed.
+ */
+static void read_file(const std::string& filename,
+                      std::map<std::string, std::string>& opts);
+
+/*!
+ * \brief           Parses an integer value.
+ * \ingroup         config
+ * \param text      The value.
+ * \param value     Set to the integer, if the value is one.
+ * \returns         `true` if the whole value is an integer.
+ */
+static bool parse_int(const std::string& text, long long& value);
+
+/*!
+ * \brief           Parses a boolean value.
+ * \ingroup         config
+ * \param text      The value.
+ * \param value     Set to the boolean, if the value is one.
+ * \returns         `true` if the value is a boolean.
+ */
+static bool parse_bool(const std::string& text, bool& value);
+
+ConfigSnapshot::ConfigSnapshot(const std::map<std::string, std::string>&
+                                   options,
+                               const unsigned long generation) :
+    m_values(), m_generation(generation) {
+    for ( const auto& p : options ) {
+        Value value{p.second, false, 0, false, false};
+        value.is_int = parse_int(p.second, value.int_value);
+        value.is_bool = parse_bool(p.second, value.bool_value);
+        m_values.insert(std::make_pair(p.first, std::move(value)));
+    }
+}
+
+bool ConfigSnapshot::is_set(const std::string& option) const {
+    return find(option) != nullptr;
+}
+
+const std::string& ConfigSnapshot::operator[](const std::string& option)
+const {
+    const Value * value = find(option);
+    if ( !value ) {
+        throw ConfigOptionNotSet(option);
+    }
+    return value->text;
+}
+
+std::string ConfigSnapshot::get_string(const std::string& option,
+                                       const std::string& def) const {
+    const Value * value = find(option);
+    return value ? value->text : def;
+}
+
+long long ConfigSnapshot::get_int(const std::string& option,
+                                  const long long def) const {
+    const Value * value = find(option);
+    if ( !value ) {
+        return def;
+    }
+    else if ( !value->is_int ) {
+        throw ConfigBadOption(option);
+    }
+    return value->int_value;
+}
+
+bool ConfigSnapshot::get_bool(const std::string& option,
+                              const bool def) const {
+    const Value * value = find(option);
+    if ( !value ) {
+        return def;
+    }
+    else if ( !value->is_bool ) {
+        throw ConfigBadOption(option);
+    }
+    return value->bool_value;
+}
+
+const ConfigSnapshot::Value * ConfigSnapshot::find(const std::string& option)
+const {
+    const auto found = m_values.find(option);
+    return found == m_values.end() ? nullptr : &found->second;
+}
+
+Config::Config() :
+    m_opts_set(), m_opts_supp(), m_opts_cmdline(), m_files(),
+    m_generation(0) {
 }
 
 Config::~Config() {
@@ -38,6 +134,29 @@ const std::string& Config::operator[](const std::string& option) const {
 }
 
 void Config::populate_from_file(const std::string filename) {
+    read_file(filename, m_opts_set);
+    m_files.push_back(filename);
+}
+
+std::shared_ptr<const ConfigSnapshot> Config::snapshot() const {
+    return std::make_shared<const ConfigSnapshot>(m_opts_set, m_generation);
+}
+
+void Config::reload() {
+    std::map<std::string, std::string> opts;
+    for ( const auto& filename : m_files ) {
+        read_file(filename, opts);
+    }
+    for ( const auto& p : m_opts_cmdline ) {
+        opts[p.first] = p.second;
+    }
+
+    m_opts_set.swap(opts);
+    ++m_generation;
+}
+
+static void read_file(const std::string& filename,
+                      std::map<std::string, std::string>& opts) {
     std::ifstream ifs;
     ifs.open(filename);
 
@@ -68,7 +187,7 @@ void Config::populate_from_file(const std::string filename) {
 
             const std::string& key = trim_back(tokens[0]);
             const std::string& value = trim_front(tokens[1]);
-            m_opts_set[key] = value;
+            opts[key] = value;
         }
 
         ifs.close();
@@ -78,3 +197,29 @@ void Config::populate_from_file(const std::string filename) {
     }
 }
 
+static bool parse_int(const std::string& text, long long& value) {
+    try {
+        size_t used = 0;
+        value = std::stoll(text, &used);
+        return used == text.size();
+    }
+    catch ( const std::logic_error& e ) {
+        return false;
+    }
+}
+
+static bool parse_bool(const std::string& text, bool& value) {
+    std::string lower{text};
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if ( lower.empty() || lower == "yes" || lower == "true" ||
+         lower == "on" || lower == "1" ) {
+        value = true;
+        return true;
+    }
+    else if ( lower == "no" || lower == "false" || lower == "off" ||
+              lower == "0" ) {
+        value = false;
+        return true;
+    }
+    return false;
+}
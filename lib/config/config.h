@@ -11,8 +11,10 @@
 
 #include <map>
 #include <list>
+#include <memory>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 namespace genleg {
 
@@ -96,6 +98,118 @@ class ConfigBadConfigFile : public ConfigException {
             ConfigException(msg) {};
 };
 
+/*!
+ * \brief       Immutable snapshot of configuration options
+ * \details     Each value is parsed as an integer and as a boolean once,
+ * when the snapshot is made, so the typed accessors only look the value
+ * up. A snapshot never changes, so any number of threads may read one
+ * without locking.
+ * \ingroup     config
+ */
+class ConfigSnapshot {
+    public:
+        /*!
+         * \brief               Constructor.
+         * \param options       The options, by name.
+         * \param generation    The number of times the options have been
+         * reloaded.
+         */
+        ConfigSnapshot (const std::map<std::string, std::string>& options,
+                        const unsigned long generation);
+
+        /*!
+         * \brief           Returns the number of times the options had been
+         * reloaded when the snapshot was made.
+         * \returns         The generation.
+         */
+        unsigned long generation() const { return m_generation; }
+
+        /*!
+         * \brief           Checks is an option is set.
+         * \param option    The name of the option to check.
+         * \returns         `true` if the option has been set, `false`
+         * if it has not.
+         */
+        bool is_set(const std::string& option) const;
+
+        /*!
+         * \brief           operator[] overload.
+         * \details         Retrieves the value of a set option.
+         * \param option    The name of the option.
+         * \returns         The value of the option.
+         * \throws          ConfigOptionNotSet If the named option has
+         * not been set.
+         */
+        const std::string& operator[](const std::string& option) const;
+
+        /*!
+         * \brief           Returns the value of an option.
+         * \param option    The name of the option.
+         * \param def       The value to return if the option is not set.
+         * \returns         The value of the option.
+         */
+        std::string get_string(const std::string& option,
+                               const std::string& def) const;
+
+        /*!
+         * \brief           Returns the value of an integer option.
+         * \param option    The name of the option.
+         * \param def       The value to return if the option is not set.
+         * \returns         The value of the option.
+         * \throws          ConfigBadOption If the option is set but is not
+         * an integer.
+         */
+        long long get_int(const std::string& option,
+                          const long long def) const;
+
+        /*!
+         * \brief           Returns the value of a boolean option.
+         * \details         \c yes, \c true, \c on and \c 1 are true, and
+         * \c no, \c false, \c off and \c 0 are false. An option set
+         * without a value, such as a command line flag, is true.
+         * \param option    The name of the option.
+         * \param def       The value to return if the option is not set.
+         * \returns         The value of the option.
+         * \throws          ConfigBadOption If the option is set to any
+         * other value.
+         */
+        bool get_bool(const std::string& option, const bool def) const;
+
+    private:
+        /*!  A parsed option value  */
+        struct Value {
+            /*!  The value as given  */
+            std::string text;
+
+            /*!  Whether the value is an integer  */
+            bool is_int;
+
+            /*!  The integer value, if it is one  */
+            long long int_value;
+
+            /*!  Whether the value is a boolean  */
+            bool is_bool;
+
+            /*!  The boolean value, if it is one  */
+            bool bool_value;
+        };
+
+        /*!  Map of options which have been set  */
+        std::map<std::string, Value> m_values;
+
+        /*!  The reload generation  */
+        unsigned long m_generation;
+
+        /*!
+         * \brief           Finds an option.
+         * \param option    The name of the option.
+         * \returns         A pointer to the value, or \c nullptr if the
+         * option is not set.
+         */
+        const Value * find(const std::string& option) const;
+
+};              //  class ConfigSnapshot
+
 /*!
  * \brief       Configuration options class
  * \ingroup     config
@@ -154,6 +268,30 @@ class Config {
          */
         const std::string& operator[](const std::string& option) const;
 
+        /*!
+         * \brief           Returns a snapshot of the options.
+         * \returns         The snapshot.
+         */
+        std::shared_ptr<const ConfigSnapshot> snapshot() const;
+
+        /*!
+         * \brief           Reads the configuration files again.
+         * \details         The files are read in the order they were first
+         * read, and options given on the command line still take precedence
+         * over them. The options are unchanged if a file cannot be read.
+         * \throws          ConfigCouldNotOpenFile If a configuration
+         * file cannot be opened.
+         * \throws          ConfigBadConfigFile If a configuration file is
+         * badly formed.
+         */
+        void reload();
+
+        /*!
+         * \brief           Returns the configuration files read.
+         * \returns         The names of the files, in the order read.
+         */
+        const std::vector<std::string>& files() const { return m_files; }
+
     private:
         /*!  Map of options which have been set  */
         std::map<std::string, std::string> m_opts_set;
@@ -161,6 +299,15 @@ class Config {
         /*!  List of options which are supported  */
         std::list<std::pair<std::string, enum Argument> > m_opts_supp;
 
+        /*!  Map of options which were set on the command line  */
+        std::map<std::string, std::string> m_opts_cmdline;
+
+        /*!  The configuration files read, in order  */
+        std::vector<std::string> m_files;
+
+        /*!  The number of times the options have been reloaded  */
+        unsigned long m_generation;
+
 };              //  class Config
 
 }               //  namespace genleg
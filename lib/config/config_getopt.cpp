@@ -69,6 +69,7 @@ void Config::populate_from_cmdline(const int argc, char * const * argv) {
         switch ( c ) {
             case 0:
                 m_opts_set[option_name] = option_arg;
+                m_opts_cmdline[option_name] = option_arg;
                 break;
 
             case '?':
@@ -0,0 +1,45 @@
+/*!
+ * \file            liveconfig.cpp
+ * \brief           Implementation of reloadable program configurations class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <sys/stat.h>
+
+#include "liveconfig.h"
+
+using namespace genleg;
+
+LiveConfig::LiveConfig(Config& config) :
+    m_config(config),
+    m_current(config.snapshot()),
+    m_reload_requested(false),
+    m_mtimes(file_mtimes()) {
+}
+
+bool LiveConfig::check() {
+    std::vector<std::time_t> mtimes = file_mtimes();
+    if ( !m_reload_requested.exchange(false) && mtimes == m_mtimes ) {
+        return false;
+    }
+
+    /*  Record the times first, so a bad file is not retried until it
+     *  changes again.                                                  */
+
+    m_mtimes.swap(mtimes);
+    m_config.reload();
+    std::atomic_store(&m_current, m_config.snapshot());
+    return true;
+}
+
+std::vector<std::time_t> LiveConfig::file_mtimes() const {
+    std::vector<std::time_t> mtimes;
+    for ( const auto& filename : m_config.files() ) {
+        struct stat st;
+        mtimes.push_back(::stat(filename.c_str(), &st) == 0 ?
+                         st.st_mtime : 0);
+    }
+    return mtimes;
+}
@@ -0,0 +1,94 @@
+/*!
+ * \file            liveconfig.h
+ * \brief           Interface to reloadable program configurations class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_LIVE_CONFIGURATION_H
+#define PG_GENERAL_LEDGER_LIVE_CONFIGURATION_H
+
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <vector>
+#include "config.h"
+
+namespace genleg {
+
+/*!
+ * \brief       Reloadable configuration options class
+ * \details     Publishes the options of a \c Config as a
+ * \c ConfigSnapshot, replaced as a whole when the configuration files are
+ * reloaded. Readers take the current snapshot with an atomic load and
+ * keep it for as long as they need it, so a reload never blocks them nor
+ * changes options under them.
+ * \ingroup     config
+ */
+class LiveConfig {
+    public:
+        /*!
+         * \brief           Constructor.
+         * \param config    The options, already populated. Only
+         * \c check() uses it after construction.
+         */
+        explicit LiveConfig (Config& config);
+
+        /*!  Deleted copy constructor  */
+        LiveConfig (const LiveConfig&) = delete;
+
+        /*!  Deleted copy assignment operator  */
+        LiveConfig& operator=(const LiveConfig&) = delete;
+
+        /*!
+         * \brief           Returns the current snapshot.
+         * \details         May be called from any thread.
+         * \returns         The current snapshot.
+         */
+        std::shared_ptr<const ConfigSnapshot> current() const {
+            return std::atomic_load(&m_current);
+        }
+
+        /*!
+         * \brief           Asks the next \c check() to reload.
+         * \details         Only sets a flag, so may be called from a signal
+         * handler, such as for \c SIGHUP.
+         */
+        void request_reload() { m_reload_requested = true; }
+
+        /*!
+         * \brief           Reloads the configuration files if a reload was
+         * requested or any of them has changed.
+         * \details         Should be called from one thread only.
+         * \returns         `true` if a new snapshot was published.
+         * \throws          ConfigException If a file cannot be reloaded, in
+         * which case the current snapshot stays published.
+         */
+        bool check();
+
+    private:
+        /*!  The options  */
+        Config& m_config;
+
+        /*!  The current snapshot  */
+        std::shared_ptr<const ConfigSnapshot> m_current;
+
+        /*!  Set when a reload has been requested  */
+        std::atomic<bool> m_reload_requested;
+
+        /*!  The modification time of each file when last read  */
+        std::vector<std::time_t> m_mtimes;
+
+        /*!
+         * \brief           Returns the modification time of each file.
+         * \returns         The modification times, or zero for a file
+         * which cannot be found.
+         */
+        std::vector<std::time_t> file_mtimes() const;
+
+};              //  class LiveConfig
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_LIVE_CONFIGURATION_H
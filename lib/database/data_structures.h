@@ -12,6 +12,8 @@
 #include "tablefield.h"
 #include "tablerow.h"
 #include "table.h"
+#include "tablewriter.h"
+#include "synthetic.h"
 
 #endif      /*  PG_DATABASE_DATA_STRUCTURES_H  */
 
@@ -12,6 +12,8 @@
 #include "data_structures.h"
 #include "dbconnimp.h"
 #include "dbconn.h"
+#include "dbcapture.h"
+#include "querystats.h"
 
 #endif      /*  PG_DATABASE_H  */
 
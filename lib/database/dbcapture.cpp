@@ -0,0 +1,428 @@
+/*!
+ * \file            dbcapture.cpp
+ * \brief           Implementation of query capture and replay classes
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <chrono>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include "dbcapture.h"
+
+using namespace gldb;
+
+/*!  Signature at the start of every capture file  */
+static const std::string capture_signature{"GLDBCAP1"};
+
+/*!
+ * \brief           Appends a variable length integer to a buffer.
+ * \details         Seven bits are written to each byte, low bits first,
+ * with the top bit set on every byte but the last.
+ * \param buffer    The buffer.
+ * \param value     The integer.
+ */
+static void put_number(std::string& buffer, uint64_t value);
+
+/*!
+ * \brief           Appends a length and string to a buffer.
+ * \param buffer    The buffer.
+ * \param str       The string.
+ */
+static void put_string(std::string& buffer, const std::string& str);
+
+/*!
+ * \brief           Reads a variable length integer from a buffer.
+ * \param buffer    The buffer.
+ * \param pos       The position to read from, which is advanced.
+ * \returns         The integer.
+ * \throws          DBCaptureException if the buffer ends first.
+ */
+static uint64_t get_number(const std::string& buffer, size_t& pos);
+
+/*!
+ * \brief           Reads a length and string from a buffer.
+ * \param buffer    The buffer.
+ * \param pos       The position to read from, which is advanced.
+ * \returns         The string.
+ * \throws          DBCaptureException if the buffer ends first.
+ */
+static std::string get_string(const std::string& buffer, size_t& pos);
+
+/*!
+ * \brief               Joins the statements of a batch.
+ * \param statements    The statements.
+ * \returns             The joined statements.
+ */
+static std::string join_batch(const std::vector<std::string>& statements);
+
+CaptureWriter::CaptureWriter(const std::string& filename,
+                             const std::string& database_type) :
+    m_mutex(), m_file(filename, std::ios::binary | std::ios::trunc)
+{
+    if ( !m_file ) {
+        throw DBCaptureException("Could not create capture file " + filename);
+    }
+
+    std::string header{capture_signature};
+    put_string(header, database_type);
+    m_file.write(header.data(), header.size());
+}
+
+void CaptureWriter::write(const CaptureEntry& entry)
+{
+    std::string record;
+    record += static_cast<char>(entry.op);
+    put_string(record, entry.sql);
+    put_number(record, entry.usecs);
+    record += static_cast<char>(entry.status);
+
+    if ( entry.status != CaptureStatus::ok ) {
+        put_number(record, entry.value);
+        put_string(record, entry.message);
+    }
+    else if ( entry.op == CaptureOp::last_auto_increment ) {
+        put_number(record, entry.value);
+    }
+    else if ( entry.op == CaptureOp::select ) {
+        const Table& table = entry.table;
+        put_number(record, table.num_fields());
+        for ( const auto& header : table.get_headers() ) {
+            put_string(record, header.str());
+        }
+        put_number(record, table.num_records());
+        for ( const auto& row : table ) {
+            for ( const auto& field : row ) {
+                put_string(record, field.str());
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file.write(record.data(), record.size());
+}
+
+CaptureLibrary::CaptureLibrary(const std::string& filename) :
+    m_mutex(), m_database_type(), m_entries(), m_remaining(0)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if ( !file ) {
+        throw DBCaptureException("Could not open capture file " + filename);
+    }
+    const std::string buffer{std::istreambuf_iterator<char>(file),
+                             std::istreambuf_iterator<char>()};
+
+    if ( buffer.compare(0, capture_signature.size(),
+                        capture_signature) != 0 ) {
+        throw DBCaptureException(filename + " is not a capture file");
+    }
+    size_t pos = capture_signature.size();
+    m_database_type = get_string(buffer, pos);
+
+    while ( pos < buffer.size() ) {
+        CaptureEntry entry;
+        entry.op = static_cast<CaptureOp>(buffer[pos++]);
+        entry.sql = get_string(buffer, pos);
+        entry.usecs = get_number(buffer, pos);
+        if ( pos == buffer.size() ) {
+            throw DBCaptureException("Capture file " + filename +
+                                     " is truncated");
+        }
+        entry.status = static_cast<CaptureStatus>(buffer[pos++]);
+
+        if ( entry.status != CaptureStatus::ok ) {
+            entry.value = get_number(buffer, pos);
+            entry.message = get_string(buffer, pos);
+        }
+        else if ( entry.op == CaptureOp::last_auto_increment ) {
+            entry.value = get_number(buffer, pos);
+        }
+        else if ( entry.op == CaptureOp::select ) {
+
+            /*  Every field takes at least its length byte, so counts the
+             *  rest of the file cannot hold are refused before any rows
+             *  are added for them                                       */
+
+            const uint64_t num_fields = get_number(buffer, pos);
+            if ( num_fields > buffer.size() - pos ) {
+                throw DBCaptureException("Capture file " + filename +
+                                         " is truncated");
+            }
+            TableRow headers;
+            for ( size_t i = 0; i < num_fields; ++i ) {
+                headers.append_field(get_string(buffer, pos));
+            }
+            Table table{std::move(headers)};
+            const uint64_t num_records = get_number(buffer, pos);
+            if ( num_fields == 0 ? num_records != 0 :
+                 num_records > (buffer.size() - pos) / num_fields ) {
+                throw DBCaptureException("Capture file " + filename +
+                                         " has a bad row count");
+            }
+            for ( size_t r = 0; r < num_records; ++r ) {
+                TableRow row;
+                for ( size_t i = 0; i < num_fields; ++i ) {
+                    row.append_field(get_string(buffer, pos));
+                }
+                table.append_record(std::move(row));
+            }
+            entry.table = std::move(table);
+        }
+
+        auto key = std::make_pair(entry.op, entry.sql);
+        m_entries[std::move(key)].push_back(std::move(entry));
+        ++m_remaining;
+    }
+}
+
+size_t CaptureLibrary::remaining() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_remaining;
+}
+
+CaptureEntry CaptureLibrary::take(const CaptureOp op, const std::string& sql)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_entries.find(std::make_pair(op, sql));
+    if ( found == m_entries.end() || found->second.empty() ) {
+        throw DBCaptureException("No recorded result for: " +
+                                 (sql.empty() ? "transaction" : sql));
+    }
+
+    CaptureEntry entry{std::move(found->second.front())};
+    found->second.pop_front();
+    --m_remaining;
+    return entry;
+}
+
+DBConnRecorder::DBConnRecorder(DBConnImp * imp,
+                               std::shared_ptr<CaptureWriter> writer) :
+    m_imp(imp), m_writer(std::move(writer)), m_last_sql()
+{
+}
+
+void DBConnRecorder::query(const std::string& sql_query)
+{
+    CaptureEntry entry;
+    entry.op = CaptureOp::query;
+    entry.sql = sql_query;
+    record(entry, [this, &sql_query]() { m_imp->query(sql_query); });
+}
+
+Table DBConnRecorder::select(const std::string& query)
+{
+    CaptureEntry entry;
+    entry.op = CaptureOp::select;
+    entry.sql = query;
+    record(entry, [this, &entry, &query]() {
+        entry.table = m_imp->select(query);
+    });
+    return std::move(entry.table);
+}
+
+void DBConnRecorder::query_batch(const std::vector<std::string>& statements)
+{
+    CaptureEntry entry;
+    entry.op = CaptureOp::batch;
+    entry.sql = join_batch(statements);
+    record(entry, [this, &statements]() { m_imp->query_batch(statements); });
+}
+
+void DBConnRecorder::begin_transaction()
+{
+    CaptureEntry entry;
+    entry.op = CaptureOp::begin;
+    record(entry, [this]() { m_imp->begin_transaction(); });
+}
+
+void DBConnRecorder::rollback_transaction()
+{
+    CaptureEntry entry;
+    entry.op = CaptureOp::rollback;
+    record(entry, [this]() { m_imp->rollback_transaction(); });
+}
+
+void DBConnRecorder::commit_transaction()
+{
+    CaptureEntry entry;
+    entry.op = CaptureOp::commit;
+    record(entry, [this]() { m_imp->commit_transaction(); });
+}
+
+unsigned long long DBConnRecorder::last_auto_increment()
+{
+
+    /*  The value depends on the insert before it, so that statement
+     *  identifies it on replay.                                        */
+
+    CaptureEntry entry;
+    entry.op = CaptureOp::last_auto_increment;
+    entry.sql = m_last_sql;
+    record(entry, [this, &entry]() {
+        entry.value = m_imp->last_auto_increment();
+    });
+    return entry.value;
+}
+
+template <class Action>
+void DBConnRecorder::record(CaptureEntry& entry, Action action)
+{
+    using clock = std::chrono::steady_clock;
+    const clock::time_point start = clock::now();
+
+    try {
+        action();
+    }
+    catch ( const DBConnBatchFailed& e ) {
+        entry.status = CaptureStatus::batch_failed;
+        entry.value = e.index();
+        entry.message = e.what();
+    }
+    catch ( const DBConnCouldNotQuery& e ) {
+        entry.status = CaptureStatus::could_not_query;
+        entry.message = e.what();
+    }
+    catch ( const DBConnException& e ) {
+        entry.status = CaptureStatus::failed;
+        entry.message = e.what();
+    }
+
+    entry.usecs = std::chrono::duration_cast<std::chrono::microseconds>(
+            clock::now() - start).count();
+    if ( entry.op != CaptureOp::last_auto_increment ) {
+        m_last_sql = entry.sql;
+    }
+    m_writer->write(entry);
+
+    switch ( entry.status ) {
+        case CaptureStatus::batch_failed:
+            throw DBConnBatchFailed(entry.value, entry.message);
+        case CaptureStatus::could_not_query:
+            throw DBConnCouldNotQuery(entry.message);
+        case CaptureStatus::failed:
+            throw DBConnException(entry.message);
+        default:
+            break;
+    }
+}
+
+DBConnReplay::DBConnReplay(std::shared_ptr<CaptureLibrary> library,
+                           const bool timed) :
+    m_library(std::move(library)), m_timed(timed), m_last_sql()
+{
+}
+
+void DBConnReplay::query(const std::string& sql_query)
+{
+    replay(CaptureOp::query, sql_query);
+}
+
+Table DBConnReplay::select(const std::string& query)
+{
+    return std::move(replay(CaptureOp::select, query).table);
+}
+
+void DBConnReplay::query_batch(const std::vector<std::string>& statements)
+{
+    replay(CaptureOp::batch, join_batch(statements));
+}
+
+void DBConnReplay::begin_transaction()
+{
+    replay(CaptureOp::begin, "");
+}
+
+void DBConnReplay::rollback_transaction()
+{
+    replay(CaptureOp::rollback, "");
+}
+
+void DBConnReplay::commit_transaction()
+{
+    replay(CaptureOp::commit, "");
+}
+
+unsigned long long DBConnReplay::last_auto_increment()
+{
+    return replay(CaptureOp::last_auto_increment, m_last_sql).value;
+}
+
+CaptureEntry DBConnReplay::replay(const CaptureOp op, const std::string& sql)
+{
+    CaptureEntry entry{m_library->take(op, sql)};
+    if ( op != CaptureOp::last_auto_increment ) {
+        m_last_sql = sql;
+    }
+    if ( m_timed ) {
+        std::this_thread::sleep_for(std::chrono::microseconds(entry.usecs));
+    }
+
+    switch ( entry.status ) {
+        case CaptureStatus::batch_failed:
+            throw DBConnBatchFailed(entry.value, entry.message);
+        case CaptureStatus::could_not_query:
+            throw DBConnCouldNotQuery(entry.message);
+        case CaptureStatus::failed:
+            throw DBConnException(entry.message);
+        default:
+            break;
+    }
+    return entry;
+}
+
+static void put_number(std::string& buffer, uint64_t value)
+{
+    while ( value >= 0x80 ) {
+        buffer += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buffer += static_cast<char>(value);
+}
+
+static void put_string(std::string& buffer, const std::string& str)
+{
+    put_number(buffer, str.size());
+    buffer += str;
+}
+
+static uint64_t get_number(const std::string& buffer, size_t& pos)
+{
+    uint64_t value = 0;
+    for ( unsigned shift = 0; shift < 64; shift += 7 ) {
+        if ( pos == buffer.size() ) {
+            break;
+        }
+        const unsigned char byte = buffer[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ( !(byte & 0x80) ) {
+            return value;
+        }
+    }
+    throw DBCaptureException("Capture file is truncated");
+}
+
+static std::string get_string(const std::string& buffer, size_t& pos)
+{
+    const uint64_t length = get_number(buffer, pos);
+    if ( length > buffer.size() - pos ) {
+        throw DBCaptureException("Capture file is truncated");
+    }
+    std::string str{buffer, pos, static_cast<size_t>(length)};
+    pos += length;
+    return str;
+}
+
+static std::string join_batch(const std::vector<std::string>& statements)
+{
+    std::string joined;
+    for ( const auto& statement : statements ) {
+        if ( !joined.empty() ) {
+            joined += ";\n";
+        }
+        joined += statement;
+    }
+    return joined;
+}
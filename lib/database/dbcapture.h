@@ -0,0 +1,396 @@
+/*!
+ * \file            dbcapture.h
+ * \brief           Interface to query capture and replay classes
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_DATABASE_DBCAPTURE_H
+#define PG_DATABASE_DBCAPTURE_H
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "data_structures.h"
+#include "dbconnimp.h"
+#include "dbconn.h"
+
+namespace gldb {
+
+/*!
+ * \brief       Capture file exception class
+ * \ingroup     database
+ */
+class DBCaptureException : public DBConnException {
+    public:
+        /*!
+         * \brief           Constructor
+         * \param msg       Error message
+         */
+        explicit DBCaptureException(const std::string& msg) :
+            DBConnException(msg) {};
+};
+
+/*!
+ * \brief           Captured operation type.
+ * \ingroup         database
+ */
+enum class CaptureOp : unsigned char {
+    query = 1,              /*!<  \c DBConnImp::query()  */
+    select,                 /*!<  \c DBConnImp::select()  */
+    batch,                  /*!<  \c DBConnImp::query_batch()  */
+    begin,                  /*!<  \c DBConnImp::begin_transaction()  */
+    rollback,               /*!<  \c DBConnImp::rollback_transaction()  */
+    commit,                 /*!<  \c DBConnImp::commit_transaction()  */
+    last_auto_increment     /*!<  \c DBConnImp::last_auto_increment()  */
+};
+
+/*!
+ * \brief           Captured operation outcome.
+ * \ingroup         database
+ */
+enum class CaptureStatus : unsigned char {
+    ok = 0,                 /*!<  Succeeded  */
+    could_not_query,        /*!<  Threw \c DBConnCouldNotQuery  */
+    batch_failed,           /*!<  Threw \c DBConnBatchFailed  */
+    failed                  /*!<  Threw another \c DBConnException  */
+};
+
+/*!
+ * \brief           Captured operation.
+ * \ingroup         database
+ */
+struct CaptureEntry {
+    /*!  The operation  */
+    CaptureOp op;
+
+    /*!  The statement, the statements of a batch joined by semicolons,
+     *   or for \c last_auto_increment the statement before it  */
+    std::string sql;
+
+    /*!  The time taken in microseconds  */
+    uint64_t usecs;
+
+    /*!  The outcome  */
+    CaptureStatus status;
+
+    /*!  The auto increment value, or the index of a failed batch
+     *   statement  */
+    uint64_t value;
+
+    /*!  The error message, if the operation failed  */
+    std::string message;
+
+    /*!  The result of a successful \c select  */
+    Table table;
+
+    /*!  Constructor  */
+    CaptureEntry () :
+        op(CaptureOp::query), sql(), usecs(0), status(CaptureStatus::ok),
+        value(0), message(), table(TableRow{}) {}
+};
+
+/*!
+ * \brief           Capture file writer class.
+ * \details         A capture file starts with a signature and the database
+ * type, followed by one record per operation, with lengths and numbers
+ * written as variable length integers. One writer may be shared by any
+ * number of recording connections, whose records are interleaved in the
+ * order their operations finished.
+ * \ingroup         database
+ */
+class CaptureWriter {
+    public:
+
+        /*!
+         * \brief               Constructor.
+         * \param filename      The capture file, which is overwritten.
+         * \param database_type The database type, which selects the SQL
+         * dialect on replay.
+         * \throws              DBCaptureException if the file could not
+         * be created.
+         */
+        CaptureWriter (const std::string& filename,
+                       const std::string& database_type);
+
+        /*!  Deleted copy constructor  */
+        CaptureWriter (const CaptureWriter&) = delete;
+
+        /*!  Deleted assignment operator  */
+        CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+        /*!
+         * \brief           Writes an operation.
+         * \param entry     The operation.
+         */
+        void write(const CaptureEntry& entry);
+
+    private:
+
+        /*!  Protects the file  */
+        std::mutex m_mutex;
+
+        /*!  The file  */
+        std::ofstream m_file;
+
+};              //  class CaptureWriter
+
+/*!
+ * \brief           Capture file contents class.
+ * \details         Holds every recorded operation, queued by operation and
+ * statement in the order recorded. Replaying a statement takes the next
+ * recording of it, so a run which issues the same statements in the same
+ * order as the recorded run gets the same results, however they were
+ * spread across connections.
+ * \ingroup         database
+ */
+class CaptureLibrary {
+    public:
+
+        /*!
+         * \brief           Constructor, which reads a capture file.
+         * \param filename  The capture file.
+         * \throws          DBCaptureException if the file could not be
+         * read or is not a capture file.
+         */
+        explicit CaptureLibrary (const std::string& filename);
+
+        /*!  Deleted copy constructor  */
+        CaptureLibrary (const CaptureLibrary&) = delete;
+
+        /*!  Deleted assignment operator  */
+        CaptureLibrary& operator=(const CaptureLibrary&) = delete;
+
+        /*!
+         * \brief           Returns the recorded database type.
+         * \returns         The database type.
+         */
+        const std::string& database_type() const { return m_database_type; }
+
+        /*!
+         * \brief           Returns the number of operations not yet
+         * replayed.
+         * \returns         The number of operations.
+         */
+        size_t remaining() const;
+
+        /*!
+         * \brief           Takes the next recording of an operation.
+         * \param op        The operation.
+         * \param sql       The statement.
+         * \returns         The recorded operation.
+         * \throws          DBCaptureException if there is no recording
+         * left.
+         */
+        CaptureEntry take(const CaptureOp op, const std::string& sql);
+
+    private:
+
+        /*!  Protects the recordings  */
+        mutable std::mutex m_mutex;
+
+        /*!  The recorded database type  */
+        std::string m_database_type;
+
+        /*!  Recordings by operation and statement  */
+        std::map<std::pair<CaptureOp, std::string>,
+                 std::deque<CaptureEntry>> m_entries;
+
+        /*!  Number of recordings not yet taken  */
+        size_t m_remaining;
+
+};              //  class CaptureLibrary
+
+/*!
+ * \brief           Recording database implementation class.
+ * \details         Passes every operation to another implementation, and
+ * writes the operation with its result or error and the time it took to a
+ * capture file.
+ * \ingroup         database
+ */
+class DBConnRecorder : public DBConnImp {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \param imp       The implementation to record, which the
+         * recorder takes ownership of.
+         * \param writer    The capture file writer.
+         */
+        DBConnRecorder (DBConnImp * imp,
+                        std::shared_ptr<CaptureWriter> writer);
+
+        /*!  Deleted copy constructor  */
+        DBConnRecorder (const DBConnRecorder&) = delete;
+
+        /*!  Deleted assignment operator  */
+        DBConnRecorder& operator=(const DBConnRecorder&) = delete;
+
+        /*!
+         * \brief           Runs and records an SQL query.
+         * \param sql_query The query.
+         */
+        virtual void query(const std::string& sql_query);
+
+        /*!
+         * \brief           Runs and records an SQL SELECT query.
+         * \param query     The query.
+         * \returns         A Table object containing the results.
+         */
+        virtual Table select(const std::string& query);
+
+        /*!
+         * \brief               Runs and records a batch of statements.
+         * \param statements    The statements.
+         */
+        virtual void query_batch(const std::vector<std::string>& statements);
+
+        /*!
+         * \brief           Begins a transaction.
+         */
+        virtual void begin_transaction();
+
+        /*!
+         * \brief           Rolls back a transaction.
+         */
+        virtual void rollback_transaction();
+
+        /*!
+         * \brief           Commits a transaction.
+         */
+        virtual void commit_transaction();
+
+        /*!
+         * \brief           Returns the last auto incremented value.
+         * \returns         The last auto incremented value.
+         */
+        virtual unsigned long long last_auto_increment();
+
+        /*!
+         * \brief           Returns the size of the last result.
+         * \returns         The size reported by the wrapped connection.
+         */
+        virtual unsigned long long last_result_bytes() const {
+            return m_imp->last_result_bytes();
+        }
+
+        /*!  Prepares the wrapped connection for the calling thread  */
+        virtual void thread_init() { m_imp->thread_init(); }
+
+        /*!  Releases what \c thread_init() set up  */
+        virtual void thread_end() { m_imp->thread_end(); }
+
+    private:
+
+        /*!  The recorded implementation  */
+        std::unique_ptr<DBConnImp> m_imp;
+
+        /*!  The capture file writer  */
+        std::shared_ptr<CaptureWriter> m_writer;
+
+        /*!  The last statement run  */
+        std::string m_last_sql;
+
+        /*!
+         * \brief           Runs and records an operation.
+         * \param entry     The operation, to which the outcome is added.
+         * \param action    Runs the operation.
+         */
+        template <class Action>
+        void record(CaptureEntry& entry, Action action);
+
+};              //  class DBConnRecorder
+
+/*!
+ * \brief           Replaying database implementation class.
+ * \details         Serves recorded results and errors without a database,
+ * optionally taking as long over each as the recorded operation took.
+ * \ingroup         database
+ */
+class DBConnReplay : public DBConnImp {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \param library   The recorded operations.
+         * \param timed     \c true to wait for the recorded time of each
+         * operation.
+         */
+        DBConnReplay (std::shared_ptr<CaptureLibrary> library,
+                      const bool timed);
+
+        /*!
+         * \brief           Replays an SQL query.
+         * \param sql_query The query.
+         * \throws          DBCaptureException if it was not recorded.
+         */
+        virtual void query(const std::string& sql_query);
+
+        /*!
+         * \brief           Replays an SQL SELECT query.
+         * \param query     The query.
+         * \returns         The recorded results.
+         * \throws          DBCaptureException if it was not recorded.
+         */
+        virtual Table select(const std::string& query);
+
+        /*!
+         * \brief               Replays a batch of statements.
+         * \param statements    The statements.
+         * \throws              DBCaptureException if it was not recorded.
+         */
+        virtual void query_batch(const std::vector<std::string>& statements);
+
+        /*!
+         * \brief           Replays beginning a transaction.
+         */
+        virtual void begin_transaction();
+
+        /*!
+         * \brief           Replays rolling back a transaction.
+         */
+        virtual void rollback_transaction();
+
+        /*!
+         * \brief           Replays committing a transaction.
+         */
+        virtual void commit_transaction();
+
+        /*!
+         * \brief           Returns the recorded auto incremented value.
+         * \returns         The recorded auto incremented value.
+         */
+        virtual unsigned long long last_auto_increment();
+
+    private:
+
+        /*!  The recorded operations  */
+        std::shared_ptr<CaptureLibrary> m_library;
+
+        /*!  Whether to wait for the recorded time  */
+        const bool m_timed;
+
+        /*!  The last statement replayed  */
+        std::string m_last_sql;
+
+        /*!
+         * \brief           Replays an operation.
+         * \details         Rethrows the recorded error, if any.
+         * \param op        The operation.
+         * \param sql       The statement.
+         * \returns         The recorded operation.
+         */
+        CaptureEntry replay(const CaptureOp op, const std::string& sql);
+
+};              //  class DBConnReplay
+
+}               //  namespace gldb
+
+#endif          //  PG_DATABASE_DBCAPTURE_H
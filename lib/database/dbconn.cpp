@@ -6,38 +6,280 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <chrono>
 #include "dbconn.h"
+#include "querystats.h"
 
 using namespace gldb;
 
-DBConn::DBConn(DBConnImp * imp) : m_imp(imp) {
+namespace {
+
+/*!
+ * \brief           Statement timer class.
+ * \details         Records a statement in the query statistics when it
+ * finishes, or as failed if it is destroyed first by an exception. If
+ * query statistics are not enabled when it is made, it does nothing, and
+ * the statement is neither timed nor classified.
+ * \ingroup         database
+ */
+class StatementTimer {
+    public:
+
+        /*!
+         * \brief           Constructor, which starts the timer.
+         * \param name      The statement class, or empty to classify
+         * \c sql.
+         * \param sql       The statement, which must outlive the timer.
+         * \param prefix    A prefix for the class when \c sql is
+         * classified.
+         */
+        StatementTimer (const char * name, const std::string& sql,
+                        const char * prefix = "") :
+            m_active(QueryStats::instance().enabled()),
+            m_name(name), m_prefix(prefix), m_sql(sql),
+            m_start(m_active ? clock::now() : clock::time_point{}),
+            m_done(false) {}
+
+        /*!  Destructor, which records a failure if not done  */
+        ~StatementTimer () {
+            if ( !m_done ) {
+                record(0, 0, true);
+            }
+        }
+
+        /*!  Deleted copy constructor  */
+        StatementTimer (const StatementTimer&) = delete;
+
+        /*!  Deleted assignment operator  */
+        StatementTimer& operator=(const StatementTimer&) = delete;
+
+        /*!
+         * \brief           Records the statement as successful.
+         * \param rows      The number of rows returned.
+         * \param bytes     The bytes of field data returned.
+         */
+        void done(const uint64_t rows = 0, const uint64_t bytes = 0) {
+            m_done = true;
+            record(rows, bytes, false);
+        }
+
+    private:
+
+        /*!  Alias for clock type  */
+        using clock = std::chrono::steady_clock;
+
+        /*!  Whether the statement is being timed  */
+        const bool m_active;
+
+        /*!  The statement class, or empty to classify \c m_sql  */
+        const char * const m_name;
+
+        /*!  The prefix for a classified statement class  */
+        const char * const m_prefix;
+
+        /*!  The statement  */
+        const std::string& m_sql;
+
+        /*!  When the statement started  */
+        const clock::time_point m_start;
+
+        /*!  Whether the statement has been recorded  */
+        bool m_done;
+
+        /*!
+         * \brief           Records the statement, if being timed.
+         * \param rows      The number of rows returned.
+         * \param bytes     The bytes of field data returned.
+         * \param failed    \c true if the statement failed.
+         */
+        void record(const uint64_t rows, const uint64_t bytes,
+                    const bool failed) {
+            if ( !m_active ) {
+                return;
+            }
+            const uint64_t usecs = std::chrono::duration_cast<
+                std::chrono::microseconds>(clock::now() - m_start).count();
+            const std::string name = *m_name ? std::string{m_name} :
+                m_prefix + QueryStats::classify(m_sql);
+            QueryStats::instance().record(name, m_sql, usecs,
+                                          rows, bytes, failed);
+        }
+};
+
+/*!  Statement text recorded for transaction control  */
+const std::string begin_sql{"BEGIN"};
+
+/*!  Statement text recorded for transaction control  */
+const std::string rollback_sql{"ROLLBACK"};
+
+/*!  Statement text recorded for transaction control  */
+const std::string commit_sql{"COMMIT"};
+
+}               //  namespace
+
+DBConn::DBConn(DBConnImp * imp) :
+    m_imp(imp), m_mutex(), m_imp_mutex(), m_jobs(), m_running(false),
+    m_thread() {
 }
 
 DBConn::~DBConn() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        thread = std::move(m_thread);
+    }
+    if ( thread.joinable() ) {
+        thread.join();
+    }
     delete m_imp;
 }
 
 void DBConn::query(const std::string& sql_query) {
-    m_imp->query(sql_query);
+    run<void>([this, sql_query]() { timed_query(sql_query); });
 }
 
 Table DBConn::select(const std::string& query) {
-    return m_imp->select(query);
+    return run<Table>([this, query]() { return timed_select(query); });
+}
+
+void DBConn::query_batch(const std::vector<std::string>& statements) {
+    run<void>([this, &statements]() { timed_batch(statements); });
+}
+
+std::future<void> DBConn::query_async(const std::string& sql_query) {
+    return submit<void>([this, sql_query]() { timed_query(sql_query); });
+}
+
+std::future<Table> DBConn::select_async(const std::string& query) {
+    return submit<Table>([this, query]() { return timed_select(query); });
 }
 
 void DBConn::begin_transaction() {
-    m_imp->begin_transaction();
+    run<void>([this]() {
+        StatementTimer timer{"begin", begin_sql};
+        m_imp->begin_transaction();
+        timer.done();
+    });
 }
 
 void DBConn::rollback_transaction() {
-    m_imp->rollback_transaction();
+    run<void>([this]() {
+        StatementTimer timer{"rollback", rollback_sql};
+        m_imp->rollback_transaction();
+        timer.done();
+    });
 }
 
 void DBConn::commit_transaction() {
-    m_imp->commit_transaction();
+    run<void>([this]() {
+        StatementTimer timer{"commit", commit_sql};
+        m_imp->commit_transaction();
+        timer.done();
+    });
 }
 
 unsigned long long DBConn::last_auto_increment() {
-    return m_imp->last_auto_increment();
+    return run<unsigned long long>([this]() {
+        return m_imp->last_auto_increment();
+    });
+}
+
+void DBConn::timed_query(const std::string& sql_query) {
+    StatementTimer timer{"", sql_query};
+    m_imp->query(sql_query);
+    timer.done();
+}
+
+Table DBConn::timed_select(const std::string& query) {
+    StatementTimer timer{"", query};
+    Table table{m_imp->select(query)};
+    timer.done(table.num_records(), m_imp->last_result_bytes());
+    return table;
+}
+
+void DBConn::timed_batch(const std::vector<std::string>& statements) {
+    if ( statements.empty() ) {
+        return;
+    }
+
+    /*  A batch is one operation, recorded under its first statement  */
+
+    StatementTimer timer{"", statements[0], "batch "};
+    m_imp->query_batch(statements);
+    timer.done();
 }
 
+template <class Result>
+std::future<Result> DBConn::submit(std::function<Result()> job) {
+
+    /*  std::function needs a copyable target, so the task is shared  */
+
+    auto task = std::make_shared<std::packaged_task<Result()>>(
+            std::move(job));
+    std::future<Result> result = task->get_future();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.emplace_back([task]() { (*task)(); });
+    if ( !m_running ) {
+
+        /*  A thread which has stopped running has left the queue, and
+         *  only has to return, so joining it here does not wait long.  */
+
+        if ( m_thread.joinable() ) {
+            m_thread.join();
+        }
+        m_running = true;
+        m_thread = std::thread(&DBConn::run_io_thread, this);
+    }
+
+    return result;
+}
+
+template <class Result>
+Result DBConn::run(std::function<Result()> job) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if ( m_running ) {
+        lock.unlock();
+        return submit<Result>(std::move(job)).get();
+    }
+
+    /*  Taking the connection before letting go of the queue keeps any
+     *  job queued after this one from running before it  */
+
+    std::lock_guard<std::mutex> imp_lock(m_imp_mutex);
+    lock.unlock();
+    return job();
+}
+
+void DBConn::run_io_thread() {
+    m_imp->thread_init();
+    while ( true ) {
+        std::function<void()> job;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if ( m_jobs.empty() ) {
+                m_running = false;
+                break;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        std::lock_guard<std::mutex> imp_lock(m_imp_mutex);
+        job();
+    }
+
+    /*  The destructor joins this thread before deleting the connection  */
+
+    m_imp->thread_end();
+}
+
+void DBConnImp::query_batch(const std::vector<std::string>& statements) {
+    for ( size_t i = 0; i < statements.size(); ++i ) {
+        try {
+            query(statements[i]);
+        }
+        catch ( const DBConnCouldNotQuery& e ) {
+            throw DBConnBatchFailed(i, e.what());
+        }
+    }
+}
@@ -9,9 +9,15 @@
 #ifndef PG_DATABASE_DBCONN_H
 #define PG_DATABASE_DBCONN_H
 
+#include <deque>
+#include <functional>
+#include <future>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include "data_structures.h"
 #include "dbconnimp.h"
@@ -60,8 +66,50 @@ class DBConnCouldNotQuery : public DBConnException {
             DBConnException(msg) {};
 };
 
+/*!
+ * \brief       Failed statement in a batch exception class
+ * \ingroup     database
+ */
+class DBConnBatchFailed : public DBConnCouldNotQuery {
+    public:
+        /*!
+         * \brief           Constructor
+         * \param index     Zero-based index of the failed statement
+         * \param msg       Database error message
+         */
+        DBConnBatchFailed(const size_t index, const std::string& msg) :
+            DBConnCouldNotQuery(msg), m_index(index) {};
+
+        /*!
+         * \brief           Returns the index of the failed statement.
+         * \details         Statements before it were run, and statements
+         * after it were not.
+         * \returns         The zero-based index of the failed statement.
+         */
+        size_t index() const { return m_index; }
+
+    private:
+
+        /*!  Index of the failed statement  */
+        size_t m_index;
+};
+
 /*! 
  * \brief       Database connection class
+ * \details     Queries may be run asynchronously. An asynchronous call
+ * starts an I/O thread for the connection if none is running, which runs
+ * queued queries one at a time in the order they were made, while the
+ * caller carries on, and exits when the queue is empty. While the thread
+ * is running, synchronous calls are queued behind any outstanding
+ * asynchronous ones and waited for, so statements are always run in the
+ * order they are made, and a transaction commits everything queued before
+ * it. Otherwise they run on the calling thread. Only one statement runs
+ * on the connection at a time, whichever thread makes it, so queries on
+ * one connection never overlap each other. To overlap queries, run them
+ * on separate connections.
+ *
+ * Once \c QueryStats is enabled, the time taken by every statement, and
+ * the rows and bytes it returns, are recorded there.
  * \ingroup     database
  */
 class DBConn {
@@ -91,6 +139,31 @@ class DBConn {
          */
         Table select(const std::string& query);
 
+        /*!
+         * \brief           Runs an SQL query asynchronously.
+         * \param sql_query The query.
+         * \returns         A future which becomes ready when the query has
+         * run, and rethrows any exception it threw.
+         */
+        std::future<void> query_async(const std::string& sql_query);
+
+        /*!
+         * \brief               Runs a batch of SQL statements which return
+         * no results, in as few round trips as the backend allows.
+         * \param statements    The statements.
+         * \throws              DBConnBatchFailed If a statement failed,
+         * giving its index.
+         */
+        void query_batch(const std::vector<std::string>& statements);
+
+        /*!
+         * \brief           Runs an SQL SELECT query asynchronously.
+         * \param query     The query.
+         * \returns         A future for a Table object containing the
+         * results, which rethrows any exception the query threw.
+         */
+        std::future<Table> select_async(const std::string& query);
+
         /*!
          * \brief           Begins a transaction.
          */
@@ -129,6 +202,66 @@ class DBConn {
         /*!  Pointer to database implementation object.  */
         DBConnImp * m_imp;
 
+        /*!  Protects the job queue and the I/O thread  */
+        std::mutex m_mutex;
+
+        /*!  Held while a job runs, so only one uses the connection  */
+        std::mutex m_imp_mutex;
+
+        /*!  Jobs waiting for the I/O thread  */
+        std::deque<std::function<void()>> m_jobs;
+
+        /*!  Whether the I/O thread is running jobs  */
+        bool m_running;
+
+        /*!  The I/O thread, if one has been started  */
+        std::thread m_thread;
+
+        /*!
+         * \brief           Queues a job for the I/O thread.
+         * \details         Starts the thread if it is not running, after
+         * joining any thread which has already exited.
+         * \param job       The job.
+         * \returns         A future for the result of the job.
+         */
+        template <class Result>
+        std::future<Result> submit(std::function<Result()> job);
+
+        /*!
+         * \brief           Runs a job now, or on the I/O thread after any
+         * queued jobs if it is running.
+         * \param job       The job.
+         * \returns         The result of the job.
+         */
+        template <class Result>
+        Result run(std::function<Result()> job);
+
+        /*!
+         * \brief           Runs queued jobs until the queue is empty.
+         */
+        void run_io_thread();
+
+        /*!
+         * \brief           Runs an SQL query and records its statistics.
+         * \param sql_query The query.
+         */
+        void timed_query(const std::string& sql_query);
+
+        /*!
+         * \brief           Runs an SQL SELECT query and records its
+         * statistics.
+         * \param query     The query.
+         * \returns         A Table object containing the results.
+         */
+        Table timed_select(const std::string& query);
+
+        /*!
+         * \brief               Runs a batch of SQL statements and records
+         * its statistics.
+         * \param statements    The statements.
+         */
+        void timed_batch(const std::vector<std::string>& statements);
+
 };              //  class DBConn
 
 }               //  namespace gldb
@@ -10,6 +10,7 @@
 #define PG_DATABASE_DBCONNIMP_H
 
 #include <string>
+#include <vector>
 
 #include "data_structures.h"
 
@@ -40,6 +41,46 @@ class DBConnImp {
          */
         virtual Table select(const std::string& query) = 0;
 
+        /*!
+         * \brief               Runs a batch of SQL statements which return
+         * no results.
+         * \details             Statements are run in order, and the batch
+         * stops at the first which fails. The default runs each with
+         * \c query(). Implementations for which each statement costs a
+         * round trip to a server send the batch together.
+         * \param statements    The statements.
+         * \throws              DBConnBatchFailed If a statement failed,
+         * giving its index.
+         */
+        virtual void query_batch(const std::vector<std::string>& statements);
+
+        /*!
+         * \brief           Returns the size of the last result.
+         * \details         Implementations count the bytes of field data
+         * as they read each row, so the size costs nothing more to know.
+         * The default, for those which do not, is zero.
+         * \returns         The bytes of field data in the result last
+         * returned by \c select().
+         */
+        virtual unsigned long long last_result_bytes() const { return 0; }
+
+        /*!
+         * \brief           Prepares the calling thread to use the
+         * connection.
+         * \details         Called by a thread other than the one which
+         * made the connection before it first uses it, for client
+         * libraries which keep state for each thread. The default does
+         * nothing.
+         */
+        virtual void thread_init() {}
+
+        /*!
+         * \brief           Releases what \c thread_init() set up.
+         * \details         Called by the same thread once it has finished
+         * with the connection. The default does nothing.
+         */
+        virtual void thread_end() {}
+
         /*!
          * \brief           Begins a transaction.
          */
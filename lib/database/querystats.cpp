@@ -0,0 +1,362 @@
+/*!
+ * \file            querystats.cpp
+ * \brief           Implementation of query statistics classes
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <cctype>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include "querystats.h"
+
+using namespace gldb;
+
+/*!  Number of buckets in each power of two, as a power of two  */
+static const unsigned sub_bucket_bits = 4;
+
+/*!  Number of buckets in each power of two  */
+static const uint64_t sub_buckets = 1 << sub_bucket_bits;
+
+/*!  Longest statement text written to the slow query log  */
+static const size_t max_logged_sql = 200;
+
+/*!
+ * \brief           Returns the index of the highest set bit.
+ * \param value     The value, not zero.
+ * \returns         The bit index.
+ */
+static unsigned highest_bit(uint64_t value);
+
+/*!
+ * \brief           Splits a statement into lower case words.
+ * \details         Quoted strings are skipped, and only the first
+ * \c max_words words are returned.
+ * \param sql       The statement.
+ * \param max_words The most words to return.
+ * \returns         The words.
+ */
+static std::vector<std::string> statement_words(const std::string& sql,
+                                                const size_t max_words);
+
+LatencyHistogram::LatencyHistogram() :
+    m_count{0}, m_total{0}, m_max{0}
+{
+    for ( auto& count : m_buckets ) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::record(const uint64_t usecs)
+{
+    m_buckets[bucket(usecs)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(usecs, std::memory_order_relaxed);
+
+    uint64_t current = m_max.load(std::memory_order_relaxed);
+    while ( usecs > current &&
+            !m_max.compare_exchange_weak(current, usecs,
+                                         std::memory_order_relaxed) ) {
+    }
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::max() const
+{
+    return m_max.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::total() const
+{
+    return m_total.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(const double pct) const
+{
+
+    /*  Counts are read one at a time while other threads may be
+     *  recording, so the total is taken from the buckets themselves.  */
+
+    uint64_t counts[num_buckets];
+    uint64_t total = 0;
+    for ( size_t i = 0; i < num_buckets; ++i ) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if ( total == 0 ) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(pct / 100.0 * total + 0.5);
+    if ( rank < 1 ) {
+        rank = 1;
+    }
+    else if ( rank > total ) {
+        rank = total;
+    }
+
+    uint64_t seen = 0;
+    for ( size_t i = 0; i < num_buckets; ++i ) {
+        seen += counts[i];
+        if ( seen >= rank ) {
+            const uint64_t high = bucket_high(i);
+            return high < max() ? high : max();
+        }
+    }
+    return max();
+}
+
+size_t LatencyHistogram::bucket(const uint64_t usecs)
+{
+    if ( usecs < 2 * sub_buckets ) {
+        return usecs;
+    }
+    const unsigned shift = highest_bit(usecs) - sub_bucket_bits;
+    return (shift + 1) * sub_buckets + ((usecs >> shift) - sub_buckets);
+}
+
+uint64_t LatencyHistogram::bucket_high(const size_t idx)
+{
+    if ( idx < 2 * sub_buckets ) {
+        return idx;
+    }
+    const unsigned shift = idx / sub_buckets - 1;
+    const uint64_t low = (idx % sub_buckets + sub_buckets) << shift;
+    return low + ((uint64_t{1} << shift) - 1);
+}
+
+QueryStats::QueryStats() :
+    m_mutex{}, m_stats{}, m_log_mutex{}, m_slow_log{nullptr},
+    m_slow_threshold{0}, m_collecting{false}
+{
+}
+
+QueryStats& QueryStats::instance()
+{
+    static QueryStats stats;
+    return stats;
+}
+
+void QueryStats::enable()
+{
+    m_collecting.store(true, std::memory_order_relaxed);
+}
+
+void QueryStats::record(const std::string& sql,
+                        const uint64_t usecs,
+                        const uint64_t rows,
+                        const uint64_t bytes,
+                        const bool failed)
+{
+    record(classify(sql), sql, usecs, rows, bytes, failed);
+}
+
+void QueryStats::record(const std::string& name,
+                        const std::string& sql,
+                        const uint64_t usecs,
+                        const uint64_t rows,
+                        const uint64_t bytes,
+                        const bool failed)
+{
+    StatementStats& stats = stats_for(name);
+    stats.latency.record(usecs);
+    if ( failed ) {
+        stats.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    if ( rows ) {
+        stats.rows.fetch_add(rows, std::memory_order_relaxed);
+    }
+    if ( bytes ) {
+        stats.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    log_if_slow(name, sql, usecs, failed);
+}
+
+const StatementStats * QueryStats::find(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const auto found = m_stats.find(name);
+    return found == m_stats.end() ? nullptr : found->second.get();
+}
+
+void QueryStats::set_slow_query_log(std::ostream * out,
+                                    const uint64_t threshold)
+{
+    std::lock_guard<std::mutex> lock{m_log_mutex};
+    m_slow_threshold.store(threshold, std::memory_order_relaxed);
+    m_slow_log.store(out);
+}
+
+Table QueryStats::table() const
+{
+    Table stats_table{TableRow{"Statement", "Count", "Errors", "Rows",
+                               "Bytes", "Mean", "p50", "p90", "p99",
+                               "Max"}};
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for ( const auto& entry : m_stats ) {
+        const StatementStats& stats = *entry.second;
+        const uint64_t count = stats.latency.count();
+        stats_table.append_record(TableRow{
+            entry.first,
+            std::to_string(count),
+            std::to_string(stats.errors.load(std::memory_order_relaxed)),
+            std::to_string(stats.rows.load(std::memory_order_relaxed)),
+            std::to_string(stats.bytes.load(std::memory_order_relaxed)),
+            std::to_string(count ? stats.latency.total() / count : 0),
+            std::to_string(stats.latency.percentile(50)),
+            std::to_string(stats.latency.percentile(90)),
+            std::to_string(stats.latency.percentile(99)),
+            std::to_string(stats.latency.max())
+        });
+    }
+
+    return stats_table;
+}
+
+std::string QueryStats::classify(const std::string& sql)
+{
+    const std::vector<std::string> words = statement_words(sql, 64);
+    if ( words.empty() ) {
+        return "empty";
+    }
+
+    const std::string& verb = words[0];
+    std::string marker;
+    size_t skip = 0;
+
+    if ( verb == "select" || verb == "delete" ) {
+        marker = "from";
+    }
+    else if ( verb == "insert" || verb == "replace" ) {
+        marker = "into";
+    }
+    else if ( verb == "update" ) {
+        skip = 1;
+    }
+    else if ( (verb == "create" || verb == "drop" || verb == "alter") &&
+              words.size() > 1 ) {
+
+        /*  The object type is part of the class, as in "create table"  */
+
+        std::string name = verb + " " + words[1];
+        for ( size_t i = 2; i < words.size(); ++i ) {
+            const std::string& word = words[i];
+            if ( word != "if" && word != "not" && word != "exists" ) {
+                name += " " + word;
+                break;
+            }
+        }
+        return name;
+    }
+    else {
+        return verb;
+    }
+
+    if ( !marker.empty() ) {
+        for ( size_t i = 1; i + 1 < words.size(); ++i ) {
+            if ( words[i] == marker ) {
+                skip = i + 1;
+                break;
+            }
+        }
+    }
+
+    return skip && skip < words.size() ? verb + " " + words[skip] : verb;
+}
+
+StatementStats& QueryStats::stats_for(const std::string& name)
+{
+
+    /*  Statistics are never removed, so a thread may keep pointers to
+     *  them. The index is shared by every registry, but there is only
+     *  ever the one.                                                  */
+
+    thread_local std::unordered_map<std::string, StatementStats *> seen;
+
+    const auto found = seen.find(name);
+    if ( found != seen.end() ) {
+        return *found->second;
+    }
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    auto& entry = m_stats[name];
+    if ( !entry ) {
+        entry.reset(new StatementStats);
+    }
+    seen.emplace(name, entry.get());
+    return *entry;
+}
+
+void QueryStats::log_if_slow(const std::string& name,
+                             const std::string& sql,
+                             const uint64_t usecs,
+                             const bool failed)
+{
+    if ( !m_slow_log.load(std::memory_order_relaxed) ||
+         usecs < m_slow_threshold.load(std::memory_order_relaxed) ) {
+        return;
+    }
+
+    std::ostringstream line;
+    line << "Slow query: " << name << ": " << usecs / 1000
+         << "." << (usecs % 1000) / 100 << " ms"
+         << (failed ? " (failed)" : "") << ": "
+         << sql.substr(0, max_logged_sql)
+         << (sql.size() > max_logged_sql ? "..." : "") << '\n';
+
+    std::lock_guard<std::mutex> lock{m_log_mutex};
+    std::ostream * out = m_slow_log.load();
+    if ( out ) {
+        *out << line.str() << std::flush;
+    }
+}
+
+static unsigned highest_bit(uint64_t value)
+{
+    unsigned bit = 0;
+    while ( value >>= 1 ) {
+        ++bit;
+    }
+    return bit;
+}
+
+static std::vector<std::string> statement_words(const std::string& sql,
+                                                const size_t max_words)
+{
+    std::vector<std::string> words;
+    std::string word;
+
+    for ( size_t i = 0; i < sql.size() && words.size() < max_words; ++i ) {
+        const unsigned char c = sql[i];
+        if ( std::isalnum(c) || c == '_' ) {
+            word += static_cast<char>(std::tolower(c));
+            continue;
+        }
+
+        if ( !word.empty() ) {
+            words.push_back(word);
+            word.clear();
+        }
+
+        if ( c == '\'' || c == '"' ) {
+            const size_t close = sql.find(c, i + 1);
+            if ( close == std::string::npos ) {
+                break;
+            }
+            i = close;
+        }
+    }
+
+    if ( !word.empty() && words.size() < max_words ) {
+        words.push_back(word);
+    }
+    return words;
+}
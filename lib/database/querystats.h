@@ -0,0 +1,288 @@
+/*!
+ * \file            querystats.h
+ * \brief           Interface to query statistics classes
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_DATABASE_QUERY_STATS_H
+#define PG_DATABASE_QUERY_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include "table.h"
+
+namespace gldb {
+
+/*!
+ * \brief           Latency histogram class.
+ * \details         Records values in microseconds into log-linear buckets,
+ * sixteen to each power of two, so a recorded value is known to within
+ * 1/16 of itself, in the style of an HDR histogram. Recording is a few
+ * relaxed atomic increments, so any number of threads may record at once
+ * without locking.
+ * \ingroup         database
+ */
+class LatencyHistogram {
+    public:
+
+        /*!  Number of buckets, enough for any 64-bit value  */
+        static const size_t num_buckets = 976;
+
+        /*!  Constructor  */
+        LatencyHistogram ();
+
+        /*!  Deleted copy constructor  */
+        LatencyHistogram (const LatencyHistogram&) = delete;
+
+        /*!  Deleted assignment operator  */
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        /*!
+         * \brief           Records a value.
+         * \param usecs     The value in microseconds.
+         */
+        void record(const uint64_t usecs);
+
+        /*!
+         * \brief           Returns the number of values recorded.
+         * \returns         The number of values.
+         */
+        uint64_t count() const;
+
+        /*!
+         * \brief           Returns the largest value recorded.
+         * \returns         The largest value, or zero if none.
+         */
+        uint64_t max() const;
+
+        /*!
+         * \brief           Returns the sum of the values recorded.
+         * \returns         The sum.
+         */
+        uint64_t total() const;
+
+        /*!
+         * \brief           Returns a percentile.
+         * \param pct       The percentile, from 0 to 100.
+         * \returns         The highest value in the bucket containing the
+         * percentile, capped at the largest value recorded, or zero if
+         * nothing was recorded.
+         */
+        uint64_t percentile(const double pct) const;
+
+        /*!
+         * \brief           Returns the bucket for a value.
+         * \param usecs     The value.
+         * \returns         The bucket index.
+         */
+        static size_t bucket(const uint64_t usecs);
+
+        /*!
+         * \brief           Returns the highest value in a bucket.
+         * \param idx       The bucket index.
+         * \returns         The highest value.
+         */
+        static uint64_t bucket_high(const size_t idx);
+
+    private:
+
+        /*!  Bucket counts  */
+        std::atomic<uint64_t> m_buckets[num_buckets];
+
+        /*!  Number of values  */
+        std::atomic<uint64_t> m_count;
+
+        /*!  Sum of values  */
+        std::atomic<uint64_t> m_total;
+
+        /*!  Largest value  */
+        std::atomic<uint64_t> m_max;
+
+};              //  class LatencyHistogram
+
+/*!
+ * \brief           Statistics for one class of statement.
+ * \ingroup         database
+ */
+struct StatementStats {
+    /*!  Latency of successful and failed statements  */
+    LatencyHistogram latency;
+
+    /*!  Number of failed statements  */
+    std::atomic<uint64_t> errors{0};
+
+    /*!  Rows returned  */
+    std::atomic<uint64_t> rows{0};
+
+    /*!  Bytes of field data returned  */
+    std::atomic<uint64_t> bytes{0};
+};
+
+/*!
+ * \brief           Query statistics registry class.
+ * \details         Collects statistics for every statement run through a
+ * \c DBConn in the process, by statement class, and writes statements
+ * slower than a threshold to a slow query log. Nothing is recorded until
+ * collection is enabled or a slow query log is set.
+ * \ingroup         database
+ */
+class QueryStats {
+    public:
+
+        /*!
+         * \brief           Returns the process-wide registry.
+         * \returns         A reference to the registry.
+         */
+        static QueryStats& instance();
+
+        /*!  Deleted copy constructor  */
+        QueryStats (const QueryStats&) = delete;
+
+        /*!  Deleted assignment operator  */
+        QueryStats& operator=(const QueryStats&) = delete;
+
+        /*!
+         * \brief           Starts collecting statistics.
+         * \details         Statements are only timed and recorded once
+         * statistics are collected or a slow query log is set, so that
+         * they cost nothing otherwise.
+         */
+        void enable();
+
+        /*!
+         * \brief           Checks whether statements should be recorded.
+         * \returns         \c true if statistics are collected or a slow
+         * query log is set.
+         */
+        bool enabled() const {
+            return m_collecting.load(std::memory_order_relaxed) ||
+                   m_slow_log.load(std::memory_order_relaxed);
+        }
+
+        /*!
+         * \brief           Records a statement.
+         * \param sql       The statement.
+         * \param usecs     The time taken in microseconds.
+         * \param rows      The number of rows returned.
+         * \param bytes     The bytes of field data returned.
+         * \param failed    \c true if the statement failed.
+         */
+        void record(const std::string& sql,
+                    const uint64_t usecs,
+                    const uint64_t rows,
+                    const uint64_t bytes,
+                    const bool failed);
+
+        /*!
+         * \brief           Records a statement with a given class.
+         * \details         Each thread keeps its own index of the classes
+         * it has recorded, so the registry is only locked the first time
+         * a thread records a class, and the slow query log is written
+         * without holding it.
+         * \param name      The statement class.
+         * \param sql       The statement, for the slow query log.
+         * \param usecs     The time taken in microseconds.
+         * \param rows      The number of rows returned.
+         * \param bytes     The bytes of field data returned.
+         * \param failed    \c true if the statement failed.
+         */
+        void record(const std::string& name,
+                    const std::string& sql,
+                    const uint64_t usecs,
+                    const uint64_t rows,
+                    const uint64_t bytes,
+                    const bool failed);
+
+        /*!
+         * \brief           Returns the statistics for a statement class.
+         * \param name      The statement class.
+         * \returns         A pointer to the statistics, or \c nullptr if
+         * no statement of the class has been recorded.
+         */
+        const StatementStats * find(const std::string& name) const;
+
+        /*!
+         * \brief               Sets the slow query log.
+         * \param out           The stream to which to log, or \c nullptr
+         * to turn off logging.
+         * \param threshold     Statements taking at least this many
+         * microseconds are logged.
+         */
+        void set_slow_query_log(std::ostream * out, const uint64_t threshold);
+
+        /*!
+         * \brief           Returns the statistics as a table.
+         * \details         One row per statement class, in order of name,
+         * with latencies in microseconds.
+         * \returns         The table.
+         */
+        Table table() const;
+
+        /*!
+         * \brief           Classifies a statement.
+         * \details         The class is the statement's verb and the first
+         * table it names, such as <tt>select jes</tt> or
+         * <tt>insert jelines</tt>, so that statements made by the same
+         * \c DBSQLStatements method with different values share a class.
+         * \param sql       The statement.
+         * \returns         The statement class.
+         */
+        static std::string classify(const std::string& sql);
+
+    private:
+
+        /*!  Constructor  */
+        QueryStats ();
+
+        /*!  Protects the registry  */
+        mutable std::mutex m_mutex;
+
+        /*!  Statistics by statement class  */
+        std::map<std::string, std::unique_ptr<StatementStats>> m_stats;
+
+        /*!  Protects the slow query log stream  */
+        std::mutex m_log_mutex;
+
+        /*!  Slow query log stream, or \c nullptr  */
+        std::atomic<std::ostream *> m_slow_log;
+
+        /*!  Slow query threshold in microseconds  */
+        std::atomic<uint64_t> m_slow_threshold;
+
+        /*!  Whether statistics are collected  */
+        std::atomic<bool> m_collecting;
+
+        /*!
+         * \brief           Returns the statistics for a statement class,
+         * creating them if needed.
+         * \param name      The statement class.
+         * \returns         A reference to the statistics.
+         */
+        StatementStats& stats_for(const std::string& name);
+
+        /*!
+         * \brief           Writes a statement to the slow query log, if it
+         * is slow enough.
+         * \param name      The statement class.
+         * \param sql       The statement.
+         * \param usecs     The time taken in microseconds.
+         * \param failed    \c true if the statement failed.
+         */
+        void log_if_slow(const std::string& name,
+                         const std::string& sql,
+                         const uint64_t usecs,
+                         const bool failed);
+
+};              //  class QueryStats
+
+}               //  namespace gldb
+
+#endif          //  PG_DATABASE_QUERY_STATS_H
@@ -0,0 +1,426 @@
+/*!
+ * \file            synthetic.cpp
+ * \brief           Implementation of synthetic table data generator
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include "synthetic.h"
+#include "pgutils/pgutils.h"
+
+using namespace gldb;
+
+/*!  Rows per unit of scale  */
+static const uint64_t rows_per_scale = 1000;
+
+/*!  Accounts per unit of scale  */
+static const uint64_t accounts_per_scale = 100;
+
+/*!  Maximum number of accounts  */
+static const uint64_t max_accounts = 9000;
+
+/*!  Maximum number of entities  */
+static const uint64_t max_entities = 999;
+
+/*!  Default columns  */
+static const char * default_columns =
+    "id:serial,entity:entity,account:account:skewed,date:date,"
+    "description:text,amount:money:skewed";
+
+/*!  Words for text columns, sixteen of each  */
+static const char * const first_words[] = {
+    "Cash", "Sales", "Payroll", "Rent", "Travel", "Freight", "Interest",
+    "Stock", "Equipment", "Utilities", "Insurance", "Legal", "Consulting",
+    "Licence", "Repairs", "Marketing"
+};
+
+/*!  Second words for text columns  */
+static const char * const second_words[] = {
+    "accrual", "payment", "receipt", "transfer", "adjustment", "reversal",
+    "invoice", "refund", "charge", "allocation", "provision", "settlement",
+    "deposit", "write-off", "recharge", "correction"
+};
+
+/*!
+ * \brief           Mixes a 64-bit value.
+ * \details         The finalizer of the SplitMix64 generator, which maps
+ * nearby inputs to unrelated outputs.
+ * \param x         The value.
+ * \returns         The mixed value.
+ */
+static uint64_t mix(uint64_t x);
+
+/*!
+ * \brief           Picks an index from a hash.
+ * \details         A skewed pick cubes a uniform fraction, so that the
+ * first tenth of the range is chosen about half of the time.
+ * \param hash      The hash.
+ * \param n         The size of the range, at least one.
+ * \param dist      The distribution.
+ * \returns         An index less than \c n.
+ */
+static uint64_t pick(const uint64_t hash,
+                     const uint64_t n,
+                     const SyntheticDistribution dist);
+
+/*!
+ * \brief           Writes an unsigned integer.
+ * \param value     The value.
+ * \param buffer    The buffer, of at least 20 characters.
+ * \returns         The number of characters written.
+ */
+static size_t write_unsigned(uint64_t value, char * buffer);
+
+/*!
+ * \brief           Writes a number with a minimum number of digits.
+ * \param value     The value.
+ * \param width     The minimum number of digits.
+ * \param buffer    The buffer.
+ * \returns         The number of characters written.
+ */
+static size_t write_padded(uint64_t value, const size_t width,
+                           char * buffer);
+
+/*!
+ * \brief           Parses an unsigned number from a specification.
+ * \param key       The key, for error messages.
+ * \param value     The value.
+ * \returns         The number.
+ * \throws          SyntheticBadSpec if the value is not a number.
+ */
+static uint64_t parse_number(const std::string& key,
+                             const std::string& value);
+
+/*!
+ * \brief           Parses a column list from a specification.
+ * \param value     The column list.
+ * \returns         The columns.
+ * \throws          SyntheticBadSpec if the list is malformed.
+ */
+static std::vector<SyntheticColumn> parse_columns(const std::string& value);
+
+SyntheticGenerator::SyntheticGenerator(const std::string& spec) :
+    m_columns{parse_columns(default_columns)},
+    m_num_records{rows_per_scale},
+    m_num_accounts{accounts_per_scale},
+    m_num_entities{1},
+    m_seed{1},
+    m_year{2014}
+{
+    uint64_t scale = 1;
+    bool have_rows = false;
+
+    for ( auto& item : pgutils::split(spec, ';') ) {
+        pgutils::trim(item);
+        if ( item.empty() ) {
+            continue;
+        }
+
+        const size_t eq = item.find('=');
+        if ( eq == std::string::npos ) {
+            throw SyntheticBadSpec("Missing value in synthetic data option");
+        }
+        const std::string key = item.substr(0, eq);
+        const std::string value = item.substr(eq + 1);
+
+        if ( key == "scale" ) {
+            scale = parse_number(key, value);
+            if ( scale == 0 ) {
+                throw SyntheticBadSpec("Synthetic data scale must be positive");
+            }
+        }
+        else if ( key == "rows" ) {
+            m_num_records = parse_number(key, value);
+            have_rows = true;
+        }
+        else if ( key == "seed" ) {
+            m_seed = parse_number(key, value);
+        }
+        else if ( key == "year" ) {
+            const uint64_t year = parse_number(key, value);
+            if ( year < 1 || year > 9999 ) {
+                throw SyntheticBadSpec("Bad synthetic data year");
+            }
+            m_year = static_cast<int>(year);
+        }
+        else if ( key == "columns" ) {
+            m_columns = parse_columns(value);
+        }
+        else {
+            throw SyntheticBadSpec("Unknown synthetic data option: " + key);
+        }
+    }
+
+    if ( !have_rows ) {
+        m_num_records = scale * rows_per_scale;
+    }
+    m_num_accounts = std::min(scale * accounts_per_scale, max_accounts);
+    m_num_entities = std::min(scale, max_entities);
+}
+
+TableRow SyntheticGenerator::headers() const
+{
+    TableRow headers(m_columns.size());
+    for ( size_t i = 0; i < m_columns.size(); ++i ) {
+        headers[i] = m_columns[i].name;
+    }
+    return headers;
+}
+
+void SyntheticGenerator::fill_row(const size_t idx, TableRow& row) const
+{
+    if ( row.size() != m_columns.size() ) {
+        row = TableRow(m_columns.size());
+    }
+
+    char buffer[32];
+    for ( size_t col = 0; col < m_columns.size(); ++col ) {
+        row[col].assign(buffer, field(idx, col, buffer));
+    }
+}
+
+TableRow SyntheticGenerator::row(const size_t idx) const
+{
+    TableRow new_row(m_columns.size());
+    fill_row(idx, new_row);
+    return new_row;
+}
+
+Table SyntheticGenerator::table() const
+{
+    return table(0, m_num_records);
+}
+
+Table SyntheticGenerator::table(const size_t first, const size_t count) const
+{
+    Table new_table{headers()};
+
+    std::vector<bool> quoted(m_columns.size());
+    for ( size_t i = 0; i < m_columns.size(); ++i ) {
+        quoted[i] = m_columns[i].type == SyntheticType::date ||
+                    m_columns[i].type == SyntheticType::text;
+    }
+    new_table.set_quoted(std::move(quoted));
+
+    const size_t last = first < m_num_records ?
+                        first + std::min(count, m_num_records - first) :
+                        first;
+    for ( size_t idx = first; idx < last; ++idx ) {
+        new_table.append_record(row(idx));
+    }
+
+    return new_table;
+}
+
+size_t SyntheticGenerator::field(const uint64_t row,
+                                 const size_t col,
+                                 char * buffer) const
+{
+    const SyntheticColumn& column = m_columns[col];
+    const uint64_t hash = mix(m_seed ^ mix(row * 0x9E3779B97F4A7C15ULL +
+                                           col + 1));
+
+    switch ( column.type ) {
+        case SyntheticType::serial:
+            return write_unsigned(row + 1, buffer);
+
+        case SyntheticType::integer:
+            return write_unsigned(pick(hash, 1000000, column.distribution),
+                                  buffer);
+
+        case SyntheticType::account:
+            return write_unsigned(1000 + pick(hash, m_num_accounts,
+                                              column.distribution), buffer);
+
+        case SyntheticType::entity:
+            return write_unsigned(1 + pick(hash, m_num_entities,
+                                           column.distribution), buffer);
+
+        case SyntheticType::money: {
+
+            /*  A skewed amount has a uniformly chosen number of digits,
+             *  so small amounts are as common as large ones overall.   */
+
+            uint64_t cents;
+            if ( column.distribution == SyntheticDistribution::skewed ) {
+                static const uint64_t limits[] = {
+                    10, 100, 1000, 10000, 100000, 1000000, 10000000
+                };
+                cents = (hash >> 8) % limits[(hash & 0xff) % 7];
+            }
+            else {
+                cents = (hash >> 1) % 10000000;
+            }
+
+            size_t len = 0;
+            if ( hash & 1 ) {
+                buffer[len++] = '-';
+            }
+            len += write_unsigned(cents / 100, buffer + len);
+            buffer[len++] = '.';
+            len += write_padded(cents % 100, 2, buffer + len);
+            return len;
+        }
+
+        case SyntheticType::date: {
+            static const int month_days[] = {
+                31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+            };
+            const bool leap = (m_year % 4 == 0 && m_year % 100 != 0) ||
+                              m_year % 400 == 0;
+
+            /*  A skewed date falls toward the end of the year  */
+
+            uint64_t day = pick(hash, leap ? 366 : 365, column.distribution);
+            if ( column.distribution == SyntheticDistribution::skewed ) {
+                day = (leap ? 365 : 364) - day;
+            }
+
+            int month = 0;
+            while ( day >= static_cast<uint64_t>(month_days[month] +
+                                                 (month == 1 && leap)) ) {
+                day -= month_days[month] + (month == 1 && leap);
+                ++month;
+            }
+
+            size_t len = write_padded(m_year, 4, buffer);
+            buffer[len++] = '-';
+            len += write_padded(month + 1, 2, buffer + len);
+            buffer[len++] = '-';
+            len += write_padded(day + 1, 2, buffer + len);
+            return len;
+        }
+
+        case SyntheticType::text: {
+            const uint64_t n = pick(hash, 256, column.distribution);
+            const char * first = first_words[n / 16];
+            const char * second = second_words[n % 16];
+            const size_t first_len = std::strlen(first);
+            const size_t second_len = std::strlen(second);
+            std::memcpy(buffer, first, first_len);
+            buffer[first_len] = ' ';
+            std::memcpy(buffer + first_len + 1, second, second_len);
+            return first_len + 1 + second_len;
+        }
+    }
+
+    return 0;
+}
+
+static uint64_t mix(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t pick(const uint64_t hash,
+                     const uint64_t n,
+                     const SyntheticDistribution dist)
+{
+    if ( dist == SyntheticDistribution::uniform ) {
+        return hash % n;
+    }
+
+    const double u = static_cast<double>(hash >> 11) / 9007199254740992.0;
+    return static_cast<uint64_t>(u * u * u * static_cast<double>(n));
+}
+
+static size_t write_unsigned(uint64_t value, char * buffer)
+{
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while ( value );
+
+    for ( size_t i = 0; i < n; ++i ) {
+        buffer[i] = digits[n - i - 1];
+    }
+    return n;
+}
+
+static size_t write_padded(uint64_t value, const size_t width,
+                           char * buffer)
+{
+    char digits[20];
+    const size_t n = write_unsigned(value, digits);
+    size_t len = 0;
+    while ( len + n < width ) {
+        buffer[len++] = '0';
+    }
+    std::memcpy(buffer + len, digits, n);
+    return len + n;
+}
+
+static uint64_t parse_number(const std::string& key,
+                             const std::string& value)
+{
+    if ( value.empty() || value.size() > 18 ||
+         value.find_first_not_of("0123456789") != std::string::npos ) {
+        throw SyntheticBadSpec("Bad synthetic data " + key + ": " + value);
+    }
+    return std::stoull(value);
+}
+
+static std::vector<SyntheticColumn> parse_columns(const std::string& value)
+{
+    std::vector<SyntheticColumn> columns;
+
+    for ( auto& item : pgutils::split(value, ',') ) {
+        const std::vector<std::string> parts = pgutils::split(item, ':');
+        if ( parts.size() < 2 || parts.size() > 3 || parts[0].empty() ) {
+            throw SyntheticBadSpec("Bad synthetic data column: " + item);
+        }
+
+        SyntheticColumn column{parts[0], SyntheticType::text,
+                               SyntheticDistribution::uniform};
+
+        const std::string& type = parts[1];
+        if ( type == "serial" ) {
+            column.type = SyntheticType::serial;
+        }
+        else if ( type == "integer" ) {
+            column.type = SyntheticType::integer;
+        }
+        else if ( type == "money" ) {
+            column.type = SyntheticType::money;
+        }
+        else if ( type == "account" ) {
+            column.type = SyntheticType::account;
+        }
+        else if ( type == "entity" ) {
+            column.type = SyntheticType::entity;
+        }
+        else if ( type == "date" ) {
+            column.type = SyntheticType::date;
+        }
+        else if ( type != "text" ) {
+            throw SyntheticBadSpec("Unknown synthetic data type: " + type);
+        }
+
+        if ( parts.size() == 3 ) {
+            if ( parts[2] == "skewed" ) {
+                column.distribution = SyntheticDistribution::skewed;
+            }
+            else if ( parts[2] != "uniform" ) {
+                throw SyntheticBadSpec("Unknown synthetic data "
+                                       "distribution: " + parts[2]);
+            }
+        }
+
+        columns.push_back(std::move(column));
+    }
+
+    if ( columns.empty() ) {
+        throw SyntheticBadSpec("No synthetic data columns");
+    }
+
+    return columns;
+}
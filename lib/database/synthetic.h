@@ -0,0 +1,201 @@
+/*!
+ * \file            synthetic.h
+ * \brief           Interface to synthetic table data generator
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_DATABASE_SYNTHETIC_H
+#define PG_DATABASE_SYNTHETIC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "table.h"
+#include "tablerow.h"
+
+namespace gldb {
+
+/*!
+ * \brief       Bad synthetic data specification exception class
+ * \ingroup     database
+ */
+class SyntheticBadSpec : public std::runtime_error {
+    public:
+        /*!
+         * \brief           Constructor.
+         * \param msg       The error message.
+         */
+        explicit SyntheticBadSpec(const std::string& msg) :
+            std::runtime_error(msg) {}
+};
+
+/*!
+ * \brief           Synthetic column value type.
+ * \ingroup         database
+ */
+enum class SyntheticType {
+    serial,         /*!<  The row number, starting at one  */
+    integer,        /*!<  An integer from 0 to 999999  */
+    money,          /*!<  A signed amount with two decimal places  */
+    account,        /*!<  A four digit account number  */
+    entity,         /*!<  An entity number  */
+    date,           /*!<  A date in the accounting year  */
+    text            /*!<  A short description  */
+};
+
+/*!
+ * \brief           Synthetic column value distribution.
+ * \ingroup         database
+ */
+enum class SyntheticDistribution {
+    uniform,        /*!<  Every value equally likely  */
+    skewed          /*!<  Low values, or small amounts, much more likely  */
+};
+
+/*!
+ * \brief           Synthetic column description.
+ * \ingroup         database
+ */
+struct SyntheticColumn {
+    /*!  The column name  */
+    std::string name;
+
+    /*!  The value type  */
+    SyntheticType type;
+
+    /*!  The value distribution  */
+    SyntheticDistribution distribution;
+};
+
+/*!
+ * \brief           Synthetic table data generator class.
+ * \details         Generates journal-line-like rows without a database,
+ * for benchmarking tables, reports and aggregation. Each field is computed
+ * from a hash of the seed, row number and column number alone, so the same
+ * specification always gives the same data, and any row can be generated
+ * on its own, in any order, without generating the rows before it.
+ *
+ * A specification is a list of \c key=value pairs separated by semicolons:
+ *
+ * - \c scale: the scale factor, default 1. There are 1000 rows, 100
+ *   accounts and one entity per unit of scale, with at most 9000 accounts
+ *   and 999 entities.
+ * - \c rows: the number of rows, overriding the scale factor.
+ * - \c seed: the random seed, default 1.
+ * - \c year: the year of generated dates, default 2014.
+ * - \c columns: a comma-separated list of \c name:type or
+ *   \c name:type:distribution columns, where the types are \c serial,
+ *   \c integer, \c money, \c account, \c entity, \c date and \c text, and
+ *   the distributions are \c uniform, the default, and \c skewed. The
+ *   default columns are
+ *   <tt>id:serial,entity:entity,account:account:skewed,date:date,
+ *   description:text,amount:money:skewed</tt>.
+ * \ingroup         database
+ */
+class SyntheticGenerator {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \param spec      The specification.
+         * \throws          SyntheticBadSpec if the specification is
+         * malformed.
+         */
+        explicit SyntheticGenerator (const std::string& spec = "");
+
+        /*!
+         * \brief           Returns the number of rows.
+         * \returns         The number of rows.
+         */
+        size_t num_records() const { return m_num_records; }
+
+        /*!
+         * \brief           Returns the number of fields.
+         * \returns         The number of fields.
+         */
+        size_t num_fields() const { return m_columns.size(); }
+
+        /*!
+         * \brief           Returns the column descriptions.
+         * \returns         The column descriptions.
+         */
+        const std::vector<SyntheticColumn>& columns() const
+                                                { return m_columns; }
+
+        /*!
+         * \brief           Returns the column names.
+         * \returns         A TableRow containing the column names.
+         */
+        TableRow headers() const;
+
+        /*!
+         * \brief           Generates a row into an existing row.
+         * \details         Reusing a row of the right size reuses the
+         * field storage.
+         * \param idx       The zero-based row number, which may be beyond
+         * the number of rows.
+         * \param row       The row to fill, resized if necessary.
+         */
+        void fill_row(const size_t idx, TableRow& row) const;
+
+        /*!
+         * \brief           Generates a row.
+         * \param idx       The zero-based row number.
+         * \returns         The row.
+         */
+        TableRow row(const size_t idx) const;
+
+        /*!
+         * \brief           Generates all the rows as a table.
+         * \returns         The table.
+         */
+        Table table() const;
+
+        /*!
+         * \brief           Generates a range of rows as a table.
+         * \param first     The zero-based number of the first row.
+         * \param count     The maximum number of rows.
+         * \returns         The table, which stops at the last row.
+         */
+        Table table(const size_t first, const size_t count) const;
+
+    private:
+
+        /*!  The columns  */
+        std::vector<SyntheticColumn> m_columns;
+
+        /*!  The number of rows  */
+        size_t m_num_records;
+
+        /*!  The number of accounts  */
+        uint64_t m_num_accounts;
+
+        /*!  The number of entities  */
+        uint64_t m_num_entities;
+
+        /*!  The random seed  */
+        uint64_t m_seed;
+
+        /*!  The year of generated dates  */
+        int m_year;
+
+        /*!
+         * \brief           Generates a field.
+         * \param row       The zero-based row number.
+         * \param col       The zero-based column number.
+         * \param buffer    A buffer of at least 32 characters.
+         * \returns         The length of the field written to the buffer.
+         */
+        size_t field(const uint64_t row,
+                     const size_t col,
+                     char * buffer) const;
+
+};              //  class SyntheticGenerator
+
+}               //  namespace gldb
+
+#endif          //  PG_DATABASE_SYNTHETIC_H
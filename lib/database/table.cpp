@@ -174,3 +174,12 @@ std::string Table::get_field(const std::string& field_name,
     return m_records[row_index][col];
 }
  
+
+bool Table::has_field(const std::string& field_name) const {
+    for ( const auto& header : m_headers ) {
+        if ( static_cast<std::string>(header) == field_name ) {
+            return true;
+        }
+    }
+    return false;
+}
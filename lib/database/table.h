@@ -267,6 +267,13 @@ class Table {
         std::string get_field(const std::string& field_name,
                               const size_t row_index);
 
+        /*!
+         * \brief               Checks if the table has a named field.
+         * \param field_name    The name of the field.
+         * \returns             `true` if the field exists, `false` otherwise.
+         */
+        bool has_field(const std::string& field_name) const;
+
     private:
         /*!  The names of the fields  */
         TableRow m_headers;
@@ -36,6 +36,11 @@ TableField& TableField::operator=(const char * data) {
     return *this;
 }
 
+TableField& TableField::assign(const char * data, const size_t length) {
+    m_data.assign(data, length);
+    return *this;
+}
+
 TableField& TableField::operator=(const std::string& data) {
     m_data = data;
     return *this;
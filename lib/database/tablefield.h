@@ -65,6 +65,12 @@ class TableField {
          */
         size_t length() const { return m_data.length(); }
 
+        /*!
+         * \brief           Returns a reference to the field contents.
+         * \returns         A const reference to the field contents.
+         */
+        const std::string& str() const { return m_data; }
+
         /*!
          * \brief           Overridden conversion operator.
          * \details         Returns the field contents as a string.
@@ -78,6 +84,16 @@ class TableField {
          */
         TableField& operator=(const char * data);
 
+        /*!
+         * \brief           Replaces the contents of the field.
+         * \details         Reuses the existing storage where it is large
+         * enough.
+         * \param data      The new contents of the field.
+         * \param length    The length of the new contents.
+         * \returns         A reference to the same field.
+         */
+        TableField& assign(const char * data, const size_t length);
+
         /*!
          * \brief           Overridden assignment operator for `std::string`.
          * \param data      The new contents of the field.
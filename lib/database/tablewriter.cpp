@@ -0,0 +1,533 @@
+/*!
+ * \file            tablewriter.cpp
+ * \brief           Implementation of machine-readable table output writers
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include "tablewriter.h"
+
+using namespace gldb;
+
+/*!  Magic string at the start of a binary columnar file  */
+static const char columnar_magic[8] = {'G', 'L', 'C', 'O', 'L', '1', 0, 0};
+
+/*!  Maximum number of digits in a number stored as \c int64_t  */
+static const size_t max_digits = 18;
+
+/*!  Most rows or bytes reserved ahead of reading them from a stream
+ *   whose size is unknown  */
+static const uint64_t max_unchecked_reserve = 65536;
+
+/*!
+ * \brief           Checks if a string is a canonical decimal number.
+ * \ingroup         database
+ * \param s         The string to check.
+ * \param scale     Set to the number of decimal places on success.
+ * \retval true     If the string is a canonical number.
+ * \retval false    If the string is not a canonical number.
+ */
+static bool canonical_number(const std::string& s, size_t& scale);
+
+/*!
+ * \brief           Converts a canonical number to a scaled integer.
+ * \ingroup         database
+ * \param s         The string to convert.
+ * \returns         The number multiplied by 10 to the power of its scale.
+ */
+static int64_t scaled_value(const std::string& s);
+
+/*!
+ * \brief           Converts a scaled integer back to a string.
+ * \ingroup         database
+ * \param value     The scaled integer.
+ * \param scale     The number of decimal places.
+ * \returns         The string representation.
+ */
+static std::string scaled_string(const int64_t value, const uint32_t scale);
+
+/*!
+ * \brief           Writes a field to a CSV stream, quoting if necessary.
+ * \ingroup         database
+ * \param out       The output stream.
+ * \param field     The field to write.
+ */
+static void write_csv_field(std::ostream& out, const std::string& field);
+
+/*!
+ * \brief           Writes a string to a stream as a JSON string literal.
+ * \ingroup         database
+ * \param out       The output stream.
+ * \param s         The string to write.
+ */
+static void write_json_string(std::ostream& out, const std::string& s);
+
+/*!
+ * \brief           Writes a value to a binary stream in host byte order.
+ * \ingroup         database
+ * \param out       The output stream.
+ * \param value     The value to write.
+ */
+template<typename T>
+static void put_binary(std::ostream& out, const T value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+/*!
+ * \brief           Reads a value from a binary stream in host byte order.
+ * \ingroup         database
+ * \param in        The input stream.
+ * \returns         The value read.
+ * \throws          TableBadInputFile if the stream ends early.
+ */
+template<typename T>
+static T get_binary(std::istream& in)
+{
+    T value;
+    if ( !in.read(reinterpret_cast<char *>(&value), sizeof(value)) ) {
+        throw TableBadInputFile("Unexpected end of columnar input");
+    }
+    return value;
+}
+
+/*!
+ * \brief           Writes zero bytes to pad a length to 8 bytes.
+ * \ingroup         database
+ * \param out       The output stream.
+ * \param length    The length written so far.
+ */
+static void put_padding(std::ostream& out, const size_t length);
+
+/*!
+ * \brief           Skips bytes padding a length to 8 bytes.
+ * \ingroup         database
+ * \param in        The input stream.
+ * \param length    The length read so far.
+ * \throws          TableBadInputFile if the stream ends early.
+ */
+static void skip_padding(std::istream& in, const size_t length);
+
+/*!
+ * \brief           Returns the number of bytes left in a stream.
+ * \ingroup         database
+ * \param in        The input stream.
+ * \returns         The number of bytes left, or the largest \c uint64_t
+ * if the stream cannot seek.
+ */
+static uint64_t remaining_bytes(std::istream& in);
+
+/*!
+ * \brief           Reads bytes from a stream.
+ * \details         The string grows as the bytes arrive, so a corrupt
+ * length never allocates more than the stream holds.
+ * \ingroup         database
+ * \param in        The input stream.
+ * \param count     The number of bytes to read.
+ * \returns         The bytes read.
+ * \throws          TableBadInputFile if the stream ends early.
+ */
+static std::string read_bytes(std::istream& in, const uint64_t count);
+
+std::vector<ColumnInfo> gldb::infer_column_types(const Table& table)
+{
+    std::vector<ColumnInfo> columns;
+    for ( const auto& header : table.get_headers() ) {
+        columns.push_back(ColumnInfo{header.str(), ColumnType::integer, 0});
+    }
+
+    if ( table.num_records() == 0 ) {
+        for ( auto& column : columns ) {
+            column.type = ColumnType::text;
+        }
+        return columns;
+    }
+
+    for ( size_t i = 0; i < columns.size(); ++i ) {
+        ColumnInfo& column = columns[i];
+        bool first = true;
+        for ( const auto& record : table ) {
+            size_t scale;
+            if ( !canonical_number(record[i].str(), scale) ||
+                 (!first && scale != column.scale) ) {
+                column.type = ColumnType::text;
+                column.scale = 0;
+                break;
+            }
+            column.scale = scale;
+            first = false;
+        }
+        if ( column.type != ColumnType::text && column.scale > 0 ) {
+            column.type = ColumnType::decimal;
+        }
+    }
+
+    return columns;
+}
+
+void CSVTableWriter::write(std::ostream& out, const Table& table)
+{
+    const TableRow& headers = table.get_headers();
+    for ( size_t i = 0; i < headers.size(); ++i ) {
+        if ( i > 0 ) {
+            out << ',';
+        }
+        write_csv_field(out, headers[i].str());
+    }
+    out << '\n';
+
+    for ( const auto& record : table ) {
+        for ( size_t i = 0; i < record.size(); ++i ) {
+            if ( i > 0 ) {
+                out << ',';
+            }
+            write_csv_field(out, record[i].str());
+        }
+        out << '\n';
+    }
+    out.flush();
+}
+
+void JSONLinesTableWriter::write(std::ostream& out, const Table& table)
+{
+    const std::vector<ColumnInfo> columns = infer_column_types(table);
+
+    for ( const auto& record : table ) {
+        out << '{';
+        for ( size_t i = 0; i < columns.size(); ++i ) {
+            if ( i > 0 ) {
+                out << ',';
+            }
+            write_json_string(out, columns[i].name);
+            out << ':';
+            if ( columns[i].type == ColumnType::text ) {
+                write_json_string(out, record[i].str());
+            }
+            else {
+                out << record[i].str();
+            }
+        }
+        out << "}\n";
+    }
+    out.flush();
+}
+
+void ColumnarTableWriter::write(std::ostream& out, const Table& table)
+{
+    const std::vector<ColumnInfo> columns = infer_column_types(table);
+    const uint64_t num_rows = table.num_records();
+
+    out.write(columnar_magic, sizeof(columnar_magic));
+    put_binary<uint32_t>(out, columns.size());
+    put_binary<uint32_t>(out, 0);
+    put_binary<uint64_t>(out, num_rows);
+
+    for ( const auto& column : columns ) {
+        put_binary<uint32_t>(out, static_cast<uint32_t>(column.type));
+        put_binary<uint32_t>(out, column.scale);
+        put_binary<uint32_t>(out, column.name.size());
+        out.write(column.name.data(), column.name.size());
+        put_padding(out, 3 * sizeof(uint32_t) + column.name.size());
+    }
+
+    for ( size_t i = 0; i < columns.size(); ++i ) {
+        if ( columns[i].type == ColumnType::text ) {
+            uint64_t offset = 0;
+            put_binary<uint64_t>(out, offset);
+            for ( const auto& record : table ) {
+                offset += record[i].length();
+                put_binary<uint64_t>(out, offset);
+            }
+            for ( const auto& record : table ) {
+                out.write(record[i].str().data(), record[i].length());
+            }
+            put_padding(out, offset);
+        }
+        else {
+            for ( const auto& record : table ) {
+                put_binary<int64_t>(out, scaled_value(record[i].str()));
+            }
+        }
+    }
+    out.flush();
+}
+
+std::unique_ptr<TableWriter> gldb::make_table_writer(const std::string& format)
+{
+    if ( format == "csv" ) {
+        return std::unique_ptr<TableWriter>(new CSVTableWriter);
+    }
+    else if ( format == "jsonl" ) {
+        return std::unique_ptr<TableWriter>(new JSONLinesTableWriter);
+    }
+    else if ( format == "columnar" ) {
+        return std::unique_ptr<TableWriter>(new ColumnarTableWriter);
+    }
+    else {
+        throw TableException("Unknown output format '" + format + "'");
+    }
+}
+
+Table gldb::read_columnar_table(std::istream& in)
+{
+    char magic[sizeof(columnar_magic)];
+    if ( !in.read(magic, sizeof(magic)) ||
+         std::memcmp(magic, columnar_magic, sizeof(magic)) != 0 ) {
+        throw TableBadInputFile("Input is not in binary columnar format");
+    }
+
+    const uint32_t num_columns = get_binary<uint32_t>(in);
+    get_binary<uint32_t>(in);
+    const uint64_t num_rows = get_binary<uint64_t>(in);
+
+    /*  Each column header takes at least 16 bytes  */
+
+    if ( num_columns > remaining_bytes(in) / 16 ) {
+        throw TableBadInputFile("Unexpected end of columnar input");
+    }
+
+    std::vector<ColumnInfo> columns;
+    TableRow headers;
+    for ( uint32_t i = 0; i < num_columns; ++i ) {
+        const uint32_t type = get_binary<uint32_t>(in);
+        const uint32_t scale = get_binary<uint32_t>(in);
+        const uint32_t name_length = get_binary<uint32_t>(in);
+        std::string name = read_bytes(in, name_length);
+        skip_padding(in, 3 * sizeof(uint32_t) + name_length);
+        if ( type > static_cast<uint32_t>(ColumnType::decimal) ) {
+            throw TableBadInputFile("Unknown column type in columnar input");
+        }
+        if ( scale > max_digits ) {
+            throw TableBadInputFile("Bad column scale in columnar input");
+        }
+        headers.append_field(name);
+        columns.push_back(ColumnInfo{name, static_cast<ColumnType>(type),
+                                     scale});
+    }
+
+    /*  Every column takes at least 8 bytes a row, so a row count the
+     *  rest of the input cannot hold is rejected before anything is
+     *  reserved for it, and where the size of the input is unknown
+     *  only a limited number of rows is reserved ahead                 */
+
+    if ( num_columns == 0 && num_rows != 0 ) {
+        throw TableBadInputFile("Columnar input has rows but no columns");
+    }
+    if ( num_columns && num_rows > remaining_bytes(in) / 8 / num_columns ) {
+        throw TableBadInputFile("Unexpected end of columnar input");
+    }
+    const size_t reserve_rows = std::min(num_rows, max_unchecked_reserve);
+
+    std::vector<std::vector<std::string>> data(num_columns);
+    for ( uint32_t i = 0; i < num_columns; ++i ) {
+        data[i].reserve(reserve_rows);
+        if ( columns[i].type == ColumnType::text ) {
+            std::vector<uint64_t> offsets;
+            offsets.reserve(reserve_rows + 1);
+            offsets.push_back(get_binary<uint64_t>(in));
+            for ( uint64_t r = 0; r < num_rows; ++r ) {
+                offsets.push_back(get_binary<uint64_t>(in));
+            }
+            if ( offsets.front() != 0 ||
+                 !std::is_sorted(offsets.begin(), offsets.end()) ) {
+                throw TableBadInputFile("Bad text offset in columnar input");
+            }
+            const std::string bytes = read_bytes(in, offsets.back());
+            skip_padding(in, bytes.size());
+            for ( uint64_t r = 0; r < num_rows; ++r ) {
+                data[i].push_back(bytes.substr(offsets[r],
+                                               offsets[r + 1] - offsets[r]));
+            }
+        }
+        else {
+            for ( uint64_t r = 0; r < num_rows; ++r ) {
+                data[i].push_back(scaled_string(get_binary<int64_t>(in),
+                                                columns[i].scale));
+            }
+        }
+    }
+
+    Table table{std::move(headers)};
+    for ( uint64_t r = 0; r < num_rows; ++r ) {
+        TableRow row;
+        for ( uint32_t i = 0; i < num_columns; ++i ) {
+            row.append_field(std::move(data[i][r]));
+        }
+        table.append_record(std::move(row));
+    }
+    return table;
+}
+
+static bool canonical_number(const std::string& s, size_t& scale)
+{
+    size_t i = 0;
+    const bool negative = !s.empty() && s[0] == '-';
+    if ( negative ) {
+        ++i;
+    }
+
+    const size_t int_start = i;
+    while ( i < s.length() && s[i] >= '0' && s[i] <= '9' ) {
+        ++i;
+    }
+    const size_t int_digits = i - int_start;
+    if ( int_digits == 0 || (int_digits > 1 && s[int_start] == '0') ) {
+        return false;
+    }
+
+    scale = 0;
+    bool all_zero = s[int_start] == '0';
+    if ( i < s.length() ) {
+        if ( s[i] != '.' ) {
+            return false;
+        }
+        ++i;
+        const size_t frac_start = i;
+        while ( i < s.length() && s[i] >= '0' && s[i] <= '9' ) {
+            if ( s[i] != '0' ) {
+                all_zero = false;
+            }
+            ++i;
+        }
+        scale = i - frac_start;
+        if ( scale == 0 || i != s.length() ) {
+            return false;
+        }
+    }
+
+    if ( negative && all_zero ) {
+        return false;
+    }
+    return int_digits + scale <= max_digits;
+}
+
+static int64_t scaled_value(const std::string& s)
+{
+    int64_t value = 0;
+    for ( const char c : s ) {
+        if ( c >= '0' && c <= '9' ) {
+            value = value * 10 + (c - '0');
+        }
+    }
+    return !s.empty() && s[0] == '-' ? -value : value;
+}
+
+static std::string scaled_string(const int64_t value, const uint32_t scale)
+{
+    const uint64_t magnitude = value < 0 ? -static_cast<uint64_t>(value) :
+                                           value;
+    std::string digits = std::to_string(magnitude);
+    if ( scale > 0 ) {
+        if ( digits.length() <= scale ) {
+            digits.insert(0, scale + 1 - digits.length(), '0');
+        }
+        digits.insert(digits.length() - scale, 1, '.');
+    }
+    return value < 0 ? "-" + digits : digits;
+}
+
+static void write_csv_field(std::ostream& out, const std::string& field)
+{
+    if ( field.find_first_of(",\"\r\n") == std::string::npos ) {
+        out << field;
+        return;
+    }
+
+    out << '"';
+    for ( const char c : field ) {
+        if ( c == '"' ) {
+            out << '"';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+static void write_json_string(std::ostream& out, const std::string& s)
+{
+    out << '"';
+    for ( const char c : s ) {
+        switch ( c ) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\r':
+                out << "\\r";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if ( static_cast<unsigned char>(c) < 0x20 ) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x",
+                                  static_cast<unsigned int>(c));
+                    out << buffer;
+                }
+                else {
+                    out << c;
+                }
+                break;
+        }
+    }
+    out << '"';
+}
+
+static void put_padding(std::ostream& out, const size_t length)
+{
+    static const char zeros[8] = {0};
+    out.write(zeros, (8 - length % 8) % 8);
+}
+
+static void skip_padding(std::istream& in, const size_t length)
+{
+    const std::streamsize padding = (8 - length % 8) % 8;
+    if ( !in.ignore(padding) || in.gcount() != padding ) {
+        throw TableBadInputFile("Unexpected end of columnar input");
+    }
+}
+
+static uint64_t remaining_bytes(std::istream& in)
+{
+    const std::istream::pos_type here = in.tellg();
+    if ( here == std::istream::pos_type(-1) ) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+    in.seekg(0, std::ios::end);
+    const std::istream::pos_type end = in.tellg();
+    in.clear();
+    in.seekg(here);
+    if ( end == std::istream::pos_type(-1) || !in ) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    return static_cast<uint64_t>(end - here);
+}
+
+static std::string read_bytes(std::istream& in, const uint64_t count)
+{
+    std::string bytes;
+    bytes.reserve(std::min(count, max_unchecked_reserve));
+
+    char buffer[4096];
+    for ( uint64_t left = count; left > 0; ) {
+        const size_t chunk = std::min<uint64_t>(left, sizeof(buffer));
+        if ( !in.read(buffer, chunk) ) {
+            throw TableBadInputFile("Unexpected end of columnar input");
+        }
+        bytes.append(buffer, chunk);
+        left -= chunk;
+    }
+    return bytes;
+}
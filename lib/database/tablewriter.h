@@ -0,0 +1,146 @@
+/*!
+ * \file            tablewriter.h
+ * \brief           Interface to machine-readable table output writers
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_DATABASE_TABLE_WRITER_H
+#define PG_DATABASE_TABLE_WRITER_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "table.h"
+
+namespace gldb {
+
+/*!
+ * \brief           Column data type for typed output formats.
+ * \ingroup         database
+ */
+enum class ColumnType : uint32_t {
+    text = 0,       /*!<  Arbitrary text  */
+    integer = 1,    /*!<  Signed 64-bit integer  */
+    decimal = 2     /*!<  Signed 64-bit integer with a fixed decimal scale  */
+};
+
+/*!
+ * \brief           Column description for typed output formats.
+ * \ingroup         database
+ */
+struct ColumnInfo {
+    /*!  The column name  */
+    std::string name;
+
+    /*!  The column data type  */
+    ColumnType type;
+
+    /*!  The number of decimal places, for decimal columns  */
+    uint32_t scale;
+};
+
+/*!
+ * \brief           Infers column types from the contents of a table.
+ * \details         A column is \c integer if every field is a canonical
+ * decimal integer, \c decimal if every field is a canonical decimal
+ * number with the same number of decimal places, and \c text otherwise.
+ * Canonical numbers have no leading zeros or '+' sign, so that values such
+ * as account number "0100" stay text and every field converts back to
+ * exactly the same string.
+ * \ingroup         database
+ * \param table     The table.
+ * \returns         A vector containing a description of each column.
+ */
+std::vector<ColumnInfo> infer_column_types(const Table& table);
+
+/*!
+ * \brief           Abstract table output writer class.
+ * \ingroup         database
+ */
+class TableWriter {
+    public:
+
+        /*!  Destructor  */
+        virtual ~TableWriter () {}
+
+        /*!
+         * \brief           Writes a table to an output stream.
+         * \param out       The stream to which to write.
+         * \param table     The table to write.
+         */
+        virtual void write(std::ostream& out, const Table& table) = 0;
+};
+
+/*!
+ * \brief           CSV table writer class.
+ * \details         Writes a header line followed by one line per record.
+ * Fields containing commas, double quotes or line breaks are quoted as
+ * described in RFC 4180.
+ * \ingroup         database
+ */
+class CSVTableWriter : public TableWriter {
+    public:
+        virtual void write(std::ostream& out, const Table& table);
+};
+
+/*!
+ * \brief           JSON Lines table writer class.
+ * \details         Writes one JSON object per record, keyed by the column
+ * headers. Integer and decimal columns are written as JSON numbers, and
+ * text columns as JSON strings.
+ * \ingroup         database
+ */
+class JSONLinesTableWriter : public TableWriter {
+    public:
+        virtual void write(std::ostream& out, const Table& table);
+};
+
+/*!
+ * \brief           Binary columnar table writer class.
+ * \details         All integers are written in host byte order, and every
+ * section starts on an 8-byte boundary so a consumer can mmap the file
+ * and use the column arrays in place. The layout is:
+ *
+ * - Header: the 8 byte magic string \c "GLCOL1\0\0", then a \c uint32_t
+ *   column count, a \c uint32_t reserved word and a \c uint64_t row count.
+ * - Schema: for each column, a \c uint32_t type (see \c ColumnType),
+ *   a \c uint32_t scale, a \c uint32_t name length, and the name bytes,
+ *   padded to 8 bytes.
+ * - Data: for each column in order, either an array of \c int64_t values
+ *   (integer and decimal columns, decimals scaled by 10 to the power of
+ *   the scale), or for text columns an array of row count plus one
+ *   \c uint64_t offsets followed by the concatenated string bytes, padded
+ *   to 8 bytes.
+ * \ingroup         database
+ */
+class ColumnarTableWriter : public TableWriter {
+    public:
+        virtual void write(std::ostream& out, const Table& table);
+};
+
+/*!
+ * \brief           Creates a table writer for a named format.
+ * \ingroup         database
+ * \param format    The format name: "csv", "jsonl" or "columnar".
+ * \returns         A pointer to the new writer.
+ * \throws          TableException if the format is not recognized.
+ */
+std::unique_ptr<TableWriter> make_table_writer(const std::string& format);
+
+/*!
+ * \brief           Reads a table written by \c ColumnarTableWriter.
+ * \ingroup         database
+ * \param in        The stream from which to read.
+ * \returns         The table.
+ * \throws          TableBadInputFile if the input is not in the binary
+ * columnar format, or is truncated or corrupt.
+ */
+Table read_columnar_table(std::istream& in);
+
+}               //  namespace gldb
+
+#endif          //  PG_DATABASE_TABLE_WRITER_H
@@ -0,0 +1,42 @@
+/*!
+ * \file            backend_plugin.cpp
+ * \brief           Entry point of a database backend plugin.
+ * \details         Compiled only into plugins, together with one database
+ * implementation, which provides the functions in the factory table, and
+ * the SQL dialects.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include "backends.h"
+#include "database_imp.h"
+#include "dbsql/dbsql_functions.h"
+
+using namespace gldb;
+
+/*!
+ * \brief           Creates the SQL dialect for the plugin's database type.
+ * \ingroup         database
+ * \returns         A new dialect owned by the caller.
+ */
+static genleg::DBSQLStatements * get_sql_object();
+
+/*!
+ * \brief           Returns the plugin factory table.
+ * \ingroup         database
+ * \returns         A pointer to the factory table.
+ */
+extern "C" const BackendPlugin * gldb_backend_plugin()
+{
+    static const BackendPlugin plugin{
+        backend_plugin_version, get_database_type, get_connection,
+        init_thread, end_thread, get_sql_object
+    };
+    return &plugin;
+}
+
+static genleg::DBSQLStatements * get_sql_object()
+{
+    return genleg::new_sql_dialect(get_database_type());
+}
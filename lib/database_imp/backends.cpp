@@ -0,0 +1,183 @@
+/*!
+ * \file            backends.cpp
+ * \brief           Implementation of runtime-loadable database backends.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#include <dlfcn.h>
+
+#include "backends.h"
+#include "database_imp.h"
+
+using namespace gldb;
+
+/*!  Factory table for the compiled-in backend  */
+static const BackendPlugin builtin_backend{
+    backend_plugin_version, get_database_type, get_connection,
+    init_thread, end_thread, nullptr
+};
+
+/*!  Protects the backend registry  */
+static std::mutex backend_mutex;
+
+/*!  Loaded plugins, by file name  */
+static std::map<std::string, const BackendPlugin *> loaded_backends;
+
+/*!  The selected backend  */
+static const BackendPlugin * current_backend = &builtin_backend;
+
+/*!  The capture file new connections record to, if any  */
+static std::shared_ptr<CaptureWriter> capture_writer;
+
+/*!  The capture file new connections replay, if any  */
+static std::shared_ptr<CaptureLibrary> replay_library;
+
+/*!  Whether replayed connections take the recorded time  */
+static bool replay_timed = false;
+
+/*!
+ * \brief           Loads a plugin.
+ * \param filename  The file name of the plugin.
+ * \returns         The plugin factory table.
+ * \throws          DBConnCouldNotLoadBackend on error.
+ */
+static const BackendPlugin * load_plugin(const std::string& filename);
+
+void gldb::select_backend(const std::string& backend)
+{
+    std::lock_guard<std::mutex> lock{backend_mutex};
+
+    if ( backend.empty() || backend == "builtin" ) {
+        current_backend = &builtin_backend;
+        return;
+    }
+
+    const std::string filename = backend.find('/') == std::string::npos ?
+                                 "gldb_" + backend + ".so" : backend;
+
+    auto found = loaded_backends.find(filename);
+    if ( found == loaded_backends.end() ) {
+        found = loaded_backends.emplace(filename,
+                                        load_plugin(filename)).first;
+    }
+    current_backend = found->second;
+}
+
+void gldb::record_backend(const std::string& filename)
+{
+    std::lock_guard<std::mutex> lock{backend_mutex};
+    capture_writer = std::make_shared<CaptureWriter>(
+            filename, current_backend->database_type());
+}
+
+void gldb::replay_backend(const std::string& filename, const bool timed)
+{
+    auto library = std::make_shared<CaptureLibrary>(filename);
+    std::lock_guard<std::mutex> lock{backend_mutex};
+    replay_library = std::move(library);
+    replay_timed = timed;
+}
+
+DBConnImp * gldb::backend_connection(const std::string& database,
+                                     const std::string& hostname,
+                                     const std::string& username,
+                                     const std::string& password)
+{
+    const BackendPlugin * backend;
+    std::shared_ptr<CaptureWriter> writer;
+    {
+        std::lock_guard<std::mutex> lock{backend_mutex};
+        if ( replay_library ) {
+            return new DBConnReplay(replay_library, replay_timed);
+        }
+        backend = current_backend;
+        writer = capture_writer;
+    }
+
+    DBConnImp * imp = backend->get_connection(database, hostname,
+                                              username, password);
+    return writer ? new DBConnRecorder(imp, std::move(writer)) : imp;
+}
+
+BackendThread::BackendThread() :
+    m_backend{nullptr}
+{
+
+    /*  Replayed connections use no client library  */
+
+    {
+        std::lock_guard<std::mutex> lock{backend_mutex};
+        if ( !replay_library ) {
+            m_backend = current_backend;
+        }
+    }
+    if ( m_backend ) {
+        m_backend->init_thread();
+    }
+}
+
+BackendThread::~BackendThread()
+{
+    if ( m_backend ) {
+        m_backend->end_thread();
+    }
+}
+
+genleg::DBSQLStatements * gldb::backend_sql_object()
+{
+    const BackendPlugin * backend;
+    {
+        std::lock_guard<std::mutex> lock{backend_mutex};
+        if ( replay_library ) {
+            return nullptr;
+        }
+        backend = current_backend;
+    }
+    return backend->get_sql_object ? backend->get_sql_object() : nullptr;
+}
+
+std::string gldb::backend_database_type()
+{
+    std::lock_guard<std::mutex> lock{backend_mutex};
+    return replay_library ? replay_library->database_type() :
+                            current_backend->database_type();
+}
+
+static const BackendPlugin * load_plugin(const std::string& filename)
+{
+    void * handle = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if ( !handle ) {
+        throw DBConnCouldNotLoadBackend(dlerror());
+    }
+
+    /*  Casting from an object pointer to a function pointer is
+     *  conditionally supported, and is how dlsym() is meant to be used. */
+
+    using entry_type = const BackendPlugin * (*)();
+    const entry_type entry = reinterpret_cast<entry_type>(
+            reinterpret_cast<uintptr_t>(dlsym(handle,
+                                              backend_plugin_symbol)));
+    const BackendPlugin * plugin = entry ? entry() : nullptr;
+
+    if ( !plugin ) {
+        dlclose(handle);
+        throw DBConnCouldNotLoadBackend(filename + " is not a database "
+                                        "backend plugin");
+    }
+    if ( plugin->version != backend_plugin_version ) {
+        std::ostringstream ss;
+        ss << filename << " is backend plugin version " << plugin->version
+           << ", expected version " << backend_plugin_version;
+        dlclose(handle);
+        throw DBConnCouldNotLoadBackend(ss.str());
+    }
+
+    return plugin;
+}
@@ -0,0 +1,190 @@
+/*!
+ * \file            backends.h
+ * \brief           Interface to runtime-loadable database backends.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_BACKENDS_H
+#define PG_GENERAL_LEDGER_DATABASE_BACKENDS_H
+
+#include <cstdint>
+#include <string>
+
+#include "database/database.h"
+
+namespace genleg {
+class DBSQLStatements;
+}
+
+namespace gldb {
+
+/*!
+ * \brief           Version of the backend plugin factory table.
+ * \details         Incremented whenever \c BackendPlugin, \c DBConnImp or
+ * any class passed between a plugin and the program changes, so that a
+ * plugin built against different headers is refused rather than called.
+ * \ingroup         database
+ */
+const uint32_t backend_plugin_version = 3;
+
+/*!
+ * \brief           Name of the function a backend plugin exports.
+ * \details         The function is declared <tt>extern "C"</tt>, takes no
+ * arguments and returns a pointer to a static \c BackendPlugin.
+ * \ingroup         database
+ */
+const char * const backend_plugin_symbol = "gldb_backend_plugin";
+
+/*!
+ * \brief           Backend plugin factory table.
+ * \details         A backend plugin is a shared object built from one of
+ * the database implementations with <tt>make plugin database=name</tt>.
+ * \ingroup         database
+ */
+struct BackendPlugin {
+    /*!  The version of the table, \c backend_plugin_version  */
+    uint32_t version;
+
+    /*!  Returns the database type, which also selects the SQL dialect  */
+    std::string (*database_type)();
+
+    /*!  Creates a connection, as \c get_connection()  */
+    DBConnImp * (*get_connection)(const std::string& database,
+                                  const std::string& hostname,
+                                  const std::string& username,
+                                  const std::string& password);
+
+    /*!  Prepares the calling thread to use connections  */
+    void (*init_thread)();
+
+    /*!  Releases what \c init_thread set up  */
+    void (*end_thread)();
+
+    /*!  Creates the SQL dialect for the database type, owned by the
+     *   caller, or \c nullptr to use the dialect registered in the
+     *   program. May itself be \c nullptr.                            */
+    genleg::DBSQLStatements * (*get_sql_object)();
+};
+
+/*!
+ * \brief       Could not load backend plugin exception class.
+ * \ingroup     database
+ */
+class DBConnCouldNotLoadBackend : public DBConnException {
+    public:
+        /*!
+         * \brief           Constructor
+         * \param msg       Error message
+         */
+        explicit DBConnCouldNotLoadBackend(const std::string& msg) :
+            DBConnException(msg) {};
+};
+
+/*!
+ * \brief           Selects the database backend.
+ * \details         Connections made after this call use the selected
+ * backend. A plugin, once loaded, stays loaded until the program exits,
+ * since its connections and their code may still be in use, and selecting
+ * the same plugin again reuses it.
+ * \ingroup         database
+ * \param backend   The empty string or \c builtin for the backend compiled
+ * into the program. Otherwise the name of a plugin, which is the path of a
+ * shared object if it contains a slash, and otherwise a backend name such
+ * as \c sqlite, which is loaded as \c gldb_sqlite.so from the library
+ * search path.
+ * \throws          DBConnCouldNotLoadBackend if the plugin could not be
+ * loaded or has the wrong version.
+ */
+void select_backend(const std::string& backend);
+
+/*!
+ * \brief           Records connections to a capture file.
+ * \details         Connections made after this call with the selected
+ * backend record every operation, with its result or error and the time
+ * it took, to the file, which a later run may replay.
+ * \ingroup         database
+ * \param filename  The capture file, which is overwritten.
+ * \throws          DBCaptureException if the file could not be created.
+ */
+void record_backend(const std::string& filename);
+
+/*!
+ * \brief           Replays a capture file instead of using a backend.
+ * \details         Connections made after this call serve the recorded
+ * results without a database, and report the recorded database type, so
+ * the same SQL dialect is used as when recording. Connections made while
+ * replaying are not recorded.
+ * \ingroup         database
+ * \param filename  The capture file.
+ * \param timed     \c true to take as long over each operation as it
+ * took when recorded.
+ * \throws          DBCaptureException if the file could not be read.
+ */
+void replay_backend(const std::string& filename, const bool timed);
+
+/*!
+ * \brief           Creates a connection with the selected backend.
+ * \ingroup         database
+ * \param database  The name of the database to which to connect.
+ * \param hostname  The hostname of the computer running the database.
+ * \param username  The username with which to log into the database.
+ * \param password  The password with which to log into the database.
+ * \returns         A pointer to the database implementation.
+ */
+DBConnImp * backend_connection(const std::string& database,
+                               const std::string& hostname,
+                               const std::string& username,
+                               const std::string& password);
+
+/*!
+ * \brief           Backend thread RAII class.
+ * \details         Prepares the thread which creates it to use connections
+ * made with the selected backend, and releases what it set up when
+ * destroyed. Every thread other than the main thread which uses
+ * connections, such as the workers of a connection pool, should hold one
+ * for as long as it does, since some client libraries, such as MySQL's,
+ * keep state for each thread.
+ * \ingroup         database
+ */
+class BackendThread {
+    public:
+        /*!  Constructor, preparing the thread  */
+        BackendThread ();
+
+        /*!  Destructor, releasing what the constructor set up  */
+        ~BackendThread ();
+
+        /*!  Deleted copy constructor  */
+        BackendThread (const BackendThread&) = delete;
+
+        /*!  Deleted copy assignment operator  */
+        BackendThread& operator=(const BackendThread&) = delete;
+
+    private:
+        /*!  The backend the thread was prepared for, if any  */
+        const BackendPlugin * m_backend;
+};
+
+/*!
+ * \brief           Creates the SQL dialect of the selected backend.
+ * \details         Replayed connections, and backends which provide no
+ * dialect, such as the compiled-in one, use the dialect registered in the
+ * program for their database type.
+ * \ingroup         database
+ * \returns         A new dialect owned by the caller, or \c nullptr if
+ * the backend provides none.
+ */
+genleg::DBSQLStatements * backend_sql_object();
+
+/*!
+ * \brief           Returns the type of the selected backend.
+ * \ingroup         database
+ * \returns         The name of the database type.
+ */
+std::string backend_database_type();
+
+}           //  namespace gldb
+
+#endif      //  PG_GENERAL_LEDGER_DATABASE_BACKENDS_H
@@ -45,6 +45,20 @@ DBConnImp * get_connection(const std::string& database,
  */
 std::string get_database_type();
 
+/*!
+ * \brief           Prepares the calling thread to use connections.
+ * \details         Implementations whose client library keeps state for
+ * each thread set it up here, and the others do nothing.
+ * \ingroup         database
+ */
+void init_thread();
+
+/*!
+ * \brief           Releases what \c init_thread() set up.
+ * \ingroup         database
+ */
+void end_thread();
+
 }           //  namespace gldb
 
 #endif      //  PG_GENERAL_LEDGER_DATABASE_IMP_H
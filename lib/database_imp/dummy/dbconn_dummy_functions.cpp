@@ -16,3 +16,8 @@ std::string gldb::get_database_type() {
     return "DUMMY";
 }
 
+void gldb::init_thread() {
+}
+
+void gldb::end_thread() {
+}
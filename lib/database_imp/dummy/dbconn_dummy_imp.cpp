@@ -14,8 +14,19 @@ using namespace gldb;
 
 DBConnDummy::DBConnDummy(const std::string database,
         const std::string hostname, const std::string username,
-        const std::string password) {
-    (void)database;
+        const std::string password) : m_synthetic{} {
+    static const std::string synthetic_prefix{"synthetic"};
+    if ( database.compare(0, synthetic_prefix.size(),
+                          synthetic_prefix) == 0 ) {
+        try {
+            m_synthetic.reset(new SyntheticGenerator(
+                        database.substr(synthetic_prefix.size())));
+        }
+        catch ( const SyntheticBadSpec& e ) {
+            throw DBConnCouldNotConnect(e.what());
+        }
+    }
+
     (void)hostname;
     (void)username;
     (void)password;
@@ -29,6 +40,12 @@ void DBConnDummy::query(const std::string& sql_query) {
 }
 
 Table DBConnDummy::select(const std::string& query) {
+    (void)query;
+
+    if ( m_synthetic ) {
+        return m_synthetic->table();
+    }
+
     const size_t num_fields = 4, num_records = 6;
 
     TableRow field_names(num_fields);
@@ -50,7 +67,6 @@ Table DBConnDummy::select(const std::string& query) {
         table.append_record(record);
     }
 
-    (void)query;
     return table;
 }
 
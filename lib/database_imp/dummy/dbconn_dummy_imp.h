@@ -9,6 +9,7 @@
 #ifndef PG_GENERAL_LEDGER_DATABASE_DBCONNDUMMYIMP_H
 #define PG_GENERAL_LEDGER_DATABASE_DBCONNDUMMYIMP_H
 
+#include <memory>
 #include <string>
 
 #include "database/database.h"
@@ -17,6 +18,14 @@ namespace gldb {
 
 /*!
  * \brief       Dummy database implementation class
+ * \details     If the database name starts with \c synthetic, every
+ * \c select() returns all the rows from a \c SyntheticGenerator,
+ * configured by the rest of the name, as in
+ * <tt>synthetic;scale=100;seed=7</tt>. The query is not looked at, so
+ * a synthetic database only generates a table of a given size, for
+ * benchmarking code which reads the results of a single select, and
+ * cannot stand in for the ledger schema. Otherwise \c select() returns
+ * a small table of placeholder strings.
  * \ingroup     database
  */
 class DBConnDummy : public DBConnImp {
@@ -27,6 +36,8 @@ class DBConnDummy : public DBConnImp {
          * \param hostname  The hostname of the server.
          * \param username  The username to log into the database.
          * \param password  The password to log into the database.
+         * \throws          DBConnCouldNotConnect If a synthetic data
+         * specification is malformed.
          */
         DBConnDummy (const std::string database,
                 const std::string hostname, const std::string username,
@@ -51,8 +62,9 @@ class DBConnDummy : public DBConnImp {
 
         /*!
          * \brief           Fakes running of an SQL SELECT query.
-         * \param query     Any query.
-         * \returns         A Table object containing dummy results.
+         * \param query     Any query, which is ignored.
+         * \returns         A Table object containing dummy results, or
+         * every synthetic row if the database is synthetic.
          */
         Table select(const std::string& query);
 
@@ -77,6 +89,11 @@ class DBConnDummy : public DBConnImp {
          */
         virtual unsigned long long last_auto_increment() { return 1; }
 
+    private:
+
+        /*!  Synthetic data generator, if the database is synthetic  */
+        std::unique_ptr<SyntheticGenerator> m_synthetic;
+
 };              //  class DBConnDummy
 
 }               //  namespace gldb
@@ -0,0 +1,38 @@
+local_dir := lib/database_imp
+local_lib := $(local_dir)/libdatabase_backends.a
+local_src := $(local_dir)/backends.cpp
+local_objs := $(subst .cpp,.o,$(local_src))
+
+libraries += $(local_lib)
+LDFLAGS   += -ldl
+sources   += $(local_src)
+
+$(local_lib): $(local_objs)
+	@echo "Building database backends library..."
+	@$(AR) $(ARFLAGS) $@ $^
+
+# A plugin holds the selected database implementation, with the database
+# and utility libraries it uses and the SQL dialects and the user class
+# they use, built as position independent code.
+
+plugin_lib  := $(local_dir)/$(database)/gldb_$(database).so
+plugin_src  := $(wildcard $(local_dir)/$(database)/*.cpp)
+plugin_src  += $(local_dir)/backend_plugin.cpp
+plugin_src  += $(wildcard lib/database/*.cpp) $(wildcard lib/pgutils/*.cpp)
+plugin_src  += lib/dbsql/dbsql_dialects.cpp lib/dbsql/dbsqlstatements.cpp
+plugin_src  += lib/dbsql/dbsql_sqlite.cpp
+plugin_src  += lib/gldb/gluser.cpp lib/gldb/glpermission.cpp
+plugin_objs := $(subst .cpp,.pic.o,$(plugin_src))
+
+CLNGLOB += $(wildcard $(local_dir)/*/*.so)
+CLNGLOB += $(wildcard lib/*/*.pic.o $(local_dir)/*/*.pic.o)
+
+.PHONY: plugin
+plugin: $(plugin_lib)
+
+$(plugin_lib): $(plugin_objs)
+	@echo "Building $(database) database plugin..."
+	@$(CXX) -shared -Wl,-Bsymbolic -o $@ $^ $(LDFLAGS)
+
+%.pic.o: %.cpp
+	$(CXX) $(CXXFLAGS) -fPIC -c -o $@ $<
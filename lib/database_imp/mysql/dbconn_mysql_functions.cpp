@@ -22,3 +22,10 @@ std::string gldb::get_database_type() {
     return "MySQL";
 }
 
+void gldb::init_thread() {
+    mysql_thread_init();
+}
+
+void gldb::end_thread() {
+    mysql_thread_end();
+}
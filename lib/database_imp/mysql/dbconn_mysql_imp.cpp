@@ -26,19 +26,26 @@ get_field_names(MySQLResult& result);
  * \ingroup database
  * \param result        The MySQL result structure.
  * \param row           The MySQL row structure.
+ * \param bytes         Incremented by the bytes of field data in the row.
  * \returns             A TableRow containing the row data.
  */
 static TableRow
-get_row(MySQLResult& result, MYSQL_ROW row);
+get_row(MySQLResult& result, MYSQL_ROW row, unsigned long long& bytes);
 
-/*  Define static class mutex  */
+/*!  Largest multi-statement query sent, well under the default
+ *   max_allowed_packet of older servers                            */
+static const size_t max_batch_bytes = 512 * 1024;
+
+/*  Define static class mutex and connection count  */
 std::mutex DBConnMySQL::mtx;
+size_t DBConnMySQL::num_connections = 0;
 
 DBConnMySQL::DBConnMySQL(const std::string& database,
                          const std::string& hostname,
                          const std::string& username,
                          const std::string& password) :
-    m_conn{nullptr}
+    m_conn{nullptr},
+    m_result_bytes{0}
 {
     /*  Lock mutex since calls to mysql_init()
      *  are not thread-safe.                    */
@@ -47,8 +54,12 @@ DBConnMySQL::DBConnMySQL(const std::string& database,
 
     m_conn = mysql_init(nullptr);
     if ( !m_conn ) {
+        if ( num_connections == 0 ) {
+            mysql_library_end();
+        }
         throw DBConnCouldNotConnect("Could not initialize connection");
     }
+    ++num_connections;
 
     lock.unlock();
 
@@ -56,18 +67,29 @@ DBConnMySQL::DBConnMySQL(const std::string& database,
             username.c_str(), password.c_str(),
             database.c_str(), 0, nullptr, 0) ) {
         const std::string msg = mysql_error(m_conn);
-        mysql_close(m_conn);
-        mysql_library_end();
+        close();
         throw DBConnCouldNotConnect(msg);
     }
 }
 
 DBConnMySQL::~DBConnMySQL()
 {
+    close();
+}
+
+void DBConnMySQL::close()
+{
+    /*  The client library is shared by all connections, so only
+     *  shut it down when the last one is closed.                   */
+
+    std::lock_guard<std::mutex> lock{DBConnMySQL::mtx};
     if ( m_conn ) {
         mysql_close(m_conn);
+        m_conn = nullptr;
+        if ( --num_connections == 0 ) {
+            mysql_library_end();
+        }
     }
-    mysql_library_end();
 }
 
 void DBConnMySQL::query(const std::string& sql_query)
@@ -83,13 +105,54 @@ Table DBConnMySQL::select(const std::string& sql_query)
     MySQLResult result(m_conn);
     Table table{get_field_names(result)};
 
+    m_result_bytes = 0;
     for ( MYSQL_ROW row; (row = mysql_fetch_row(result.result())); ) {
-        table.append_record(get_row(result, row));
+        table.append_record(get_row(result, row, m_result_bytes));
     }
 
     return table;
 }
 
+void DBConnMySQL::query_batch(const std::vector<std::string>& statements)
+{
+    if ( statements.size() < 2 ) {
+        DBConnImp::query_batch(statements);
+        return;
+    }
+
+    /*  Multiple statements are only enabled for the batch, so that a
+     *  single query can never carry extra statements with it.          */
+
+    if ( mysql_set_server_option(m_conn, MYSQL_OPTION_MULTI_STATEMENTS_ON) ) {
+        throw DBConnCouldNotQuery(mysql_error(m_conn));
+    }
+
+    try {
+        size_t first = 0;
+        while ( first < statements.size() ) {
+            std::string batch{statements[first]};
+            size_t last = first + 1;
+            while ( last < statements.size() &&
+                    batch.size() + statements[last].size() + 2 <
+                        max_batch_bytes ) {
+                batch += ";\n";
+                batch += statements[last++];
+            }
+            query_multi(batch, first);
+            first = last;
+        }
+    }
+    catch ( ... ) {
+        mysql_set_server_option(m_conn, MYSQL_OPTION_MULTI_STATEMENTS_OFF);
+        throw;
+    }
+
+    if ( mysql_set_server_option(m_conn,
+                                 MYSQL_OPTION_MULTI_STATEMENTS_OFF) ) {
+        throw DBConnCouldNotQuery(mysql_error(m_conn));
+    }
+}
+
 void DBConnMySQL::begin_transaction()
 {
     query("START TRANSACTION");
@@ -110,6 +173,43 @@ unsigned long long DBConnMySQL::last_auto_increment()
     return mysql_insert_id(m_conn);
 }
 
+void DBConnMySQL::thread_init()
+{
+    if ( mysql_thread_init() ) {
+        throw DBConnCouldNotQuery("Could not initialize thread");
+    }
+}
+
+void DBConnMySQL::thread_end()
+{
+    mysql_thread_end();
+}
+
+void DBConnMySQL::query_multi(const std::string& batch, const size_t first)
+{
+    if ( mysql_real_query(m_conn, batch.c_str(), batch.size()) ) {
+        throw DBConnBatchFailed(first, mysql_error(m_conn));
+    }
+
+    /*  The server stops at the first failed statement, which is reported
+     *  when reading the result after the last successful one.          */
+
+    size_t done = 0;
+    int status;
+    do {
+        MYSQL_RES * result = mysql_store_result(m_conn);
+        if ( result ) {
+            mysql_free_result(result);
+        }
+        ++done;
+
+        status = mysql_next_result(m_conn);
+        if ( status > 0 ) {
+            throw DBConnBatchFailed(first + done, mysql_error(m_conn));
+        }
+    } while ( status == 0 );
+}
+
 static TableRow
 get_field_names(MySQLResult& result)
 {
@@ -124,13 +224,14 @@ get_field_names(MySQLResult& result)
 }
 
 static TableRow
-get_row(MySQLResult& result, MYSQL_ROW row)
+get_row(MySQLResult& result, MYSQL_ROW row, unsigned long long& bytes)
 {
     TableRow record{result.num_fields()};
     unsigned long * lengths = mysql_fetch_lengths(result.result());
 
     for ( size_t f = 0; f < result.num_fields(); ++f ) {
         record[f] = std::string{row[f], lengths[f]};
+        bytes += lengths[f];
     }
 
     return record;
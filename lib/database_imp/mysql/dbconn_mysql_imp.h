@@ -10,6 +10,7 @@
 #define PG_GENERAL_LEDGER_DATABASE_DBCONNMYSQLIMP_H
 
 #include <string>
+#include <vector>
 #include <mutex>
 
 #include "database/database.h"
@@ -73,6 +74,19 @@ class DBConnMySQL : public DBConnImp {
          */
         virtual Table select(const std::string& sql_query);
 
+        /*!
+         * \brief               Runs a batch of SQL statements which return
+         * no results.
+         * \details             Multiple statements are enabled on the
+         * connection for the duration of the batch, which is sent as few
+         * multi-statement queries as fit within the server's packet size,
+         * each needing one round trip.
+         * \param statements    The statements.
+         * \throws              DBConnBatchFailed If a statement failed,
+         * giving its index.
+         */
+        virtual void query_batch(const std::vector<std::string>& statements);
+
         /*!
          * \brief           Begins a transaction.
          */
@@ -94,14 +108,56 @@ class DBConnMySQL : public DBConnImp {
          */
         virtual unsigned long long last_auto_increment();
 
+        /*!
+         * \brief           Returns the size of the last result.
+         * \returns         The bytes of field data in the last result.
+         */
+        virtual unsigned long long last_result_bytes() const {
+            return m_result_bytes;
+        }
+
+        /*!
+         * \brief           Prepares the calling thread to use the
+         * connection.
+         * \details         Calls \c mysql_thread_init(), which every
+         * thread but the one which made the connection must call.
+         */
+        virtual void thread_init();
+
+        /*!
+         * \brief           Releases what \c thread_init() set up.
+         */
+        virtual void thread_end();
+
     private:
 
         /*!  The initialized MySQL handle.  */
         MYSQL * m_conn;
 
+        /*!  Bytes of field data in the last result  */
+        unsigned long long m_result_bytes;
+
         /*!  Database connection mutex  */
         static std::mutex mtx;
 
+        /*!  Number of open connections, guarded by \c mtx  */
+        static size_t num_connections;
+
+        /*!
+         * \brief           Closes the handle, and shuts down the client
+         * library if this was the last open connection.
+         */
+        void close();
+
+        /*!
+         * \brief           Runs a multi-statement query and reads all its
+         * results.
+         * \param batch     The statements, separated by semicolons.
+         * \param first     The batch index of the first statement.
+         * \throws          DBConnBatchFailed If a statement failed.
+         */
+        void query_multi(const std::string& batch, const size_t first);
+
 };              //  class DBConnMySQL
 
 }               //  namespace gldb
@@ -0,0 +1,180 @@
+/*!
+ * \file            dbconn_sqlite_imp.cpp
+ * \brief           Implementation of SQLite database connection
+ * implementation class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <cctype>
+#include "dbconn_sqlite_imp.h"
+
+using namespace gldb;
+
+/*!  Milliseconds to wait for a lock held by another connection  */
+static const int busy_timeout_ms = 10000;
+
+/*!
+ * \brief               Gets field names from a prepared statement.
+ * \ingroup database
+ * \param stmt          The prepared statement.
+ * \returns             A TableRow containing the field names.
+ */
+static TableRow
+get_field_names(sqlite3_stmt * stmt);
+
+/*!
+ * \brief               Creates a TableRow from the current result row.
+ * \details             NULL values are returned as empty strings.
+ * \ingroup database
+ * \param stmt          The prepared statement.
+ * \param bytes         Incremented by the bytes of field data in the row.
+ * \returns             A TableRow containing the row data.
+ */
+static TableRow
+get_row(sqlite3_stmt * stmt, unsigned long long& bytes);
+
+DBConnSQLite::DBConnSQLite(const std::string& database,
+                           const std::string&,
+                           const std::string&,
+                           const std::string&) :
+    m_conn{nullptr},
+    m_result_bytes{0}
+{
+    const int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE |
+                      SQLITE_OPEN_NOMUTEX;
+    if ( sqlite3_open_v2(database.c_str(), &m_conn, flags,
+                         nullptr) != SQLITE_OK ) {
+        const std::string msg = m_conn ? sqlite3_errmsg(m_conn) :
+                                         "Could not allocate connection";
+        sqlite3_close(m_conn);
+        throw DBConnCouldNotConnect(msg);
+    }
+
+    sqlite3_busy_timeout(m_conn, busy_timeout_ms);
+
+    try {
+        query("PRAGMA journal_mode = WAL");
+        query("PRAGMA synchronous = NORMAL");
+        query("PRAGMA foreign_keys = ON");
+    }
+    catch ( const DBConnCouldNotQuery& e ) {
+        sqlite3_close(m_conn);
+        throw DBConnCouldNotConnect(e.what());
+    }
+}
+
+DBConnSQLite::~DBConnSQLite()
+{
+    sqlite3_close(m_conn);
+}
+
+void DBConnSQLite::query(const std::string& sql_query)
+{
+    char * errmsg = nullptr;
+    if ( sqlite3_exec(m_conn, sql_query.c_str(),
+                      nullptr, nullptr, &errmsg) != SQLITE_OK ) {
+        const std::string msg = errmsg ? errmsg : sqlite3_errmsg(m_conn);
+        sqlite3_free(errmsg);
+        throw DBConnCouldNotQuery(msg);
+    }
+}
+
+Table DBConnSQLite::select(const std::string& sql_query)
+{
+    Statement stmt = prepare(sql_query);
+    Table table{get_field_names(stmt.get())};
+
+    m_result_bytes = 0;
+    int status;
+    while ( (status = sqlite3_step(stmt.get())) == SQLITE_ROW ) {
+        table.append_record(get_row(stmt.get(), m_result_bytes));
+    }
+
+    /*  Resetting releases the read lock before the statement is
+     *  finalized, and returns the error if the step failed.        */
+
+    if ( sqlite3_reset(stmt.get()) != SQLITE_OK || status != SQLITE_DONE ) {
+        throw DBConnCouldNotQuery(sqlite3_errmsg(m_conn));
+    }
+
+    return table;
+}
+
+void DBConnSQLite::begin_transaction()
+{
+    query("BEGIN IMMEDIATE");
+}
+
+void DBConnSQLite::rollback_transaction()
+{
+    query("ROLLBACK");
+}
+
+void DBConnSQLite::commit_transaction()
+{
+    query("COMMIT");
+}
+
+unsigned long long DBConnSQLite::last_auto_increment()
+{
+    return sqlite3_last_insert_rowid(m_conn);
+}
+
+DBConnSQLite::Statement DBConnSQLite::prepare(const std::string& sql_query)
+{
+    sqlite3_stmt * raw = nullptr;
+    const char * tail = nullptr;
+    const int status = sqlite3_prepare_v2(m_conn, sql_query.c_str(),
+                                          sql_query.size(), &raw, &tail);
+    Statement stmt{raw, sqlite3_finalize};
+    if ( status != SQLITE_OK ) {
+        throw DBConnCouldNotQuery(sqlite3_errmsg(m_conn));
+    }
+    if ( !stmt ) {
+        throw DBConnCouldNotQuery("Empty query");
+    }
+
+    for ( const char * end = sql_query.c_str() + sql_query.size();
+          tail != end; ++tail ) {
+        if ( !std::isspace(static_cast<unsigned char>(*tail)) &&
+             *tail != ';' ) {
+            throw DBConnCouldNotQuery("Query contains multiple statements");
+        }
+    }
+
+    return stmt;
+}
+
+static TableRow
+get_field_names(sqlite3_stmt * stmt)
+{
+    const int num_fields = sqlite3_column_count(stmt);
+    TableRow field_names{static_cast<size_t>(num_fields)};
+
+    for ( int i = 0; i < num_fields; ++i ) {
+        field_names[i] = sqlite3_column_name(stmt, i);
+    }
+
+    return field_names;
+}
+
+static TableRow
+get_row(sqlite3_stmt * stmt, unsigned long long& bytes)
+{
+    const int num_fields = sqlite3_column_count(stmt);
+    TableRow record{static_cast<size_t>(num_fields)};
+
+    for ( int f = 0; f < num_fields; ++f ) {
+        const unsigned char * text = sqlite3_column_text(stmt, f);
+        if ( text ) {
+            const size_t length = sqlite3_column_bytes(stmt, f);
+            record[f] = std::string{reinterpret_cast<const char *>(text),
+                                    length};
+            bytes += length;
+        }
+    }
+
+    return record;
+}
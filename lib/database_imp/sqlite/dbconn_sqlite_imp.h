@@ -0,0 +1,140 @@
+/*!
+ * \file            dbconn_sqlite_imp.h
+ * \brief           Interface to SQLite database connection implementation
+ * class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DBCONNSQLITEIMP_H
+#define PG_GENERAL_LEDGER_DATABASE_DBCONNSQLITEIMP_H
+
+#include <memory>
+#include <string>
+
+#include "database/database.h"
+
+#include <sqlite3.h>
+
+namespace gldb {
+
+/*!
+ * \brief       SQLite database implementation class
+ * \details     The database is a local file, opened in write-ahead log
+ * mode so that readers on other connections are not blocked by a writer.
+ * Foreign keys are enforced, as they are by MySQL. Every statement carries
+ * its values inline, so no two are alike often enough to be worth keeping,
+ * and each \c select() prepares its statement, reads the results into a
+ * \c Table in process, and finalizes it.
+ * \ingroup     database
+ */
+class DBConnSQLite : public DBConnImp {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \param database  The name of the SQLite database file, which is
+         * created if it does not exist.
+         * \param hostname  Ignored.
+         * \param username  Ignored.
+         * \param password  Ignored.
+         * \throws          DBConnCouldNotConnect If could not open
+         * the database.
+         */
+        DBConnSQLite (const std::string& database,
+                      const std::string& hostname,
+                      const std::string& username,
+                      const std::string& password);
+
+        /*!  Deleted copy constructor  */
+        DBConnSQLite (const DBConnSQLite&) = delete;
+
+        /*!  Delete move constructor  */
+        DBConnSQLite (const DBConnSQLite&&) = delete;
+
+        /*!  Destructor  */
+        virtual ~DBConnSQLite ();
+
+        /*!  Deleted assignment operator  */
+        DBConnSQLite& operator= (const DBConnSQLite&) = delete;
+
+        /*!  Deleted move assignment operator  */
+        DBConnSQLite& operator= (const DBConnSQLite&&) = delete;
+
+        /*!
+         * \brief           Runs an SQL query.
+         * \details         An empty query does nothing.
+         * \param sql_query The SQL query.
+         * \throws          DBConnCouldNotQuery If could not successfully
+         * execute query.
+         */
+        virtual void query(const std::string& sql_query);
+
+        /*!
+         * \brief           Runs an SQL SELECT query.
+         * \param sql_query The SQL query.
+         * \returns         A Table object containing the results.
+         * \throws          DBConnCouldNotQuery If could not successfully
+         * execute query.
+         */
+        virtual Table select(const std::string& sql_query);
+
+        /*!
+         * \brief           Begins a transaction.
+         * \details         The write lock is taken immediately, so that a
+         * transaction never fails part way through because another
+         * connection started writing first.
+         */
+        virtual void begin_transaction();
+
+        /*!
+         * \brief           Rolls back a transaction.
+         */
+        virtual void rollback_transaction();
+
+        /*!
+         * \brief           Commits a transaction.
+         */
+        virtual void commit_transaction();
+
+        /*!
+         * \brief           Returns the last auto incremented value.
+         * \returns         The last auto incremented value.
+         */
+        virtual unsigned long long last_auto_increment();
+
+        /*!
+         * \brief           Returns the size of the last result.
+         * \returns         The bytes of field data in the last result.
+         */
+        virtual unsigned long long last_result_bytes() const {
+            return m_result_bytes;
+        }
+
+    private:
+
+        /*!  The SQLite database handle.  */
+        sqlite3 * m_conn;
+
+        /*!  Bytes of field data in the last result  */
+        unsigned long long m_result_bytes;
+
+        /*!  Prepared statement, finalized when it goes out of scope  */
+        typedef std::unique_ptr<sqlite3_stmt, int (*)(sqlite3_stmt *)>
+            Statement;
+
+        /*!
+         * \brief           Prepares a statement.
+         * \param sql_query The SQL query, which must be a single statement.
+         * \returns         The statement, ready to step.
+         * \throws          DBConnCouldNotQuery If the statement could not
+         * be prepared.
+         */
+        Statement prepare(const std::string& sql_query);
+
+};              //  class DBConnSQLite
+
+}               //  namespace gldb
+
+#endif          //  PG_GENERAL_LEDGER_DATABASE_DBCONNSQLITEIMP_H
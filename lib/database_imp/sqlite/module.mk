@@ -0,0 +1,13 @@
+local_dir := lib/database_imp/sqlite
+local_lib := $(local_dir)/libdatabase_sqlite.a
+local_src := $(wildcard $(local_dir)/*.cpp)
+local_objs := $(subst .cpp,.o,$(local_src))
+
+libraries += $(local_lib)
+LDFLAGS   += -lsqlite3
+sources   += $(local_src)
+
+$(local_lib): $(local_objs)
+	@echo "Building SQLite database library..."
+	@$(AR) $(ARFLAGS) $@ $^
+
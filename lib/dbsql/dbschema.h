@@ -0,0 +1,479 @@
+/*!
+ * \file            dbschema.h
+ * \brief           Compile-time general ledger database schema registry.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DBSCHEMA_H
+#define PG_GENERAL_LEDGER_DATABASE_DBSCHEMA_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genleg {
+
+/*!
+ * \brief           Database tables, in creation order.
+ * \details         A table may only reference itself and tables before it,
+ * which is checked when compiling, so tables are created in this order and
+ * dropped in reverse.
+ * \ingroup         sql
+ */
+enum class SchemaTable : size_t {
+    schema_version,
+    standing_data,
+    users,
+    perms,
+    user_perms,
+    entities,
+    jesrcs,
+    nomaccts,
+    jes,
+    jelines,
+    count           /*!<  Number of tables, not a table  */
+};
+
+/*!
+ * \brief           Database views, in creation order.
+ * \details         Views are created after every table, and a view may
+ * only select from views before it.
+ * \ingroup         sql
+ */
+enum class SchemaView : size_t {
+    current_trial_balance,
+    check_total,
+    all_jes,
+    count           /*!<  Number of views, not a view  */
+};
+
+/*!
+ * \brief           Secondary indexes.
+ * \ingroup         sql
+ */
+enum class SchemaIndex : size_t {
+    jes_entity_period_idx,
+    jelines_je_account_idx,
+    jelines_account_je_idx,
+    count           /*!<  Number of indexes, not an index  */
+};
+
+/*!  Number of tables  */
+constexpr size_t num_schema_tables =
+    static_cast<size_t>(SchemaTable::count);
+
+/*!  Number of views  */
+constexpr size_t num_schema_views = static_cast<size_t>(SchemaView::count);
+
+/*!  Number of indexes  */
+constexpr size_t num_schema_indexes =
+    static_cast<size_t>(SchemaIndex::count);
+
+/*!
+ * \brief           Returns the dependency bit for a table.
+ * \param table     The table.
+ * \returns         The bit.
+ */
+constexpr uint64_t schema_bit(const SchemaTable table) {
+    return uint64_t{1} << static_cast<size_t>(table);
+}
+
+/*!
+ * \brief           Returns the dependency bit for a view.
+ * \param view      The view.
+ * \returns         The bit.
+ */
+constexpr uint64_t schema_bit(const SchemaView view) {
+    return uint64_t{1} << static_cast<size_t>(view);
+}
+
+/*!
+ * \brief           Table definition.
+ * \ingroup         sql
+ */
+struct SchemaTableDef {
+    /*!  The table  */
+    SchemaTable id;
+
+    /*!  The table name  */
+    const char * name;
+
+    /*!  The standard DDL, without a trailing semicolon  */
+    const char * ddl;
+
+    /*!  The DDL for a table partitioned by year, which has the year in
+     *   its primary key and no foreign keys, or \c nullptr if the table
+     *   is never partitioned  */
+    const char * partitioned_ddl;
+
+    /*!  The tables referenced, as \c schema_bit() values  */
+    uint64_t depends;
+};
+
+/*!
+ * \brief           View definition.
+ * \details         Every view has one amount column, whose expression is
+ * formatted by the SQL dialect, so the DDL is split around it.
+ * \ingroup         sql
+ */
+struct SchemaViewDef {
+    /*!  The view  */
+    SchemaView id;
+
+    /*!  The view name  */
+    const char * name;
+
+    /*!  The DDL before the amount column  */
+    const char * ddl_head;
+
+    /*!  The amount column expression  */
+    const char * amount_expr;
+
+    /*!  The DDL after the amount column expression  */
+    const char * ddl_tail;
+
+    /*!  The views selected from, as \c schema_bit() values  */
+    uint64_t depends;
+};
+
+/*!
+ * \brief           Index definition.
+ * \ingroup         sql
+ */
+struct SchemaIndexDef {
+    /*!  The index  */
+    SchemaIndex id;
+
+    /*!  The index name  */
+    const char * name;
+
+    /*!  The indexed table  */
+    SchemaTable table;
+
+    /*!  The DDL  */
+    const char * ddl;
+};
+
+/*!
+ * \brief           Table definitions, in creation order.
+ * \ingroup         sql
+ */
+constexpr SchemaTableDef schema_tables[] = {
+    {SchemaTable::schema_version, "schema_version",
+        "CREATE TABLE schema_version ("
+        "    version        INTEGER         NOT NULL,"
+        "    description    VARCHAR(100)    NOT NULL,"
+        "    step           INTEGER         NOT NULL DEFAULT 0,"
+        "    progress       BIGINT          NOT NULL DEFAULT 0,"
+        "    applied        TIMESTAMP       NULL DEFAULT NULL,"
+        "  CONSTRAINT schema_version_pk"
+        "    PRIMARY KEY (version)"
+        ")",
+        nullptr, 0},
+    {SchemaTable::standing_data, "standing_data",
+        "CREATE TABLE standing_data ("
+        "    organization   VARCHAR(100)    NOT NULL,"
+        "    current_year   INTEGER         NOT NULL,"
+        "    current_period INTEGER         NOT NULL,"
+        "    num_periods    INTEGER         NOT NULL,"
+        "    ledger_version BIGINT          NOT NULL DEFAULT 0,"
+        "  CONSTRAINT standing_data_pk"
+        "    PRIMARY KEY (organization)"
+        ")",
+        nullptr, 0},
+    {SchemaTable::users, "users",
+        "CREATE TABLE users ("
+        "    id         INTEGER     NOT NULL AUTO_INCREMENT,"
+        "    user_name  VARCHAR(30) NOT NULL UNIQUE,"
+        "    first_name VARCHAR(30) NOT NULL,"
+        "    last_name  VARCHAR(30) NOT NULL,"
+        "    pass_hash  VARCHAR(128) NOT NULL DEFAULT 'Not set',"
+        "    pass_salt  VARCHAR(64) NOT NULL DEFAULT 'XX',"
+        "    enabled    BOOLEAN     NOT NULL DEFAULT FALSE,"
+        "    created    TIMESTAMP   NOT NULL DEFAULT CURRENT_TIMESTAMP,"
+        "  CONSTRAINT users_pk"
+        "    PRIMARY KEY (id)"
+        ")",
+        nullptr, 0},
+    {SchemaTable::perms, "perms",
+        "CREATE TABLE perms ("
+        "    id             INTEGER         NOT NULL AUTO_INCREMENT,"
+        "    name           VARCHAR(10)     NOT NULL UNIQUE,"
+        "    description    VARCHAR(100)    NOT NULL,"
+        "  CONSTRAINT perms_pk"
+        "    PRIMARY KEY (id)"
+        ")",
+        nullptr, 0},
+    {SchemaTable::user_perms, "user_perms",
+        "CREATE TABLE user_perms ("
+        "    userid         INTEGER         NOT NULL,"
+        "    permid         INTEGER         NOT NULL,"
+        "    addedby        INTEGER         NOT NULL,"
+        "    created        TIMESTAMP       NOT NULL DEFAULT CURRENT_TIMESTAMP,"
+        "  CONSTRAINT user_perms_pk"
+        "    PRIMARY KEY (userid, permid),"
+        "  CONSTRAINT user_perms_userid_fk"
+        "    FOREIGN KEY (userid)"
+        "    REFERENCES users(id),"
+        "  CONSTRAINT user_perms_permid_fk"
+        "    FOREIGN KEY (permid)"
+        "    REFERENCES perms(id),"
+        "  CONSTRAINT user_perms_addedby_fk"
+        "    FOREIGN KEY (addedby)"
+        "    REFERENCES users(id)"
+        ")",
+        nullptr, schema_bit(SchemaTable::users) |
+                 schema_bit(SchemaTable::perms)},
+    {SchemaTable::entities, "entities",
+        "CREATE TABLE entities ("
+        "    id         INTEGER         NOT NULL AUTO_INCREMENT,"
+        "    name       VARCHAR(100)    NOT NULL,"
+        "    shortname  VARCHAR(10)     NOT NULL,"
+        "    currency   CHAR(30)        NOT NULL DEFAULT 'USD',"
+        "    parent     INT             NOT NULL,"
+        "    aggregate  BOOLEAN         NOT NULL DEFAULT FALSE,"
+        "    enabled    BOOLEAN         NOT NULL DEFAULT TRUE,"
+        "  CONSTRAINT entities_pk"
+        "    PRIMARY KEY (id),"
+        "  CONSTRAINT entities_parent_fk"
+        "    FOREIGN KEY (parent)"
+        "    REFERENCES entities(id)"
+        ")",
+        nullptr, schema_bit(SchemaTable::entities)},
+    {SchemaTable::jesrcs, "jesrcs",
+        "CREATE TABLE jesrcs ("
+        "    name           VARCHAR(10)     NOT NULL,"
+        "    description    VARCHAR(100)    NOT NULL,"
+        "  CONSTRAINT jesrcs_pk"
+        "    PRIMARY KEY (name)"
+        ")",
+        nullptr, 0},
+    {SchemaTable::nomaccts, "nomaccts",
+        "CREATE TABLE nomaccts ("
+        "    num            VARCHAR(20)     NOT NULL,"
+        "    description    VARCHAR(100)    NOT NULL,"
+        "    enabled        BOOLEAN         NOT NULL DEFAULT TRUE,"
+        "  CONSTRAINT nomaccts"
+        "    PRIMARY KEY (num)"
+        ")",
+        nullptr, 0},
+    {SchemaTable::jes, "jes",
+        "CREATE TABLE jes ("
+        "    id         INTEGER         NOT NULL AUTO_INCREMENT,"
+        "    user       INTEGER         NOT NULL,"
+        "    period     INTEGER         NOT NULL,"
+        "    year       INTEGER         NOT NULL,"
+        "    source     VARCHAR(10)     NOT NULL,"
+        "    entity     INTEGER         NOT NULL,"
+        "    memo       VARCHAR(100)    NOT NULL,"
+        "    posted     TIMESTAMP       NOT NULL DEFAULT CURRENT_TIMESTAMP,"
+        "  CONSTRAINT jes_pk"
+        "    PRIMARY KEY (id),"
+        "  CONSTRAINT jes_user_fk"
+        "    FOREIGN KEY (user)"
+        "    REFERENCES users(id),"
+        "  CONSTRAINT jes_entity_fk"
+        "    FOREIGN KEY (entity)"
+        "    REFERENCES entities(id),"
+        "  CONSTRAINT jes_source_fk"
+        "    FOREIGN KEY (source)"
+        "    REFERENCES jesrcs(name)"
+        ")",
+        "CREATE TABLE jes ("
+        "    id         INTEGER         NOT NULL AUTO_INCREMENT,"
+        "    user       INTEGER         NOT NULL,"
+        "    period     INTEGER         NOT NULL,"
+        "    year       INTEGER         NOT NULL,"
+        "    source     VARCHAR(10)     NOT NULL,"
+        "    entity     INTEGER         NOT NULL,"
+        "    memo       VARCHAR(100)    NOT NULL,"
+        "    posted     TIMESTAMP       NOT NULL DEFAULT CURRENT_TIMESTAMP,"
+        "  CONSTRAINT jes_pk"
+        "    PRIMARY KEY (id, year)"
+        ")",
+        schema_bit(SchemaTable::users) | schema_bit(SchemaTable::entities) |
+        schema_bit(SchemaTable::jesrcs)},
+    {SchemaTable::jelines, "jelines",
+        "CREATE TABLE jelines ("
+        "    id         INTEGER         NOT NULL AUTO_INCREMENT,"
+        "    je         INTEGER         NOT NULL,"
+        "    year       INTEGER         NOT NULL,"
+        "    account    VARCHAR(20)     NOT NULL,"
+        "    amount     DECIMAL(20,2)   NOT NULL,"
+        "  CONSTRAINT jelines_pk"
+        "    PRIMARY KEY (id),"
+        "  CONSTRAINT jes_je_fk"
+        "    FOREIGN KEY (je)"
+        "    REFERENCES jes(id),"
+        "  CONSTRAINT jes_account_fk"
+        "    FOREIGN KEY (account)"
+        "    REFERENCES nomaccts(num)"
+        ")",
+        "CREATE TABLE jelines ("
+        "    id         INTEGER         NOT NULL AUTO_INCREMENT,"
+        "    je         INTEGER         NOT NULL,"
+        "    year       INTEGER         NOT NULL,"
+        "    account    VARCHAR(20)     NOT NULL,"
+        "    amount     DECIMAL(20,2)   NOT NULL,"
+        "  CONSTRAINT jelines_pk"
+        "    PRIMARY KEY (id, year)"
+        ")",
+        schema_bit(SchemaTable::jes) | schema_bit(SchemaTable::nomaccts)}
+};
+
+/*!
+ * \brief           View definitions, in creation order.
+ * \ingroup         sql
+ */
+constexpr SchemaViewDef schema_views[] = {
+    {SchemaView::current_trial_balance, "current_trial_balance",
+        "CREATE VIEW current_trial_balance AS"
+        "  SELECT"
+        "    j.entity AS 'Entity',"
+        "    a.num AS 'A/C No.',"
+        "    a.description AS 'Description',"
+        "    ",
+        "sum(l.amount)",
+        " AS 'Balance'"
+        "    FROM nomaccts AS a"
+        "    LEFT OUTER JOIN jelines AS l"
+        "      ON a.num = l.account"
+        "    INNER JOIN jes AS j"
+        "      ON l.je = j.id AND l.year = j.year"
+        "    GROUP BY j.entity, a.num"
+        "    ORDER BY j.entity ASC, l.account ASC",
+        0},
+    {SchemaView::check_total, "check_total",
+        "CREATE VIEW check_total AS"
+        "  SELECT"
+        "    Entity,"
+        "    ",
+        "sum(Balance)",
+        " AS 'Check Total'"
+        "    FROM current_trial_balance"
+        "    GROUP BY Entity"
+        "    ORDER BY Entity ASC",
+        schema_bit(SchemaView::current_trial_balance)},
+    {SchemaView::all_jes, "all_jes",
+        "CREATE VIEW all_jes AS"
+        "  SELECT"
+        "    l.je AS 'JE',"
+        "    j.entity AS 'En',"
+        "    l.account AS 'A/C No.',"
+        "    a.description AS 'Description',"
+        "    ",
+        "l.amount",
+        " AS 'Amount'"
+        "    FROM jelines AS l"
+        "    INNER JOIN jes AS j"
+        "      ON j.id = l.je AND j.year = l.year"
+        "    INNER JOIN nomaccts AS a"
+        "      ON a.num = l.account"
+        "    ORDER BY j.id ASC, l.account ASC",
+        0}
+};
+
+/*!
+ * \brief           Index definitions.
+ * \ingroup         sql
+ */
+constexpr SchemaIndexDef schema_indexes[] = {
+
+    /*  Period and entity filters on journal entries  */
+
+    {SchemaIndex::jes_entity_period_idx, "jes_entity_period_idx",
+        SchemaTable::jes,
+        "CREATE INDEX jes_entity_period_idx"
+        "  ON jes (entity, year, period)"},
+
+    /*  Covers journal entry line lookups and the all_jes view  */
+
+    {SchemaIndex::jelines_je_account_idx, "jelines_je_account_idx",
+        SchemaTable::jelines,
+        "CREATE INDEX jelines_je_account_idx"
+        "  ON jelines (je, account, amount)"},
+
+    /*  Covers the account aggregation in current_trial_balance  */
+
+    {SchemaIndex::jelines_account_je_idx, "jelines_account_je_idx",
+        SchemaTable::jelines,
+        "CREATE INDEX jelines_account_je_idx"
+        "  ON jelines (account, je, amount)"}
+};
+
+/*!
+ * \brief           Returns a table definition.
+ * \param table     The table.
+ * \returns         The definition.
+ */
+constexpr const SchemaTableDef& schema_def(const SchemaTable table) {
+    return schema_tables[static_cast<size_t>(table)];
+}
+
+/*!
+ * \brief           Returns a view definition.
+ * \param view      The view.
+ * \returns         The definition.
+ */
+constexpr const SchemaViewDef& schema_def(const SchemaView view) {
+    return schema_views[static_cast<size_t>(view)];
+}
+
+/*!
+ * \brief           Returns an index definition.
+ * \param index     The index.
+ * \returns         The definition.
+ */
+constexpr const SchemaIndexDef& schema_def(const SchemaIndex index) {
+    return schema_indexes[static_cast<size_t>(index)];
+}
+
+/*!
+ * \brief           Checks that definitions follow their enumeration and
+ * depend only on themselves and earlier definitions.
+ * \param defs      The definitions.
+ * \param count     The number of definitions.
+ * \param idx       The first definition to check.
+ * \returns         \c true if the definitions are in order.
+ */
+template <class Def>
+constexpr bool schema_in_order(const Def * defs, const size_t count,
+                               const size_t idx = 0) {
+    return idx == count ||
+           (static_cast<size_t>(defs[idx].id) == idx &&
+            (defs[idx].depends >> idx >> 1) == 0 &&
+            schema_in_order(defs, count, idx + 1));
+}
+
+/*!
+ * \brief           Checks that index definitions follow their enumeration.
+ * \param idx       The first definition to check.
+ * \returns         \c true if the definitions are in order.
+ */
+constexpr bool schema_indexes_in_order(const size_t idx = 0) {
+    return idx == num_schema_indexes ||
+           (static_cast<size_t>(schema_indexes[idx].id) == idx &&
+            schema_indexes_in_order(idx + 1));
+}
+
+static_assert(sizeof(schema_tables) / sizeof(schema_tables[0]) ==
+              num_schema_tables, "Every table needs a definition");
+static_assert(sizeof(schema_views) / sizeof(schema_views[0]) ==
+              num_schema_views, "Every view needs a definition");
+static_assert(sizeof(schema_indexes) / sizeof(schema_indexes[0]) ==
+              num_schema_indexes, "Every index needs a definition");
+static_assert(num_schema_tables <= 64 && num_schema_views <= 64,
+              "Dependencies are held in 64 bits");
+static_assert(schema_in_order(schema_tables, num_schema_tables),
+              "Tables must be defined in order, after the tables they "
+              "reference");
+static_assert(schema_in_order(schema_views, num_schema_views),
+              "Views must be defined in order, after the views they "
+              "select from");
+static_assert(schema_indexes_in_order(),
+              "Indexes must be defined in order");
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_DATABASE_DBSCHEMA_H
@@ -0,0 +1,27 @@
+/*!
+ * \file            dbsql_dialects.cpp
+ * \brief           Implementation of the compiled-in SQL dialects factory.
+ * \details         Kept apart from the dialect registry, which depends on
+ * the selected backend, so that backend plugins may be built with it.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include "dbsql_functions.h"
+#include "dbsql_implementations.h"
+
+using namespace genleg;
+
+DBSQLStatements * genleg::new_sql_dialect(const std::string& type) {
+    if ( type == "MySQL" ) {
+        return new DBSQLMySQL();
+    }
+    else if ( type == "SQLite" ) {
+        return new DBSQLSQLite();
+    }
+    else if ( type == "DUMMY" ) {
+        return new DBSQLDummy();
+    }
+    return nullptr;
+}
@@ -6,25 +6,72 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <map>
+#include <mutex>
 #include <stdexcept>
 
 #include "dbsql_functions.h"
 #include "dbsql_implementations.h"
-#include "database_imp/database_imp.h"
+#include "database_imp/backends.h"
 
 using namespace genleg;
 
+/*!
+ * \brief           Returns a DBSQL object of a given class.
+ * \returns         The DBSQL object.
+ */
+template <class Dialect>
+static std::shared_ptr<const DBSQLStatements> make_dialect()
+{
+    return std::shared_ptr<const DBSQLStatements>(new const Dialect());
+}
+
+/*!  Protects the dialect registry  */
+static std::mutex dialect_mutex;
+
+/*!  SQL dialects, by database type  */
+static std::map<std::string, SQLDialectFactory> dialects{
+    {"MySQL", make_dialect<DBSQLMySQL>},
+    {"SQLite", make_dialect<DBSQLSQLite>},
+    {"DUMMY", make_dialect<DBSQLDummy>}
+};
+
 std::shared_ptr<const DBSQLStatements>
 genleg::get_sql_object() {
-    const std::string type = gldb::get_database_type();
-    if ( type == "MySQL" ) {
-        return std::shared_ptr<const DBSQLStatements>(new const DBSQLMySQL());
+    DBSQLStatements * const plugin_dialect = gldb::backend_sql_object();
+    if ( plugin_dialect ) {
+        return std::shared_ptr<const DBSQLStatements>(plugin_dialect);
     }
-    else if ( type == "DUMMY" ) {
-        return std::shared_ptr<const DBSQLStatements>(new const DBSQLDummy());
+
+    const std::string type = gldb::backend_database_type();
+
+    SQLDialectFactory factory = nullptr;
+    {
+        std::lock_guard<std::mutex> lock{dialect_mutex};
+        const auto found = dialects.find(type);
+        if ( found != dialects.end() ) {
+            factory = found->second;
+        }
     }
-    else {
+
+    if ( !factory ) {
         throw std::runtime_error("Unrecognized database implementation type");
     }
+    return factory();
 }
 
+SQLDialectFactory
+genleg::register_sql_dialect(const std::string& type,
+                             const SQLDialectFactory factory) {
+    std::lock_guard<std::mutex> lock{dialect_mutex};
+    const auto found = dialects.find(type);
+    const SQLDialectFactory replaced = found != dialects.end() ?
+                                       found->second : nullptr;
+    if ( factory ) {
+        dialects[type] = factory;
+    }
+    else if ( found != dialects.end() ) {
+        dialects.erase(found);
+    }
+    return replaced;
+}
@@ -10,18 +10,51 @@
 #define PG_GENERAL_LEDGER_DATABASE_DBSQL_FUNCTIONS_H
 
 #include <memory>
+#include <string>
 
 #include "dbsqlstatements.h"
 
 namespace genleg {
 
+/*!
+ * \brief           Factory function type for DBSQL objects
+ */
+using SQLDialectFactory = std::shared_ptr<const DBSQLStatements> (*)();
+
 /*!
  * \brief           Factory function for DBSQL objects
- * \returns         The DBSQLStatements corresponding to the compiled-in
+ * \details         A backend plugin provides the dialect for its own
+ * database type. Otherwise the dialect registered for the type is used.
+ * \returns         The DBSQLStatements for the dialect of the selected
  * database backend.
+ * \throws          std::runtime_error if no dialect is registered for the
+ * backend's database type.
  */
 std::shared_ptr<const DBSQLStatements> get_sql_object();
 
+/*!
+ * \brief           Creates a DBSQL object for a compiled-in dialect.
+ * \details         Backend plugins use this to provide their dialect.
+ * \param type      The database type.
+ * \returns         A new DBSQL object owned by the caller, or \c nullptr
+ * if no dialect for the type is compiled in.
+ */
+DBSQLStatements * new_sql_dialect(const std::string& type);
+
+/*!
+ * \brief           Registers an SQL dialect.
+ * \details         The MySQL, SQLite and dummy dialects are registered
+ * already. A dialect registered here is used only for a backend which
+ * does not provide its own, such as the compiled-in backend.
+ * \param type      The database type, as returned by the backend.
+ * \param factory   The factory function for the dialect, or \c nullptr
+ * to remove the dialect.
+ * \returns         The factory function replaced, or \c nullptr if there
+ * was none, which may be registered again to restore it.
+ */
+SQLDialectFactory register_sql_dialect(const std::string& type,
+                                       const SQLDialectFactory factory);
+
 }           //  namespace genleg
 
 #endif      //  PG_GENERAL_LEDGER_DATABASE_DBSQL_FUNCTIONS_H
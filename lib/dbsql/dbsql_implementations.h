@@ -12,6 +12,7 @@
 #include "dbsqlstatements.h"
 #include "dbsql_mysql.h"
 #include "dbsql_dummy.h"
+#include "dbsql_sqlite.h"
 
 #endif      //  PG_GENERAL_LEDGER_DATABASE_DBSQL_IMPLEMENTATIONS_H
 
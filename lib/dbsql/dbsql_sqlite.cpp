@@ -0,0 +1,115 @@
+/*!
+ * \file            dbsql_sqlite.cpp
+ * \brief           Implementation of SQLite SQL statement class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <sstream>
+#include <stdexcept>
+#include "dbsql_sqlite.h"
+
+using namespace genleg;
+
+std::string DBSQLSQLite::create_table(const SchemaTable table) const {
+    static const std::string auto_increment{" AUTO_INCREMENT"};
+
+    std::string query = DBSQLStatements::create_table(table);
+    for ( size_t pos = query.find(auto_increment);
+          pos != std::string::npos;
+          pos = query.find(auto_increment, pos) ) {
+        query.erase(pos, auto_increment.size());
+    }
+    return query;
+}
+
+std::string
+DBSQLSQLite::create_partitioned_table(const SchemaTable table,
+                                      const int, const int) const
+{
+    return create_table(table);
+}
+
+std::string DBSQLSQLite::add_year_partition(const SchemaTable,
+                                            const int) const
+{
+    return "";
+}
+
+std::vector<std::string>
+DBSQLSQLite::archive_year_partition(const SchemaTable table,
+                                    const int year) const
+{
+    std::vector<std::string> queries;
+    if ( table != SchemaTable::jes ) {
+        return queries;
+    }
+
+    for ( const std::string name : {"jes", "jelines"} ) {
+        std::ostringstream ss;
+        ss << "CREATE TABLE " << name << "_" << year
+           << " AS SELECT * FROM " << name << " WHERE year = " << year;
+        queries.push_back(ss.str());
+    }
+    for ( const std::string name : {"jelines", "jes"} ) {
+        std::ostringstream ss;
+        ss << "DELETE FROM " << name << " WHERE year = " << year;
+        queries.push_back(ss.str());
+    }
+    return queries;
+}
+
+std::string DBSQLSQLite::drop_index(const SchemaIndex index) const {
+    return std::string{"DROP INDEX "} + schema_def(index).name;
+}
+
+std::string DBSQLSQLite::add_column(const SchemaTable table,
+                                    const std::string& column,
+                                    const std::string& definition) const
+{
+    std::ostringstream ss;
+    ss << "ALTER TABLE " << schema_def(table).name << " ADD COLUMN "
+       << column << " " << definition;
+    return ss.str();
+}
+
+std::string DBSQLSQLite::modify_column(const SchemaTable table,
+                                       const std::string& column,
+                                       const std::string& definition) const
+{
+    (void) definition;
+    throw std::runtime_error(std::string{"SQLite cannot change the type of "}
+                             + schema_def(table).name + "." + column);
+}
+
+bool DBSQLSQLite::enforces_column_types() const {
+    return false;
+}
+
+std::string DBSQLSQLite::create_index_online(const SchemaIndex index) const {
+    return create_index(index);
+}
+
+std::string DBSQLSQLite::index_exists(const SchemaIndex index) const {
+    std::ostringstream ss;
+    ss << "SELECT COUNT(*) AS count FROM sqlite_master"
+       << " WHERE type = 'index' AND name = '" << schema_def(index).name
+       << "'";
+    return ss.str();
+}
+
+std::string DBSQLSQLite::explain(const std::string& statement) const {
+    return "EXPLAIN QUERY PLAN " + statement;
+}
+
+std::string DBSQLSQLite::amount_column(const std::string& expr) const {
+    /*  Dividing whole cents by 100 is never far enough out for the two
+     *  decimal places to round the wrong way                            */
+
+    return "printf('%.2f', (" + expr + ") / 100.0)";
+}
+
+std::string DBSQLSQLite::amount_value(const std::string& expr) const {
+    return "CAST(round((" + expr + ") * 100) AS INTEGER)";
+}
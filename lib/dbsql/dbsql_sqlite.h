@@ -0,0 +1,163 @@
+/*!
+ * \file            dbsql_sqlite.h
+ * \brief           Interface to SQLite SQL statement class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DBSQL_SQLITE_H
+#define PG_GENERAL_LEDGER_DATABASE_DBSQL_SQLITE_H
+
+#include "dbsqlstatements.h"
+
+namespace genleg {
+
+/*!
+ * \brief           SQLite SQL statements class.
+ * \details         SQLite assigns an \c INTEGER primary key automatically,
+ * has no table partitioning, and would store \c DECIMAL values as
+ * floating point, so those statements are adapted here. Amounts are stored
+ * as integer cents, which sum exactly.
+ * \ingroup         sql
+ */
+class DBSQLSQLite : public DBSQLStatements {
+    public:
+
+        /*!
+         * \brief               Returns a SQL statement to create a table.
+         * \details             The MySQL \c AUTO_INCREMENT attribute is
+         * removed, since an \c INTEGER primary key is an alias for the
+         * SQLite row ID.
+         * \param table         The table to create.
+         * \returns             The SQL statement.
+         */
+        virtual std::string create_table(const SchemaTable table) const;
+
+        /*!
+         * \brief               Returns a SQL statement to create a table.
+         * \details             SQLite does not support partitioning, so
+         * the table is created without partitions.
+         * \param table         The table to create.
+         * \param first_year    Ignored.
+         * \param last_year     Ignored.
+         * \returns             The SQL statement.
+         */
+        virtual std::string
+        create_partitioned_table(const SchemaTable table,
+                                 const int first_year,
+                                 const int last_year) const;
+
+        /*!
+         * \brief               Returns an empty statement, since SQLite
+         * tables are not partitioned.
+         * \param table         Ignored.
+         * \param year          Ignored.
+         * \returns             An empty string.
+         */
+        virtual std::string add_year_partition(const SchemaTable table,
+                                               const int year) const;
+
+        /*!
+         * \brief               Returns SQL statements to archive a year.
+         * \details             The rows for the year are copied to
+         * archive tables and deleted. Journal entry lines are archived
+         * along with the journal entries for \c jes, so that foreign keys
+         * are never violated, and nothing is done for \c jelines.
+         * \param table         The table.
+         * \param year          The year to archive.
+         * \returns             The SQL statements, in order.
+         */
+        virtual std::vector<std::string>
+        archive_year_partition(const SchemaTable table,
+                               const int year) const;
+
+        /*!
+         * \brief               Returns a SQL statement to drop an index.
+         * \param index         The index to drop.
+         * \returns             The SQL statement.
+         */
+        virtual std::string drop_index(const SchemaIndex index) const;
+
+        /*!
+         * \brief               Returns a SQL statement for adding a column.
+         * \details             SQLite adds a column without rewriting the
+         * table, so no online options are needed.
+         * \param table         The table.
+         * \param column        The column name.
+         * \param definition    The column type and constraints.
+         * \returns             The SQL statement.
+         */
+        virtual std::string add_column(const SchemaTable table,
+                                       const std::string& column,
+                                       const std::string& definition) const;
+
+        /*!
+         * \brief               Does not return a SQL statement for
+         * changing the type of a column, which SQLite cannot do in place.
+         * \param table         The table.
+         * \param column        The column name.
+         * \param definition    The new column type and constraints.
+         * \throws              std::runtime_error always.
+         */
+        virtual std::string
+            modify_column(const SchemaTable table,
+                          const std::string& column,
+                          const std::string& definition) const;
+
+        /*!
+         * \brief               Returns whether the backend enforces the
+         * declared type of a column.
+         * \details             SQLite does not enforce column types or
+         * sizes, so a column never needs widening.
+         * \returns             \c false.
+         */
+        virtual bool enforces_column_types() const;
+
+        /*!
+         * \brief               Returns a SQL statement for creating an
+         * index, which in SQLite is never online.
+         * \param index         The index to create.
+         * \returns             The SQL statement.
+         */
+        virtual std::string create_index_online(const SchemaIndex index) const;
+
+        /*!
+         * \brief               Returns a SQL query for whether an index
+         * exists.
+         * \param index         The index.
+         * \returns             The SQL query.
+         */
+        virtual std::string index_exists(const SchemaIndex index) const;
+
+        /*!
+         * \brief               Returns a SQL statement to show the query
+         * plan for a statement.
+         * \param statement     The statement to explain.
+         * \returns             The SQL statement.
+         */
+        virtual std::string explain(const std::string& statement) const;
+
+        /*!
+         * \brief               Returns an expression for an amount in a
+         * query result.
+         * \details             The amount in cents is formatted with two
+         * decimal places.
+         * \param expr          The amount expression, in cents.
+         * \returns             The output expression.
+         */
+        virtual std::string amount_column(const std::string& expr) const;
+
+        /*!
+         * \brief               Returns an expression for an amount as it
+         * is stored.
+         * \param expr          The decimal amount expression.
+         * \returns             The amount in cents, as an integer.
+         */
+        virtual std::string amount_value(const std::string& expr) const;
+
+};              //  class DBSQLSQLite
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_DATABASE_DBSQL_SQLITE_H
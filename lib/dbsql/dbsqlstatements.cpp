@@ -6,6 +6,7 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
 #include <sstream>
 #include "dbsqlstatements.h"
 
@@ -17,211 +18,261 @@ DBSQLStatements::DBSQLStatements() {
 DBSQLStatements::~DBSQLStatements() {
 }
 
-std::string DBSQLStatements::create_table(const std::string& table_name) const {
-    std::string query;
+std::string DBSQLStatements::create_table(const SchemaTable table) const {
+    return schema_def(table).ddl;
+}
 
-    if ( table_name == "standing_data" ) {
-        query = "CREATE TABLE standing_data ("
-        "    organization   VARCHAR(100)    NOT NULL,"
-        "    current_year   INTEGER         NOT NULL,"
-        "    current_period INTEGER         NOT NULL,"
-        "    num_periods    INTEGER         NOT NULL,"
-        "  CONSTRAINT standing_data_pk"
-        "    PRIMARY KEY (organization)"
-        ");";
-    }
-    else if ( table_name == "users" ) {
-        query = "CREATE TABLE users ("
-        "    id         INTEGER     NOT NULL AUTO_INCREMENT,"
-        "    user_name  VARCHAR(30) NOT NULL UNIQUE,"
-        "    first_name VARCHAR(30) NOT NULL,"
-        "    last_name  VARCHAR(30) NOT NULL,"
-        "    pass_hash  VARCHAR(30) NOT NULL DEFAULT 'Not set',"
-        "    pass_salt  VARCHAR(30) NOT NULL DEFAULT 'XX',"
-        "    enabled    BOOLEAN     NOT NULL DEFAULT FALSE,"
-        "    created    TIMESTAMP   NOT NULL DEFAULT CURRENT_TIMESTAMP,"
-        "  CONSTRAINT users_pk"
-        "    PRIMARY KEY (id)"
-        ");";
-    }
-    else if ( table_name == "perms" ) {
-        query = "CREATE TABLE perms ("
-        "    id             INTEGER         NOT NULL AUTO_INCREMENT,"
-        "    name           VARCHAR(10)     NOT NULL UNIQUE,"
-        "    description    VARCHAR(100)    NOT NULL,"
-        "  CONSTRAINT perms_pk"
-        "    PRIMARY KEY (id)"
-        ");";
-    }
-    else if ( table_name == "user_perms" ) {
-        query = "CREATE TABLE user_perms ("
-        "    userid         INTEGER         NOT NULL,"
-        "    permid         INTEGER         NOT NULL,"
-        "    addedby        INTEGER         NOT NULL,"
-        "    created        TIMESTAMP       NOT NULL DEFAULT CURRENT_TIMESTAMP,"
-        "  CONSTRAINT user_perms_pk"
-        "    PRIMARY KEY (userid, permid),"
-        "  CONSTRAINT user_perms_userid_fk"
-        "    FOREIGN KEY (userid)"
-        "    REFERENCES users(id),"
-        "  CONSTRAINT user_perms_permid_fk"
-        "    FOREIGN KEY (permid)"
-        "    REFERENCES perms(id),"
-        "  CONSTRAINT user_perms_addedby_fk"
-        "    FOREIGN KEY (addedby)"
-        "    REFERENCES users(id)"
-        ");";
-    }
-    else if ( table_name == "entities" ) {
-        query = "CREATE TABLE entities ("
-        "    id         INTEGER         NOT NULL AUTO_INCREMENT,"
-        "    name       VARCHAR(100)    NOT NULL,"
-        "    shortname  VARCHAR(10)     NOT NULL,"
-        "    currency   CHAR(30)        NOT NULL DEFAULT 'USD',"
-        "    parent     INT             NOT NULL,"
-        "    aggregate  BOOLEAN         NOT NULL DEFAULT FALSE,"
-        "    enabled    BOOLEAN         NOT NULL DEFAULT TRUE,"
-        "  CONSTRAINT entities_pk"
-        "    PRIMARY KEY (id),"
-        "  CONSTRAINT entities_parent_fk"
-        "    FOREIGN KEY (parent)"
-        "    REFERENCES entities(id)"
-        ");";
-    }
-    else if ( table_name == "jesrcs" ) {
-        query = "CREATE TABLE jesrcs ("
-        "    name           VARCHAR(10)     NOT NULL,"
-        "    description    VARCHAR(100)    NOT NULL,"
-        "  CONSTRAINT jesrcs_pk"
-        "    PRIMARY KEY (name)"
-        ");";
-    }
-    else if ( table_name == "nomaccts" ) {
-        query = "CREATE TABLE nomaccts ("
-        "    num            VARCHAR(20)     NOT NULL,"
-        "    description    VARCHAR(100)    NOT NULL,"
-        "    enabled        BOOLEAN         NOT NULL DEFAULT TRUE,"
-        "  CONSTRAINT nomaccts"
-        "    PRIMARY KEY (num)"
-        ");";
-    }
-    else if ( table_name == "jes" ) {
-        query = "CREATE TABLE jes ("
-        "    id         INTEGER         NOT NULL AUTO_INCREMENT,"
-        "    user       INTEGER         NOT NULL,"
-        "    period     INTEGER         NOT NULL,"
-        "    year       INTEGER         NOT NULL,"
-        "    source     VARCHAR(10)     NOT NULL,"
-        "    entity     INTEGER         NOT NULL,"
-        "    memo       VARCHAR(100)    NOT NULL,"
-        "    posted     TIMESTAMP       NOT NULL DEFAULT CURRENT_TIMESTAMP,"
-        "  CONSTRAINT jes_pk"
-        "    PRIMARY KEY (id),"
-        "  CONSTRAINT jes_user_fk"
-        "    FOREIGN KEY (user)"
-        "    REFERENCES users(id),"
-        "  CONSTRAINT jes_entity_fk"
-        "    FOREIGN KEY (entity)"
-        "    REFERENCES entities(id),"
-        "  CONSTRAINT jes_source_fk"
-        "    FOREIGN KEY (source)"
-        "    REFERENCES jesrcs(name)"
-        ");";
-    }
-    else if ( table_name == "jelines" ) {
-        query = "CREATE TABLE jelines ("
-        "    id         INTEGER         NOT NULL AUTO_INCREMENT,"
-        "    je         INTEGER         NOT NULL,"
-        "    account    VARCHAR(20)     NOT NULL,"
-        "    amount     DECIMAL(20,2)   NOT NULL,"
-        "  CONSTRAINT jelines_pk"
-        "    PRIMARY KEY (id),"
-        "  CONSTRAINT jes_je_fk"
-        "    FOREIGN KEY (je)"
-        "    REFERENCES jes(id),"
-        "  CONSTRAINT jes_account_fk"
-        "    FOREIGN KEY (account)"
-        "    REFERENCES nomaccts(num)"
-        ");";
+std::string DBSQLStatements::create_partitioned_table(
+        const SchemaTable table,
+        const int first_year,
+        const int last_year) const
+{
+
+    /*  MySQL requires the partitioning column in every unique key,
+     *  and does not support foreign keys on partitioned tables.     */
+
+    const SchemaTableDef& def = schema_def(table);
+    if ( !def.partitioned_ddl ) {
+        return create_table(table);
     }
-    else {
-        throw "Unrecognized table.";
+
+    std::ostringstream ss;
+    ss << def.partitioned_ddl << " PARTITION BY RANGE (year) (";
+    for ( int year = first_year; year <= last_year; ++year ) {
+        ss << "PARTITION p" << year
+           << " VALUES LESS THAN (" << year + 1 << "), ";
     }
+    ss << "PARTITION pmax VALUES LESS THAN MAXVALUE)";
+    return ss.str();
+}
+
+std::string DBSQLStatements::add_year_partition(const SchemaTable table,
+                                                const int year) const
+{
+    std::ostringstream ss;
+    ss << "ALTER TABLE " << schema_def(table).name
+       << " REORGANIZE PARTITION pmax INTO ("
+       << "PARTITION p" << year << " VALUES LESS THAN (" << year + 1 << "), "
+       << "PARTITION pmax VALUES LESS THAN MAXVALUE)";
+    return ss.str();
+}
 
-    return query;
+std::vector<std::string>
+DBSQLStatements::archive_year_partition(const SchemaTable table,
+                                        const int year) const
+{
+    const std::string table_name{schema_def(table).name};
+    std::ostringstream archive;
+    archive << table_name << "_" << year;
+    const std::string archive_name = archive.str();
+
+    std::vector<std::string> queries;
+    queries.push_back("CREATE TABLE " + archive_name + " LIKE " + table_name);
+    queries.push_back("ALTER TABLE " + archive_name + " REMOVE PARTITIONING");
+
+    std::ostringstream exchange;
+    exchange << "ALTER TABLE " << table_name
+             << " EXCHANGE PARTITION p" << year
+             << " WITH TABLE " << archive_name;
+    queries.push_back(exchange.str());
+
+    std::ostringstream drop;
+    drop << "ALTER TABLE " << table_name << " DROP PARTITION p" << year;
+    queries.push_back(drop.str());
+
+    return queries;
+}
+
+std::string DBSQLStatements::drop_table(const SchemaTable table) const {
+    return std::string{"DROP TABLE "} + schema_def(table).name;
+}
+
+std::string DBSQLStatements::create_view(const SchemaView view) const {
+    const SchemaViewDef& def = schema_def(view);
+    return def.ddl_head + amount_column(def.amount_expr) + def.ddl_tail;
+}
+
+std::string DBSQLStatements::drop_view(const SchemaView view) const {
+    return std::string{"DROP VIEW "} + schema_def(view).name;
 }
 
-std::string DBSQLStatements::drop_table(const std::string& table_name) const {
+std::string DBSQLStatements::create_index(const SchemaIndex index) const {
+    return schema_def(index).ddl;
+}
+
+std::string DBSQLStatements::drop_index(const SchemaIndex index) const {
+    const SchemaIndexDef& def = schema_def(index);
     std::ostringstream ss;
-    ss << "DROP TABLE " << table_name;
+    ss << "DROP INDEX " << def.name << " ON " << schema_def(def.table).name;
     return ss.str();
 }
 
-std::string DBSQLStatements::create_view(const std::string& view_name) const {
-    std::string query;
+std::string DBSQLStatements::add_column(const SchemaTable table,
+                                        const std::string& column,
+                                        const std::string& definition) const
+{
+    std::ostringstream ss;
+    ss << "ALTER TABLE " << schema_def(table).name << " ADD COLUMN "
+       << column << " " << definition << ", ALGORITHM=INPLACE, LOCK=NONE";
+    return ss.str();
+}
 
-    if ( view_name == "current_trial_balance" ) {
-        query = "CREATE VIEW current_trial_balance AS"
-        "  SELECT"
-        "    j.entity AS 'Entity',"
-        "    a.num AS 'A/C No.',"
-        "    a.description AS 'Description',"
-        "    sum(l.amount) AS 'Balance'"
-        "    FROM nomaccts AS a"
-        "    LEFT OUTER JOIN jelines AS l"
-        "      ON a.num = l.account"
-        "    INNER JOIN jes AS j"
-        "      ON l.je = j.id"
-        "    GROUP BY j.entity, a.num"
-        "    ORDER BY j.entity ASC, l.account ASC";
-    }
-    else if ( view_name == "check_total" ) {
-        query = "CREATE VIEW check_total AS"
-        "  SELECT"
-        "    Entity,"
-        "    sum(Balance) AS 'Check Total'"
-        "    FROM current_trial_balance"
-        "    GROUP BY Entity"
-        "    ORDER BY Entity ASC";
-    }
-    else if ( view_name == "all_jes" ) {
-        query = "CREATE VIEW all_jes AS"
-        "  SELECT"
-        "    l.je AS 'JE',"
-        "    j.entity AS 'En',"
-        "    l.account AS 'A/C No.',"
-        "    a.description AS 'Description',"
-        "    l.amount AS 'Amount'"
-        "    FROM jelines AS l"
-        "    INNER JOIN jes AS j"
-        "      ON j.id = l.je"
-        "    INNER JOIN nomaccts AS a"
-        "      ON a.num = l.account"
-        "    ORDER BY j.id ASC, l.account ASC";
-    }
+std::string DBSQLStatements::modify_column(const SchemaTable table,
+                                           const std::string& column,
+                                           const std::string& definition)
+const
+{
+    std::ostringstream ss;
+    ss << "ALTER TABLE " << schema_def(table).name << " MODIFY COLUMN "
+       << column << " " << definition;
+    return ss.str();
+}
+
+bool DBSQLStatements::enforces_column_types() const {
+    return true;
+}
+
+std::string DBSQLStatements::column_probe(const SchemaTable table,
+                                          const std::string& column) const
+{
+    std::ostringstream ss;
+    ss << "SELECT " << column << " FROM " << schema_def(table).name
+       << " LIMIT 1";
+    return ss.str();
+}
+
+std::string
+DBSQLStatements::create_index_online(const SchemaIndex index) const {
+    return create_index(index) + " ALGORITHM=INPLACE LOCK=NONE";
+}
 
-    return query;
+std::string DBSQLStatements::index_exists(const SchemaIndex index) const {
+    std::ostringstream ss;
+    ss << "SELECT COUNT(*) AS count FROM information_schema.statistics"
+       << " WHERE table_schema = DATABASE() AND index_name = '"
+       << schema_def(index).name << "'";
+    return ss.str();
 }
 
-std::string DBSQLStatements::drop_view(const std::string& view_name) const {
+std::string DBSQLStatements::key_range(const SchemaTable table,
+                                       const std::string& key) const
+{
     std::ostringstream ss;
-    ss << "DROP VIEW " << view_name;
+    ss << "SELECT MIN(" << key << ") AS first, MAX(" << key << ") AS last"
+       << " FROM " << schema_def(table).name;
     return ss.str();
 }
 
+std::string DBSQLStatements::backfill(const SchemaTable table,
+                                      const std::string& assignment,
+                                      const std::string& key,
+                                      const unsigned long long after,
+                                      const unsigned long long last) const
+{
+    std::ostringstream ss;
+    ss << "UPDATE " << schema_def(table).name << " SET " << assignment
+       << " WHERE " << key << " > " << after
+       << " AND " << key << " <= " << last;
+    return ss.str();
+}
+
+std::string DBSQLStatements::schema_versions() const {
+    return "SELECT version, description, step, progress, applied,"
+           " CASE WHEN applied IS NULL THEN 0 ELSE 1 END AS done"
+           " FROM schema_version ORDER BY version";
+}
+
+std::string
+DBSQLStatements::add_schema_version(const unsigned int version,
+                                    const std::string& description,
+                                    const bool applied) const
+{
+    std::ostringstream ss;
+    ss << "INSERT INTO schema_version"
+       << " (version, description, step, progress, applied) VALUES ("
+       << version << ", '" << description << "', 0, 0, "
+       << (applied ? "CURRENT_TIMESTAMP" : "NULL") << ")";
+    return ss.str();
+}
+
+std::string
+DBSQLStatements::update_schema_version(const unsigned int version,
+                                       const size_t step,
+                                       const unsigned long long progress) const
+{
+    std::ostringstream ss;
+    ss << "UPDATE schema_version SET step = " << step
+       << ", progress = " << progress << " WHERE version = " << version;
+    return ss.str();
+}
+
+std::string
+DBSQLStatements::finish_schema_version(const unsigned int version) const {
+    std::ostringstream ss;
+    ss << "UPDATE schema_version SET applied = CURRENT_TIMESTAMP"
+       << " WHERE version = " << version;
+    return ss.str();
+}
+
+std::string DBSQLStatements::explain(const std::string& statement) const {
+    return std::string{"EXPLAIN "} + statement;
+}
+
+std::string DBSQLStatements::amount_column(const std::string& expr) const {
+    return expr;
+}
+
+std::string DBSQLStatements::amount_value(const std::string& expr) const {
+    return expr;
+}
+
 std::string DBSQLStatements::standing_data() const {
     return "SELECT * FROM standing_data";
 }
 
+std::string DBSQLStatements::ledger_version() const {
+    return "SELECT ledger_version FROM standing_data";
+}
+
+std::string DBSQLStatements::bump_ledger_version() const {
+    return "UPDATE standing_data SET ledger_version = ledger_version + 1";
+}
+
+std::string DBSQLStatements::user_with_perms() const {
+    return "SELECT u.*, COALESCE(p.name, '') AS perm_name FROM users AS u "
+           "LEFT OUTER JOIN user_perms AS up ON up.userid = u.id "
+           "LEFT OUTER JOIN perms AS p ON p.id = up.permid ";
+}
+
 std::string DBSQLStatements::user_by_id(const std::string& user_id) const {
     std::ostringstream ss;
-    ss << "SELECT * FROM users WHERE id = " << user_id;
+    ss << user_with_perms() << "WHERE u.id = " << user_id;
     return ss.str();
 }
 
 std::string DBSQLStatements::user_by_username(const std::string& user_name) const {
     std::ostringstream ss;
-    ss << "SELECT * FROM users WHERE user_name = '" << user_name << "'";
+    ss << user_with_perms() << "WHERE u.user_name = '" << user_name << "'";
+    return ss.str();
+}
+
+std::string
+DBSQLStatements::insert_users(std::vector<GLUser>::const_iterator first,
+                              std::vector<GLUser>::const_iterator last) const
+{
+    std::ostringstream ss;
+    ss << "INSERT INTO users"
+       << " (user_name, first_name, last_name, pass_hash, pass_salt, enabled)"
+       << " VALUES ";
+    for ( auto user = first; user != last; ++user ) {
+        ss << (user == first ? "" : ", ")
+           << "('" << user->username()
+           << "', '" << user->firstname()
+           << "', '" << user->lastname()
+           << "', '" << user->pass_hash()
+           << "', '" << user->pass_salt()
+           << "', " << (user->enabled() ? "TRUE" : "FALSE") << ")";
+    }
     return ss.str();
 }
 
@@ -248,7 +299,7 @@ std::string
 DBSQLStatements::entity_by_name(const std::string& entity_name) const
 {
     std::ostringstream ss;
-    ss << "SELECT * FROM entities WHERE shortname = " << entity_name;
+    ss << "SELECT * FROM entities WHERE shortname = '" << entity_name << "'";
     return ss.str();
 }
 
@@ -256,7 +307,7 @@ std::string
 DBSQLStatements::account_by_name(const std::string& acc_name) const
 {
     std::ostringstream ss;
-    ss << "SELECT * FROM nomaccts WHERE num = " << acc_name;
+    ss << "SELECT * FROM nomaccts WHERE num = '" << acc_name << "'";
     return ss.str();
 }
 
@@ -268,12 +319,77 @@ std::string DBSQLStatements::je_by_id(const std::string& je_id) const {
 
 std::string DBSQLStatements::jelines_by_id(const std::string& je_id) const {
     std::ostringstream ss;
-    ss << "SELECT account, amount FROM jelines "
+    ss << "SELECT account, " << amount_column("amount") << " AS amount"
+       << "  FROM jelines "
+       << "  WHERE je = " << je_id
+       << "  ORDER BY account ASC";
+    return ss.str();
+}
+
+std::string DBSQLStatements::jelines_by_id(const std::string& je_id,
+                                           const int year) const
+{
+    std::ostringstream ss;
+    ss << "SELECT account, " << amount_column("amount") << " AS amount"
+       << "  FROM jelines "
        << "  WHERE je = " << je_id
+       << "  AND year = " << year
        << "  ORDER BY account ASC";
     return ss.str();
 }
 
+std::string
+DBSQLStatements::jelines_with_accounts(const std::string& je_id,
+                                       const int year) const
+{
+    std::ostringstream ss;
+    ss << "SELECT l.account AS account, "
+       << amount_column("l.amount") << " AS amount,"
+       << "  a.description AS description"
+       << "  FROM jelines AS l"
+       << "  INNER JOIN nomaccts AS a"
+       << "    ON a.num = l.account"
+       << "  WHERE l.je = " << je_id
+       << "  AND l.year = " << year
+       << "  ORDER BY l.account ASC";
+    return ss.str();
+}
+
+std::string DBSQLStatements::count_jelines() const {
+    return "SELECT COUNT(*) AS count, MAX(id) AS last FROM jelines";
+}
+
+std::string DBSQLStatements::jelines_page(const unsigned long long after_id,
+                                          const size_t skip,
+                                          const size_t count) const
+{
+    std::ostringstream ss;
+    ss << "SELECT id, je, year, account, "
+       << amount_column("amount") << " AS amount"
+       << "  FROM jelines "
+       << "  WHERE id > " << after_id
+       << "  ORDER BY id ASC"
+       << "  LIMIT " << count << " OFFSET " << skip;
+    return ss.str();
+}
+
+std::string
+DBSQLStatements::jelines_page_before(const unsigned long long before_id,
+                                     const size_t skip,
+                                     const size_t count) const
+{
+    std::ostringstream ss;
+    ss << "SELECT id, je, year, account, "
+       << amount_column("amount") << " AS amount"
+       << "  FROM jelines ";
+    if ( before_id ) {
+        ss << "  WHERE id < " << before_id;
+    }
+    ss << "  ORDER BY id DESC"
+       << "  LIMIT " << count << " OFFSET " << skip;
+    return ss.str();
+}
+
 std::string DBSQLStatements::post_je(const unsigned int user,
                     const unsigned int entity,
                     const int period,
@@ -291,24 +407,21 @@ std::string DBSQLStatements::post_je(const unsigned int user,
 }
 
 std::string DBSQLStatements::post_je_line(const unsigned long long je,
+        const int year,
         const std::string account,
         const std::string amount) const
 {
     std::ostringstream ss;
     ss << "INSERT INTO jelines "
-       << "  (je, account, amount)"
+       << "  (je, year, account, amount)"
        << "  VALUES ("
-       << je << ", '" << account << "', " << amount << ")";
+       << je << ", " << year << ", '" << account << "', "
+       << amount_value(amount) << ")";
     return ss.str();
 }
 
-std::string DBSQLStatements::get_perms(const std::string& user_id) const {
-    std::ostringstream ss;
-    ss << "SELECT p.name AS Permission FROM perms AS p "
-       << "INNER JOIN user_perms AS u ON u.permid = p.id "
-       << "WHERE u.userid = " << user_id << " "
-       << "ORDER BY name ASC";
-    return ss.str();
+std::string DBSQLStatements::list_perms() const {
+    return "SELECT name FROM perms ORDER BY id ASC";
 }
 
 std::string DBSQLStatements::grant(const std::string& user_id,
@@ -341,8 +454,135 @@ std::string DBSQLStatements::currenttb() const {
 std::string DBSQLStatements::currenttb_by_entity(
         const std::string& entity) const
 {
-    return std::string{"SELECT * FROM current_trial_balance WHERE Entity = "} +
-           entity;
+    TBFilter filter{{entity}, "", "", "", false, 0};
+    return currenttb_filtered(filter);
+}
+
+std::string DBSQLStatements::currenttb_filtered(const TBFilter& filter) const
+{
+    std::ostringstream ss;
+    ss << "SELECT"
+       << "  j.entity AS 'Entity',"
+       << "  a.num AS 'A/C No.',"
+       << "  a.description AS 'Description',"
+       << "  " << amount_column("sum(l.amount)") << " AS 'Balance'"
+       << "  FROM jelines AS l"
+       << "  INNER JOIN jes AS j"
+       << "    ON l.je = j.id AND l.year = j.year"
+       << "  INNER JOIN nomaccts AS a"
+       << "    ON a.num = l.account";
+
+    std::vector<std::string> where;
+    if ( !filter.entities.empty() ) {
+        std::ostringstream es;
+        es << "j.entity IN (";
+        for ( size_t i = 0; i < filter.entities.size(); ++i ) {
+            es << (i ? ", " : "") << filter.entities[i];
+        }
+        es << ")";
+        where.push_back(es.str());
+    }
+    if ( !filter.first_account.empty() ) {
+        where.push_back("l.account >= '" + filter.first_account + "'");
+    }
+    if ( !filter.last_account.empty() ) {
+        where.push_back("l.account <= '" + filter.last_account + "'");
+    }
+    for ( size_t i = 0; i < where.size(); ++i ) {
+        ss << (i ? "    AND " : "  WHERE ") << where[i];
+    }
+
+    ss << "  GROUP BY j.entity, a.num, a.description";
+
+    std::vector<std::string> having;
+    if ( filter.nonzero ) {
+        having.push_back("sum(l.amount) <> 0");
+    }
+    if ( !filter.threshold.empty() ) {
+        having.push_back("abs(sum(l.amount)) >= " +
+                         amount_value(filter.threshold));
+    }
+    for ( size_t i = 0; i < having.size(); ++i ) {
+        ss << (i ? "    AND " : "  HAVING ") << having[i];
+    }
+
+    if ( filter.top_n > 0 ) {
+        ss << "  ORDER BY abs(sum(l.amount)) DESC, j.entity ASC, a.num ASC"
+           << "  LIMIT " << filter.top_n;
+    }
+    else {
+        ss << "  ORDER BY j.entity ASC, a.num ASC";
+    }
+    return ss.str();
+}
+
+std::string DBSQLStatements::comparativetb(
+        const std::vector<TBColumn>& columns,
+        const std::string& entity) const
+{
+    int first_year = columns.front().year;
+    int last_year = columns.front().year;
+    for ( const auto& column : columns ) {
+        first_year = std::min(first_year, column.year);
+        last_year = std::max(last_year, column.year);
+    }
+
+    std::ostringstream ss;
+    ss << "SELECT"
+       << "  j.entity AS 'Entity',"
+       << "  a.num AS 'A/C No.',"
+       << "  a.description AS 'Description'";
+    for ( const auto& column : columns ) {
+        std::ostringstream sum;
+        sum << "sum(CASE WHEN j.year = " << column.year
+            << " AND j.period BETWEEN " << column.first_period
+            << " AND " << column.last_period
+            << " THEN l.amount ELSE 0 END)";
+        ss << ",  " << amount_column(sum.str())
+           << " AS '" << column.label << "'";
+    }
+    ss << "  FROM jelines AS l"
+       << "  INNER JOIN jes AS j"
+       << "    ON l.je = j.id AND l.year = j.year"
+       << "  INNER JOIN nomaccts AS a"
+       << "    ON a.num = l.account"
+       << "  WHERE j.year BETWEEN " << first_year << " AND " << last_year
+       << "    AND l.year BETWEEN " << first_year << " AND " << last_year;
+    if ( !entity.empty() ) {
+        ss << "    AND j.entity = " << entity;
+    }
+    ss << "  GROUP BY j.entity, a.num, a.description"
+       << "  ORDER BY j.entity ASC, a.num ASC";
+    return ss.str();
+}
+
+std::string DBSQLStatements::cube_balances() const
+{
+    std::ostringstream ss;
+    ss << "SELECT"
+       << "  j.entity AS 'Entity',"
+       << "  l.account AS 'A/C No.',"
+       << "  j.year AS 'Year',"
+       << "  j.period AS 'Period',"
+       << "  " << amount_column("sum(l.amount)") << " AS 'Balance'"
+       << "  FROM jelines AS l"
+       << "  INNER JOIN jes AS j"
+       << "    ON l.je = j.id AND l.year = j.year"
+       << "  GROUP BY j.entity, l.account, j.year, j.period"
+       << "  ORDER BY j.entity ASC, l.account ASC, j.year ASC, j.period ASC";
+    return ss.str();
+}
+
+std::string DBSQLStatements::list_entities() const
+{
+    return "SELECT id AS 'ID', name AS 'Name', parent AS 'Parent'"
+           "  FROM entities ORDER BY id ASC";
+}
+
+std::string DBSQLStatements::list_accounts() const
+{
+    return "SELECT num AS 'A/C No.', description AS 'Description'"
+           "  FROM nomaccts ORDER BY num ASC";
 }
 
 std::string DBSQLStatements::listusers() const {
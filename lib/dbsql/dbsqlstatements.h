@@ -10,10 +10,59 @@
 #define PG_GENERAL_LEDGER_DATABASE_DBSQL_STATEMENTS_H
 
 #include <string>
+#include <vector>
 #include "gldb/gluser.h"
+#include "dbschema.h"
 
 namespace genleg {
 
+/*!
+ * \brief           A column of a comparative trial balance.
+ * \details         The column sums journal entry lines posted in
+ * \c year with a period from \c first_period to \c last_period inclusive.
+ * \ingroup         sql
+ */
+struct TBColumn {
+    /*!  The column heading  */
+    std::string label;
+
+    /*!  The accounting year  */
+    int year;
+
+    /*!  The first accounting period included  */
+    int first_period;
+
+    /*!  The last accounting period included  */
+    int last_period;
+};
+
+/*!
+ * \brief           Filters for a trial balance report.
+ * \details         Values are inserted into SQL as given, so they must be
+ * validated before use: entities as integers, accounts as account numbers
+ * and the threshold as an unsigned decimal amount.
+ * \ingroup         sql
+ */
+struct TBFilter {
+    /*!  Entity numbers to include, or empty for all entities  */
+    std::vector<std::string> entities;
+
+    /*!  The first account number to include, or empty  */
+    std::string first_account;
+
+    /*!  The last account number to include, or empty  */
+    std::string last_account;
+
+    /*!  Minimum absolute balance to include, or empty  */
+    std::string threshold;
+
+    /*!  Include only accounts with a non-zero balance  */
+    bool nonzero;
+
+    /*!  Include only this many balances, largest first, or 0 for all  */
+    size_t top_n;
+};
+
 /*!
  * \brief           SQL statements class.
  * \ingroup         sql
@@ -29,31 +78,247 @@ class DBSQLStatements {
 
         /*!
          * \brief               Returns a SQL statement for creating a table.
-         * \param table_name    The table to create.
+         * \param table         The table to create.
          * \returns             The SQL statement to create the table.
          */
-        virtual std::string create_table(const std::string& table_name) const;
+        virtual std::string create_table(const SchemaTable table) const;
+
+        /*!
+         * \brief               Returns a SQL statement for creating a table
+         * partitioned by accounting year.
+         * \details             Only the journal entry tables are
+         * partitioned, any other table is created as by create_table().
+         * A partition is created for each year in the range, together with
+         * a catch-all partition for later years.
+         * \param table         The table to create.
+         * \param first_year    The first year for which to create a
+         * partition.
+         * \param last_year     The last year for which to create a
+         * partition.
+         * \returns             The SQL statement to create the table.
+         */
+        virtual std::string
+        create_partitioned_table(const SchemaTable table,
+                                 const int first_year,
+                                 const int last_year) const;
+
+        /*!
+         * \brief               Returns a SQL statement for splitting a
+         * partition for a new year from the catch-all partition.
+         * \param table         The partitioned table.
+         * \param year          The year for which to add the partition.
+         * \returns             The SQL statement.
+         */
+        virtual std::string add_year_partition(const SchemaTable table,
+                                               const int year) const;
+
+        /*!
+         * \brief               Returns SQL statements for moving a year's
+         * partition out to a separate archive table.
+         * \details             The archive table is named after the table
+         * and the year, e.g. `jelines_2010`.
+         * \param table         The partitioned table.
+         * \param year          The year to archive.
+         * \returns             The SQL statements, to be run in order.
+         */
+        virtual std::vector<std::string>
+        archive_year_partition(const SchemaTable table,
+                               const int year) const;
 
         /*!
          * \brief               Returns a SQL statement for dropping a table.
-         * \param table_name    The table to drop.
+         * \param table         The table to drop.
          * \returns             The SQL statement to drop the table.
          */
-        virtual std::string drop_table(const std::string& table_name) const;
+        virtual std::string drop_table(const SchemaTable table) const;
 
         /*!
          * \brief               Returns a SQL statement for creating a view.
-         * \param view_name     The view to create.
+         * \param view          The view to create.
          * \returns             The SQL statement to create the view.
          */
-        virtual std::string create_view(const std::string& view_name) const;
+        virtual std::string create_view(const SchemaView view) const;
 
         /*!
          * \brief               Returns a SQL statement for dropping a view.
-         * \param view_name     The view to drop.
+         * \param view          The view to drop.
          * \returns             The SQL statement to drop the view.
          */
-        virtual std::string drop_view(const std::string& view_name) const;
+        virtual std::string drop_view(const SchemaView view) const;
+
+        /*!
+         * \brief               Returns a SQL statement for creating an index.
+         * \param index         The index to create.
+         * \returns             The SQL statement to create the index.
+         */
+        virtual std::string create_index(const SchemaIndex index) const;
+
+        /*!
+         * \brief               Returns a SQL statement for dropping an index.
+         * \param index         The index to drop.
+         * \returns             The SQL statement to drop the index.
+         */
+        virtual std::string drop_index(const SchemaIndex index) const;
+
+        /*!
+         * \brief               Returns a SQL statement for adding a column
+         * to an existing table while it stays open for writes.
+         * \param table         The table.
+         * \param column        The column name.
+         * \param definition    The column type and constraints.
+         * \returns             The SQL statement.
+         */
+        virtual std::string add_column(const SchemaTable table,
+                                       const std::string& column,
+                                       const std::string& definition) const;
+
+        /*!
+         * \brief               Returns a SQL statement for changing the
+         * type of a column.
+         * \param table         The table.
+         * \param column        The column name.
+         * \param definition    The new column type and constraints.
+         * \returns             The SQL statement.
+         */
+        virtual std::string
+            modify_column(const SchemaTable table,
+                          const std::string& column,
+                          const std::string& definition) const;
+
+        /*!
+         * \brief               Returns whether the backend enforces the
+         * declared type of a column.
+         * \details             A change of column type is only needed by
+         * a backend which enforces it.
+         * \returns             \c true by default.
+         */
+        virtual bool enforces_column_types() const;
+
+        /*!
+         * \brief               Returns a SQL statement which fails if a
+         * column does not exist.
+         * \param table         The table.
+         * \param column        The column name.
+         * \returns             The SQL statement.
+         */
+        virtual std::string column_probe(const SchemaTable table,
+                                         const std::string& column) const;
+
+        /*!
+         * \brief               Returns a SQL statement for creating an
+         * index on an existing table while it stays open for writes.
+         * \param index         The index to create.
+         * \returns             The SQL statement.
+         */
+        virtual std::string create_index_online(const SchemaIndex index) const;
+
+        /*!
+         * \brief               Returns a SQL query for whether an index
+         * exists.
+         * \param index         The index.
+         * \returns             The SQL query, returning a non-zero
+         * \c count if the index exists.
+         */
+        virtual std::string index_exists(const SchemaIndex index) const;
+
+        /*!
+         * \brief               Returns a SQL query for the range of a key.
+         * \param table         The table.
+         * \param key           The integer key column.
+         * \returns             The SQL query, returning \c first and
+         * \c last.
+         */
+        virtual std::string key_range(const SchemaTable table,
+                                      const std::string& key) const;
+
+        /*!
+         * \brief               Returns a SQL statement for updating a
+         * chunk of a table.
+         * \param table         The table.
+         * \param assignment    The \c SET clause.
+         * \param key           The integer key column.
+         * \param after         Rows with keys after this are updated.
+         * \param last          Rows with keys up to this are updated.
+         * \returns             The SQL statement.
+         */
+        virtual std::string backfill(const SchemaTable table,
+                                     const std::string& assignment,
+                                     const std::string& key,
+                                     const unsigned long long after,
+                                     const unsigned long long last) const;
+
+        /*!
+         * \brief               Returns a SQL query for the recorded schema
+         * versions.
+         * \returns             The SQL query.
+         */
+        virtual std::string schema_versions() const;
+
+        /*!
+         * \brief               Returns a SQL statement for recording a
+         * schema version.
+         * \param version       The version.
+         * \param description   The description of the version.
+         * \param applied       \c true if the version is fully applied,
+         * \c false if its migration is starting.
+         * \returns             The SQL statement.
+         */
+        virtual std::string add_schema_version(const unsigned int version,
+                                               const std::string& description,
+                                               const bool applied) const;
+
+        /*!
+         * \brief               Returns a SQL statement for recording the
+         * progress of a migration.
+         * \param version       The version being migrated to.
+         * \param step          The zero-based step in progress.
+         * \param progress      The last key completed by the step.
+         * \returns             The SQL statement.
+         */
+        virtual std::string
+        update_schema_version(const unsigned int version,
+                              const size_t step,
+                              const unsigned long long progress) const;
+
+        /*!
+         * \brief               Returns a SQL statement for recording that
+         * a migration is complete.
+         * \param version       The version migrated to.
+         * \returns             The SQL statement.
+         */
+        virtual std::string
+        finish_schema_version(const unsigned int version) const;
+
+        /*!
+         * \brief               Returns a SQL statement to show the execution
+         * plan for another statement.
+         * \param statement     The statement to explain.
+         * \returns             The SQL statement.
+         */
+        virtual std::string explain(const std::string& statement) const;
+
+        /*!
+         * \brief               Returns an expression for an amount in a
+         * query result.
+         * \details             Amounts are returned with exactly two
+         * decimal places. \c DECIMAL columns already are, so by default the
+         * expression is returned unchanged.
+         * \param expr          The amount expression.
+         * \returns             The output expression.
+         */
+        virtual std::string amount_column(const std::string& expr) const;
+
+        /*!
+         * \brief               Returns an expression for an amount as it
+         * is stored.
+         * \details             Used for amounts written to the database
+         * and for amounts compared with stored ones. \c DECIMAL columns
+         * store a decimal amount as it is, so by default the expression is
+         * returned unchanged.
+         * \param expr          The decimal amount expression.
+         * \returns             The stored expression.
+         */
+        virtual std::string amount_value(const std::string& expr) const;
 
         /*!
          * \brief               Returns a SQL statement to get the standing
@@ -63,21 +328,57 @@ class DBSQLStatements {
         virtual std::string standing_data() const;
 
         /*!
-         * \brief               Returns a SQL statement to select a user by ID.
+         * \brief               Returns a SQL statement to get the ledger
+         * version.
+         * \returns             The SQL statement.
+         */
+        virtual std::string ledger_version() const;
+
+        /*!
+         * \brief               Returns a SQL statement to increment the
+         * ledger version.
+         * \returns             The SQL statement.
+         */
+        virtual std::string bump_ledger_version() const;
+
+        /*!
+         * \brief               Returns the SELECT and FROM clauses of a
+         * statement to select users along with their permissions.
+         * \details             Selects one row for each permission a user
+         * holds, or a single row with an empty \c perm_name column if they
+         * hold none, so a user is loaded in one query.
+         * \returns             The clauses.
+         */
+        virtual std::string user_with_perms() const;
+
+        /*!
+         * \brief               Returns a SQL statement to select a user and
+         * their permissions by ID.
          * \param user_id       The user_id
          * \returns             The SQL statement.
          */
         virtual std::string user_by_id(const std::string& user_id) const;
         
         /*!
-         * \brief               Returns a SQL statement to select a user by
-         * username.
+         * \brief               Returns a SQL statement to select a user and
+         * their permissions by username.
          * \param user_name     The username.
          * \returns             The SQL statement.
          */
         virtual std::string
             user_by_username(const std::string& user_name) const;
 
+        /*!
+         * \brief               Returns a SQL INSERT statement to add
+         * several users in one statement.
+         * \param first         The first user to add.
+         * \param last          One past the last user to add.
+         * \returns             The SQL statement.
+         */
+        virtual std::string
+            insert_users(std::vector<GLUser>::const_iterator first,
+                         std::vector<GLUser>::const_iterator last) const;
+
         /*!
          * \brief               Returns a SQL UPDATE statement to update a
          * user.
@@ -128,6 +429,73 @@ class DBSQLStatements {
          */
         virtual std::string jelines_by_id(const std::string& je_id) const;
 
+        /*!
+         * \brief               Returns a SQL statement to select journal
+         * entry lines by ID, restricted to the accounting year of the entry.
+         * \details             The year allows a partitioned table to be
+         * pruned to a single partition.
+         * \param je_id         The journal entry ID.
+         * \param year          The accounting year of the journal entry.
+         * \returns             The SQL statement.
+         */
+        virtual std::string jelines_by_id(const std::string& je_id,
+                                          const int year) const;
+
+        /*!
+         * \brief               Returns a SQL statement to select journal
+         * entry lines by ID with the description of each account.
+         * \details             Selects the account, amount and
+         * description columns, in that order, so one query gives
+         * everything a journal entry report needs from the lines.
+         * \param je_id         The journal entry ID.
+         * \param year          The accounting year of the journal entry.
+         * \returns             The SQL statement.
+         */
+        virtual std::string jelines_with_accounts(const std::string& je_id,
+                                                  const int year) const;
+
+        /*!
+         * \brief               Returns a SQL statement to count journal
+         * entry lines.
+         * \details             Selects the \c count of lines and the
+         * \c last ID, which is empty if there are none.
+         * \returns             The SQL statement.
+         */
+        virtual std::string count_jelines() const;
+
+        /*!
+         * \brief               Returns a SQL statement to select a page of
+         * journal entry lines in ID order.
+         * \details             Starting from a known ID lets the primary
+         * key find the page directly, so \c skip need only cover the rows
+         * after that ID rather than every row before the page.
+         * \param after_id      Select only lines with a greater ID, or 0
+         * to start from the first line.
+         * \param skip          The number of lines to skip.
+         * \param count         The most lines to select.
+         * \returns             The SQL statement.
+         */
+        virtual std::string jelines_page(const unsigned long long after_id,
+                                         const size_t skip,
+                                         const size_t count) const;
+
+        /*!
+         * \brief               Returns a SQL statement to select a page of
+         * journal entry lines in descending ID order.
+         * \details             Seeks back from a known ID, or from the last
+         * line, so a page nearer the end of the ledger skips only the rows
+         * after it.
+         * \param before_id     Select only lines with a lesser ID, or 0
+         * to start from the last line.
+         * \param skip          The number of lines to skip.
+         * \param count         The most lines to select.
+         * \returns             The SQL statement.
+         */
+        virtual std::string
+            jelines_page_before(const unsigned long long before_id,
+                                const size_t skip,
+                                const size_t count) const;
+
         /*!
          * \brief               Returns a SQL INSERT statement to post a
          * journal entry.
@@ -150,11 +518,13 @@ class DBSQLStatements {
          * \brief               Returns a SQL INSERT query to post a journal
          * entry line.
          * \param je            The journal entry ID.
+         * \param year          The accounting year of the journal entry.
          * \param account       The account to which to post.
          * \param amount        The amount to post.
          * \returns             A string containing the SQL statement.
          */
         virtual std::string post_je_line(const unsigned long long je,
+                const int year,
                 const std::string account,
                 const std::string amount) const;
 
@@ -183,12 +553,11 @@ class DBSQLStatements {
                                    const std::string& perm) const;
 
         /*!
-         * \brief               Returns a SQL UPDATE statement to list a
-         * user's permissions.
-         * \param user_id       The user ID for which to list.
+         * \brief               Returns a SQL statement to list the names of
+         * all permissions.
          * \returns             The SQL statement.
          */
-        virtual std::string get_perms(const std::string& user_id) const;
+        virtual std::string list_perms() const;
 
         /*!
          * \brief               Returns a SQL statement to run the current
@@ -206,6 +575,55 @@ class DBSQLStatements {
         virtual std::string currenttb_by_entity(
                 const std::string& entity) const;
 
+        /*!
+         * \brief               Returns a SQL statement to run a filtered
+         * trial balance report.
+         * \details             The filters are applied to the journal entry
+         * lines before aggregation, or to the aggregated balances with
+         * \c HAVING and \c LIMIT, rather than to the output of the
+         * \c current_trial_balance view.
+         * \param filter        The filters to apply.
+         * \returns             The SQL statement.
+         */
+        virtual std::string currenttb_filtered(const TBFilter& filter) const;
+
+        /*!
+         * \brief               Returns a SQL statement to run a comparative
+         * trial balance report.
+         * \details             All of the columns are computed in a single
+         * pass using conditional aggregation, and only the years covered by
+         * the columns are read.
+         * \param columns       The columns to compute. Must not be empty.
+         * \param entity        The entity number for which to run the
+         * report, or an empty string for all entities.
+         * \returns             The SQL statement.
+         */
+        virtual std::string comparativetb(const std::vector<TBColumn>& columns,
+                                          const std::string& entity) const;
+
+        /*!
+         * \brief               Returns a SQL statement to select the
+         * balances for a balance cube.
+         * \details             Journal entry lines are summed by entity,
+         * account, year and period, ordered by the same fields.
+         * \returns             The SQL statement.
+         */
+        virtual std::string cube_balances() const;
+
+        /*!
+         * \brief               Returns a SQL statement to list the entity
+         * numbers, names and parents.
+         * \returns             The SQL statement.
+         */
+        std::string list_entities() const;
+
+        /*!
+         * \brief               Returns a SQL statement to list the account
+         * numbers and descriptions.
+         * \returns             The SQL statement.
+         */
+        std::string list_accounts() const;
+
         /*!
          * \brief               Returns a SQL statement to run the list users
          * report.
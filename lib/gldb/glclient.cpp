@@ -0,0 +1,95 @@
+/*!
+ * \file            glclient.cpp
+ * \brief           Implementation of General Ledger server client class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "glclient.h"
+
+using namespace genleg;
+
+GLClient::GLClient(const std::string& path) :
+    m_fd{-1}
+{
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if ( path.size() >= sizeof(addr.sun_path) ) {
+        throw GLProtocolException("socket path '" + path + "' too long");
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if ( m_fd == -1 ) {
+        throw GLProtocolException(std::string{"couldn't create socket: "} +
+                                  std::strerror(errno));
+    }
+
+    if ( ::connect(m_fd, reinterpret_cast<sockaddr *>(&addr),
+                   sizeof(addr)) == -1 ) {
+        const std::string error{std::strerror(errno)};
+        ::close(m_fd);
+        throw GLProtocolException("couldn't connect to server at '" +
+                                  path + "': " + error);
+    }
+}
+
+GLClient::~GLClient() {
+    ::close(m_fd);
+}
+
+GLReport GLClient::report(const std::string& report_name,
+                          const std::string& arg) {
+    std::istringstream in{call(GLRequestType::report, {report_name, arg})};
+    return GLReport::load(in);
+}
+
+GLUser GLClient::get_user_by_id(const std::string& user_id) {
+    return user_from_strings(decode_strings(
+                call(GLRequestType::user_by_id, {user_id})));
+}
+
+GLUser GLClient::get_user_by_username(const std::string& user_name) {
+    return user_from_strings(decode_strings(
+                call(GLRequestType::user_by_username, {user_name})));
+}
+
+void GLClient::update_user(const GLUser& user) {
+    call(GLRequestType::update_user, user_to_strings(user));
+}
+
+void GLClient::grant(const GLUser& user, const std::string& perm) {
+    call(GLRequestType::grant, {user.id(), perm});
+}
+
+void GLClient::revoke(const GLUser& user, const std::string& perm) {
+    call(GLRequestType::revoke, {user.id(), perm});
+}
+
+void GLClient::post_journal(const GLJournal& journal) {
+    call(GLRequestType::post_journal, journal_to_strings(journal));
+}
+
+std::string GLClient::call(const GLRequestType type,
+                           const std::vector<std::string>& args) {
+    write_frame(m_fd, encode_request(GLRequest{type, args}));
+
+    std::string payload;
+    if ( !read_frame(m_fd, payload) ) {
+        throw GLProtocolException("server closed the connection");
+    }
+
+    GLResponse response = decode_response(payload);
+    if ( response.status == GLResponseStatus::error ) {
+        throw GLDBException(response.body);
+    }
+    return std::move(response.body);
+}
@@ -0,0 +1,123 @@
+/*!
+ * \file            glclient.h
+ * \brief           Interface to General Ledger server client class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_GL_CLIENT_H
+#define PG_GENERAL_LEDGER_GL_CLIENT_H
+
+#include <string>
+#include <vector>
+#include "glprotocol.h"
+#include "glreport.h"
+
+namespace genleg {
+
+/*!
+ * \brief           General ledger server client class.
+ * \details         Sends requests to a running \c gl_server over its
+ * Unix-domain socket. The member functions mirror those of \c GLDatabase,
+ * so a program may run its requests against either, without connecting to
+ * or logging into the database itself.
+ * \ingroup         gldatabase
+ */
+class GLClient {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \param path      The path of the server's socket.
+         * \throws          GLProtocolException if the server could not be
+         * reached.
+         */
+        explicit GLClient (const std::string& path);
+
+        /*!  Destructor, closing the connection  */
+        ~GLClient ();
+
+        /*!  Deleted copy constructor  */
+        GLClient (const GLClient&) = delete;
+
+        /*!  Deleted copy assignment operator  */
+        GLClient& operator=(const GLClient&) = delete;
+
+        /*!
+         * \brief               Runs a report on the server.
+         * \param report_name   The name of the report.
+         * \param arg           The report argument.
+         * \returns             The report.
+         * \throws              GLDBException on error.
+         */
+        GLReport report(const std::string& report_name,
+                        const std::string& arg = "");
+
+        /*!
+         * \brief           Returns a user by ID.
+         * \param user_id   The user ID.
+         * \returns         The user.
+         * \throws          GLDBException on error.
+         */
+        GLUser get_user_by_id(const std::string& user_id);
+
+        /*!
+         * \brief           Returns a user by username.
+         * \param user_name The username.
+         * \returns         The user.
+         * \throws          GLDBException on error.
+         */
+        GLUser get_user_by_username(const std::string& user_name);
+
+        /*!
+         * \brief           Updates a user.
+         * \param user      The user.
+         * \throws          GLDBException on error.
+         */
+        void update_user(const GLUser& user);
+
+        /*!
+         * \brief           Grants a permission to a user.
+         * \param user      The user.
+         * \param perm      The permission.
+         * \throws          GLDBException on error.
+         */
+        void grant(const GLUser& user, const std::string& perm);
+
+        /*!
+         * \brief           Revokes a permission from a user.
+         * \param user      The user.
+         * \param perm      The permission.
+         * \throws          GLDBException on error.
+         */
+        void revoke(const GLUser& user, const std::string& perm);
+
+        /*!
+         * \brief           Posts a journal entry.
+         * \param journal   The journal entry.
+         * \throws          GLDBException on error.
+         */
+        void post_journal(const GLJournal& journal);
+
+    private:
+
+        /*!  The connected socket  */
+        int m_fd;
+
+        /*!
+         * \brief           Sends a request and waits for its response.
+         * \param type      The request type.
+         * \param args      The request arguments.
+         * \returns         The response body.
+         * \throws          GLDBException with the server's message if the
+         * request failed.
+         */
+        std::string call(const GLRequestType type,
+                         const std::vector<std::string>& args);
+
+};              //  class GLClient
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_GL_CLIENT_H
@@ -0,0 +1,740 @@
+/*!
+ * \file            glcube.cpp
+ * \brief           Implementation of balance cube classes
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "glcube.h"
+#include "glexception.h"
+#include "pgutils/pgutils.h"
+
+using namespace genleg;
+using namespace gldb;
+
+/*!  Magic string at the start of a balance cube file  */
+static const char cube_magic[8] = {'G', 'L', 'C', 'U', 'B', 'E', '1', 0};
+
+/*!
+ * \brief           Balance cube file header.
+ * \ingroup         gldatabase
+ */
+struct CubeHeader {
+    char magic[8];              /*!<  Magic string  */
+    uint32_t num_entities;      /*!<  Number of entities  */
+    uint32_t num_accounts;      /*!<  Number of accounts  */
+    uint32_t num_slots;         /*!<  Number of (year, period) pairs  */
+    uint32_t num_periods;       /*!<  Accounting periods in a year  */
+    int32_t year;               /*!<  Current accounting year  */
+    int32_t period;             /*!<  Current accounting period  */
+    uint64_t num_cells;         /*!<  Number of cells  */
+    uint64_t version;           /*!<  Ledger version  */
+    uint64_t text_bytes;        /*!<  Size of the text section strings  */
+};
+
+/*!
+ * \brief           Balance cube cell.
+ * \ingroup         gldatabase
+ */
+struct CubeCell {
+    uint32_t entity;            /*!<  Entity index  */
+    uint32_t account;           /*!<  Account index  */
+    uint32_t slot;              /*!<  (year, period) index  */
+    uint32_t reserved;          /*!<  Reserved, always zero  */
+    int64_t cents;              /*!<  Balance in cents  */
+};
+
+static_assert(sizeof(CubeHeader) == 56, "Unexpected cube header size");
+static_assert(sizeof(CubeCell) == 24, "Unexpected cube cell size");
+
+/*!
+ * \brief           Converts a decimal amount to cents.
+ * \ingroup         gldatabase
+ * \param amount    The amount, with an optional leading '-' and up to two
+ * decimal places.
+ * \returns         The amount in cents.
+ * \throws          GLDBException if the amount is malformed.
+ */
+static int64_t parse_cents(const std::string& amount);
+
+/*!
+ * \brief           Converts cents to a decimal amount.
+ * \ingroup         gldatabase
+ * \param cents     The amount in cents.
+ * \returns         The amount with two decimal places.
+ */
+static std::string format_cents(const int64_t cents);
+
+/*!
+ * \brief           Writes zero bytes up to the next 8-byte boundary.
+ * \ingroup         gldatabase
+ * \param out       The output stream.
+ * \param size      The number of bytes written since the last boundary.
+ */
+static void put_padding(std::ostream& out, const size_t size);
+
+/*!
+ * \brief           Rounds a size up to a multiple of 8.
+ * \ingroup         gldatabase
+ * \param size      The size.
+ * \returns         The rounded size.
+ */
+static uint64_t padded(const uint64_t size);
+
+/*!
+ * \brief           Writes an array of values in binary form.
+ * \ingroup         gldatabase
+ * \param out       The output stream.
+ * \param vec       The values.
+ */
+template<typename T>
+static void put_array(std::ostream& out, const std::vector<T>& vec);
+
+GLCubeBuilder::GLCubeBuilder(const GLStandingData& sd) :
+    m_sd{sd},
+    m_entities{},
+    m_accounts{},
+    m_balances{}
+{}
+
+void GLCubeBuilder::add_entity(const uint32_t entity,
+                               const std::string& name,
+                               const uint32_t parent)
+{
+    m_entities[entity] = std::make_pair(name, parent);
+}
+
+void GLCubeBuilder::add_account(const std::string& account,
+                                const std::string& description)
+{
+    m_accounts[account] = description;
+}
+
+void GLCubeBuilder::add_balance(const uint32_t entity,
+                                const std::string& account,
+                                const int year,
+                                const int period,
+                                const std::string& amount)
+{
+    const int64_t cents = parse_cents(amount);
+    m_entities.emplace(entity, std::make_pair(std::string{}, 0));
+    m_accounts.emplace(account, std::string{});
+    m_balances[key_type{entity, account, year, period}] += cents;
+}
+
+void GLCubeBuilder::write(const std::string& filename) const
+{
+    std::vector<uint32_t> entities;
+    std::map<uint32_t, uint32_t> entity_idx;
+    for ( const auto& e : m_entities ) {
+        const uint32_t idx = entity_idx.size();
+        entity_idx[e.first] = idx;
+        entities.push_back(e.first);
+        entities.push_back(e.second.second);
+    }
+
+    std::map<std::string, uint32_t> account_idx;
+    for ( const auto& a : m_accounts ) {
+        const uint32_t idx = account_idx.size();
+        account_idx[a.first] = idx;
+    }
+
+    std::set<std::pair<int, int>> slot_set;
+    for ( const auto& b : m_balances ) {
+        slot_set.emplace(std::get<2>(b.first), std::get<3>(b.first));
+    }
+    std::vector<int32_t> slots;
+    std::map<std::pair<int, int>, uint32_t> slot_idx;
+    for ( const auto& s : slot_set ) {
+        const uint32_t idx = slot_idx.size();
+        slot_idx[s] = idx;
+        slots.push_back(s.first);
+        slots.push_back(s.second);
+    }
+
+    std::vector<CubeCell> cells;
+    std::vector<uint64_t> entity_index(m_entities.size() + 1, 0);
+    for ( const auto& b : m_balances ) {
+        const uint32_t e = entity_idx[std::get<0>(b.first)];
+        const uint32_t a = account_idx[std::get<1>(b.first)];
+        const uint32_t s = slot_idx[std::make_pair(std::get<2>(b.first),
+                                                   std::get<3>(b.first))];
+        cells.push_back(CubeCell{e, a, s, 0, b.second});
+        ++entity_index[e + 1];
+    }
+    for ( size_t i = 1; i < entity_index.size(); ++i ) {
+        entity_index[i] += entity_index[i - 1];
+    }
+
+    std::string text;
+    std::vector<uint64_t> text_index{0};
+    for ( const auto& a : m_accounts ) {
+        text += a.first;
+        text_index.push_back(text.size());
+    }
+    for ( const auto& a : m_accounts ) {
+        text += a.second;
+        text_index.push_back(text.size());
+    }
+    for ( const auto& e : m_entities ) {
+        text += e.second.first;
+        text_index.push_back(text.size());
+    }
+
+    CubeHeader header;
+    std::memcpy(header.magic, cube_magic, sizeof(cube_magic));
+    header.num_entities = m_entities.size();
+    header.num_accounts = m_accounts.size();
+    header.num_slots = slot_set.size();
+    header.num_periods = m_sd.num_periods();
+    header.year = m_sd.year();
+    header.period = m_sd.period();
+    header.num_cells = cells.size();
+    header.version = m_sd.ledger_version();
+    header.text_bytes = text.size();
+
+    const std::string temp_name = filename + ".tmp";
+    {
+        std::ofstream ofs{temp_name, std::ios::binary | std::ios::trunc};
+        ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        put_array(ofs, entities);
+        put_array(ofs, entity_index);
+        put_array(ofs, slots);
+        put_array(ofs, cells);
+        put_array(ofs, text_index);
+        ofs.write(text.data(), text.size());
+        put_padding(ofs, text.size());
+        ofs.flush();
+        if ( !ofs ) {
+            std::remove(temp_name.c_str());
+            throw GLDBException("Could not write balance cube '" +
+                                filename + "'");
+        }
+    }
+
+    if ( std::rename(temp_name.c_str(), filename.c_str()) != 0 ) {
+        std::remove(temp_name.c_str());
+        throw GLDBException("Could not write balance cube '" +
+                            filename + "'");
+    }
+}
+
+GLCube::GLCube(const std::string& filename) :
+    m_base{nullptr},
+    m_size{0},
+    m_num_entities{0},
+    m_num_accounts{0},
+    m_num_slots{0},
+    m_num_periods{0},
+    m_year{0},
+    m_period{0},
+    m_num_cells{0},
+    m_version{0},
+    m_entities{nullptr},
+    m_entity_index{nullptr},
+    m_slots{nullptr},
+    m_cells{nullptr},
+    m_text_index{nullptr},
+    m_text{nullptr}
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if ( fd == -1 ) {
+        throw GLDBException("Could not open balance cube '" + filename + "'");
+    }
+
+    struct stat st;
+    if ( fstat(fd, &st) == -1 ||
+         static_cast<size_t>(st.st_size) < sizeof(CubeHeader) ) {
+        close(fd);
+        throw GLDBException("'" + filename + "' is not a balance cube");
+    }
+
+    m_size = st.st_size;
+    void * base = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if ( base == MAP_FAILED ) {
+        throw GLDBException("Could not map balance cube '" + filename + "'");
+    }
+    m_base = static_cast<const char *>(base);
+
+    CubeHeader header;
+    std::memcpy(&header, m_base, sizeof(header));
+
+    /*  Locate each section, checking that the file is large enough  */
+
+    uint64_t offset = sizeof(header);
+    bool valid = std::memcmp(header.magic, cube_magic,
+                             sizeof(cube_magic)) == 0 &&
+                 header.num_cells <= m_size / sizeof(CubeCell) &&
+                 header.text_bytes <= m_size &&
+                 header.num_periods > 0;
+    auto section = [&](const uint64_t bytes) -> const char * {
+        const char * p = m_base + offset;
+        offset += padded(bytes);
+        valid = valid && offset <= m_size;
+        return p;
+    };
+
+    const uint64_t na = header.num_accounts;
+    const uint64_t ne = header.num_entities;
+    m_entities = reinterpret_cast<const uint32_t *>(section(ne * 8));
+    m_entity_index = reinterpret_cast<const uint64_t *>(
+            section((ne + 1) * 8));
+    m_slots = reinterpret_cast<const int32_t *>(
+            section(header.num_slots * 8ULL));
+    m_cells = section(header.num_cells * sizeof(CubeCell));
+    m_text_index = reinterpret_cast<const uint64_t *>(
+            section((2 * na + ne + 1) * 8));
+    m_text = section(header.text_bytes);
+
+    if ( valid ) {
+        valid = m_entity_index[0] == 0 &&
+                m_entity_index[ne] == header.num_cells &&
+                std::is_sorted(m_entity_index, m_entity_index + ne + 1) &&
+                m_text_index[0] == 0 &&
+                m_text_index[2 * na + ne] == header.text_bytes &&
+                std::is_sorted(m_text_index, m_text_index + 2 * na + ne + 1);
+    }
+
+    if ( !valid ) {
+        munmap(const_cast<char *>(m_base), m_size);
+        throw GLDBException("'" + filename + "' is not a balance cube");
+    }
+
+    m_num_entities = header.num_entities;
+    m_num_accounts = header.num_accounts;
+    m_num_slots = header.num_slots;
+    m_num_periods = header.num_periods;
+    m_year = header.year;
+    m_period = header.period;
+    m_num_cells = header.num_cells;
+    m_version = header.version;
+}
+
+GLCube::~GLCube()
+{
+    munmap(const_cast<char *>(m_base), m_size);
+}
+
+unsigned long long GLCube::ledger_version() const
+{
+    return m_version;
+}
+
+size_t GLCube::num_cells() const
+{
+    return m_num_cells;
+}
+
+GLReport GLCube::report(const std::string& report_name,
+                        const std::string& arg) const
+{
+    if ( report_name == "currenttb" ) {
+        return trial_balance_report(arg, false);
+    }
+    else if ( report_name == "rollup" ) {
+        return trial_balance_report(arg, true);
+    }
+    else if ( report_name == "comparetb" ) {
+        return comparative_trial_balance_report(arg);
+    }
+    else {
+        throw GLDBException{"Report not available from a balance cube"};
+    }
+}
+
+std::string GLCube::text(const size_t idx) const
+{
+    return std::string(m_text + m_text_index[idx],
+                       m_text_index[idx + 1] - m_text_index[idx]);
+}
+
+uint32_t GLCube::entity_index(const std::string& entity) const
+{
+    unsigned long number;
+    try {
+        number = std::stoul(entity);
+    }
+    catch ( const std::logic_error& e ) {
+        throw GLDBException("Bad entity number");
+    }
+    uint32_t lo = 0;
+    uint32_t hi = m_num_entities;
+    while ( lo < hi ) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if ( m_entities[2 * mid] < number ) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    if ( lo == m_num_entities || m_entities[2 * lo] != number ) {
+        throw GLDBException("Entity " + entity + " not in balance cube");
+    }
+    return lo;
+}
+
+std::string GLCube::entity_label(const uint32_t idx) const
+{
+    std::ostringstream ss;
+    ss << text(2 * m_num_accounts + idx) << " [" << m_entities[2 * idx] << "]";
+    return ss.str();
+}
+
+uint32_t GLCube::slot_bound(const int year, const int period) const
+{
+    uint32_t lo = 0;
+    uint32_t hi = m_num_slots;
+    while ( lo < hi ) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if ( std::make_pair(m_slots[2 * mid], m_slots[2 * mid + 1]) <
+             std::make_pair(year, period) ) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+GLCube::range_type GLCube::account_range(const std::string& first,
+                                         const std::string& last) const
+{
+    auto bound = [this](const std::string& account, const bool upper) {
+        uint32_t lo = 0;
+        uint32_t hi = m_num_accounts;
+        while ( lo < hi ) {
+            const uint32_t mid = lo + (hi - lo) / 2;
+            const int cmp = text(mid).compare(account);
+            if ( cmp < 0 || (upper && cmp == 0) ) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        return lo;
+    };
+
+    return range_type{first.empty() ? 0 : bound(first, false),
+                      last.empty() ? m_num_accounts : bound(last, true)};
+}
+
+void GLCube::aggregate(const std::vector<uint32_t>& entities,
+                       const range_type& accounts,
+                       const range_type& touch,
+                       const std::vector<range_type>& columns,
+                       const bool by_entity,
+                       Table& table,
+                       std::vector<int64_t>& amounts) const
+{
+    const CubeCell * cells = reinterpret_cast<const CubeCell *>(m_cells);
+    const size_t num_columns = columns.size();
+    std::vector<int64_t> sums(m_num_accounts * num_columns, 0);
+    std::vector<char> touched(m_num_accounts, 0);
+
+    auto flush = [&](const uint32_t entity) {
+        for ( uint32_t a = accounts.first; a < accounts.second; ++a ) {
+            if ( !touched[a] ) {
+                continue;
+            }
+
+            std::vector<std::string> fields;
+            if ( by_entity ) {
+                fields.push_back(std::to_string(entity));
+            }
+            fields.push_back(text(a));
+            fields.push_back(text(m_num_accounts + a));
+            for ( size_t c = 0; c < num_columns; ++c ) {
+                fields.push_back(format_cents(sums[a * num_columns + c]));
+            }
+            table.append_record(TableRow{std::move(fields)});
+            amounts.push_back(sums[a * num_columns]);
+
+            touched[a] = 0;
+            std::fill_n(sums.begin() + a * num_columns, num_columns, 0);
+        }
+    };
+
+    for ( const uint32_t e : entities ) {
+        const CubeCell * first = cells + m_entity_index[e];
+        const CubeCell * last = cells + m_entity_index[e + 1];
+        first = std::lower_bound(first, last, accounts.first,
+                [](const CubeCell& cell, const uint32_t account) {
+                    return cell.account < account;
+                });
+
+        for ( const CubeCell * cell = first;
+              cell != last && cell->account < accounts.second; ++cell ) {
+            if ( cell->account >= m_num_accounts ||
+                 cell->slot >= m_num_slots ) {
+                throw GLDBException("Corrupt balance cube cell");
+            }
+            if ( cell->slot < touch.first || cell->slot >= touch.second ) {
+                continue;
+            }
+
+            touched[cell->account] = 1;
+            for ( size_t c = 0; c < num_columns; ++c ) {
+                if ( cell->slot >= columns[c].first &&
+                     cell->slot < columns[c].second ) {
+                    sums[cell->account * num_columns + c] += cell->cents;
+                }
+            }
+        }
+
+        if ( by_entity ) {
+            flush(m_entities[2 * e]);
+        }
+    }
+
+    if ( !by_entity ) {
+        flush(0);
+    }
+}
+
+GLReport GLCube::trial_balance_report(const std::string& arg,
+                                      const bool rollup) const
+{
+    const TBFilter filter = tb_filter_from_arg(arg);
+
+    std::vector<char> selected(m_num_entities, filter.entities.empty());
+    for ( const auto& entity : filter.entities ) {
+        selected[entity_index(entity)] = 1;
+    }
+
+    if ( rollup && !filter.entities.empty() ) {
+
+        /*  Add descendants until no more are found  */
+
+        bool added = true;
+        while ( added ) {
+            added = false;
+            for ( uint32_t e = 0; e < m_num_entities; ++e ) {
+                if ( selected[e] ) {
+                    continue;
+                }
+                const uint32_t parent = m_entities[2 * e + 1];
+                for ( uint32_t p = 0; p < m_num_entities; ++p ) {
+                    if ( selected[p] && m_entities[2 * p] == parent ) {
+                        selected[e] = 1;
+                        added = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> entities;
+    for ( uint32_t e = 0; e < m_num_entities; ++e ) {
+        if ( selected[e] ) {
+            entities.push_back(e);
+        }
+    }
+
+    int64_t threshold = 0;
+    if ( !filter.threshold.empty() ) {
+        try {
+            threshold = parse_cents(filter.threshold);
+        }
+        catch ( const GLDBException& e ) {
+            throw GLDBException("Bad balance threshold");
+        }
+    }
+
+    std::vector<std::string> headers;
+    if ( !rollup ) {
+        headers.push_back("Entity");
+    }
+    headers.push_back("A/C No.");
+    headers.push_back("Description");
+    headers.push_back("Balance");
+
+    Table balances{TableRow{headers}};
+    std::vector<int64_t> amounts;
+    const range_type all_slots{0, m_num_slots};
+    aggregate(entities,
+              account_range(filter.first_account, filter.last_account),
+              all_slots, {all_slots}, !rollup, balances, amounts);
+
+    std::vector<size_t> rows;
+    for ( size_t i = 0; i < amounts.size(); ++i ) {
+        if ( (!filter.nonzero || amounts[i] != 0) &&
+             std::llabs(amounts[i]) >= threshold ) {
+            rows.push_back(i);
+        }
+    }
+    if ( filter.top_n > 0 ) {
+        std::stable_sort(rows.begin(), rows.end(),
+                [&amounts](const size_t a, const size_t b) {
+                    return std::llabs(amounts[a]) > std::llabs(amounts[b]);
+                });
+        if ( rows.size() > filter.top_n ) {
+            rows.resize(filter.top_n);
+        }
+    }
+
+    Table table{TableRow{headers}};
+    for ( const size_t i : rows ) {
+        table.append_record(balances[i]);
+    }
+
+    GLReport report{rollup ? "Consolidated Trial Balance Report" :
+                             "Current Trial Balance Report",
+                    std::move(table)};
+    if ( filter.entities.size() == 1 ) {
+        report.add_header("Entity",
+                          entity_label(entity_index(filter.entities[0])));
+    }
+    else if ( filter.entities.size() > 1 ) {
+        std::string list;
+        report.add_header("Entities", pgutils::join(filter.entities,
+                                                    list, ','));
+    }
+    if ( rollup && !filter.entities.empty() ) {
+        report.add_header("Including descendants", "Yes");
+    }
+    if ( !filter.first_account.empty() && !filter.last_account.empty() ) {
+        report.add_header("Accounts", filter.first_account + " to " +
+                                      filter.last_account);
+    }
+    else if ( !filter.first_account.empty() ) {
+        report.add_header("Accounts", filter.first_account + " onwards");
+    }
+    else if ( !filter.last_account.empty() ) {
+        report.add_header("Accounts", "up to " + filter.last_account);
+    }
+    if ( !filter.threshold.empty() ) {
+        report.add_header("Minimum absolute balance", filter.threshold);
+    }
+    if ( filter.nonzero ) {
+        report.add_header("Non-zero balances only", "Yes");
+    }
+    if ( filter.top_n > 0 ) {
+        report.add_header("Largest balances", std::to_string(filter.top_n));
+    }
+    report.add_header("Balance cube ledger version",
+                      std::to_string(m_version));
+    return report;
+}
+
+GLReport GLCube::comparative_trial_balance_report(const std::string& arg) const
+{
+    const TBComparison cmp = tb_comparison_from_arg(arg, m_year, m_period,
+                                                    m_num_periods);
+
+    std::vector<uint32_t> entities;
+    if ( cmp.entity.empty() ) {
+        for ( uint32_t e = 0; e < m_num_entities; ++e ) {
+            entities.push_back(e);
+        }
+    }
+    else {
+        entities.push_back(entity_index(cmp.entity));
+    }
+
+    /*  Like the SQL query, only accounts with lines in the years
+     *  covered by the columns are included.                       */
+
+    int first_year = cmp.columns.front().year;
+    int last_year = cmp.columns.front().year;
+    std::vector<std::string> headers{"Entity", "A/C No.", "Description"};
+    std::vector<range_type> columns;
+    for ( const auto& column : cmp.columns ) {
+        first_year = std::min(first_year, column.year);
+        last_year = std::max(last_year, column.year);
+        headers.push_back(column.label);
+        columns.push_back(range_type{
+                slot_bound(column.year, column.first_period),
+                slot_bound(column.year, column.last_period + 1)});
+    }
+    const int min_period = std::numeric_limits<int>::min();
+    const range_type touch{slot_bound(first_year, min_period),
+                           slot_bound(last_year + 1, min_period)};
+
+    Table table{TableRow{headers}};
+    std::vector<int64_t> amounts;
+    aggregate(entities, range_type{0, m_num_accounts}, touch, columns,
+              true, table, amounts);
+
+    GLReport report{"Comparative Trial Balance Report", std::move(table)};
+    report.add_header("Period", std::to_string(cmp.period));
+    report.add_header("Year", std::to_string(cmp.year));
+    if ( !cmp.entity.empty() ) {
+        report.add_header("Entity", entity_label(entities[0]));
+    }
+    report.add_header("Balance cube ledger version",
+                      std::to_string(m_version));
+    return report;
+}
+
+static int64_t parse_cents(const std::string& amount)
+{
+    const bool negative = !amount.empty() && amount[0] == '-';
+    const std::string digits = amount.substr(negative ? 1 : 0);
+    const size_t dot = digits.find('.');
+    const std::string int_part = digits.substr(0, dot);
+    const std::string frac_part = dot == std::string::npos ? "" :
+                                  digits.substr(dot + 1);
+
+    auto is_digits = [](const std::string& s) {
+        return std::all_of(s.begin(), s.end(), [](const char c) {
+                return c >= '0' && c <= '9';
+        });
+    };
+    if ( int_part.empty() || int_part.length() > 16 || !is_digits(int_part) ||
+         frac_part.length() > 2 || !is_digits(frac_part) ) {
+        throw GLDBException("Bad amount '" + amount + "'");
+    }
+
+    int64_t cents = std::stoll(int_part) * 100;
+    if ( !frac_part.empty() ) {
+        cents += std::stoll(frac_part) * (frac_part.length() == 1 ? 10 : 1);
+    }
+    return negative ? -cents : cents;
+}
+
+static std::string format_cents(const int64_t cents)
+{
+    const uint64_t magnitude = cents < 0 ? -static_cast<uint64_t>(cents) :
+                                           cents;
+    std::string s = std::to_string(magnitude / 100) + ".";
+    s += static_cast<char>('0' + magnitude % 100 / 10);
+    s += static_cast<char>('0' + magnitude % 10);
+    return cents < 0 ? "-" + s : s;
+}
+
+static void put_padding(std::ostream& out, const size_t size)
+{
+    static const char zeros[8] = {0};
+    out.write(zeros, padded(size) - size);
+}
+
+static uint64_t padded(const uint64_t size)
+{
+    return (size + 7) & ~static_cast<uint64_t>(7);
+}
+
+template<typename T>
+static void put_array(std::ostream& out, const std::vector<T>& vec)
+{
+    const size_t size = vec.size() * sizeof(T);
+    out.write(reinterpret_cast<const char *>(vec.data()), size);
+    put_padding(out, size);
+}
@@ -0,0 +1,323 @@
+/*!
+ * \file            glcube.h
+ * \brief           Interface to balance cube classes
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_GLCUBE_H
+#define PG_GENERAL_LEDGER_GLCUBE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "glreport.h"
+#include "glstanding.h"
+
+namespace genleg {
+
+/*!
+ * \brief           Balance cube builder class.
+ * \details         Accumulates balances by entity, account, year and
+ * period, and writes them to a balance cube file for reading with
+ * \c GLCube.
+ *
+ * The file is written in host byte order with every section starting on
+ * an 8-byte boundary, so that it can be mapped into memory and used in
+ * place. The layout is:
+ *
+ * - Header: the 8 byte magic string \c "GLCUBE1\0", then \c uint32_t
+ *   entity, account, (year, period) and periods per year counts, the
+ *   \c int32_t current year and period, and \c uint64_t cell count,
+ *   ledger version and text size.
+ * - Entities: \c uint32_t (number, parent) pairs, sorted by number.
+ * - Entity index: entity count plus one \c uint64_t offsets of the first
+ *   cell of each entity.
+ * - Periods: \c int32_t (year, period) pairs, sorted.
+ * - Cells: \c uint32_t entity, account and period indices, a reserved
+ *   \c uint32_t and an \c int64_t balance in cents, for each non-empty
+ *   combination, sorted by entity, account and period.
+ * - Text: \c uint64_t offsets of the account numbers, the account
+ *   descriptions and the entity names, plus one, followed by the
+ *   concatenated string bytes. Accounts are sorted by number.
+ * \ingroup         gldatabase
+ */
+class GLCubeBuilder {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \param sd        The standing data of the ledger.
+         */
+        explicit GLCubeBuilder (const GLStandingData& sd);
+
+        /*!
+         * \brief           Adds an entity.
+         * \param entity    The entity number.
+         * \param name      The entity name.
+         * \param parent    The parent entity number.
+         */
+        void add_entity(const uint32_t entity,
+                        const std::string& name,
+                        const uint32_t parent);
+
+        /*!
+         * \brief           Adds an account.
+         * \param account       The account number.
+         * \param description   The account description.
+         */
+        void add_account(const std::string& account,
+                         const std::string& description);
+
+        /*!
+         * \brief           Adds an amount to a balance.
+         * \details         Entities and accounts not previously added are
+         * added with empty names and descriptions.
+         * \param entity    The entity number.
+         * \param account   The account number.
+         * \param year      The accounting year.
+         * \param period    The accounting period.
+         * \param amount    The amount, as a decimal number with up to two
+         * decimal places.
+         * \throws          GLDBException if the amount is malformed.
+         */
+        void add_balance(const uint32_t entity,
+                         const std::string& account,
+                         const int year,
+                         const int period,
+                         const std::string& amount);
+
+        /*!
+         * \brief           Writes the cube file.
+         * \details         The file is written under a temporary name and
+         * then renamed, so readers never see a partial file.
+         * \param filename  The name of the file.
+         * \throws          GLDBException if the file could not be written.
+         */
+        void write(const std::string& filename) const;
+
+    private:
+
+        /*!  Alias for balance key type  */
+        using key_type = std::tuple<uint32_t, std::string, int, int>;
+
+        /*!  Standing data of the ledger  */
+        GLStandingData m_sd;
+
+        /*!  Entity names and parents, by entity number  */
+        std::map<uint32_t, std::pair<std::string, uint32_t>> m_entities;
+
+        /*!  Account descriptions, by account number  */
+        std::map<std::string, std::string> m_accounts;
+
+        /*!  Balances in cents  */
+        std::map<key_type, int64_t> m_balances;
+
+};              //  class GLCubeBuilder
+
+/*!
+ * \brief           Memory-mapped balance cube class.
+ * \details         Answers trial balance reports from a file written by
+ * \c GLCubeBuilder without a database connection. Each entity's cells are
+ * located through the entity index, and each report is computed in a
+ * single pass over the selected cells.
+ * \ingroup         gldatabase
+ */
+class GLCube {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \param filename  The name of the cube file.
+         * \throws          GLDBException if the file could not be mapped or
+         * is not a balance cube.
+         */
+        explicit GLCube (const std::string& filename);
+
+        /*!  Destructor  */
+        ~GLCube ();
+
+        /*!  Deleted copy constructor  */
+        GLCube (const GLCube&) = delete;
+
+        /*!  Deleted assignment operator  */
+        GLCube& operator=(const GLCube&) = delete;
+
+        /*!
+         * \brief           Returns the ledger version the cube was built at.
+         * \returns         The ledger version.
+         */
+        unsigned long long ledger_version() const;
+
+        /*!
+         * \brief           Returns the number of non-empty cells.
+         * \returns         The number of cells.
+         */
+        size_t num_cells() const;
+
+        /*!
+         * \brief           Runs a report.
+         * \details         The reports are \c currenttb and \c comparetb,
+         * which take the same arguments as the database reports, and
+         * \c rollup, a consolidated trial balance which takes the same
+         * arguments as \c currenttb, except that each entity includes all
+         * of its descendants.
+         * \param report_name   The name of the report.
+         * \param arg           The report argument.
+         * \returns             The report.
+         * \throws              GLDBException on an unknown report or a bad
+         * argument.
+         */
+        GLReport report(const std::string& report_name,
+                        const std::string& arg = "") const;
+
+    private:
+
+        /*!  A range of indices  */
+        using range_type = std::pair<uint32_t, uint32_t>;
+
+        /*!  Base address of the mapping  */
+        const char * m_base;
+
+        /*!  Size of the mapping  */
+        size_t m_size;
+
+        /*!  Number of entities  */
+        uint32_t m_num_entities;
+
+        /*!  Number of accounts  */
+        uint32_t m_num_accounts;
+
+        /*!  Number of (year, period) pairs  */
+        uint32_t m_num_slots;
+
+        /*!  Number of accounting periods in a year  */
+        int m_num_periods;
+
+        /*!  Current accounting year  */
+        int m_year;
+
+        /*!  Current accounting period  */
+        int m_period;
+
+        /*!  Number of cells  */
+        uint64_t m_num_cells;
+
+        /*!  Ledger version  */
+        uint64_t m_version;
+
+        /*!  Entity (number, parent) pairs  */
+        const uint32_t * m_entities;
+
+        /*!  Entity cell offsets  */
+        const uint64_t * m_entity_index;
+
+        /*!  (year, period) pairs  */
+        const int32_t * m_slots;
+
+        /*!  Cells  */
+        const char * m_cells;
+
+        /*!  Text offsets  */
+        const uint64_t * m_text_index;
+
+        /*!  Text bytes  */
+        const char * m_text;
+
+        /*!
+         * \brief           Returns a string from the text section.
+         * \param idx       The string index.
+         * \returns         The string.
+         */
+        std::string text(const size_t idx) const;
+
+        /*!
+         * \brief           Finds an entity.
+         * \param entity    The entity number.
+         * \returns         The entity index.
+         * \throws          GLDBException if the entity is not in the cube.
+         */
+        uint32_t entity_index(const std::string& entity) const;
+
+        /*!
+         * \brief           Returns the entity name and number for a report
+         * header.
+         * \param idx       The entity index.
+         * \returns         The entity description.
+         */
+        std::string entity_label(const uint32_t idx) const;
+
+        /*!
+         * \brief           Returns the number of (year, period) pairs
+         * before a given pair.
+         * \param year      The accounting year.
+         * \param period    The accounting period.
+         * \returns         The index of the first pair not before the given
+         * pair.
+         */
+        uint32_t slot_bound(const int year, const int period) const;
+
+        /*!
+         * \brief           Returns the account indices for a range of
+         * account numbers.
+         * \param first     The first account number, or empty.
+         * \param last      The last account number, or empty.
+         * \returns         The half-open range of indices.
+         */
+        range_type account_range(const std::string& first,
+                                 const std::string& last) const;
+
+        /*!
+         * \brief           Sums cells into balances.
+         * \param entities  The entity indices to include, in order.
+         * \param accounts  The half-open range of account indices to
+         * include.
+         * \param touch     The half-open range of period indices for which
+         * a cell makes an account appear in the output.
+         * \param columns   The half-open ranges of period indices to sum
+         * for each column.
+         * \param by_entity Sum entities separately if \c true, or together
+         * if \c false.
+         * \param table     The table to which to append a row of entity
+         * number, if \c by_entity, account number, description and column
+         * amounts for each balance.
+         * \param amounts   Receives the first column amount in cents for
+         * each row appended.
+         */
+        void aggregate(const std::vector<uint32_t>& entities,
+                       const range_type& accounts,
+                       const range_type& touch,
+                       const std::vector<range_type>& columns,
+                       const bool by_entity,
+                       gldb::Table& table,
+                       std::vector<int64_t>& amounts) const;
+
+        /*!
+         * \brief           Runs a current or consolidated trial balance
+         * report.
+         * \param arg       The report argument.
+         * \param rollup    Consolidate each entity with its descendants if
+         * \c true.
+         * \returns         The report.
+         */
+        GLReport trial_balance_report(const std::string& arg,
+                                      const bool rollup) const;
+
+        /*!
+         * \brief           Runs a comparative trial balance report.
+         * \param arg       The report argument.
+         * \returns         The report.
+         */
+        GLReport comparative_trial_balance_report(
+                const std::string& arg) const;
+
+};              //  class GLCube
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_GLCUBE_H
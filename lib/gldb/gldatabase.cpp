@@ -6,13 +6,23 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <future>
+#include <map>
 #include <sstream>
+#include <stdexcept>
+#include <utility>
 #include <boost/filesystem.hpp>
 #include "gldatabase.h"
+#include "gldatabasepool.h"
+#include "glcube.h"
 #include "glexception.h"
-#include "database_imp/database_imp.h"
+#include "glmigration.h"
+#include "database_imp/backends.h"
 #include "pgutils/pgutils.h"
 
 using namespace genleg;
@@ -30,15 +40,31 @@ using pgutils::currency_from_string;
  */
 static bool boolstring_to_bool(const std::string& bs);
 
+/*!
+ * \brief           Creates an account from a query result.
+ * \param table     The result of an account query.
+ * \returns         The account.
+ * \throws          GLDBException on a bad enabled flag.
+ */
+static GLAccount create_account(Table& table);
+
+/*!
+ * \brief           Creates a journal entry from query results.
+ * \param je        The result of a journal entry query.
+ * \param lines     The result of a journal entry lines query.
+ * \returns         The journal entry.
+ * \throws          GLDBException if the entry does not balance.
+ */
+static GLJournal create_journal(Table& je, const Table& lines);
+
 GLDatabase::GLDatabase(const std::string& database,
                        const std::string& hostname,
                        const std::string& username,
                        const std::string& password) try :
-    m_dbc(get_connection(database, hostname, username, password)),
+    m_dbc(backend_connection(database, hostname, username, password)),
     m_sql(get_sql_object()),
-    m_tables({"standing_data", "users", "perms", "user_perms", "entities",
-              "jesrcs", "nomaccts", "jes", "jelines"}),
-    m_views({"current_trial_balance", "check_total", "all_jes"})
+    m_cache(),
+    m_pool(nullptr)
 { }
 catch ( const DBConnException& e ) {
     throw GLDBException(e.what());
@@ -48,26 +74,238 @@ GLDatabase::~GLDatabase() {
 }
 
 void GLDatabase::create_structure() try {
-    for ( const auto& table_name : m_tables ) {
-        m_dbc.query(m_sql->create_table(table_name));
+    for ( const auto& table : schema_tables ) {
+        m_dbc.query(m_sql->create_table(table.id));
+    }
+
+    create_indexes_and_views();
+    GLMigrator{m_dbc, *m_sql}.stamp();
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+
+void GLDatabase::create_structure(const int first_year,
+                                  const int last_year) try {
+    if ( first_year > last_year ) {
+        throw GLDBException("Bad range of partition years");
     }
 
-    for ( const auto& view_name : m_views ) {
-        m_dbc.query(m_sql->create_view(view_name));
+    for ( const auto& table : schema_tables ) {
+        m_dbc.query(m_sql->create_partitioned_table(table.id,
+                                                    first_year, last_year));
     }
+
+    create_indexes_and_views();
+    GLMigrator{m_dbc, *m_sql}.stamp();
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+
+void GLDatabase::create_indexes_and_views() {
+    for ( const auto& index : schema_indexes ) {
+        m_dbc.query(m_sql->create_index(index.id));
+    }
+
+    for ( const auto& view : schema_views ) {
+        m_dbc.query(m_sql->create_view(view.id));
+    }
+}
+
+void GLDatabase::add_year_partition(const int year) try {
+    for ( const auto& table : schema_tables ) {
+        if ( table.partitioned_ddl ) {
+            m_dbc.query(m_sql->add_year_partition(table.id, year));
+        }
+    }
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+
+void GLDatabase::archive_year_partition(const int year) try {
+    for ( const auto& table : schema_tables ) {
+        if ( !table.partitioned_ddl ) {
+            continue;
+        }
+        for ( const auto& query :
+                m_sql->archive_year_partition(table.id, year) ) {
+            m_dbc.query(query);
+        }
+    }
+    bump_ledger_version();
 }
 catch ( const DBConnException& e ) {
     throw GLDBException(e.what());
 }
 
 void GLDatabase::destroy_structure() try {
-    for ( auto itr = m_views.rbegin(); itr != m_views.rend(); ++itr ) {
-        m_dbc.query(m_sql->drop_view(*itr));
+
+    /*  Objects are dropped in the reverse of their dependency order  */
+
+    for ( size_t i = num_schema_views; i > 0; --i ) {
+        m_dbc.query(m_sql->drop_view(schema_views[i - 1].id));
+    }
+
+    /*  A database created before schema versioning has no version table  */
+
+    const bool versioned = GLMigrator{m_dbc, *m_sql}.has_version_table();
+    for ( size_t i = num_schema_tables; i > 0; --i ) {
+        const SchemaTable table = schema_tables[i - 1].id;
+        if ( table != SchemaTable::schema_version || versioned ) {
+            m_dbc.query(m_sql->drop_table(table));
+        }
+    }
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+
+void GLDatabase::create_indexes() try {
+    for ( const auto& index : schema_indexes ) {
+        m_dbc.query(m_sql->create_index(index.id));
     }
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
 
-    for ( auto itr = m_tables.rbegin(); itr != m_tables.rend(); ++itr ) {
-        m_dbc.query(m_sql->drop_table(*itr));
+GLReport GLDatabase::migration_status() try {
+    GLMigrator migrator{m_dbc, *m_sql};
+    GLReport report{"Schema Version Report", migrator.status()};
+    report.add_header("Schema version",
+                      std::to_string(migrator.current_version()));
+    report.add_header("Latest version",
+                      std::to_string(migrator.latest_version()));
+    return report;
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+
+GLReport GLDatabase::migration_plan(const unsigned long long chunk_rows) try {
+    if ( chunk_rows == 0 ) {
+        throw GLDBException("Backfill chunk size must not be zero");
     }
+    GLReport report{"Schema Migration Plan",
+                    GLMigrator{m_dbc, *m_sql}.plan(chunk_rows)};
+    report.add_header("Dry run", "no changes made");
+    return report;
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+
+bool GLDatabase::migrate(const unsigned long long chunk_rows,
+                         const size_t max_chunks,
+                         const std::function<void(const std::string&)>&
+                             progress) try {
+    if ( !GLMigrator{m_dbc, *m_sql}.migrate(chunk_rows, max_chunks,
+                                            progress) ) {
+        return false;
+    }
+
+    /*  Migrations may rewrite what reports show, and the version is only
+     *  certain to exist once they are all applied                        */
+
+    bump_ledger_version();
+    return true;
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+
+GLReport GLDatabase::explain_statements() try {
+    const std::vector<std::pair<std::string, std::string>> statements{
+        {"standing_data", m_sql->standing_data()},
+        {"user_by_id", m_sql->user_by_id("1")},
+        {"user_by_username", m_sql->user_by_username("admin")},
+        {"list_perms", m_sql->list_perms()},
+        {"entity_by_id", m_sql->entity_by_id("1")},
+        {"account_by_name", m_sql->account_by_name("10001000")},
+        {"je_by_id", m_sql->je_by_id("1")},
+        {"jelines_by_id", m_sql->jelines_by_id("1", 2014)},
+        {"jelines_with_accounts", m_sql->jelines_with_accounts("1", 2014)},
+        {"currenttb", m_sql->currenttb()},
+        {"currenttb_by_entity", m_sql->currenttb_by_entity("1")},
+        {"listusers", m_sql->listusers()}
+    };
+
+    Table plan{TableRow{"Statement", "Table", "Access", "Key",
+                        "Rows", "Flag"}};
+    size_t full_scans = 0;
+
+    for ( const auto& stmt : statements ) {
+        Table result{m_dbc.select(m_sql->explain(stmt.second))};
+
+        /*  SQLite describes each step of the plan in one string,
+         *  for example "SCAN l" or "SEARCH j USING INDEX x (id=?)"    */
+
+        if ( result.has_field("detail") ) {
+            for ( size_t i = 0; i < result.num_records(); ++i ) {
+                std::istringstream detail{result.get_field("detail", i)};
+                std::string access, table, word, key;
+                detail >> access >> table;
+                if ( access != "SCAN" && access != "SEARCH" ) {
+                    continue;
+                }
+                while ( detail >> word && word != "INDEX" &&
+                        word != "KEY" ) {
+                }
+                if ( word == "INDEX" ) {
+                    detail >> key;
+                }
+                else if ( word == "KEY" ) {
+                    key = "PRIMARY";
+                }
+
+                std::string flag;
+                if ( access == "SCAN" && key.empty() ) {
+                    flag = "FULL SCAN";
+                    ++full_scans;
+                }
+                else if ( access == "SCAN" ) {
+                    flag = "INDEX SCAN";
+                }
+
+                plan.append_record(TableRow{stmt.first, table, access,
+                                            key, "", flag});
+            }
+            continue;
+        }
+
+        /*  Backends without a query plan report only the name  */
+
+        if ( !result.has_field("type") ) {
+            plan.append_record(TableRow{stmt.first, "", "", "", "", "n/a"});
+            continue;
+        }
+
+        for ( size_t i = 0; i < result.num_records(); ++i ) {
+            const std::string access = result.get_field("type", i);
+            std::string flag;
+            if ( access == "ALL" ) {
+                flag = "FULL SCAN";
+                ++full_scans;
+            }
+            else if ( access == "index" ) {
+                flag = "INDEX SCAN";
+            }
+
+            plan.append_record(TableRow{stmt.first,
+                                        result.get_field("table", i),
+                                        access,
+                                        result.get_field("key", i),
+                                        result.get_field("rows", i),
+                                        flag});
+        }
+    }
+
+    GLReport report{"Statement Execution Plan Report",
+                    std::move(plan)};
+    report.add_header("Full scans", std::to_string(full_scans));
+    return report;
 }
 catch ( const DBConnException& e ) {
     throw GLDBException(e.what());
@@ -77,14 +315,16 @@ void GLDatabase::load_sample_data(const std::string& dir) try {
 
     /*  Load tables directly  */
 
-    for ( const auto& tname : m_tables ) {
-        if ( tname == "jes" || tname == "jelines" ) {
+    for ( const auto& def : schema_tables ) {
+        if ( def.id == SchemaTable::jes || def.id == SchemaTable::jelines ||
+             def.id == SchemaTable::schema_version ) {
 
-            /*  Ignore journal entry tables  */
+            /*  Ignore journal entry and version tables  */
 
             continue;
         }
 
+        const std::string tname{def.name};
         std::string filename = dir + "/" + tname;
         Table table{Table::create_from_file(filename, ':')};
         for ( size_t i = 0; i < table.num_records(); ++i ) {
@@ -113,6 +353,11 @@ void GLDatabase::load_sample_data(const std::string& dir) try {
         }
         post_journal(journal_from_stream(ifs));
     }
+
+    /*  Posting bumps the version too, but the tables loaded directly
+     *  change reports even without journal entries                    */
+
+    bump_ledger_version();
 }
 catch ( const DBConnException& e ) {
     throw GLDBException(e.what());
@@ -128,8 +373,87 @@ catch ( const TableBadInputFile& e ) {
     throw GLDBException(ss.str());
 }
 
+void GLDatabase::build_cube(const std::string& filename) try {
+    GLDBTransaction txn{m_dbc};
+
+    GLCubeBuilder builder{get_standing_data()};
+
+    Table entities{m_dbc.select(m_sql->list_entities())};
+    for ( const auto& row : entities ) {
+        builder.add_entity(std::stoul(row[0].str()), row[1].str(),
+                           std::stoul(row[2].str()));
+    }
+
+    Table accounts{m_dbc.select(m_sql->list_accounts())};
+    for ( const auto& row : accounts ) {
+        builder.add_account(row[0].str(), row[1].str());
+    }
+
+    Table balances{m_dbc.select(m_sql->cube_balances())};
+    for ( const auto& row : balances ) {
+        builder.add_balance(std::stoul(row[0].str()), row[1].str(),
+                            std::stoi(row[2].str()), std::stoi(row[3].str()),
+                            row[4].str());
+    }
+
+    txn.commit();
+    builder.write(filename);
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+catch ( const std::logic_error& e ) {
+    throw GLDBException("Bad numeric field reading balances");
+}
+
 std::string GLDatabase::backend() {
-    return get_database_type();
+    return backend_database_type();
+}
+
+void GLDatabase::select_backend(const std::string& backend) try {
+    gldb::select_backend(backend);
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+
+void GLDatabase::record_queries(const std::string& filename) try {
+    gldb::record_backend(filename);
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+
+void GLDatabase::replay_queries(const std::string& filename,
+                                const bool timed) try {
+    gldb::replay_backend(filename, timed);
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+
+void GLDatabase::set_slow_query_threshold(const std::string& msecs) {
+    if ( msecs.empty() || msecs.size() > 9 ||
+         msecs.find_first_not_of("0123456789") != std::string::npos ) {
+        throw GLDBException("Bad slow query threshold: " + msecs);
+    }
+    QueryStats::instance().set_slow_query_log(&std::cerr,
+                                              std::stoull(msecs) * 1000);
+}
+
+void GLDatabase::report_query_stats_at_exit() {
+
+    /*  Creating the registry first means it is destroyed after the
+     *  exit handler has run.                                       */
+
+    QueryStats::instance().enable();
+    std::atexit([]() { std::cerr << query_stats_report(); });
+}
+
+GLReport GLDatabase::query_stats_report() {
+    GLReport report{"Query Statistics", QueryStats::instance().table()};
+    report.add_header("Latencies", "microseconds");
+    return report;
 }
 
 GLStandingData GLDatabase::get_standing_data()
@@ -138,15 +462,34 @@ GLStandingData GLDatabase::get_standing_data()
     return GLStandingData{sd.get_field("organization", 0),
                           std::stoi(sd.get_field("current_period", 0)),
                           std::stoi(sd.get_field("current_year", 0)),
-                          std::stoi(sd.get_field("num_periods", 0))};
+                          std::stoi(sd.get_field("num_periods", 0)),
+                          std::stoull(sd.get_field("ledger_version", 0))};
+}
+
+unsigned long long GLDatabase::ledger_version() try
+{
+    Table table{m_dbc.select(m_sql->ledger_version())};
+    return std::stoull(table.get_field("ledger_version", 0));
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+catch ( const gldb::TableException& e ) {
+    throw GLDBException("Could not read ledger version");
+}
+
+void GLDatabase::bump_ledger_version()
+{
+    m_dbc.query(m_sql->bump_ledger_version());
 }
 
 GLUser GLDatabase::create_user(Table& table) {
-    const std::string permquery = m_sql->get_perms(table.get_field("id", 0));
-    Table permtable{m_dbc.select(permquery)};
-    std::vector<std::string> perms;
-    for ( size_t i = 0; i < permtable.num_records(); ++i ) {
-        perms.push_back(permtable[i][0]);
+    GLPermissionSet perms;
+    for ( size_t i = 0; i < table.num_records(); ++i ) {
+        const std::string name = table.get_field("perm_name", i);
+        if ( !name.empty() ) {
+            perms.set(permission_bit(name));
+        }
     }
 
     const bool enabled = boolstring_to_bool(table.get_field("enabled", 0));
@@ -156,7 +499,7 @@ GLUser GLDatabase::create_user(Table& table) {
                     table.get_field("last_name", 0),
                     table.get_field("pass_hash", 0),
                     table.get_field("pass_salt", 0),
-                    std::move(perms),
+                    perms,
                     enabled);
 
     return new_user;
@@ -172,16 +515,68 @@ GLUser GLDatabase::get_user_by_username(const std::string& user_name) {
     return create_user(table);
 }
 
+void GLDatabase::add_users(const std::vector<GLUser>& users,
+                           const size_t batch_rows) {
+    if ( batch_rows == 0 ) {
+        throw GLDBException("User batch size must not be zero");
+    }
+
+    std::vector<std::string> batches;
+    for ( size_t i = 0; i < users.size(); i += batch_rows ) {
+        const size_t end = std::min(i + batch_rows, users.size());
+        batches.push_back(m_sql->insert_users(users.begin() + i,
+                                              users.begin() + end));
+    }
+
+    GLDBTransaction txn(m_dbc);
+    try {
+        m_dbc.query_batch(batches);
+    }
+    catch ( const DBConnBatchFailed& e ) {
+        std::ostringstream ss;
+        ss << "Could not add users from " << e.index() * batch_rows + 1
+           << ": " << e.what();
+        throw GLDBException(ss.str());
+    }
+    bump_ledger_version();
+    txn.commit();
+}
+
 void GLDatabase::update_user(const GLUser& user) {
+    GLDBTransaction txn(m_dbc);
     m_dbc.query(m_sql->update_user(user));
+    bump_ledger_version();
+    txn.commit();
 }
 
 void GLDatabase::grant(const GLUser& user, const std::string& perm) {
+    GLDBTransaction txn(m_dbc);
     m_dbc.query(m_sql->grant(user.id(), perm));
+    bump_ledger_version();
+    txn.commit();
 }
 
 void GLDatabase::revoke(const GLUser& user, const std::string& perm) {
+    GLDBTransaction txn(m_dbc);
     m_dbc.query(m_sql->revoke(user.id(), perm));
+    bump_ledger_version();
+    txn.commit();
+}
+
+std::vector<std::string> GLDatabase::sync_permissions() {
+    Table table{m_dbc.select(m_sql->list_perms())};
+    GLPermissionSet found;
+    for ( size_t i = 0; i < table.num_records(); ++i ) {
+        found.set(permission_bit(table[i][0]));
+    }
+
+    std::vector<std::string> missing;
+    for ( const auto& def : gl_permissions ) {
+        if ( !found.test(static_cast<size_t>(def.id)) ) {
+            missing.push_back(def.name);
+        }
+    }
+    return missing;
 }
 
 GLEntity GLDatabase::create_entity(Table& table) {
@@ -212,31 +607,21 @@ GLEntity GLDatabase::get_entity_by_name(const std::string& entity_name)
 GLAccount GLDatabase::get_account_by_name(const std::string& acc_name)
 {
     Table table{m_dbc.select(m_sql->account_by_name(acc_name))};
-    const bool enabled = boolstring_to_bool(table.get_field("enabled", 0));
-    GLAccount acct{table.get_field("num", 0),
-                   table.get_field("description", 0),
-                   enabled};
-    return acct;
+    return create_account(table);
+}
+
+bool GLDatabase::account_exists(const std::string& acc_name) try {
+    return m_dbc.select(m_sql->account_by_name(acc_name)).num_records() > 0;
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
 }
 
 GLJournal GLDatabase::get_je_by_id(const std::string& je_id) {
     Table table{m_dbc.select(m_sql->je_by_id(je_id))};
-    GLJournal j{std::stoul(table.get_field("entity", 0)),
-                std::stoi(table.get_field("period", 0)),
-                std::stoi(table.get_field("year", 0)),
-                table.get_field("source", 0),
-                table.get_field("memo", 0),
-                std::stoul(table.get_field("id", 0)),
-                std::stoul(table.get_field("user", 0))};
-
-    Table lines{m_dbc.select(m_sql->jelines_by_id(je_id))};
-    for ( const auto& line : lines ) {
-        j.add_line(line[0], currency_from_string(line[1]));
-    }
-    if ( !j.balances() ) {
-        throw GLDBException("Journal entry doesn't balance after retrieval");
-    }
-    return j;
+    const int year = std::stoi(table.get_field("year", 0));
+    return create_journal(table,
+                          m_dbc.select(m_sql->jelines_by_id(je_id, year)));
 }
 
 void GLDatabase::post_journal(const GLJournal& journal)
@@ -257,17 +642,86 @@ void GLDatabase::post_journal(const GLJournal& journal)
     m_dbc.query(query);
 
     const int n = m_dbc.last_auto_increment();
+    std::vector<std::string> lines;
     for ( const auto& line : journal ) {
-        std::string query = m_sql->post_je_line(n, line.account(),
-                line.amount().string());
-        m_dbc.query(query);
+        lines.push_back(m_sql->post_je_line(n, journal.year(),
+                line.account(), line.amount().string()));
     }
 
+    try {
+        m_dbc.query_batch(lines);
+    }
+    catch ( const DBConnBatchFailed& e ) {
+        std::ostringstream ss;
+        ss << "Could not post line " << e.index() + 1 << ": " << e.what();
+        throw GLDBException(ss.str());
+    }
+
+    bump_ledger_version();
     txn.commit();
 }
 
+unsigned long long GLDatabase::jeline_count()
+{
+    unsigned long long last_id;
+    return jeline_count(last_id);
+}
+
+unsigned long long GLDatabase::jeline_count(unsigned long long& last_id) try
+{
+    Table table{m_dbc.select(m_sql->count_jelines())};
+    const std::string last = table.get_field("last", 0);
+    last_id = last.empty() ? 0 : std::stoull(last);
+    return std::stoull(table.get_field("count", 0));
+}
+catch ( const DBConnException& e ) {
+    throw GLDBException(e.what());
+}
+catch ( const gldb::TableException& e ) {
+    throw GLDBException("Could not count journal entry lines");
+}
+
+Table GLDatabase::jelines_page(const unsigned long long after_id,
+                               const size_t skip,
+                               const size_t count)
+{
+    return m_dbc.select(m_sql->jelines_page(after_id, skip, count));
+}
+
+Table GLDatabase::jelines_page_before(const unsigned long long before_id,
+                                      const size_t skip,
+                                      const size_t count)
+{
+    Table descending{m_dbc.select(m_sql->jelines_page_before(before_id,
+                                                             skip, count))};
+    Table table{descending.get_headers()};
+    for ( size_t i = descending.num_records(); i > 0; --i ) {
+        table.append_record(descending[i - 1]);
+    }
+    return table;
+}
+
 GLReport GLDatabase::report(const std::string& report_name,
                             const std::string& arg)
+{
+    if ( !m_cache ) {
+        return run_report(report_name, arg);
+    }
+
+    const unsigned long long version = ledger_version();
+    std::shared_ptr<const GLReport> cached =
+        m_cache->find(report_name, arg, version);
+    if ( cached ) {
+        return *cached;
+    }
+
+    GLReport report = run_report(report_name, arg);
+    m_cache->store(report_name, arg, version, report);
+    return report;
+}
+
+GLReport GLDatabase::run_report(const std::string& report_name,
+                                const std::string& arg)
 {
     if ( report_name == "standingdata" ) {
         return standing_data_report();
@@ -275,6 +729,9 @@ GLReport GLDatabase::report(const std::string& report_name,
     else if ( report_name == "currenttb" ) {
         return current_trial_balance_report(arg);
     }
+    else if ( report_name == "comparetb" ) {
+        return comparative_trial_balance_report(arg);
+    }
     else if ( report_name == "listusers" ) {
         return list_users_report();
     }
@@ -297,21 +754,70 @@ GLReport GLDatabase::standing_data_report()
                       std::to_string(sd.year()));
     report.add_header("Number of accounting periods in a year",
                       std::to_string(sd.num_periods()));
+    report.add_header("Ledger version",
+                      std::to_string(sd.ledger_version()));
     return report;
 }
 
-GLReport GLDatabase::current_trial_balance_report(const std::string& entity)
+GLReport GLDatabase::current_trial_balance_report(const std::string& arg)
 {
-    std::string query;
-    if ( !entity.empty() ) {
-        query = m_sql->currenttb_by_entity(entity);
+    const TBFilter filter = tb_filter_from_arg(arg);
+    const bool filtered = !filter.entities.empty() ||
+                          !filter.first_account.empty() ||
+                          !filter.last_account.empty() ||
+                          !filter.threshold.empty() ||
+                          filter.nonzero || filter.top_n > 0;
+
+    const std::string query = filtered ? m_sql->currenttb_filtered(filter) :
+                                         m_sql->currenttb();
+
+    GLReport report{"Current Trial Balance Report",
+                    m_dbc.select(query)};
+    if ( filter.entities.size() == 1 ) {
+        GLEntity e = get_entity_by_id(filter.entities[0]);
+        std::ostringstream ss;
+        ss << e.name() << " [" << e.id() << "]";
+        report.add_header("Entity", ss.str());
     }
-    else {
-        query = m_sql->currenttb();
+    else if ( filter.entities.size() > 1 ) {
+        std::string entities;
+        report.add_header("Entities", pgutils::join(filter.entities,
+                                                    entities, ','));
+    }
+    if ( !filter.first_account.empty() && !filter.last_account.empty() ) {
+        report.add_header("Accounts", filter.first_account + " to " +
+                                      filter.last_account);
     }
+    else if ( !filter.first_account.empty() ) {
+        report.add_header("Accounts", filter.first_account + " onwards");
+    }
+    else if ( !filter.last_account.empty() ) {
+        report.add_header("Accounts", "up to " + filter.last_account);
+    }
+    if ( !filter.threshold.empty() ) {
+        report.add_header("Minimum absolute balance", filter.threshold);
+    }
+    if ( filter.nonzero ) {
+        report.add_header("Non-zero balances only", "Yes");
+    }
+    if ( filter.top_n > 0 ) {
+        report.add_header("Largest balances", std::to_string(filter.top_n));
+    }
+    return report;
+}
 
-    GLReport report{"Current Trial Balance Report",
-                    decorated_report_from_table(m_dbc.select(query))};
+GLReport GLDatabase::comparative_trial_balance_report(const std::string& arg)
+{
+    const GLStandingData sd = get_standing_data();
+    const TBComparison cmp = tb_comparison_from_arg(arg, sd.year(),
+                                                    sd.period(),
+                                                    sd.num_periods());
+    const std::string& entity = cmp.entity;
+
+    GLReport report{"Comparative Trial Balance Report",
+                    m_dbc.select(m_sql->comparativetb(cmp.columns, entity))};
+    report.add_header("Period", std::to_string(cmp.period));
+    report.add_header("Year", std::to_string(cmp.year));
     if ( !entity.empty() ) {
         GLEntity e = get_entity_by_id(entity);
         std::ostringstream ss;
@@ -324,29 +830,44 @@ GLReport GLDatabase::current_trial_balance_report(const std::string& entity)
 GLReport GLDatabase::list_users_report()
 {
     const std::string query = m_sql->listusers();
-    return GLReport{"Users List Report",
-                    decorated_report_from_table(m_dbc.select(query))};
+    return GLReport{"Users List Report", m_dbc.select(query)};
 }
 
 GLReport GLDatabase::je_report(const std::string& je_id)
 {
-    GLJournal j = get_je_by_id(je_id);
+
+    /*  Everything but the header depends only on the header, so the
+     *  lines, entity and user are all started before waiting for any of
+     *  them, on other connections where the pool has them free. The
+     *  lines come back with their account descriptions.                */
+
+    Table header{m_dbc.select(m_sql->je_by_id(je_id))};
+    const int year = std::stoi(header.get_field("year", 0));
+    std::future<Table> lines_result =
+        select_concurrently(m_sql->jelines_with_accounts(je_id, year));
+    std::future<Table> entity_result =
+        select_concurrently(m_sql->entity_by_id(header.get_field("entity", 0)));
+    std::future<Table> user_result =
+        select_concurrently(m_sql->user_by_id(header.get_field("user", 0)));
+
+    Table line_table{lines_result.get()};
+    GLJournal j = create_journal(header, line_table);
 
     TableRow headers{"Account", "Description", "Amount"};
     Table lines{headers};
 
+    size_t i = 0;
     for ( const auto& line : j ) {
-        GLAccount acct = get_account_by_name(line.account());
         TableRow row{line.account(),
-                     acct.description(),
+                     line_table.get_field("description", i++),
                      line.amount().string()};
         lines.append_record(row);
     }
 
-    GLReport report{"Single JE report",
-                    decorated_report_from_table(lines)};
+    GLReport report{"Single JE report", std::move(lines)};
 
-    GLEntity e = get_entity_by_id(std::to_string(j.entity()));
+    Table entity_table{entity_result.get()};
+    GLEntity e = create_entity(entity_table);
     std::ostringstream es;
     es << e.name() << " [" << e.id() << "]";
     report.add_header("Entity", es.str());
@@ -356,7 +877,8 @@ GLReport GLDatabase::je_report(const std::string& je_id)
     report.add_header("Source", j.source());
     report.add_header("Memo", j.memo());
 
-    GLUser u = get_user_by_id(std::to_string(j.user()));
+    Table user_table{user_result.get()};
+    GLUser u = create_user(user_table);
     std::ostringstream us;
     us << u.username() << " [" << u.id() << "]";
     report.add_header("Posted by", us.str());
@@ -364,6 +886,28 @@ GLReport GLDatabase::je_report(const std::string& je_id)
     return report;
 }
 
+std::future<Table> GLDatabase::select_concurrently(const std::string& sql)
+{
+    if ( m_pool ) {
+        std::unique_ptr<GLDatabasePool::Lease> lease{m_pool->try_acquire()};
+        if ( lease ) {
+
+            /*  The lease is shared with the query's thread, and so
+             *  returned to the pool when the query finishes            */
+
+            std::shared_ptr<GLDatabasePool::Lease> held{std::move(lease)};
+            return std::async(std::launch::async, [held, sql]() {
+                const BackendThread backend_thread;
+                return (*held)->m_dbc.select(sql);
+            });
+        }
+    }
+
+    return std::async(std::launch::deferred, [this, sql]() {
+        return m_dbc.select(sql);
+    });
+}
+
 static bool boolstring_to_bool(const std::string& bs) {
     if ( bs == "1" || bs == "TRUE" ) {
         return true;
@@ -376,3 +920,27 @@ static bool boolstring_to_bool(const std::string& bs) {
     }
 }
 
+static GLAccount create_account(Table& table) {
+    const bool enabled = boolstring_to_bool(table.get_field("enabled", 0));
+    return GLAccount{table.get_field("num", 0),
+                     table.get_field("description", 0),
+                     enabled};
+}
+
+static GLJournal create_journal(Table& je, const Table& lines) {
+    GLJournal j{std::stoul(je.get_field("entity", 0)),
+                std::stoi(je.get_field("period", 0)),
+                std::stoi(je.get_field("year", 0)),
+                je.get_field("source", 0),
+                je.get_field("memo", 0),
+                std::stoul(je.get_field("id", 0)),
+                std::stoul(je.get_field("user", 0))};
+
+    for ( const auto& line : lines ) {
+        j.add_line(line[0], currency_from_string(line[1]));
+    }
+    if ( !j.balances() ) {
+        throw GLDBException("Journal entry doesn't balance after retrieval");
+    }
+    return j;
+}
@@ -9,12 +9,16 @@
 #ifndef PG_GENERAL_LEDGER_GL_DATABASE_H
 #define PG_GENERAL_LEDGER_GL_DATABASE_H
 
+#include <functional>
+#include <future>
+#include <memory>
 #include <vector>
 #include <string>
 #include "database/database.h"
 #include "dbsql/dbsql.h"
 #include "gluser.h"
 #include "glreport.h"
+#include "glreportcache.h"
 #include "gljournal.h"
 #include "glentity.h"
 #include "glaccount.h"
@@ -22,6 +26,8 @@
 
 namespace genleg {
 
+class GLDatabasePool;
+
 /*!
  * \brief       General ledger database class
  * \ingroup     gldatabase
@@ -51,12 +57,91 @@ class GLDatabase {
          */
         void create_structure();
 
+        /*!
+         * \brief               Creates the database structure, with the
+         * journal entry tables partitioned by accounting year.
+         * \param first_year    The first year for which to create a
+         * partition.
+         * \param last_year     The last year for which to create a
+         * partition.
+         * \throws              GLDBException on error.
+         */
+        void create_structure(const int first_year, const int last_year);
+
+        /*!
+         * \brief           Adds a partition for a new accounting year to
+         * the partitioned journal entry tables.
+         * \param year      The year for which to add the partition.
+         * \throws          GLDBException on error.
+         */
+        void add_year_partition(const int year);
+
+        /*!
+         * \brief           Moves an accounting year's partition out of the
+         * journal entry tables into separate archive tables.
+         * \param year      The year to archive.
+         * \throws          GLDBException on error.
+         */
+        void archive_year_partition(const int year);
+
         /*!
          * \brief           Destroys the database structure.
          * \throws          GLDBException on error.
          */
         void destroy_structure();
 
+        /*!
+         * \brief           Creates the secondary indexes.
+         * \details         Called by create_structure(), and may be called
+         * separately to add the indexes to a database created without them.
+         * \throws          GLDBException on error.
+         */
+        void create_indexes();
+
+        /*!
+         * \brief           Returns the state of each schema version.
+         * \returns         A GLReport object with the report.
+         * \throws          GLDBException on error.
+         */
+        GLReport migration_status();
+
+        /*!
+         * \brief               Returns the statements which migrating to
+         * the latest schema version would run, without running them.
+         * \param chunk_rows    The number of keys in each backfill chunk.
+         * \returns             A GLReport object with the report.
+         * \throws              GLDBException on error.
+         */
+        GLReport migration_plan(const unsigned long long chunk_rows);
+
+        /*!
+         * \brief               Migrates the schema to the latest version.
+         * \details             Backfills are run in chunks, each committed
+         * with its progress, so a migration may be spread over several runs
+         * by limiting the number of chunks.
+         * \param chunk_rows    The number of keys in each backfill chunk.
+         * \param max_chunks    The most chunks to run, or 0 for no limit.
+         * \param progress      Called with a message after each step and
+         * chunk, if set.
+         * \returns             \c true if the schema is at the latest
+         * version, \c false if the chunk limit was reached first.
+         * \throws              GLDBException on error.
+         */
+        bool migrate(const unsigned long long chunk_rows,
+                     const size_t max_chunks,
+                     const std::function<void(const std::string&)>&
+                         progress);
+
+        /*!
+         * \brief           Shows the execution plan for each report and
+         * lookup statement.
+         * \details         Any statement which reads a whole table is
+         * flagged as a full scan.
+         * \returns         A GLReport object with the report.
+         * \throws          GLDBException on error.
+         */
+        GLReport explain_statements();
+
         /*!
          * \brief           Loads sample data into the database.
          * \param dir       The directory containing the sample data.
@@ -66,20 +151,119 @@ class GLDatabase {
          */
         void load_sample_data(const std::string& dir);
 
+        /*!
+         * \brief           Builds a balance cube file.
+         * \details         Balances are aggregated by the database and read
+         * in a single transaction, so the cube matches the ledger version
+         * it records.
+         * \param filename  The name of the cube file.
+         * \throws          GLDBException on error.
+         */
+        void build_cube(const std::string& filename);
+
         /*!
          * \brief           Returns the backend database implementation.
          * \details         This may be called to discover which database
-         * platform support has been compiled into the application.
+         * platform support has been compiled into the application, or
+         * loaded by \c select_backend().
          * \returns         A string containing the database platform name.
          */
         static std::string backend();
 
+        /*!
+         * \brief           Selects the backend database implementation.
+         * \details         Databases opened after this call use the
+         * selected backend, which may be loaded from a plugin at run time.
+         * \param backend   \c builtin or the empty string for the backend
+         * compiled into the program, or the name or path of a plugin.
+         * \throws          GLDBException if the plugin could not be loaded.
+         */
+        static void select_backend(const std::string& backend);
+
+        /*!
+         * \brief           Records database operations to a capture file.
+         * \details         Databases opened after this call with the
+         * selected backend record every query and its result, so that a
+         * run may be replayed later without a database.
+         * \param filename  The capture file, which is overwritten.
+         * \throws          GLDBException if the file could not be created.
+         */
+        static void record_queries(const std::string& filename);
+
+        /*!
+         * \brief           Replays database operations from a capture file.
+         * \details         Databases opened after this call serve the
+         * recorded results instead of connecting to a database. A query
+         * which was not recorded fails.
+         * \param filename  The capture file.
+         * \param timed     \c true to take as long over each query as it
+         * took when recorded.
+         * \throws          GLDBException if the file could not be read.
+         */
+        static void replay_queries(const std::string& filename,
+                                   const bool timed);
+
+        /*!
+         * \brief           Turns on the slow query log.
+         * \details         Statements taking at least the threshold are
+         * written to the standard error stream.
+         * \param msecs     The threshold in milliseconds.
+         * \throws          GLDBException if the threshold is not a number.
+         */
+        static void set_slow_query_threshold(const std::string& msecs);
+
+        /*!
+         * \brief           Writes the query statistics report to the
+         * standard error stream when the program exits.
+         */
+        static void report_query_stats_at_exit();
+
+        /*!
+         * \brief           Returns the query statistics.
+         * \details         Latency, row and byte counts for every class
+         * of statement run so far by any database in the program.
+         * \returns         A GLReport object with the report.
+         */
+        static GLReport query_stats_report();
+
         /*!
          * \brief           Gets the standing data.
          * \returns         The standing data.
          */
         GLStandingData get_standing_data();
 
+        /*!
+         * \brief           Returns the current ledger version.
+         * \details         The ledger version is incremented by every
+         * GLDatabase method which changes what a report could show:
+         * posting a journal entry, changing users or permissions, loading
+         * sample data, archiving a year and completing a migration.
+         * \returns         The current ledger version.
+         * \throws          GLDBException on error.
+         */
+        unsigned long long ledger_version();
+
+        /*!
+         * \brief           Sets the cache used by report().
+         * \details         A cache may be shared between connections.
+         * \param cache     The cache, or an empty pointer to disable
+         * caching.
+         */
+        void set_report_cache(std::shared_ptr<GLReportCache> cache) {
+            m_cache = cache;
+        }
+
+        /*!
+         * \brief           Sets the pool holding this connection.
+         * \details         Reports which run independent queries run them
+         * on other free connections from the pool at the same time.
+         * \param pool      The pool, or \c nullptr if the connection is
+         * not pooled.
+         */
+        void set_pool(GLDatabasePool * pool) {
+            m_pool = pool;
+        }
+
         /*!
          * \brief           Returns a user from an ID.
          * \param user_id   The user ID.
@@ -96,6 +280,19 @@ class GLDatabase {
          */
         GLUser get_user_by_username(const std::string& user_name);
 
+        /*!
+         * \brief           Adds new users.
+         * \details         Users are inserted several to a statement, all
+         * in one transaction, so either every user is added or none is.
+         * Their IDs and permissions are ignored.
+         * \param users         The users.
+         * \param batch_rows    The number of users to insert in each
+         * statement.
+         * \throws          GLDBException if a batch cannot be inserted.
+         */
+        void add_users(const std::vector<GLUser>& users,
+                       const size_t batch_rows = 500);
+
         /*!
          * \brief           Updates a user's details.
          * \param user      The user object.
@@ -115,6 +312,17 @@ class GLDatabase {
          * \param perm      A string containing the permission to revoke.
          */
         void revoke(const GLUser& user, const std::string& perm);
+
+        /*!
+         * \brief           Registers every permission in the perms table.
+         * \details         Permissions not built in are given the next
+         * free bits, which would otherwise happen as users holding them are
+         * first loaded.
+         * \returns         The names of built-in permissions missing from
+         * the perms table.
+         * \throws          GLDBException if there are too many permissions.
+         */
+        std::vector<std::string> sync_permissions();
         
         /*!
          * \brief           Returns an entity from an ID.
@@ -141,6 +349,14 @@ class GLDatabase {
          */
         GLAccount get_account_by_name(const std::string& acc_name);
 
+        /*!
+         * \brief           Checks whether an account exists.
+         * \param acc_name  The account name/number.
+         * \returns         \c true if the account exists.
+         * \throws          GLDBException on error.
+         */
+        bool account_exists(const std::string& acc_name);
+
         /*!
          * \brief               Returns a journal entry from an ID.
          * \param je_id         The journal entry ID.
@@ -154,8 +370,56 @@ class GLDatabase {
          */
         void post_journal(const GLJournal& journal);
 
+        /*!
+         * \brief               Returns the number of journal entry lines.
+         * \returns             The number of lines.
+         * \throws              GLDBException if the lines cannot be
+         * counted.
+         */
+        unsigned long long jeline_count();
+
+        /*!
+         * \brief               Returns the number of journal entry lines.
+         * \param last_id       Set to the ID of the last line, or 0 if
+         * there are none, counted at the same time.
+         * \returns             The number of lines.
+         * \throws              GLDBException if the lines cannot be
+         * counted.
+         */
+        unsigned long long jeline_count(unsigned long long& last_id);
+
+        /*!
+         * \brief               Returns a page of journal entry lines in ID
+         * order.
+         * \param after_id      Return only lines with a greater ID, or 0
+         * to start from the first line.
+         * \param skip          The number of lines to skip.
+         * \param count         The most lines to return.
+         * \returns             A table with \c id, \c je, \c year,
+         * \c account and \c amount columns.
+         */
+        gldb::Table jelines_page(const unsigned long long after_id,
+                                 const size_t skip,
+                                 const size_t count);
+
+        /*!
+         * \brief               Returns a page of journal entry lines
+         * counting back from a known ID.
+         * \param before_id     Return only lines with a lesser ID, or 0
+         * to count back from the last line.
+         * \param skip          The number of lines to skip back over.
+         * \param count         The most lines to return.
+         * \returns             A table with \c id, \c je, \c year,
+         * \c account and \c amount columns, in ascending ID order.
+         */
+        gldb::Table jelines_page_before(const unsigned long long before_id,
+                                        const size_t skip,
+                                        const size_t count);
+
         /*!
          * \brief               Runs a report
+         * \details             If a report cache is set, a report already
+         * run at the current ledger version is returned from the cache.
          * \param report_name   The name of the report.
          * \param arg           An optional argument.
          * \returns             A report object.
@@ -170,18 +434,53 @@ class GLDatabase {
         /*!  SQL statements object  */
         const std::shared_ptr<const DBSQLStatements> m_sql;
 
-        /*!  Vector containing database table names  */
-        const std::vector<std::string> m_tables;
+        /*!  Report cache, if any  */
+        std::shared_ptr<GLReportCache> m_cache;
+
+        /*!  Pool holding this connection, if any  */
+        GLDatabasePool * m_pool;
+
+        /*!
+         * \brief           Starts a select query on another connection.
+         * \details         The query runs on its own thread on a free
+         * connection from the pool, so several may run at once. If the
+         * connection is not pooled, or no other connection is free, the
+         * query instead runs on this connection when the result is waited
+         * for.
+         * \param sql       The query.
+         * \returns         A future holding the results.
+         */
+        std::future<gldb::Table> select_concurrently(const std::string& sql);
+
+        /*!
+         * \brief           Increments the ledger version.
+         * \details         Should be called within the same transaction as
+         * the change which requires it.
+         */
+        void bump_ledger_version();
 
-        /*!  Vector containing database view names  */
-        const std::vector<std::string> m_views;
+        /*!
+         * \brief               Runs a report without using the cache.
+         * \param report_name   The name of the report.
+         * \param arg           An optional argument.
+         * \returns             A report object.
+         */
+        GLReport run_report(const std::string& report_name,
+                            const std::string& arg);
+
+        /*!
+         * \brief           Creates the secondary indexes and the views.
+         * \details         Common to both create_structure() functions.
+         */
+        void create_indexes_and_views();
         
         /*!
          * \brief           Creates a user from a query table.
          * \details         Provided because the public functions can
          * get a user either from an ID or a name, this function contains
          * the common functionality.
-         * \param table     A table from the appropriate query.
+         * \param table     A table from the appropriate query, with one
+         * row for each permission the user holds.
          * \returns         The new user.
          */
         GLUser create_user(gldb::Table& table);
@@ -204,11 +503,32 @@ class GLDatabase {
 
         /*!
          * \brief           Returns a current trial balance report.
-         * \param entity    The entity for which to run the report, or
-         * an empty string for all entities.
+         * \details         \c arg is either an entity number, or a
+         * \c key=value;... string of filters as described for
+         * tb_filter_from_arg(). Filters are applied in the generated SQL.
+         * \param arg       The report argument, or an empty string for an
+         * unfiltered report of all entities.
+         * \returns         A GLReport object with the report.
+         * \throws          GLDBException on a bad argument.
+         */
+        GLReport current_trial_balance_report(const std::string& arg);
+
+        /*!
+         * \brief           Returns a comparative trial balance report.
+         * \details         \c arg is parsed by parse_report_args(), with
+         * the keys:
+         * - \c columns: a comma-separated list of \c current (the
+         *   period), \c prior (the previous period), \c prioryear (the same
+         *   period last year), \c ytd (the year to date) and \c priorytd
+         *   (last year to date). Defaults to \c current,prior,prioryear,ytd.
+         * - \c entity: the entity number, or all entities if not given.
+         * - \c year and \c period: the reporting period, which defaults to
+         *   the current period in the standing data.
+         * \param arg       The report argument string.
          * \returns         A GLReport object with the report.
+         * \throws          GLDBException on a bad argument.
          */
-        GLReport current_trial_balance_report(const std::string& entity);
+        GLReport comparative_trial_balance_report(const std::string& arg);
 
         /*!
          * \brief           Returns a list users report.
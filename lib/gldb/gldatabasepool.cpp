@@ -0,0 +1,70 @@
+/*!
+ * \file            gldatabasepool.cpp
+ * \brief           Implementation of General Ledger database connection pool
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include "gldatabasepool.h"
+#include "glexception.h"
+
+using namespace genleg;
+
+GLDatabasePool::GLDatabasePool(const std::string& database,
+                               const std::string& hostname,
+                               const std::string& username,
+                               const std::string& password,
+                               const size_t size) :
+    m_connections{},
+    m_free{},
+    m_mutex{},
+    m_cond{}
+{
+    if ( size == 0 ) {
+        throw GLDBException("Connection pool size must be at least 1");
+    }
+
+    for ( size_t i = 0; i < size; ++i ) {
+        m_connections.emplace_back(new GLDatabase(database, hostname,
+                                                  username, password));
+        m_connections.back()->set_pool(this);
+        m_free.push_back(m_connections.back().get());
+    }
+}
+
+void GLDatabasePool::set_report_cache(std::shared_ptr<GLReportCache> cache)
+{
+    for ( auto& gdb : m_connections ) {
+        gdb->set_report_cache(cache);
+    }
+}
+
+GLDatabasePool::Lease GLDatabasePool::acquire()
+{
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cond.wait(lock, [this] { return !m_free.empty(); });
+    GLDatabase * gdb = m_free.back();
+    m_free.pop_back();
+    return Lease{*this, *gdb};
+}
+
+std::unique_ptr<GLDatabasePool::Lease> GLDatabasePool::try_acquire()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if ( m_free.empty() ) {
+        return std::unique_ptr<Lease>{};
+    }
+    GLDatabase * gdb = m_free.back();
+    m_free.pop_back();
+    return std::unique_ptr<Lease>{new Lease{*this, *gdb}};
+}
+
+void GLDatabasePool::release(GLDatabase * gdb)
+{
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_free.push_back(gdb);
+    }
+    m_cond.notify_one();
+}
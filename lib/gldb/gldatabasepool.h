@@ -0,0 +1,164 @@
+/*!
+ * \file            gldatabasepool.h
+ * \brief           Interface to General Ledger database connection pool
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_GL_DATABASE_POOL_H
+#define PG_GENERAL_LEDGER_GL_DATABASE_POOL_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "gldatabase.h"
+
+namespace genleg {
+
+/*!
+ * \brief       General ledger database connection pool class.
+ * \details     Opens a fixed number of database connections up front,
+ * and hands them out to threads one at a time. A thread which acquires a
+ * connection has exclusive use of it until its lease is destroyed.
+ * \ingroup     gldatabase
+ */
+class GLDatabasePool {
+    public:
+
+        /*!
+         * \brief       Exclusive lease on a pooled connection.
+         * \details     The connection is returned to the pool when the
+         * lease is destroyed.
+         */
+        class Lease {
+            public:
+
+                /*!
+                 * \brief           Constructor.
+                 * \param pool      The pool owning the connection.
+                 * \param gdb       The leased connection.
+                 */
+                Lease (GLDatabasePool& pool, GLDatabase& gdb) :
+                    m_pool(&pool), m_gdb(&gdb) {}
+
+                /*!  Deleted copy constructor  */
+                Lease (const Lease&) = delete;
+
+                /*!  Deleted copy assignment operator  */
+                Lease& operator=(const Lease&) = delete;
+
+                /*!
+                 * \brief           Move constructor.
+                 * \param other     The lease from which to move.
+                 */
+                Lease (Lease&& other) :
+                    m_pool(other.m_pool), m_gdb(other.m_gdb) {
+                    other.m_pool = nullptr;
+                    other.m_gdb = nullptr;
+                }
+
+                /*!  Destructor, returning the connection to the pool  */
+                ~Lease () {
+                    if ( m_pool ) {
+                        m_pool->release(m_gdb);
+                    }
+                }
+
+                /*!
+                 * \brief           Returns the leased connection.
+                 * \returns         A reference to the leased connection.
+                 */
+                GLDatabase& operator*() const { return *m_gdb; }
+
+                /*!
+                 * \brief           Returns the leased connection.
+                 * \returns         A pointer to the leased connection.
+                 */
+                GLDatabase * operator->() const { return m_gdb; }
+
+            private:
+
+                /*!  The pool owning the connection  */
+                GLDatabasePool * m_pool;
+
+                /*!  The leased connection  */
+                GLDatabase * m_gdb;
+        };
+
+        /*!
+         * \brief           Constructor.
+         * \param database  Database name.
+         * \param hostname  Hostname of database machine.
+         * \param username  Username to log into database.
+         * \param password  Password to log into database.
+         * \param size      The number of connections to open.
+         * \throws          GLDBException on error.
+         */
+        GLDatabasePool (const std::string& database,
+                        const std::string& hostname,
+                        const std::string& username,
+                        const std::string& password,
+                        const size_t size);
+
+        /*!  Deleted copy constructor  */
+        GLDatabasePool (const GLDatabasePool&) = delete;
+
+        /*!  Deleted copy assignment operator  */
+        GLDatabasePool& operator=(const GLDatabasePool&) = delete;
+
+        /*!
+         * \brief           Returns the number of connections in the pool.
+         * \returns         The number of connections in the pool.
+         */
+        size_t size() const { return m_connections.size(); }
+
+        /*!
+         * \brief           Sets the report cache for every connection.
+         * \param cache     The cache, or an empty pointer to disable
+         * caching.
+         */
+        void set_report_cache(std::shared_ptr<GLReportCache> cache);
+
+        /*!
+         * \brief           Acquires a connection, waiting until one is free.
+         * \returns         A lease on the connection.
+         */
+        Lease acquire();
+
+        /*!
+         * \brief           Acquires a connection if one is free.
+         * \details         Does not wait, so a thread which already holds
+         * a connection may call it without risk of deadlock.
+         * \returns         A lease on the connection, or an empty pointer
+         * if every connection is leased.
+         */
+        std::unique_ptr<Lease> try_acquire();
+
+    private:
+
+        /*!  The pooled connections  */
+        std::vector<std::unique_ptr<GLDatabase>> m_connections;
+
+        /*!  The connections not currently leased  */
+        std::vector<GLDatabase *> m_free;
+
+        /*!  Mutex guarding the free list  */
+        std::mutex m_mutex;
+
+        /*!  Signalled when a connection is returned  */
+        std::condition_variable m_cond;
+
+        /*!
+         * \brief           Returns a connection to the pool.
+         * \param gdb       The connection.
+         */
+        void release(GLDatabase * gdb);
+
+};              //  class GLDatabasePool
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_GL_DATABASE_POOL_H
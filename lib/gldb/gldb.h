@@ -11,8 +11,15 @@
 
 #include "glexception.h"
 #include "gldatabase.h"
+#include "gldatabasepool.h"
+#include "glmigration.h"
+#include "glpermission.h"
 #include "gluser.h"
 #include "glreport.h"
+#include "glreportcache.h"
+#include "glcube.h"
+#include "glclient.h"
+#include "glserver.h"
 #include "gljournal.h"
 #include "glentity.h"
 #include "glaccount.h"
@@ -15,13 +15,19 @@ using pgutils::Currency;
 using pgutils::split_lines;
 using pgutils::currency_from_string;
 
+pgutils::SymbolTable& genleg::account_symbols()
+{
+    static pgutils::SymbolTable symbols;
+    return symbols;
+}
+
 bool GLJournal::balances() const
 {
-    Currency sum;
+    int64_t sum = 0;
     for ( const auto& line : m_lines ) {
-        sum += line.amount();
+        sum += line.cents();
     }
-    return sum == Currency{0, 0};
+    return sum == 0;
 }
 
 GLJournal genleg::journal_from_stream(std::istream& ifs)
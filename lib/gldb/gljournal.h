@@ -9,6 +9,7 @@
 #ifndef PG_GENERAL_LEDGER_JOURNAL_ENTRY_H
 #define PG_GENERAL_LEDGER_JOURNAL_ENTRY_H
 
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -16,8 +17,20 @@
 
 namespace genleg {
 
+/*!
+ * \brief           Returns the process-wide account symbol table.
+ * \details         Account numbers/names used in journal entry lines are
+ * interned in this table and referred to by their dense integer IDs.
+ * \ingroup         gldatabase
+ * \returns         A reference to the account symbol table.
+ */
+pgutils::SymbolTable& account_symbols();
+
 /*!
  * \brief           Journal entry line class.
+ * \details         Lines are stored as a compact record of an interned
+ * account ID and an amount in cents, so collections of lines can be
+ * processed as flat arrays.
  * \ingroup         gldatabase
  */
 class GLJELine {
@@ -28,29 +41,54 @@ class GLJELine {
          * \param account   The account name/ID
          * \param amount    The currency amount
          */
-        GLJELine (const std::string account,
+        GLJELine (const std::string& account,
                   const pgutils::Currency& amount) :
-            m_acct{account}, m_amount{amount} {};
+            m_acct{account_symbols().intern(account)},
+            m_cents{amount.cents()} {};
+
+        /*!
+         * \brief           Constructor
+         * \param acct_id   The interned account ID
+         * \param cents     The amount in cents
+         */
+        GLJELine (const uint32_t acct_id, const int64_t cents) :
+            m_acct{acct_id}, m_cents{cents} {};
 
         /*!
          * \brief           Returns the account name/number.
          * \returns         The account name/number.
          */
-        std::string account() const { return m_acct; }
+        const std::string& account() const {
+            return account_symbols().name(m_acct);
+        }
+
+        /*!
+         * \brief           Returns the interned account ID.
+         * \returns         The interned account ID.
+         */
+        uint32_t account_id() const { return m_acct; }
 
         /*!
          * \brief           Returns the currency amount.
          * \returns         The currency amount.
          */
-        pgutils::Currency amount() const { return m_amount; }
+        pgutils::Currency amount() const {
+            return pgutils::Currency::from_cents(m_cents);
+        }
+
+        /*!
+         * \brief           Returns the amount in cents.
+         * \returns         The amount in cents.
+         */
+        int64_t cents() const { return m_cents; }
 
     private:
 
-        /*!  Account number/name  */
-        std::string m_acct;
+        /*!  Interned account ID  */
+        uint32_t m_acct;
 
-        /*!  Amount  */
-        pgutils::Currency m_amount;
+        /*!  Amount in cents  */
+        int64_t m_cents;
 
 };              //  class GLJELine
 
@@ -153,6 +191,22 @@ class GLJournal {
             m_lines.push_back(GLJELine{account, amount});
         }
 
+        /*!
+         * \brief           Adds a journal entry line by account ID.
+         * \param acct_id   The interned account ID.
+         * \param cents     The amount in cents.
+         */
+        void add_line(const uint32_t acct_id, const int64_t cents) {
+            m_lines.push_back(GLJELine{acct_id, cents});
+        }
+
+        /*!
+         * \brief           Returns a pointer to the array of lines.
+         * \returns         A pointer to the first of \c num_lines()
+         * contiguous lines.
+         */
+        const GLJELine * lines() const { return m_lines.data(); }
+
         /*!
          * \brief           Checks if the journal entry lines balance.
          * \retval true     If the journal entry lines balance.
@@ -160,8 +214,11 @@ class GLJournal {
          */
         bool balances() const;
 
+        /*!  Alias for line storage  */
+        using line_vector = pgutils::SmallVector<GLJELine, 8>;
+
         /*!  Alias for iterator  */
-        using iterator = std::vector<GLJELine>::iterator;
+        using iterator = line_vector::iterator;
 
         /*!
          * \brief           Returns an iterator to the first line.
@@ -176,7 +233,7 @@ class GLJournal {
         iterator end() { return m_lines.end(); }
 
         /*!  Alias for const iterator  */
-        using const_iterator = std::vector<GLJELine>::const_iterator;
+        using const_iterator = line_vector::const_iterator;
 
         /*!
          * \brief           Returns a const iterator to the first line.
@@ -214,7 +271,7 @@ class GLJournal {
         size_t m_user;
 
         /*!  A vector of journal entry lines.  */
-        std::vector<GLJELine> m_lines;
+        line_vector m_lines;
 
 };              //  class GLJournal
 
@@ -0,0 +1,500 @@
+/*!
+ * \file            glmigration.cpp
+ * \brief           Implementation of General Ledger schema migration classes
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include "glmigration.h"
+#include "gldatabase.h"
+#include "glexception.h"
+
+using namespace genleg;
+using namespace gldb;
+
+/*!
+ * \brief           Returns a description of a step.
+ * \param step      The step.
+ * \returns         The description.
+ */
+static std::string step_description(const MigrationStep& step);
+
+const std::vector<Migration>& genleg::gl_migrations() {
+    static const std::vector<Migration> migrations{
+        {1, "Initial schema", {}},
+        {2, "Add secondary indexes", {
+            {MigrationStepType::add_index, SchemaTable::jes,
+             SchemaIndex::jes_entity_period_idx, nullptr, nullptr},
+            {MigrationStepType::add_index, SchemaTable::jelines,
+             SchemaIndex::jelines_je_account_idx, nullptr, nullptr},
+            {MigrationStepType::add_index, SchemaTable::jelines,
+             SchemaIndex::jelines_account_je_idx, nullptr, nullptr}
+        }},
+        {3, "Add journal entry year to lines", {
+            {MigrationStepType::add_column, SchemaTable::jelines,
+             SchemaIndex::count, "year", "INTEGER NOT NULL DEFAULT 0"},
+            {MigrationStepType::backfill, SchemaTable::jelines,
+             SchemaIndex::count, "id",
+             "year = (SELECT jes.year FROM jes WHERE jes.id = jelines.je)"},
+            {MigrationStepType::recreate_views, SchemaTable::count,
+             SchemaIndex::count, nullptr, nullptr}
+        }},
+        {4, "Add ledger version", {
+            {MigrationStepType::add_column, SchemaTable::standing_data,
+             SchemaIndex::count, "ledger_version",
+             "BIGINT NOT NULL DEFAULT 0"}
+        }},
+        {5, "Widen password columns", {
+            {MigrationStepType::modify_column, SchemaTable::users,
+             SchemaIndex::count, "pass_hash",
+             "VARCHAR(128) NOT NULL DEFAULT 'Not set'"},
+            {MigrationStepType::modify_column, SchemaTable::users,
+             SchemaIndex::count, "pass_salt",
+             "VARCHAR(64) NOT NULL DEFAULT 'XX'"}
+        }},
+        {6, "Store amounts exactly", {
+            {MigrationStepType::store_amounts, SchemaTable::jelines,
+             SchemaIndex::count, "id", "amount"}
+        }}
+    };
+    return migrations;
+}
+
+GLMigrator::GLMigrator(DBConn& dbc,
+                       const DBSQLStatements& sql,
+                       const std::vector<Migration>& migrations) :
+    m_dbc(dbc), m_sql(sql), m_migrations(migrations)
+{
+    if ( m_migrations.empty() || m_migrations[0].version != 1 ) {
+        throw GLDBException("Migrations must start at version 1");
+    }
+    for ( size_t i = 1; i < m_migrations.size(); ++i ) {
+        if ( m_migrations[i].version <= m_migrations[i - 1].version ) {
+            throw GLDBException("Migrations are out of order");
+        }
+    }
+}
+
+unsigned int GLMigrator::latest_version() const {
+    return m_migrations.back().version;
+}
+
+unsigned int GLMigrator::current_version() {
+    unsigned int version = 1;
+    for ( const auto& entry : read_versions() ) {
+        if ( entry.second.done ) {
+            version = entry.first;
+        }
+    }
+    return version;
+}
+
+bool GLMigrator::has_version_table() {
+    try {
+        m_dbc.select(m_sql.column_probe(SchemaTable::schema_version,
+                                        "version"));
+        return true;
+    }
+    catch ( const DBConnCouldNotQuery& e ) {
+        return false;
+    }
+}
+
+void GLMigrator::stamp() {
+    for ( const auto& migration : m_migrations ) {
+        m_dbc.query(m_sql.add_schema_version(migration.version,
+                                             migration.description, true));
+    }
+}
+
+Table GLMigrator::status() {
+    const std::map<unsigned int, VersionState> versions = read_versions();
+    Table table{TableRow{"Version", "Description", "State", "Applied"}};
+
+    for ( const auto& migration : m_migrations ) {
+        std::string state;
+        std::string applied;
+        const auto found = versions.find(migration.version);
+
+        if ( found == versions.end() ) {
+            state = migration.version == 1 ? "Applied" : "Pending";
+        }
+        else if ( found->second.done ) {
+            state = "Applied";
+            applied = found->second.applied;
+        }
+        else {
+            std::ostringstream ss;
+            ss << "In progress, step " << found->second.step + 1 << " of "
+               << migration.steps.size();
+            if ( found->second.progress ) {
+                ss << " done to key " << found->second.progress;
+            }
+            state = ss.str();
+        }
+
+        table.append_record(TableRow{std::to_string(migration.version),
+                                     migration.description,
+                                     state, applied});
+    }
+
+    return table;
+}
+
+Table GLMigrator::plan(const unsigned long long chunk_rows) {
+    const std::map<unsigned int, VersionState> versions = read_versions();
+    Table table{TableRow{"Version", "Step", "Statement"}};
+
+    if ( versions.empty() ) {
+        table.append_record(TableRow{"1", "-",
+                m_sql.create_table(SchemaTable::schema_version)});
+    }
+
+    for ( const auto& migration : m_migrations ) {
+        const auto found = versions.find(migration.version);
+        if ( migration.version == 1 ||
+             (found != versions.end() && found->second.done) ) {
+            continue;
+        }
+
+        const std::string version = std::to_string(migration.version);
+        size_t first_step = 0;
+        unsigned long long done_to = 0;
+        if ( found == versions.end() ) {
+            table.append_record(TableRow{version, "-",
+                    m_sql.add_schema_version(migration.version,
+                                             migration.description,
+                                             false)});
+        }
+        else {
+            first_step = found->second.step;
+            done_to = found->second.progress;
+        }
+
+        for ( size_t i = first_step; i < migration.steps.size(); ++i ) {
+            const MigrationStep& step = migration.steps[i];
+            const std::string step_num = std::to_string(i + 1);
+
+            if ( not_needed(step) ) {
+                table.append_record(TableRow{version, step_num,
+                        step_description(step) + " not needed, skipped"});
+                continue;
+            }
+            if ( already_done(step) ) {
+                table.append_record(TableRow{version, step_num,
+                        step_description(step) + " already done, skipped"});
+                continue;
+            }
+
+            switch ( step.type ) {
+                case MigrationStepType::add_column:
+                    table.append_record(TableRow{version, step_num,
+                            m_sql.add_column(step.table, step.column,
+                                             step.definition)});
+                    break;
+
+                case MigrationStepType::modify_column:
+                    table.append_record(TableRow{version, step_num,
+                            m_sql.modify_column(step.table, step.column,
+                                                step.definition)});
+                    break;
+
+                case MigrationStepType::add_index:
+                    table.append_record(TableRow{version, step_num,
+                            m_sql.create_index_online(step.index)});
+                    break;
+
+                case MigrationStepType::backfill:
+                case MigrationStepType::store_amounts: {
+                    unsigned long long first, last;
+                    if ( !backfill_range(step, first, last) ) {
+                        first = last = 0;
+                    }
+                    if ( i != first_step || done_to < first ) {
+                        done_to = first ? first - 1 : 0;
+                    }
+                    const unsigned long long keys =
+                        last > done_to ? last - done_to : 0;
+                    const unsigned long long chunks =
+                        (keys + chunk_rows - 1) / chunk_rows;
+                    std::ostringstream ss;
+                    ss << m_sql.backfill(step.table, set_clause(step),
+                                         step.column, done_to,
+                                         std::min(done_to + chunk_rows,
+                                                  last))
+                       << " (" << chunks << " chunks of " << chunk_rows
+                       << " keys, to key " << last << ")";
+                    table.append_record(TableRow{version, step_num,
+                                                 ss.str()});
+                    break;
+                }
+
+                case MigrationStepType::recreate_views:
+                    for ( size_t v = num_schema_views; v > 0; --v ) {
+                        table.append_record(TableRow{version, step_num,
+                                m_sql.drop_view(schema_views[v - 1].id)});
+                    }
+                    for ( const auto& view : schema_views ) {
+                        table.append_record(TableRow{version, step_num,
+                                m_sql.create_view(view.id)});
+                    }
+                    break;
+            }
+        }
+
+        table.append_record(TableRow{version, "-",
+                m_sql.finish_schema_version(migration.version)});
+    }
+
+    return table;
+}
+
+bool GLMigrator::migrate(const unsigned long long chunk_rows,
+                         const size_t max_chunks,
+                         const Progress& progress) {
+    if ( chunk_rows == 0 ) {
+        throw GLDBException("Backfill chunk size must not be zero");
+    }
+
+    std::map<unsigned int, VersionState> versions = read_versions();
+    if ( versions.empty() ) {
+        m_dbc.query(m_sql.create_table(SchemaTable::schema_version));
+        m_dbc.query(m_sql.add_schema_version(1, m_migrations[0].description,
+                                             true));
+    }
+
+    size_t chunks_left = max_chunks ? max_chunks :
+                                      std::numeric_limits<size_t>::max();
+
+    for ( const auto& migration : m_migrations ) {
+        auto found = versions.find(migration.version);
+        if ( migration.version == 1 ||
+             (found != versions.end() && found->second.done) ) {
+            continue;
+        }
+
+        size_t step_idx = 0;
+        unsigned long long done_to = 0;
+        if ( found == versions.end() ) {
+            m_dbc.query(m_sql.add_schema_version(migration.version,
+                                                 migration.description,
+                                                 false));
+        }
+        else {
+            step_idx = found->second.step;
+            done_to = found->second.progress;
+        }
+
+        for ( ; step_idx < migration.steps.size(); ++step_idx ) {
+            if ( !run_step(migration, step_idx, done_to, chunk_rows,
+                           chunks_left, progress) ) {
+                return false;
+            }
+            done_to = 0;
+            m_dbc.query(m_sql.update_schema_version(migration.version,
+                                                    step_idx + 1, 0));
+        }
+
+        m_dbc.query(m_sql.finish_schema_version(migration.version));
+        if ( progress ) {
+            progress("Version " + std::to_string(migration.version) +
+                     " applied: " + migration.description);
+        }
+    }
+
+    return true;
+}
+
+std::map<unsigned int, GLMigrator::VersionState> GLMigrator::read_versions() {
+    std::map<unsigned int, VersionState> versions;
+    if ( !has_version_table() ) {
+        return versions;
+    }
+
+    Table table{m_dbc.select(m_sql.schema_versions())};
+    for ( size_t i = 0; i < table.num_records(); ++i ) {
+        const unsigned int version = std::stoul(table.get_field("version", i));
+        versions[version] = VersionState{
+            std::stoul(table.get_field("step", i)),
+            std::stoull(table.get_field("progress", i)),
+            table.get_field("done", i) != "0",
+            table.get_field("applied", i)
+        };
+    }
+    return versions;
+}
+
+bool GLMigrator::backfill_range(const MigrationStep& step,
+                                unsigned long long& first,
+                                unsigned long long& last) {
+    Table range{m_dbc.select(m_sql.key_range(step.table, step.column))};
+    const std::string first_key = range.get_field("first", 0);
+    const std::string last_key = range.get_field("last", 0);
+    if ( first_key.empty() || last_key.empty() ) {
+        return false;
+    }
+    first = std::stoull(first_key);
+    last = std::stoull(last_key);
+    return true;
+}
+
+std::string GLMigrator::set_clause(const MigrationStep& step) const {
+    if ( step.type == MigrationStepType::store_amounts ) {
+        return std::string{step.definition} + " = " +
+               m_sql.amount_value(step.definition);
+    }
+    return step.definition;
+}
+
+bool GLMigrator::already_done(const MigrationStep& step) {
+    switch ( step.type ) {
+        case MigrationStepType::add_column:
+            try {
+                m_dbc.select(m_sql.column_probe(step.table, step.column));
+                return true;
+            }
+            catch ( const DBConnCouldNotQuery& e ) {
+                return false;
+            }
+
+        case MigrationStepType::add_index: {
+            Table count{m_dbc.select(m_sql.index_exists(step.index))};
+            return count.get_field("count", 0) != "0";
+        }
+
+        case MigrationStepType::store_amounts:
+            return m_sql.amount_value(step.definition) == step.definition;
+
+        default:
+            return false;
+    }
+}
+
+bool GLMigrator::not_needed(const MigrationStep& step) const {
+    return step.type == MigrationStepType::modify_column &&
+           !m_sql.enforces_column_types();
+}
+
+bool GLMigrator::run_step(const Migration& migration,
+                          const size_t step_idx,
+                          unsigned long long& done_to,
+                          const unsigned long long chunk_rows,
+                          size_t& chunks_left,
+                          const Progress& progress) {
+    const MigrationStep& step = migration.steps[step_idx];
+    const std::string prefix = "Version " +
+                               std::to_string(migration.version) + ": ";
+
+    if ( not_needed(step) ) {
+        if ( progress ) {
+            progress(prefix + step_description(step) + " not needed");
+        }
+        return true;
+    }
+    if ( already_done(step) ) {
+        if ( progress ) {
+            progress(prefix + step_description(step) + " already done");
+        }
+        return true;
+    }
+
+    switch ( step.type ) {
+        case MigrationStepType::add_column:
+            m_dbc.query(m_sql.add_column(step.table, step.column,
+                                         step.definition));
+            break;
+
+        case MigrationStepType::modify_column:
+            m_dbc.query(m_sql.modify_column(step.table, step.column,
+                                            step.definition));
+            break;
+
+        case MigrationStepType::add_index:
+            m_dbc.query(m_sql.create_index_online(step.index));
+            break;
+
+        case MigrationStepType::backfill:
+        case MigrationStepType::store_amounts: {
+            unsigned long long first, last;
+            if ( !backfill_range(step, first, last) ) {
+                break;
+            }
+            if ( done_to < first ) {
+                done_to = first - 1;
+            }
+
+            while ( done_to < last ) {
+                if ( chunks_left == 0 ) {
+                    return false;
+                }
+
+                const unsigned long long chunk_end =
+                    last - done_to > chunk_rows ? done_to + chunk_rows : last;
+                {
+                    GLDBTransaction txn{m_dbc};
+                    m_dbc.query(m_sql.backfill(step.table, set_clause(step),
+                                               step.column, done_to,
+                                               chunk_end));
+                    m_dbc.query(m_sql.update_schema_version(
+                                migration.version, step_idx, chunk_end));
+                    txn.commit();
+                }
+                done_to = chunk_end;
+                --chunks_left;
+
+                if ( progress ) {
+                    std::ostringstream ss;
+                    ss << prefix << "backfilled "
+                       << schema_def(step.table).name << " to key "
+                       << done_to << " of " << last;
+                    progress(ss.str());
+                }
+            }
+            return true;
+        }
+
+        case MigrationStepType::recreate_views:
+            for ( size_t v = num_schema_views; v > 0; --v ) {
+                try {
+                    m_dbc.query(m_sql.drop_view(schema_views[v - 1].id));
+                }
+                catch ( const DBConnCouldNotQuery& e ) {
+
+                    /*  A view missing from an old database is created  */
+
+                }
+            }
+            for ( const auto& view : schema_views ) {
+                m_dbc.query(m_sql.create_view(view.id));
+            }
+            break;
+    }
+
+    if ( progress ) {
+        progress(prefix + step_description(step) + " done");
+    }
+    return true;
+}
+
+static std::string step_description(const MigrationStep& step) {
+    switch ( step.type ) {
+        case MigrationStepType::add_column:
+            return std::string{"column "} + schema_def(step.table).name +
+                   "." + step.column;
+        case MigrationStepType::modify_column:
+            return std::string{"type of column "} +
+                   schema_def(step.table).name + "." + step.column;
+        case MigrationStepType::add_index:
+            return std::string{"index "} + schema_def(step.index).name;
+        case MigrationStepType::backfill:
+            return std::string{"backfill of "} + schema_def(step.table).name;
+        case MigrationStepType::store_amounts:
+            return std::string{"amounts in "} + schema_def(step.table).name;
+        default:
+            return "views";
+    }
+}
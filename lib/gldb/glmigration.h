@@ -0,0 +1,268 @@
+/*!
+ * \file            glmigration.h
+ * \brief           Interface to General Ledger schema migration classes
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_GL_MIGRATION_H
+#define PG_GENERAL_LEDGER_GL_MIGRATION_H
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "database/database.h"
+#include "dbsql/dbsql.h"
+
+namespace genleg {
+
+/*!
+ * \brief           Migration step type.
+ * \ingroup         gldatabase
+ */
+enum class MigrationStepType {
+    add_column,         /*!<  Adds a column, unless it exists  */
+    modify_column,      /*!<  Changes the type of a column  */
+    add_index,          /*!<  Adds an index, unless it exists  */
+    backfill,           /*!<  Updates a table in chunks of keys  */
+    store_amounts,      /*!<  Rewrites amounts as the backend stores them,
+                              in chunks of keys  */
+    recreate_views      /*!<  Drops and recreates every view  */
+};
+
+/*!
+ * \brief           Migration step.
+ * \details         Every step may be run again after an interruption
+ * without harm, and a backfill resumes from the last chunk committed.
+ * \ingroup         gldatabase
+ */
+struct MigrationStep {
+    /*!  The step type  */
+    MigrationStepType type;
+
+    /*!  The table, for \c add_column, \c modify_column and \c backfill  */
+    SchemaTable table;
+
+    /*!  The index, for \c add_index  */
+    SchemaIndex index;
+
+    /*!  The column name for \c add_column and \c modify_column, or the
+     *   integer key column for \c backfill and \c store_amounts  */
+    const char * column;
+
+    /*!  The column type and constraints for \c add_column and
+     *   \c modify_column, the \c SET clause for \c backfill, or the
+     *   amount column for \c store_amounts  */
+    const char * definition;
+};
+
+/*!
+ * \brief           Schema migration.
+ * \ingroup         gldatabase
+ */
+struct Migration {
+    /*!  The schema version the migration moves to  */
+    unsigned int version;
+
+    /*!  A description of the version  */
+    const char * description;
+
+    /*!  The steps  */
+    std::vector<MigrationStep> steps;
+};
+
+/*!
+ * \brief           Returns the general ledger migrations.
+ * \details         Version 1 is the schema before versioning, and has no
+ * steps. A newly created database is at the latest version, since it is
+ * created from the current schema registry.
+ * \ingroup         gldatabase
+ * \returns         The migrations, in order of version.
+ */
+const std::vector<Migration>& gl_migrations();
+
+/*!
+ * \brief           Schema migration engine class.
+ * \details         Applied versions, and the progress of a migration under
+ * way, are recorded in the \c schema_version table. A database without the
+ * table is taken to be at version 1. Each backfill chunk is committed in
+ * its own transaction together with its progress, so a migration may be
+ * run a few chunks at a time on a live database, and stopped and resumed
+ * at any point.
+ * \ingroup         gldatabase
+ */
+class GLMigrator {
+    public:
+
+        /*!  Progress callback type  */
+        using Progress = std::function<void(const std::string&)>;
+
+        /*!
+         * \brief               Constructor.
+         * \param dbc           The database connection.
+         * \param sql           The SQL statements object.
+         * \param migrations    The migrations, in order of version,
+         * starting with version 1.
+         * \throws              GLDBException if the migrations are out of
+         * order.
+         */
+        GLMigrator (gldb::DBConn& dbc,
+                    const DBSQLStatements& sql,
+                    const std::vector<Migration>& migrations =
+                        gl_migrations());
+
+        /*!
+         * \brief           Returns the latest schema version.
+         * \returns         The latest schema version.
+         */
+        unsigned int latest_version() const;
+
+        /*!
+         * \brief           Returns the schema version of the database.
+         * \returns         The highest version fully applied.
+         */
+        unsigned int current_version();
+
+        /*!
+         * \brief           Returns whether the database has a
+         * \c schema_version table.
+         * \returns         \c true if it has.
+         */
+        bool has_version_table();
+
+        /*!
+         * \brief           Records every version as applied, for a newly
+         * created structure.
+         */
+        void stamp();
+
+        /*!
+         * \brief           Returns the state of every version.
+         * \returns         A table with the version, description, state
+         * and time applied.
+         */
+        gldb::Table status();
+
+        /*!
+         * \brief               Returns the statements a migration would
+         * run, without running them.
+         * \param chunk_rows    The number of keys in each backfill chunk.
+         * \returns             A table with the version, step and
+         * statement.
+         */
+        gldb::Table plan(const unsigned long long chunk_rows);
+
+        /*!
+         * \brief               Migrates to the latest version.
+         * \param chunk_rows    The number of keys in each backfill chunk.
+         * \param max_chunks    The most backfill chunks to run, or 0 for
+         * no limit.
+         * \param progress      Called with a message after each step and
+         * chunk, if set.
+         * \returns             \c true if the database is at the latest
+         * version, \c false if the chunk limit was reached first.
+         */
+        bool migrate(const unsigned long long chunk_rows,
+                     const size_t max_chunks,
+                     const Progress& progress = Progress());
+
+    private:
+
+        /*!
+         * \brief           State of a recorded version.
+         */
+        struct VersionState {
+            /*!  The zero-based step in progress  */
+            size_t step;
+
+            /*!  The last key completed by the step in progress  */
+            unsigned long long progress;
+
+            /*!  Whether the version is fully applied  */
+            bool done;
+
+            /*!  When the version was applied  */
+            std::string applied;
+        };
+
+        /*!  The database connection  */
+        gldb::DBConn& m_dbc;
+
+        /*!  The SQL statements object  */
+        const DBSQLStatements& m_sql;
+
+        /*!  The migrations  */
+        const std::vector<Migration>& m_migrations;
+
+        /*!
+         * \brief           Reads the recorded versions.
+         * \returns         The state of each recorded version, or an empty
+         * map if there is no \c schema_version table.
+         */
+        std::map<unsigned int, VersionState> read_versions();
+
+        /*!
+         * \brief           Returns the key range of a backfill.
+         * \param step      The backfill step.
+         * \param first     Set to the first key.
+         * \param last      Set to the last key.
+         * \returns         \c false if the table is empty.
+         */
+        bool backfill_range(const MigrationStep& step,
+                            unsigned long long& first,
+                            unsigned long long& last);
+
+        /*!
+         * \brief           Returns the \c SET clause of a step which
+         * updates a table in chunks of keys.
+         * \param step      The \c backfill or \c store_amounts step.
+         * \returns         The \c SET clause.
+         */
+        std::string set_clause(const MigrationStep& step) const;
+
+        /*!
+         * \brief           Returns whether a step has nothing to do.
+         * \details         True for a column or index which exists, or
+         * amounts the backend stores as they are written.
+         * \param step      The step.
+         * \returns         \c true if the step may be skipped.
+         */
+        bool already_done(const MigrationStep& step);
+
+        /*!
+         * \brief           Returns whether the backend does not need a
+         * step.
+         * \details         True for a change of column type on a backend
+         * which does not enforce column types.
+         * \param step      The step.
+         * \returns         \c true if the step may be skipped.
+         */
+        bool not_needed(const MigrationStep& step) const;
+
+        /*!
+         * \brief               Runs a step.
+         * \param migration     The migration.
+         * \param step_idx      The zero-based step.
+         * \param done_to       The last key completed, updated as chunks
+         * are committed.
+         * \param chunk_rows    The number of keys in each chunk.
+         * \param chunks_left   The chunks which may still be run, updated
+         * as chunks are committed.
+         * \param progress      The progress callback.
+         * \returns             \c true if the step is complete.
+         */
+        bool run_step(const Migration& migration,
+                      const size_t step_idx,
+                      unsigned long long& done_to,
+                      const unsigned long long chunk_rows,
+                      size_t& chunks_left,
+                      const Progress& progress);
+
+};              //  class GLMigrator
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_GL_MIGRATION_H
@@ -0,0 +1,69 @@
+/*!
+ * \file            glpermission.cpp
+ * \brief           Implementation of user permission registry
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+
+#include "glpermission.h"
+#include "glexception.h"
+
+using namespace genleg;
+
+/*!
+ * \brief           Interns the built-in permissions, in order.
+ * \ingroup         gldatabase
+ * \param symbols   The empty permission symbol table.
+ * \returns         \c true.
+ */
+static bool intern_builtin_permissions(pgutils::SymbolTable& symbols);
+
+pgutils::SymbolTable& genleg::permission_symbols()
+{
+    static pgutils::SymbolTable symbols;
+    static const bool interned = intern_builtin_permissions(symbols);
+    (void) interned;
+    return symbols;
+}
+
+size_t genleg::permission_bit(const std::string& name)
+{
+    const size_t bit = permission_symbols().intern(name);
+    if ( bit >= max_gl_permissions ) {
+        throw GLDBException("Too many permissions for '" + name + "'");
+    }
+    return bit;
+}
+
+GLPermissionSet genleg::permission_set(const std::vector<std::string>& names)
+{
+    GLPermissionSet perms;
+    for ( const auto& name : names ) {
+        perms.set(permission_bit(name));
+    }
+    return perms;
+}
+
+std::vector<std::string> genleg::permission_names(const GLPermissionSet&
+                                                      perms)
+{
+    std::vector<std::string> names;
+    for ( size_t bit = 0; bit < perms.size(); ++bit ) {
+        if ( perms.test(bit) ) {
+            names.push_back(permission_symbols().name(bit));
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+static bool intern_builtin_permissions(pgutils::SymbolTable& symbols)
+{
+    for ( const auto& def : gl_permissions ) {
+        symbols.intern(def.name);
+    }
+    return true;
+}
@@ -0,0 +1,153 @@
+/*!
+ * \file            glpermission.h
+ * \brief           Interface to user permission registry
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_GL_PERMISSION_H
+#define PG_GENERAL_LEDGER_GL_PERMISSION_H
+
+#include <bitset>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "pgutils/pgutils.h"
+
+namespace genleg {
+
+/*!
+ * \brief           Built-in permissions, in the order of the perms table
+ * sample data.
+ * \details         Each permission is also its bit in a
+ * \c GLPermissionSet.
+ * \ingroup         gldatabase
+ */
+enum class GLPermission : size_t {
+    basic_reports,
+    financial_reports,
+    admin_reports,
+    all_reports,
+    create,
+    post,
+    create_post,
+    add_user,
+    enable_user,
+    change_pass,
+    basic_perms,
+    all_perms,
+    close_period,
+    close_year
+};
+
+/*!
+ * \brief           Number of built-in permissions.
+ * \ingroup         gldatabase
+ */
+constexpr size_t num_gl_permissions = 14;
+
+/*!
+ * \brief           Largest number of distinct permissions, built-in or
+ * added to the perms table.
+ * \ingroup         gldatabase
+ */
+constexpr size_t max_gl_permissions = 64;
+
+/*!
+ * \brief           Set of permissions, with one bit for each.
+ * \ingroup         gldatabase
+ */
+using GLPermissionSet = std::bitset<max_gl_permissions>;
+
+/*!
+ * \brief           Built-in permission definition.
+ * \ingroup         gldatabase
+ */
+struct GLPermissionDef {
+    GLPermission id;        /*!<  The permission  */
+    const char * name;      /*!<  Its name in the perms table  */
+};
+
+/*!
+ * \brief           Built-in permission definitions.
+ * \ingroup         gldatabase
+ */
+constexpr GLPermissionDef gl_permissions[] = {
+    {GLPermission::basic_reports, "BASICRPTS"},
+    {GLPermission::financial_reports, "FINRPTS"},
+    {GLPermission::admin_reports, "ADMINRPTS"},
+    {GLPermission::all_reports, "ALLREPTS"},
+    {GLPermission::create, "CREATE"},
+    {GLPermission::post, "POST"},
+    {GLPermission::create_post, "CREATEPOST"},
+    {GLPermission::add_user, "ADDUSER"},
+    {GLPermission::enable_user, "ENABLEUSER"},
+    {GLPermission::change_pass, "CHANGEPASS"},
+    {GLPermission::basic_perms, "BASICPERMS"},
+    {GLPermission::all_perms, "ALLPERMS"},
+    {GLPermission::close_period, "CLOSEPRD"},
+    {GLPermission::close_year, "CLOSEYEAR"}
+};
+
+/*!
+ * \brief           Checks that permission definitions follow their
+ * enumeration.
+ * \param idx       The first definition to check.
+ * \returns         \c true if the definitions are in order.
+ */
+constexpr bool gl_permissions_in_order(const size_t idx = 0) {
+    return idx == num_gl_permissions ||
+           (static_cast<size_t>(gl_permissions[idx].id) == idx &&
+            gl_permissions_in_order(idx + 1));
+}
+
+static_assert(sizeof(gl_permissions) / sizeof(gl_permissions[0]) ==
+              num_gl_permissions, "Every permission needs a definition");
+static_assert(num_gl_permissions <= max_gl_permissions,
+              "Permissions must fit in a permission set");
+static_assert(gl_permissions_in_order(),
+              "Permissions must be defined in order");
+
+/*!
+ * \brief           Returns the process-wide permission symbol table.
+ * \details         The built-in permissions are interned first, so each
+ * ID is the permission's bit. Other names in the perms table are interned
+ * as they are first seen, after them.
+ * \ingroup         gldatabase
+ * \returns         A reference to the permission symbol table.
+ */
+pgutils::SymbolTable& permission_symbols();
+
+/*!
+ * \brief           Returns the bit for a permission name, interning it if
+ * needed.
+ * \ingroup         gldatabase
+ * \param name      The name of the permission.
+ * \returns         The bit.
+ * \throws          GLDBException If there are already
+ * \c max_gl_permissions distinct permissions.
+ */
+size_t permission_bit(const std::string& name);
+
+/*!
+ * \brief           Returns a permission set holding named permissions.
+ * \ingroup         gldatabase
+ * \param names     The names of the permissions.
+ * \returns         The permission set.
+ * \throws          GLDBException If there are too many distinct
+ * permissions.
+ */
+GLPermissionSet permission_set(const std::vector<std::string>& names);
+
+/*!
+ * \brief           Returns the names of the permissions in a set.
+ * \ingroup         gldatabase
+ * \param perms     The permission set.
+ * \returns         The names, sorted.
+ */
+std::vector<std::string> permission_names(const GLPermissionSet& perms);
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_GL_PERMISSION_H
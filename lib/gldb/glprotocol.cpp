@@ -0,0 +1,297 @@
+/*!
+ * \file            glprotocol.cpp
+ * \brief           Implementation of General Ledger server protocol
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "glprotocol.h"
+
+using namespace genleg;
+
+/*!
+ * \brief           Appends a four byte big-endian integer to a string.
+ * \ingroup         gldatabase
+ * \param out       The string.
+ * \param value     The value to append.
+ */
+static void put_u32(std::string& out, const uint32_t value);
+
+/*!
+ * \brief           Reads a four byte big-endian integer from a string.
+ * \ingroup         gldatabase
+ * \param data      The string.
+ * \param pos       The offset of the integer, advanced past it.
+ * \returns         The value read.
+ * \throws          GLProtocolException if the string ends early.
+ */
+static uint32_t get_u32(const std::string& data, size_t& pos);
+
+/*!
+ * \brief           Reads exactly \c len bytes from a socket.
+ * \ingroup         gldatabase
+ * \param fd        The socket.
+ * \param buffer    The buffer to fill.
+ * \param len       The number of bytes to read.
+ * \returns         The number of bytes read, less than \c len only if the
+ * peer closed the connection.
+ * \throws          GLProtocolException on error.
+ */
+static size_t read_fully(const int fd, char * buffer, const size_t len);
+
+/*!
+ * \brief           Converts a field to an integer.
+ * \ingroup         gldatabase
+ * \param field     The field.
+ * \returns         The integer.
+ * \throws          GLProtocolException if the field is not an integer.
+ */
+static long long to_integer(const std::string& field);
+
+void genleg::write_frame(const int fd, const std::string& payload) {
+    if ( payload.size() > gl_max_frame_size ) {
+        throw GLProtocolException("frame too large");
+    }
+
+    std::string frame;
+    frame.reserve(payload.size() + 4);
+    put_u32(frame, static_cast<uint32_t>(payload.size()));
+    frame += payload;
+
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+
+    size_t sent = 0;
+    while ( sent < frame.size() ) {
+        const ssize_t n = ::send(fd, frame.data() + sent,
+                                 frame.size() - sent, flags);
+        if ( n < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            throw GLProtocolException(std::string{"couldn't send: "} +
+                                      std::strerror(errno));
+        }
+        sent += n;
+    }
+}
+
+bool genleg::read_frame(const int fd, std::string& payload) {
+    char header[4];
+    const size_t got = read_fully(fd, header, sizeof(header));
+    if ( got == 0 ) {
+        return false;
+    }
+    else if ( got < sizeof(header) ) {
+        throw GLProtocolException("connection closed during frame");
+    }
+
+    size_t pos = 0;
+    const uint32_t len = get_u32(std::string(header, sizeof(header)), pos);
+    if ( len > gl_max_frame_size ) {
+        throw GLProtocolException("frame too large");
+    }
+
+    payload.assign(len, '\0');
+    if ( len && read_fully(fd, &payload[0], len) < len ) {
+        throw GLProtocolException("connection closed during frame");
+    }
+    return true;
+}
+
+std::string genleg::encode_strings(const std::vector<std::string>& strings) {
+    std::string out;
+    put_u32(out, static_cast<uint32_t>(strings.size()));
+    for ( const auto& s : strings ) {
+        put_u32(out, static_cast<uint32_t>(s.size()));
+        out += s;
+    }
+    return out;
+}
+
+std::vector<std::string> genleg::decode_strings(const std::string& data,
+                                                size_t pos) {
+    const uint32_t count = get_u32(data, pos);
+    if ( count > data.size() ) {
+        throw GLProtocolException("malformed string list");
+    }
+
+    std::vector<std::string> strings;
+    strings.reserve(count);
+    for ( uint32_t i = 0; i < count; ++i ) {
+        const uint32_t len = get_u32(data, pos);
+        if ( len > data.size() - pos ) {
+            throw GLProtocolException("malformed string list");
+        }
+        strings.push_back(data.substr(pos, len));
+        pos += len;
+    }
+
+    if ( pos != data.size() ) {
+        throw GLProtocolException("malformed string list");
+    }
+    return strings;
+}
+
+std::string genleg::encode_request(const GLRequest& request) {
+    return std::string(1, static_cast<char>(request.type)) +
+           encode_strings(request.args);
+}
+
+GLRequest genleg::decode_request(const std::string& payload) {
+    if ( payload.empty() ) {
+        throw GLProtocolException("empty request");
+    }
+
+    const uint8_t type = static_cast<uint8_t>(payload[0]);
+    if ( type < static_cast<uint8_t>(GLRequestType::report) ||
+         type > static_cast<uint8_t>(GLRequestType::revoke) ) {
+        throw GLProtocolException("unknown request type " +
+                                  std::to_string(type));
+    }
+
+    return GLRequest{static_cast<GLRequestType>(type),
+                     decode_strings(payload, 1)};
+}
+
+std::string genleg::encode_response(const GLResponse& response) {
+    return std::string(1, static_cast<char>(response.status)) +
+           response.body;
+}
+
+GLResponse genleg::decode_response(const std::string& payload) {
+    if ( payload.empty() ) {
+        throw GLProtocolException("empty response");
+    }
+
+    const uint8_t status = static_cast<uint8_t>(payload[0]);
+    if ( status > static_cast<uint8_t>(GLResponseStatus::error) ) {
+        throw GLProtocolException("unknown response status " +
+                                  std::to_string(status));
+    }
+
+    return GLResponse{static_cast<GLResponseStatus>(status),
+                      payload.substr(1)};
+}
+
+std::vector<std::string> genleg::user_to_strings(const GLUser& user) {
+    std::vector<std::string> fields{user.id(), user.username(),
+                                    user.firstname(), user.lastname(),
+                                    user.pass_hash(), user.pass_salt(),
+                                    user.enabled() ? "1" : "0"};
+    for ( const auto& perm : user.permissions() ) {
+        fields.push_back(perm);
+    }
+    return fields;
+}
+
+GLUser genleg::user_from_strings(const std::vector<std::string>& fields) {
+    if ( fields.size() < gl_user_fields ) {
+        throw GLProtocolException("malformed user");
+    }
+
+    std::vector<std::string> perms(fields.begin() + gl_user_fields,
+                                   fields.end());
+    return GLUser{fields[0], fields[1], fields[2], fields[3],
+                  fields[4], fields[5], std::move(perms), fields[6] == "1"};
+}
+
+std::vector<std::string> genleg::journal_to_strings(const GLJournal& journal)
+{
+    std::vector<std::string> fields{std::to_string(journal.entity()),
+                                    std::to_string(journal.period()),
+                                    std::to_string(journal.year()),
+                                    journal.source(),
+                                    journal.memo(),
+                                    std::to_string(journal.id()),
+                                    std::to_string(journal.user())};
+    for ( const auto& line : journal ) {
+        fields.push_back(line.account());
+        fields.push_back(std::to_string(line.cents()));
+    }
+    return fields;
+}
+
+GLJournal genleg::journal_from_strings(const std::vector<std::string>& fields)
+{
+    if ( fields.size() < gl_journal_fields ||
+         (fields.size() - gl_journal_fields) % 2 ) {
+        throw GLProtocolException("malformed journal entry");
+    }
+
+    GLJournal journal{static_cast<unsigned long>(to_integer(fields[0])),
+                      static_cast<int>(to_integer(fields[1])),
+                      static_cast<int>(to_integer(fields[2])),
+                      fields[3], fields[4],
+                      static_cast<size_t>(to_integer(fields[5])),
+                      static_cast<size_t>(to_integer(fields[6]))};
+    for ( size_t i = gl_journal_fields; i < fields.size(); i += 2 ) {
+        uint32_t acct_id;
+        if ( !account_symbols().find(fields[i], acct_id) ) {
+            throw GLProtocolException("unknown account '" + fields[i] + "'");
+        }
+        journal.add_line(acct_id, to_integer(fields[i + 1]));
+    }
+    return journal;
+}
+
+static void put_u32(std::string& out, const uint32_t value) {
+    out += static_cast<char>((value >> 24) & 0xff);
+    out += static_cast<char>((value >> 16) & 0xff);
+    out += static_cast<char>((value >> 8) & 0xff);
+    out += static_cast<char>(value & 0xff);
+}
+
+static uint32_t get_u32(const std::string& data, size_t& pos) {
+    if ( data.size() < 4 || pos > data.size() - 4 ) {
+        throw GLProtocolException("unexpected end of data");
+    }
+
+    uint32_t value = 0;
+    for ( size_t i = 0; i < 4; ++i ) {
+        value = (value << 8) | static_cast<uint8_t>(data[pos++]);
+    }
+    return value;
+}
+
+static size_t read_fully(const int fd, char * buffer, const size_t len) {
+    size_t got = 0;
+    while ( got < len ) {
+        const ssize_t n = ::recv(fd, buffer + got, len - got, 0);
+        if ( n < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            throw GLProtocolException(std::string{"couldn't receive: "} +
+                                      std::strerror(errno));
+        }
+        else if ( n == 0 ) {
+            break;
+        }
+        got += n;
+    }
+    return got;
+}
+
+static long long to_integer(const std::string& field) {
+    try {
+        size_t used = 0;
+        const long long value = std::stoll(field, &used);
+        if ( used == field.size() ) {
+            return value;
+        }
+    }
+    catch ( const std::logic_error& ) {
+    }
+    throw GLProtocolException("bad integer '" + field + "'");
+}
@@ -0,0 +1,223 @@
+/*!
+ * \file            glprotocol.h
+ * \brief           Interface to General Ledger server protocol
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_GL_PROTOCOL_H
+#define PG_GENERAL_LEDGER_GL_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "glexception.h"
+#include "gljournal.h"
+#include "gluser.h"
+
+namespace genleg {
+
+/*!
+ * \brief           Server protocol exception class.
+ * \ingroup         gldatabase
+ */
+class GLProtocolException : public GLDBException {
+    public:
+        /*!
+         * \brief           Constructor
+         * \param msg       Error message
+         */
+        explicit GLProtocolException(const std::string& msg) :
+            GLDBException(msg) {};
+};
+
+/*!
+ * \brief           The largest frame accepted, in bytes.
+ * \ingroup         gldatabase
+ */
+constexpr uint32_t gl_max_frame_size = 64 * 1024 * 1024;
+
+/*!
+ * \brief           Number of user fields before the permissions.
+ * \ingroup         gldatabase
+ */
+constexpr size_t gl_user_fields = 7;
+
+/*!
+ * \brief           Number of journal entry fields before the lines.
+ * \ingroup         gldatabase
+ */
+constexpr size_t gl_journal_fields = 7;
+
+/*!
+ * \brief           Server request type.
+ * \ingroup         gldatabase
+ */
+enum class GLRequestType : uint8_t {
+    report = 1,         /*!<  Report name and argument  */
+    post_journal,       /*!<  Journal entry fields and lines  */
+    user_by_id,         /*!<  User ID  */
+    user_by_username,   /*!<  Username  */
+    update_user,        /*!<  User fields  */
+    grant,              /*!<  User ID and permission  */
+    revoke              /*!<  User ID and permission  */
+};
+
+/*!
+ * \brief           Server response status.
+ * \ingroup         gldatabase
+ */
+enum class GLResponseStatus : uint8_t {
+    ok = 0,             /*!<  The body holds the result, if any  */
+    error               /*!<  The body holds the error message  */
+};
+
+/*!
+ * \brief           Server request.
+ * \ingroup         gldatabase
+ */
+struct GLRequest {
+    /*!  The request type  */
+    GLRequestType type;
+
+    /*!  The request arguments  */
+    std::vector<std::string> args;
+};
+
+/*!
+ * \brief           Server response.
+ * \ingroup         gldatabase
+ */
+struct GLResponse {
+    /*!  The response status  */
+    GLResponseStatus status;
+
+    /*!  A saved report, encoded user fields, an error message, or empty  */
+    std::string body;
+};
+
+/*!
+ * \brief           Writes a frame to a socket.
+ * \details         A frame is a four byte big-endian length followed by
+ * the payload.
+ * \ingroup         gldatabase
+ * \param fd        The socket.
+ * \param payload   The payload.
+ * \throws          GLProtocolException on error.
+ */
+void write_frame(const int fd, const std::string& payload);
+
+/*!
+ * \brief           Reads a frame from a socket.
+ * \ingroup         gldatabase
+ * \param fd        The socket.
+ * \param payload   Set to the payload.
+ * \returns         \c false if the peer closed the connection before the
+ * frame began.
+ * \throws          GLProtocolException if the connection fails or closes
+ * part way through a frame, or the frame is too large.
+ */
+bool read_frame(const int fd, std::string& payload);
+
+/*!
+ * \brief           Encodes a list of strings.
+ * \details         Each string is a four byte big-endian length followed
+ * by its bytes.
+ * \ingroup         gldatabase
+ * \param strings   The strings.
+ * \returns         The encoded strings.
+ */
+std::string encode_strings(const std::vector<std::string>& strings);
+
+/*!
+ * \brief           Decodes a list of strings encoded by
+ * \c encode_strings().
+ * \ingroup         gldatabase
+ * \param data      The encoded strings.
+ * \param pos       The offset at which the strings begin.
+ * \returns         The strings.
+ * \throws          GLProtocolException if the data is malformed.
+ */
+std::vector<std::string> decode_strings(const std::string& data,
+                                        size_t pos = 0);
+
+/*!
+ * \brief           Encodes a request.
+ * \ingroup         gldatabase
+ * \param request   The request.
+ * \returns         The frame payload.
+ */
+std::string encode_request(const GLRequest& request);
+
+/*!
+ * \brief           Decodes a request.
+ * \ingroup         gldatabase
+ * \param payload   The frame payload.
+ * \returns         The request.
+ * \throws          GLProtocolException if the payload is malformed.
+ */
+GLRequest decode_request(const std::string& payload);
+
+/*!
+ * \brief           Encodes a response.
+ * \ingroup         gldatabase
+ * \param response  The response.
+ * \returns         The frame payload.
+ */
+std::string encode_response(const GLResponse& response);
+
+/*!
+ * \brief           Decodes a response.
+ * \ingroup         gldatabase
+ * \param payload   The frame payload.
+ * \returns         The response.
+ * \throws          GLProtocolException if the payload is malformed.
+ */
+GLResponse decode_response(const std::string& payload);
+
+/*!
+ * \brief           Returns the fields of a user, for a request or
+ * response.
+ * \ingroup         gldatabase
+ * \param user      The user.
+ * \returns         The fields, followed by the permissions.
+ */
+std::vector<std::string> user_to_strings(const GLUser& user);
+
+/*!
+ * \brief           Returns a user from fields made by
+ * \c user_to_strings().
+ * \ingroup         gldatabase
+ * \param fields    The fields.
+ * \returns         The user.
+ * \throws          GLProtocolException if there are too few fields.
+ */
+GLUser user_from_strings(const std::vector<std::string>& fields);
+
+/*!
+ * \brief           Returns the fields and lines of a journal entry, for a
+ * request.
+ * \ingroup         gldatabase
+ * \param journal   The journal entry.
+ * \returns         The fields, followed by the account and amount in cents
+ * of each line.
+ */
+std::vector<std::string> journal_to_strings(const GLJournal& journal);
+
+/*!
+ * \brief           Returns a journal entry from fields made by
+ * \c journal_to_strings().
+ * \details         The fields may come from an untrusted client, so
+ * accounts are only looked up in \c account_symbols(), never added to it.
+ * \ingroup         gldatabase
+ * \param fields    The fields.
+ * \returns         The journal entry.
+ * \throws          GLProtocolException if the fields are malformed, or
+ * name an account which is not already interned.
+ */
+GLJournal journal_from_strings(const std::vector<std::string>& fields);
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_GL_PROTOCOL_H
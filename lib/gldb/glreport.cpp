@@ -6,67 +6,75 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
 #include <vector>
-#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include "glreport.h"
+#include "glexception.h"
+#include "pgutils/pgutils.h"
 
 using namespace genleg;
 using namespace gldb;
 
+/*!  Magic string at the start of a saved report  */
+static const char saved_report_magic[8] = {'G', 'L', 'R', 'P', 'T', '1', 0, 0};
+
+/*!
+ * \brief           Checks if a string is a non-empty string of digits.
+ * \ingroup         gldatabase
+ * \param s         The string to check.
+ * \returns         `true` if `s` contains only digits, `false` otherwise.
+ */
+static bool is_digits(const std::string& s);
+
 /*!
- * \brief           Calculates the maximum required column widths for a table.
+ * \brief           Checks if a string is an account number.
  * \ingroup         gldatabase
- * \param table     The table.
- * \returns         A vector of \c size_t containing the maximum required
- * width for each column, without padding.
+ * \param s         The string to check.
+ * \returns         `true` if `s` is non-empty and contains only letters,
+ * digits, '-' and '_', `false` otherwise.
  */
-static std::vector<size_t> max_column_widths(const gldb::Table& table);
+static bool is_account_number(const std::string& s);
 
 /*!
- * \brief           Increments a vector of required column widths.
- * \details         Each element of the vector is increased to fit the
- * width of each file in the row, if the existing width is not large enough
- * to contain it.
+ * \brief           Writes an unsigned integer to a binary stream.
  * \ingroup         gldatabase
- * \param widths    An existing vector of widths.
- * \param row       The row against which to check and potentially increase
- * the vector.
+ * \param out       The output stream.
+ * \param value     The value to write.
  */
-static void grow_widths(std::vector<size_t>& widths, const TableRow& row);
+static void put_uint(std::ostream& out, const uint64_t value);
 
 /*!
- * \brief           Returns a decorated separator row for a table.
- * \details         The "separator row" is of the format "+---+---+---+"
- * where each column is separated by a \c '+' character, and consists
- * of enough \c '-' characters to fit the respective width in the vector
- * plus two additional characters for spacing.
+ * \brief           Reads an unsigned integer from a binary stream.
  * \ingroup         gldatabase
- * \param widths    A vector of required widths.
- * \returns         A string containing the separator row.
+ * \param in        The input stream.
+ * \returns         The value read.
+ * \throws          GLDBException if the stream ends early.
  */
-static std::string separator_row(const std::vector<size_t>& widths);
+static uint64_t get_uint(std::istream& in);
 
 /*!
- * \brief           Returns a row for a plain report.
+ * \brief           Writes a length-prefixed string to a binary stream.
  * \ingroup         gldatabase
- * \param row       The row for which to create the report row.
- * \param widths    A vector of required widths.
- * \returns         A string containing the plain row.
+ * \param out       The output stream.
+ * \param s         The string to write.
  */
-static std::string plain_row(const TableRow& row,
-                             const std::vector<size_t>& widths);
+static void put_string(std::ostream& out, const std::string& s);
 
 /*!
- * \brief           Returns a row for a decorated report.
+ * \brief           Reads a length-prefixed string from a binary stream.
+ * \details         The string is read in chunks, so a corrupt length
+ * fails at the end of the stream instead of allocating it all first.
  * \ingroup         gldatabase
- * \param row       The row for which to create the report row.
- * \param widths    A vector of required widths.
- * \returns         A string containing the decorated row.
+ * \param in        The input stream.
+ * \returns         The string read.
+ * \throws          GLDBException if the stream ends early.
  */
-static std::string decorated_row(const TableRow& row,
-                                 const std::vector<size_t>& widths);
+static std::string get_string(std::istream& in);
 
 std::ostream& genleg::operator<< (std::ostream& out, const GLReport& report) {
     out << report.m_title << std::endl
@@ -75,53 +83,282 @@ std::ostream& genleg::operator<< (std::ostream& out, const GLReport& report) {
         out << p.first << ": " << p.second << std::endl;
     }
     out << std::endl << report.m_report_text;
+    if ( report.m_table ) {
+        ReportWriter writer{out, report.m_style};
+        writer.write_table(*report.m_table);
+    }
     return out;
 }
 
-std::string genleg::plain_report_from_table(const gldb::Table& table)
+void GLReport::write(std::ostream& out, gldb::TableWriter& writer) const
 {
-    std::ostringstream ss;
+    if ( m_table ) {
+        writer.write(out, *m_table);
+        return;
+    }
 
-    const std::vector<size_t> widths = max_column_widths(table);
-    ss << plain_row(table.get_headers(), widths);
-    for ( const auto& record : table ) {
-        ss << plain_row(record, widths);
+    Table headers{TableRow{"Name", "Value"}};
+    for ( const auto& p : m_headers ) {
+        headers.append_record(TableRow{p.first, p.second});
     }
+    writer.write(out, headers);
+}
 
-    return ss.str();
+void GLReport::save(std::ostream& out) const
+{
+    out.write(saved_report_magic, sizeof(saved_report_magic));
+    put_string(out, m_title);
+    put_uint(out, m_headers.size());
+    for ( const auto& p : m_headers ) {
+        put_string(out, p.first);
+        put_string(out, p.second);
+    }
+    put_string(out, m_report_text);
+    put_uint(out, m_style == ReportStyle::plain ? 0 : 1);
+    put_uint(out, m_table ? 1 : 0);
+    if ( m_table ) {
+        ColumnarTableWriter{}.write(out, *m_table);
+    }
 }
 
-std::string genleg::decorated_report_from_table(const gldb::Table& table)
+GLReport GLReport::load(std::istream& in) try
 {
-    std::ostringstream ss;
+    char magic[sizeof(saved_report_magic)];
+    if ( !in.read(magic, sizeof(magic)) ||
+         std::memcmp(magic, saved_report_magic, sizeof(magic)) != 0 ) {
+        throw GLDBException("Input is not a saved report");
+    }
 
-    const std::vector<size_t> widths = max_column_widths(table);
-    ss << separator_row(widths);
-    ss << decorated_row(table.get_headers(), widths);
-    ss << separator_row(widths);
-    for ( const auto& record : table ) {
-        ss << decorated_row(record, widths);
+    const std::string title = get_string(in);
+    std::vector<std::pair<std::string, std::string>> headers;
+    for ( uint64_t n = get_uint(in); n > 0; --n ) {
+        std::string name = get_string(in);
+        headers.emplace_back(name, get_string(in));
+    }
+    const std::string text = get_string(in);
+    const ReportStyle style = get_uint(in) == 0 ? ReportStyle::plain :
+                                                  ReportStyle::decorated;
+    const bool has_table = get_uint(in) != 0;
+
+    GLReport report = has_table ?
+        GLReport{title, read_columnar_table(in), style} :
+        GLReport{title, text};
+    report.m_headers = std::move(headers);
+    return report;
+}
+catch ( const TableException& e ) {
+    throw GLDBException(e.what());
+}
+
+std::map<std::string, std::string>
+genleg::parse_report_args(const std::string& arg)
+{
+    std::map<std::string, std::string> args;
+    for ( auto& element : pgutils::split(arg, ';') ) {
+        pgutils::trim(element);
+        if ( element.empty() ) {
+            continue;
+        }
+
+        const size_t eq = element.find('=');
+        if ( eq == std::string::npos || eq == 0 ) {
+            throw GLDBException("Malformed report argument '" +
+                                element + "'");
+        }
+        std::string key = element.substr(0, eq);
+        std::string value = element.substr(eq + 1);
+        args[pgutils::trim(key)] = pgutils::trim(value);
+    }
+    return args;
+}
+
+TBFilter genleg::tb_filter_from_arg(const std::string& arg)
+{
+    TBFilter filter{{}, "", "", "", false, 0};
+
+    if ( arg.find('=') == std::string::npos ) {
+        if ( !arg.empty() ) {
+            if ( !is_digits(arg) ) {
+                throw GLDBException("Bad entity number");
+            }
+            filter.entities.push_back(arg);
+        }
+        return filter;
+    }
+
+    for ( const auto& p : parse_report_args(arg) ) {
+        const std::string& key = p.first;
+        const std::string& value = p.second;
+
+        if ( key == "entity" ) {
+            for ( auto& entity : pgutils::split(value, ',') ) {
+                if ( !is_digits(pgutils::trim(entity)) ) {
+                    throw GLDBException("Bad entity number");
+                }
+                filter.entities.push_back(entity);
+            }
+        }
+        else if ( key == "from" || key == "to" ) {
+            if ( !is_account_number(value) ) {
+                throw GLDBException("Bad account number");
+            }
+            (key == "from" ? filter.first_account :
+                             filter.last_account) = value;
+        }
+        else if ( key == "threshold" ) {
+            const size_t dot = value.find('.');
+            if ( !is_digits(value.substr(0, dot)) ||
+                 (dot != std::string::npos &&
+                  !is_digits(value.substr(dot + 1))) ) {
+                throw GLDBException("Bad balance threshold");
+            }
+            filter.threshold = value;
+        }
+        else if ( key == "nonzero" ) {
+            if ( value != "yes" && value != "no" ) {
+                throw GLDBException("Bad value for nonzero");
+            }
+            filter.nonzero = value == "yes";
+        }
+        else if ( key == "top" ) {
+            if ( !is_digits(value) || value.length() > 9 ) {
+                throw GLDBException("Bad number of balances");
+            }
+            filter.top_n = std::stoul(value);
+        }
+        else {
+            throw GLDBException("Unknown trial balance argument '" +
+                                key + "'");
+        }
+    }
+    return filter;
+}
+
+TBComparison genleg::tb_comparison_from_arg(const std::string& arg,
+                                            const int year,
+                                            const int period,
+                                            const int num_periods)
+{
+    const std::map<std::string, std::string> args = parse_report_args(arg);
+    for ( const auto& p : args ) {
+        if ( p.first != "columns" && p.first != "entity" &&
+             p.first != "year" && p.first != "period" ) {
+            throw GLDBException("Unknown comparative trial balance "
+                                "argument '" + p.first + "'");
+        }
+    }
+
+    TBComparison cmp{"", year, period, {}};
+    std::string columns{"current,prior,prioryear,ytd"};
+
+    try {
+        if ( args.count("year") ) {
+            cmp.year = std::stoi(args.at("year"));
+        }
+        if ( args.count("period") ) {
+            cmp.period = std::stoi(args.at("period"));
+        }
+        if ( args.count("entity") ) {
+            cmp.entity = std::to_string(std::stoul(args.at("entity")));
+        }
+    }
+    catch ( const std::logic_error& e ) {
+        throw GLDBException("Bad numeric comparative trial balance argument");
+    }
+    if ( cmp.period < 1 || cmp.period > num_periods ) {
+        throw GLDBException("Bad accounting period");
+    }
+    if ( args.count("columns") ) {
+        columns = args.at("columns");
     }
-    ss << separator_row(widths);
 
+    const int y = cmp.year;
+    const int p = cmp.period;
+    const int prior_year = p > 1 ? y : y - 1;
+    const int prior_period = p > 1 ? p - 1 : num_periods;
+    const std::string p_label = " P" + std::to_string(p);
+
+    for ( const auto& column : pgutils::split(columns, ',') ) {
+        if ( column == "current" ) {
+            cmp.columns.push_back(TBColumn{std::to_string(y) + p_label,
+                                           y, p, p});
+        }
+        else if ( column == "prior" ) {
+            cmp.columns.push_back(TBColumn{std::to_string(prior_year) +
+                                           " P" +
+                                           std::to_string(prior_period),
+                                           prior_year,
+                                           prior_period, prior_period});
+        }
+        else if ( column == "prioryear" ) {
+            cmp.columns.push_back(TBColumn{std::to_string(y - 1) + p_label,
+                                           y - 1, p, p});
+        }
+        else if ( column == "ytd" ) {
+            cmp.columns.push_back(TBColumn{std::to_string(y) + " YTD" +
+                                           p_label, y, 1, p});
+        }
+        else if ( column == "priorytd" ) {
+            cmp.columns.push_back(TBColumn{std::to_string(y - 1) + " YTD" +
+                                           p_label, y - 1, 1, p});
+        }
+        else {
+            throw GLDBException("Unknown comparative trial balance column '" +
+                                column + "'");
+        }
+    }
+    if ( cmp.columns.empty() ) {
+        throw GLDBException("No comparative trial balance columns");
+    }
+    return cmp;
+}
+
+std::string genleg::plain_report_from_table(const gldb::Table& table)
+{
+    std::ostringstream ss;
+    ReportWriter writer{ss, ReportStyle::plain};
+    writer.write_table(table);
     return ss.str();
 }
 
-static std::vector<size_t> max_column_widths(const gldb::Table& table)
+std::string genleg::decorated_report_from_table(const gldb::Table& table)
 {
-    std::vector<size_t> widths(table.num_fields());
+    std::ostringstream ss;
+    ReportWriter writer{ss, ReportStyle::decorated};
+    writer.write_table(table);
+    return ss.str();
+}
 
-    grow_widths(widths, table.get_headers());
+ReportWriter::ReportWriter(std::ostream& out, const ReportStyle style) :
+    m_out(out),
+    m_style{style},
+    m_widths{},
+    m_line{}
+{}
+
+void ReportWriter::write_table(const gldb::Table& table)
+{
+    m_widths.assign(table.num_fields(), 0);
+    grow_widths(table.get_headers());
     for ( const auto& record : table ) {
-        grow_widths(widths, record);
+        grow_widths(record);
     }
 
-    return widths;
+    put_headers(table.get_headers());
+    for ( const auto& record : table ) {
+        put_row(record);
+    }
+    put_footer();
+    m_out.flush();
 }
 
-static void grow_widths(std::vector<size_t>& widths, const TableRow& row)
+void ReportWriter::grow_widths(const gldb::TableRow& row)
 {
-    auto w_itr = widths.begin();
+    if ( row.size() > m_widths.size() ) {
+        m_widths.resize(row.size(), 0);
+    }
+
+    auto w_itr = m_widths.begin();
     for ( const auto& field : row ) {
         if ( field.length() > *w_itr ) {
             *w_itr = field.length();
@@ -130,45 +367,110 @@ static void grow_widths(std::vector<size_t>& widths, const TableRow& row)
     }
 }
 
-static std::string plain_row(const TableRow& row,
-                             const std::vector<size_t>& widths)
+void ReportWriter::put_headers(const gldb::TableRow& headers)
 {
-    std::ostringstream ss;
-    ss.setf(std::ios_base::left);
+    if ( m_style == ReportStyle::decorated ) {
+        put_separator();
+        put_row(headers);
+        put_separator();
+    }
+    else {
+        put_row(headers);
+    }
+}
 
-    auto w_itr = widths.begin();
+void ReportWriter::put_row(const gldb::TableRow& row)
+{
+    m_line.clear();
+
+    auto w_itr = m_widths.begin();
     for ( const auto& field : row ) {
-        ss << std::setw(*w_itr++ + 1) << field;
+        const std::string& data = field.str();
+        const size_t pad = *w_itr > data.length() ? *w_itr - data.length() : 0;
+        if ( m_style == ReportStyle::decorated ) {
+            m_line += "| ";
+            m_line += data;
+            m_line.append(pad + 1, ' ');
+        }
+        else {
+            m_line += data;
+            m_line.append(pad + 1, ' ');
+        }
+        ++w_itr;
     }
 
-    ss << std::endl;
-    return ss.str();
+    if ( m_style == ReportStyle::decorated ) {
+        m_line += '|';
+    }
+    m_line += '\n';
+    m_out.write(m_line.data(), m_line.size());
 }
 
-static std::string decorated_row(const TableRow& row,
-                                 const std::vector<size_t>& widths)
+void ReportWriter::put_separator()
 {
-    std::ostringstream ss;
-    ss.setf(std::ios_base::left);
+    m_line.clear();
+    for ( const auto& w : m_widths ) {
+        m_line += "+-";
+        m_line.append(w + 1, '-');
+    }
+    m_line += "+\n";
+    m_out.write(m_line.data(), m_line.size());
+}
 
-    auto w_itr = widths.begin();
-    for ( const auto& field : row ) {
-        ss << "| " << std::setw(*w_itr++) << field << " ";
+void ReportWriter::put_footer()
+{
+    if ( m_style == ReportStyle::decorated ) {
+        put_separator();
     }
+}
 
-    ss << "|" << std::endl;
-    return ss.str();
+static void put_uint(std::ostream& out, const uint64_t value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
 }
 
-static std::string separator_row(const std::vector<size_t>& widths)
+static uint64_t get_uint(std::istream& in)
 {
-    std::ostringstream ss;
+    uint64_t value;
+    if ( !in.read(reinterpret_cast<char *>(&value), sizeof(value)) ) {
+        throw GLDBException("Unexpected end of saved report");
+    }
+    return value;
+}
+
+static void put_string(std::ostream& out, const std::string& s)
+{
+    put_uint(out, s.size());
+    out.write(s.data(), s.size());
+}
 
-    for ( const auto& w : widths ) {
-        ss << "+-" << std::string(w, '-') << "-";
+static std::string get_string(std::istream& in)
+{
+    std::string s;
+    char buffer[4096];
+    for ( uint64_t left = get_uint(in); left > 0; ) {
+        const size_t chunk = std::min<uint64_t>(left, sizeof(buffer));
+        if ( !in.read(buffer, chunk) ) {
+            throw GLDBException("Unexpected end of saved report");
+        }
+        s.append(buffer, chunk);
+        left -= chunk;
     }
+    return s;
+}
 
-    ss << "+" << std::endl;
-    return ss.str();
+static bool is_digits(const std::string& s)
+{
+    return !s.empty() &&
+           std::all_of(s.begin(), s.end(),
+                       [](const char c) { return c >= '0' && c <= '9'; });
 }
 
+static bool is_account_number(const std::string& s)
+{
+    return !s.empty() &&
+           std::all_of(s.begin(), s.end(), [](const char c) {
+                   return std::isalnum(static_cast<unsigned char>(c)) ||
+                          c == '-' || c == '_';
+           });
+}
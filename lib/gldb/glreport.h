@@ -9,13 +9,106 @@
 #ifndef PG_GENERAL_LEDGER_GLREPORT_H
 #define PG_GENERAL_LEDGER_GLREPORT_H
 
+#include <iostream>
+#include <map>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include <database/database.h>
+#include "dbsql/dbsql.h"
 
 namespace genleg {
 
+/*!
+ * \brief           Report layout style.
+ * \ingroup         gldatabase
+ */
+enum class ReportStyle {
+    plain,          /*!<  Columns separated by a space  */
+    decorated       /*!<  Columns surrounded by ASCII-art lines  */
+};
+
+/*!
+ * \brief           Report writer class.
+ * \details         Writes a table as a report directly to an output stream,
+ * one row at a time, through a reusable line buffer. Column widths are
+ * computed in a single pass over the table before any output.
+ * \ingroup         gldatabase
+ */
+class ReportWriter {
+    public:
+
+        /*!
+         * \brief               Constructor.
+         * \param out           The stream to which to write.
+         * \param style         The report layout style.
+         */
+        explicit ReportWriter (std::ostream& out,
+                               const ReportStyle style =
+                                    ReportStyle::decorated);
+
+        /*!  Deleted copy constructor  */
+        ReportWriter (const ReportWriter&) = delete;
+
+        /*!  Deleted copy assignment operator  */
+        ReportWriter& operator=(const ReportWriter&) = delete;
+
+        /*!
+         * \brief           Writes a complete table.
+         * \param table     The table to write.
+         */
+        void write_table(const gldb::Table& table);
+
+    private:
+
+        /*!  The output stream  */
+        std::ostream& m_out;
+
+        /*!  The report layout style  */
+        const ReportStyle m_style;
+
+        /*!  The column widths  */
+        std::vector<size_t> m_widths;
+
+        /*!  Reusable output line buffer  */
+        std::string m_line;
+
+        /*!
+         * \brief           Widens columns to fit the fields of a row.
+         * \param row       The row against which to check.
+         */
+        void grow_widths(const gldb::TableRow& row);
+
+        /*!
+         * \brief           Writes the report headers.
+         * \param headers   The column headers.
+         */
+        void put_headers(const gldb::TableRow& headers);
+
+        /*!
+         * \brief           Writes a single row.
+         * \param row       The row to write.
+         */
+        void put_row(const gldb::TableRow& row);
+
+        /*!
+         * \brief           Writes a decorated separator row.
+         */
+        void put_separator();
+
+        /*!
+         * \brief           Writes a bottom separator, if the style has one.
+         */
+        void put_footer();
+
+};              //  class ReportWriter
+
 /*!
  * \brief           General ledger report class
+ * \details         The body of the report is either preformatted text or a
+ * table. A table body is written directly to the output stream when the
+ * report is printed, without first being formatted into a string.
  * \ingroup         gldatabase
  */
 class GLReport {
@@ -26,7 +119,24 @@ class GLReport {
                   const std::string& report) :
             m_title{title},
             m_headers{},
-            m_report_text{report} {}
+            m_report_text{report},
+            m_table{},
+            m_style{ReportStyle::decorated} {}
+
+        /*!
+         * \brief           Constructor for a table report.
+         * \param title     The report title.
+         * \param table     The table containing the body of the report.
+         * \param style     The layout style for the table.
+         */
+        GLReport (const std::string& title,
+                  gldb::Table&& table,
+                  const ReportStyle style = ReportStyle::decorated) :
+            m_title{title},
+            m_headers{},
+            m_report_text{},
+            m_table{std::make_shared<const gldb::Table>(std::move(table))},
+            m_style{style} {}
 
         /*!  Destructor  */
         ~GLReport () {}
@@ -36,6 +146,31 @@ class GLReport {
             m_headers.push_back(std::pair<std::string,
                                           std::string>{name, value});
         }
+        /*!
+         * \brief           Writes the report data in a machine-readable
+         * format.
+         * \details         The report table is written if there is one,
+         * otherwise the report headers are written as a two column table of
+         * names and values.
+         * \param out       The stream to which to write.
+         * \param writer    The table writer for the output format.
+         */
+        void write(std::ostream& out, gldb::TableWriter& writer) const;
+
+        /*!
+         * \brief           Saves the report in a binary format.
+         * \param out       The stream to which to save.
+         */
+        void save(std::ostream& out) const;
+
+        /*!
+         * \brief           Loads a report saved by \c save().
+         * \param in        The stream from which to load.
+         * \returns         The report.
+         * \throws          GLDBException if the input is not a saved report.
+         */
+        static GLReport load(std::istream& in);
+
         friend std::ostream& operator<< (std::ostream& out,
                 const GLReport& report);
 
@@ -50,8 +185,77 @@ class GLReport {
         /*!  The main report text  */
         const std::string m_report_text;
 
+        /*!  The main report table, if any  */
+        std::shared_ptr<const gldb::Table> m_table;
+
+        /*!  The layout style for the report table  */
+        ReportStyle m_style;
+
 };              //  class GLReport
 
+/*!
+ * \brief           Parses a report argument string of named values.
+ * \details         The string is of the form \c key=value;key=value,
+ * for example \c "entity=1;columns=current,ytd".
+ * \ingroup         gldatabase
+ * \param arg       The argument string.
+ * \returns         A map of keys to values.
+ * \throws          GLDBException if an element has no '=' or a key is empty.
+ */
+std::map<std::string, std::string> parse_report_args(const std::string& arg);
+
+/*!
+ * \brief           Creates trial balance filters from a report argument.
+ * \details         The argument is either an entity number, or is parsed by
+ * parse_report_args() with the keys \c entity (a comma-separated list of
+ * entity numbers), \c from and \c to (an account number range),
+ * \c threshold (a minimum absolute balance), \c nonzero (\c yes or
+ * \c no) and \c top (a number of balances).
+ * \ingroup         gldatabase
+ * \param arg       The report argument.
+ * \returns         The filters.
+ * \throws          GLDBException on a bad argument.
+ */
+TBFilter tb_filter_from_arg(const std::string& arg);
+
+/*!
+ * \brief           Parameters of a comparative trial balance report.
+ * \ingroup         gldatabase
+ */
+struct TBComparison {
+    /*!  The entity number, or an empty string for all entities  */
+    std::string entity;
+
+    /*!  The reporting year  */
+    int year;
+
+    /*!  The reporting period  */
+    int period;
+
+    /*!  The columns to compute  */
+    std::vector<TBColumn> columns;
+};
+
+/*!
+ * \brief           Creates comparative trial balance parameters from a
+ * report argument.
+ * \details         The argument is parsed by parse_report_args() with the
+ * keys \c columns (a comma-separated list from \c current, \c prior,
+ * \c prioryear, \c ytd and \c priorytd), \c entity, \c year and
+ * \c period.
+ * \ingroup         gldatabase
+ * \param arg           The report argument.
+ * \param year          The default reporting year.
+ * \param period        The default reporting period.
+ * \param num_periods   The number of accounting periods in a year.
+ * \returns             The report parameters.
+ * \throws              GLDBException on a bad argument.
+ */
+TBComparison tb_comparison_from_arg(const std::string& arg,
+                                    const int year,
+                                    const int period,
+                                    const int num_periods);
+
 /*!
  * \brief           Creates a plain report from a table.
  * \details         A "plain report" separates each column with a space.
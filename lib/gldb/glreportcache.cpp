@@ -0,0 +1,186 @@
+/*!
+ * \file            glreportcache.cpp
+ * \brief           Implementation of report result cache class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include "glreportcache.h"
+#include "glexception.h"
+
+using namespace genleg;
+using namespace boost::filesystem;
+
+/*!  Number of digits in the version prefix of a saved report file name  */
+static const size_t version_digits = 20;
+
+/*!
+ * \brief           Encodes a string as hexadecimal digits.
+ * \details         Used so that any report name or argument makes a safe
+ * file name.
+ * \ingroup         gldatabase
+ * \param s         The string to encode.
+ * \returns         The encoded string.
+ */
+static std::string hex_encode(const std::string& s);
+
+GLReportCache::GLReportCache(const std::string& dir,
+                             const size_t max_entries) :
+    m_dir{dir},
+    m_max_entries{max_entries},
+    m_mutex{},
+    m_reports{}
+{
+    if ( !m_dir.empty() ) {
+        boost::system::error_code ec;
+        create_directories(m_dir, ec);
+        if ( ec || !is_directory(m_dir) ) {
+            throw GLDBException("Could not create report cache directory '" +
+                                m_dir + "'");
+        }
+    }
+}
+
+std::shared_ptr<const GLReport>
+GLReportCache::find(const std::string& report_name,
+                    const std::string& arg,
+                    const unsigned long long version)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    purge_before(version);
+
+    const auto found = m_reports.find(key_type{version, report_name, arg});
+    if ( found != m_reports.end() ) {
+        return found->second;
+    }
+
+    if ( m_dir.empty() ) {
+        return nullptr;
+    }
+
+    const std::string name = file_name(report_name, arg, version);
+    std::ifstream ifs{name, std::ios::binary};
+    if ( !ifs ) {
+        return nullptr;
+    }
+
+    try {
+        auto report = std::make_shared<const GLReport>(GLReport::load(ifs));
+        if ( m_reports.size() < m_max_entries ) {
+            m_reports.emplace(key_type{version, report_name, arg}, report);
+        }
+        return report;
+    }
+    catch ( const std::exception& e ) {
+
+        /*  Treat an unreadable file as a cache miss, and remove it so
+         *  the report is saved again                                   */
+
+        ifs.close();
+        boost::system::error_code ec;
+        remove(path{name}, ec);
+        return nullptr;
+    }
+}
+
+void GLReportCache::store(const std::string& report_name,
+                          const std::string& arg,
+                          const unsigned long long version,
+                          const GLReport& report)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    purge_before(version);
+
+    if ( m_reports.size() >= m_max_entries ) {
+        m_reports.clear();
+    }
+    m_reports[key_type{version, report_name, arg}] =
+        std::make_shared<const GLReport>(report);
+
+    if ( m_dir.empty() ) {
+        return;
+    }
+
+    /*  Save to a temporary file and rename it into place, so that other
+     *  processes never read a partially written report. Failures are
+     *  ignored, since the report is still cached in memory.            */
+
+    boost::system::error_code ec;
+    const path tmp = path{m_dir} / unique_path(".%%%%-%%%%-%%%%-%%%%.tmp");
+    {
+        std::ofstream ofs{tmp.string(), std::ios::binary};
+        report.save(ofs);
+        ofs.close();
+        if ( !ofs ) {
+            remove(tmp, ec);
+            return;
+        }
+    }
+    rename(tmp, file_name(report_name, arg, version), ec);
+    if ( ec ) {
+        remove(tmp, ec);
+        return;
+    }
+
+    /*  Remove saved reports for earlier versions  */
+
+    char prefix[version_digits + 1];
+    std::snprintf(prefix, sizeof(prefix), "%020llu", version);
+    for ( directory_iterator itr{m_dir, ec}, end; !ec && itr != end;
+          itr.increment(ec) ) {
+        const std::string name = itr->path().filename().string();
+        if ( name.length() > version_digits &&
+             name.compare(0, version_digits, prefix) < 0 &&
+             name[0] != '.' ) {
+            boost::system::error_code remove_ec;
+            remove(itr->path(), remove_ec);
+        }
+    }
+}
+
+size_t GLReportCache::size() const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_reports.size();
+}
+
+void GLReportCache::set_max_entries(const size_t max_entries)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_max_entries = max_entries;
+    if ( m_reports.size() > m_max_entries ) {
+        m_reports.clear();
+    }
+}
+
+void GLReportCache::purge_before(const unsigned long long version)
+{
+    m_reports.erase(m_reports.begin(),
+                    m_reports.lower_bound(key_type{version, "", ""}));
+}
+
+std::string GLReportCache::file_name(const std::string& report_name,
+                                     const std::string& arg,
+                                     const unsigned long long version) const
+{
+    char prefix[version_digits + 1];
+    std::snprintf(prefix, sizeof(prefix), "%020llu", version);
+    return (path{m_dir} / (std::string{prefix} + "-" +
+                           hex_encode(report_name) + "-" +
+                           hex_encode(arg) + ".glr")).string();
+}
+
+static std::string hex_encode(const std::string& s)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string encoded;
+    for ( const unsigned char c : s ) {
+        encoded += digits[c >> 4];
+        encoded += digits[c & 0x0f];
+    }
+    return encoded;
+}
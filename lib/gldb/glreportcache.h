@@ -0,0 +1,137 @@
+/*!
+ * \file            glreportcache.h
+ * \brief           Interface to report result cache class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_GL_REPORT_CACHE_H
+#define PG_GENERAL_LEDGER_GL_REPORT_CACHE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include "glreport.h"
+
+namespace genleg {
+
+/*!
+ * \brief           Report result cache class.
+ * \details         Caches reports keyed on report name, argument and
+ * ledger version. Since the ledger version changes whenever the data a
+ * report depends on changes, a cached report never needs to be
+ * invalidated explicitly; entries for earlier versions are simply
+ * discarded when a report for a later version is stored.
+ *
+ * Reports are always cached in memory. If a directory is given, they
+ * are also saved there, one file per report, so the cache can be shared
+ * between processes. Files are written to a temporary name and renamed
+ * into place, so readers never see a partial file.
+ *
+ * All member functions are thread-safe, so a single cache may be shared
+ * by several GLDatabase connections.
+ * \ingroup         gldatabase
+ */
+class GLReportCache {
+    public:
+
+        /*!
+         * \brief               Constructor.
+         * \param dir           The directory in which to save reports, or
+         * an empty string for an in-memory cache only.
+         * \param max_entries   The maximum number of reports to hold in
+         * memory.
+         * \throws              GLDBException if the directory cannot be
+         * created.
+         */
+        explicit GLReportCache (const std::string& dir = "",
+                                const size_t max_entries = 256);
+
+        /*!  Deleted copy constructor  */
+        GLReportCache (const GLReportCache&) = delete;
+
+        /*!  Deleted copy assignment operator  */
+        GLReportCache& operator=(const GLReportCache&) = delete;
+
+        /*!
+         * \brief               Finds a cached report.
+         * \param report_name   The name of the report.
+         * \param arg           The report argument.
+         * \param version       The current ledger version.
+         * \returns             A pointer to the cached report, or an empty
+         * pointer if it is not cached.
+         */
+        std::shared_ptr<const GLReport> find(const std::string& report_name,
+                                             const std::string& arg,
+                                             const unsigned long long version);
+
+        /*!
+         * \brief               Stores a report in the cache.
+         * \param report_name   The name of the report.
+         * \param arg           The report argument.
+         * \param version       The ledger version the report was run at.
+         * \param report        The report.
+         */
+        void store(const std::string& report_name,
+                   const std::string& arg,
+                   const unsigned long long version,
+                   const GLReport& report);
+
+        /*!
+         * \brief           Returns the number of reports held in memory.
+         * \returns         The number of reports held in memory.
+         */
+        size_t size() const;
+
+        /*!
+         * \brief               Changes the maximum number of reports to
+         * hold in memory.
+         * \details             Reports already held are discarded if there
+         * are more than the new maximum.
+         * \param max_entries   The maximum number of reports.
+         */
+        void set_max_entries(const size_t max_entries);
+
+    private:
+
+        /*!  Alias for cache key type  */
+        using key_type = std::tuple<unsigned long long,
+                                    std::string, std::string>;
+
+        /*!  The directory in which to save reports, or empty  */
+        const std::string m_dir;
+
+        /*!  The maximum number of reports to hold in memory  */
+        size_t m_max_entries;
+
+        /*!  Mutex guarding the cache  */
+        mutable std::mutex m_mutex;
+
+        /*!  The in-memory cache, ordered by ledger version  */
+        std::map<key_type, std::shared_ptr<const GLReport>> m_reports;
+
+        /*!
+         * \brief           Discards in-memory reports for earlier versions.
+         * \param version   The current ledger version.
+         */
+        void purge_before(const unsigned long long version);
+
+        /*!
+         * \brief               Returns the file name for a saved report.
+         * \param report_name   The name of the report.
+         * \param arg           The report argument.
+         * \param version       The ledger version.
+         * \returns             The path of the file.
+         */
+        std::string file_name(const std::string& report_name,
+                              const std::string& arg,
+                              const unsigned long long version) const;
+
+};              //  class GLReportCache
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_GL_REPORT_CACHE_H
@@ -0,0 +1,609 @@
+/*!
+ * \file            glserver.cpp
+ * \brief           Implementation of General Ledger server class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "glserver.h"
+#include "database_imp/backends.h"
+
+using namespace genleg;
+
+/*!
+ * \brief           How long \c run() waits for a connection before checking
+ * whether to stop, in milliseconds.
+ * \ingroup         gldatabase
+ */
+static const int stop_poll_msecs = 200;
+
+/*!
+ * \brief           Fills in a socket address.
+ * \ingroup         gldatabase
+ * \param addr      The address to fill in.
+ * \param path      The path of the socket.
+ * \throws          GLProtocolException if the path is too long.
+ */
+static void set_address(sockaddr_un& addr, const std::string& path);
+
+/*!
+ * \brief           Checks the number of arguments to a request.
+ * \ingroup         gldatabase
+ * \param request   The request.
+ * \param count     The number of arguments expected.
+ * \throws          GLProtocolException if the number is wrong.
+ */
+static void check_args(const GLRequest& request, const size_t count);
+
+/*!
+ * \brief           Checks the arguments of a request before it is run.
+ * \details         Arguments come from the client and many end up in SQL
+ * statements, so each is checked against what the request expects:
+ * numeric IDs, known report and permission names, and accounts which
+ * exist. An account found in the database is interned, so only names of
+ * real accounts are ever added to \c account_symbols().
+ * \ingroup         gldatabase
+ * \param gdb       The database connection.
+ * \param request   The request.
+ * \throws          GLProtocolException if an argument is bad.
+ */
+static void check_request(GLDatabase& gdb, const GLRequest& request);
+
+/*!
+ * \brief           Checks a numeric ID argument.
+ * \ingroup         gldatabase
+ * \param value     The argument.
+ * \param what      What the argument is, for the error message.
+ * \throws          GLProtocolException if it is not a number.
+ */
+static void check_id(const std::string& value, const std::string& what);
+
+/*!
+ * \brief           Checks a text argument which is quoted in SQL.
+ * \ingroup         gldatabase
+ * \param value     The argument.
+ * \param what      What the argument is, for the error message.
+ * \param allowed   Returns \c true for each character allowed, or
+ * \c nullptr to allow any character but a quote, backslash or control
+ * character.
+ * \throws          GLProtocolException if a character is not allowed.
+ */
+static void check_text(const std::string& value, const std::string& what,
+                       bool (*allowed)(const char) = nullptr);
+
+/*!
+ * \brief           Checks a character of a username.
+ * \ingroup         gldatabase
+ * \param c         The character.
+ * \returns         \c true for a letter, digit, '.', '_' or '-'.
+ */
+static bool username_char(const char c);
+
+/*!
+ * \brief           Checks a character of a password hash or salt.
+ * \ingroup         gldatabase
+ * \param c         The character.
+ * \returns         \c true for a character of the \c crypt() alphabet.
+ */
+static bool crypt_char(const char c);
+
+/*!
+ * \brief           Checks a password hash or salt argument.
+ * \details         Accepts a \c crypt() setting or hash of the form
+ * <tt>$id$[rounds=N$]salt[$hash]</tt>, as \c GLUser::set_password()
+ * makes, or a traditional two character salt or 13 character hash.
+ * \ingroup         gldatabase
+ * \param value     The argument.
+ * \param what      What the argument is, for the error message.
+ * \throws          GLProtocolException if it is not of either form.
+ */
+static void check_crypt(const std::string& value, const std::string& what);
+
+/*!
+ * \brief           Checks that an account exists, and interns it.
+ * \ingroup         gldatabase
+ * \param gdb       The database connection.
+ * \param account   The account name/number.
+ * \throws          GLProtocolException if there is no such account.
+ */
+static void check_account(GLDatabase& gdb, const std::string& account);
+
+/*!
+ * \brief           Checks that a permission name is known.
+ * \ingroup         gldatabase
+ * \param perm      The permission name.
+ * \throws          GLProtocolException if it is not known.
+ */
+static void check_permission(const std::string& perm);
+
+/*!
+ * \brief           Sets the send and receive timeouts of a client
+ * connection.
+ * \ingroup         gldatabase
+ * \param fd        The connection.
+ */
+static void set_timeouts(const int fd);
+
+GLServer::GLServer(GLDatabasePool& pool, const std::string& path) :
+    m_pool(pool),
+    m_path{path},
+    m_listen_fd{-1},
+    m_stopping{false},
+    m_served{0},
+    m_wake_fds{-1, -1},
+    m_mutex{},
+    m_cond{},
+    m_pending{},
+    m_returned{}
+{
+    sockaddr_un addr;
+    set_address(addr, path);
+
+    m_listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if ( m_listen_fd == -1 ) {
+        throw GLProtocolException(std::string{"couldn't create socket: "} +
+                                  std::strerror(errno));
+    }
+
+    struct stat st;
+    if ( ::stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode) ) {
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool live = probe != -1 &&
+            ::connect(probe, reinterpret_cast<sockaddr *>(&addr),
+                      sizeof(addr)) == 0;
+        if ( probe != -1 ) {
+            ::close(probe);
+        }
+        if ( live ) {
+            ::close(m_listen_fd);
+            throw GLProtocolException("a server is already listening on '" +
+                                      path + "'");
+        }
+        ::unlink(path.c_str());
+    }
+
+    /*  The socket is created with the permissions the umask allows, and
+     *  is connectable as soon as it is bound, so the umask is narrowed
+     *  for the bind rather than relying on the chmod which follows.    */
+
+    const mode_t old_mask = ::umask(S_IRWXG | S_IRWXO);
+    const int bound = ::bind(m_listen_fd, reinterpret_cast<sockaddr *>(&addr),
+                             sizeof(addr));
+    ::umask(old_mask);
+
+    if ( bound == -1 ||
+         ::chmod(path.c_str(), S_IRUSR | S_IWUSR) == -1 ||
+         ::listen(m_listen_fd, SOMAXCONN) == -1 ) {
+        const std::string error{std::strerror(errno)};
+        ::close(m_listen_fd);
+        throw GLProtocolException("couldn't listen on '" + path + "': " +
+                                  error);
+    }
+
+    if ( ::pipe(m_wake_fds) == -1 ||
+         ::fcntl(m_wake_fds[0], F_SETFL, O_NONBLOCK) == -1 ||
+         ::fcntl(m_wake_fds[1], F_SETFL, O_NONBLOCK) == -1 ) {
+        const std::string error{std::strerror(errno)};
+        for ( const int fd : m_wake_fds ) {
+            if ( fd != -1 ) {
+                ::close(fd);
+            }
+        }
+        ::close(m_listen_fd);
+        ::unlink(path.c_str());
+        throw GLProtocolException("couldn't create pipe: " + error);
+    }
+}
+
+GLServer::~GLServer() {
+    ::close(m_wake_fds[0]);
+    ::close(m_wake_fds[1]);
+    ::close(m_listen_fd);
+    ::unlink(m_path.c_str());
+}
+
+void GLServer::run() {
+    std::vector<std::thread> threads;
+    for ( size_t i = 0; i < m_pool.size(); ++i ) {
+        threads.emplace_back(&GLServer::worker, this);
+    }
+
+    std::vector<int> watched;
+    std::vector<pollfd> pfds;
+    while ( !m_stopping ) {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            watched.insert(watched.end(), m_returned.begin(),
+                           m_returned.end());
+            m_returned.clear();
+        }
+
+        pfds.clear();
+        pfds.push_back(pollfd{m_listen_fd, POLLIN, 0});
+        pfds.push_back(pollfd{m_wake_fds[0], POLLIN, 0});
+        for ( const int fd : watched ) {
+            pfds.push_back(pollfd{fd, POLLIN, 0});
+        }
+        if ( ::poll(pfds.data(), pfds.size(), stop_poll_msecs) <= 0 ) {
+            continue;
+        }
+
+        if ( pfds[1].revents ) {
+            char buffer[64];
+            while ( ::read(m_wake_fds[0], buffer, sizeof(buffer)) > 0 ) {
+            }
+        }
+
+        /*  A connection which is readable has either a request or been
+         *  closed, and the worker which reads it finds out which        */
+
+        std::vector<int> idle;
+        bool ready = false;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            for ( size_t i = 0; i < watched.size(); ++i ) {
+                if ( pfds[i + 2].revents ) {
+                    m_pending.push_back(watched[i]);
+                    ready = true;
+                }
+                else {
+                    idle.push_back(watched[i]);
+                }
+            }
+        }
+        if ( ready ) {
+            m_cond.notify_all();
+        }
+        watched.swap(idle);
+
+        if ( pfds[0].revents & POLLIN ) {
+            const int fd = ::accept(m_listen_fd, nullptr, nullptr);
+            if ( fd != -1 ) {
+                set_timeouts(fd);
+                watched.push_back(fd);
+            }
+        }
+    }
+
+    m_cond.notify_all();
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+
+    close_connections(watched);
+}
+
+GLResponse GLServer::handle(GLDatabase& gdb, const GLRequest& request) try {
+    check_request(gdb, request);
+    std::string body;
+
+    switch ( request.type ) {
+        case GLRequestType::report: {
+            std::ostringstream out;
+            gdb.report(request.args[0], request.args[1]).save(out);
+            body = out.str();
+            break;
+        }
+
+        case GLRequestType::post_journal:
+            gdb.post_journal(journal_from_strings(request.args));
+            break;
+
+        case GLRequestType::user_by_id:
+            body = encode_strings(user_to_strings(
+                        gdb.get_user_by_id(request.args[0])));
+            break;
+
+        case GLRequestType::user_by_username:
+            body = encode_strings(user_to_strings(
+                        gdb.get_user_by_username(request.args[0])));
+            break;
+
+        case GLRequestType::update_user:
+            gdb.update_user(user_from_strings(request.args));
+            break;
+
+        case GLRequestType::grant:
+            gdb.grant(gdb.get_user_by_id(request.args[0]), request.args[1]);
+            break;
+
+        case GLRequestType::revoke:
+            gdb.revoke(gdb.get_user_by_id(request.args[0]), request.args[1]);
+            break;
+    }
+
+    return GLResponse{GLResponseStatus::ok, body};
+}
+catch ( const std::exception& e ) {
+    return GLResponse{GLResponseStatus::error, e.what()};
+}
+
+void GLServer::worker() {
+    const gldb::BackendThread backend_thread;
+    while ( true ) {
+        int fd;
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_cond.wait(lock, [this] {
+                return m_stopping || !m_pending.empty();
+            });
+            if ( m_stopping ) {
+                return;
+            }
+            fd = m_pending.front();
+            m_pending.pop_front();
+        }
+
+        if ( !serve(fd) ) {
+            ::close(fd);
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_returned.push_back(fd);
+        }
+
+        /*  If the pipe is full, run() is already due to wake  */
+
+        const char wake = 0;
+        const ssize_t written = ::write(m_wake_fds[1], &wake, 1);
+        (void) written;
+    }
+}
+
+bool GLServer::serve(const int fd) {
+    try {
+        std::string payload;
+        if ( !read_frame(fd, payload) ) {
+            return false;
+        }
+
+        GLResponse response;
+        try {
+            const GLRequest request = decode_request(payload);
+            GLDatabasePool::Lease gdb = m_pool.acquire();
+            response = handle(*gdb, request);
+        }
+        catch ( const GLProtocolException& e ) {
+            response = GLResponse{GLResponseStatus::error, e.what()};
+        }
+        write_frame(fd, encode_response(response));
+        ++m_served;
+        return true;
+    }
+    catch ( const GLProtocolException& e ) {
+
+        //  The client has gone away or stalled, so there is no one to tell
+
+        return false;
+    }
+}
+
+void GLServer::close_connections(std::vector<int>& watched) {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for ( const int fd : watched ) {
+        ::close(fd);
+    }
+    for ( const int fd : m_pending ) {
+        ::close(fd);
+    }
+    for ( const int fd : m_returned ) {
+        ::close(fd);
+    }
+    watched.clear();
+    m_pending.clear();
+    m_returned.clear();
+}
+
+static void set_address(sockaddr_un& addr, const std::string& path) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if ( path.size() >= sizeof(addr.sun_path) ) {
+        throw GLProtocolException("socket path '" + path + "' too long");
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+}
+
+static void check_args(const GLRequest& request, const size_t count) {
+    if ( request.args.size() != count ) {
+        throw GLProtocolException("request has " +
+                                  std::to_string(request.args.size()) +
+                                  " arguments, expected " +
+                                  std::to_string(count));
+    }
+}
+
+static void check_request(GLDatabase& gdb, const GLRequest& request) {
+    const std::vector<std::string>& args = request.args;
+
+    switch ( request.type ) {
+        case GLRequestType::report:
+            check_args(request, 2);
+            if ( args[0] == "je" ) {
+                check_id(args[1], "journal entry ID");
+            }
+            else if ( args[0] == "standingdata" || args[0] == "listusers" ) {
+                if ( !args[1].empty() ) {
+                    throw GLProtocolException("report '" + args[0] +
+                                              "' takes no argument");
+                }
+            }
+
+            /*  The trial balance arguments are checked as they are
+             *  parsed, and nothing unchecked reaches the SQL            */
+
+            else if ( args[0] != "currenttb" && args[0] != "comparetb" ) {
+                throw GLProtocolException("unknown report '" + args[0] +
+                                          "'");
+            }
+            break;
+
+        case GLRequestType::post_journal:
+            if ( args.size() < gl_journal_fields ||
+                 (args.size() - gl_journal_fields) % 2 ) {
+                throw GLProtocolException("malformed journal entry");
+            }
+            check_text(args[3], "journal source");
+            check_text(args[4], "journal memo");
+            for ( size_t i = gl_journal_fields; i < args.size(); i += 2 ) {
+                check_account(gdb, args[i]);
+            }
+            break;
+
+        case GLRequestType::user_by_id:
+            check_args(request, 1);
+            check_id(args[0], "user ID");
+            break;
+
+        case GLRequestType::user_by_username:
+            check_args(request, 1);
+            check_text(args[0], "username", username_char);
+            break;
+
+        case GLRequestType::update_user:
+            if ( args.size() < gl_user_fields ) {
+                throw GLProtocolException("malformed user");
+            }
+            check_id(args[0], "user ID");
+            check_text(args[1], "username", username_char);
+            check_text(args[2], "first name");
+            check_text(args[3], "last name");
+            check_crypt(args[4], "password hash");
+            check_crypt(args[5], "password salt");
+            for ( size_t i = gl_user_fields; i < args.size(); ++i ) {
+                check_permission(args[i]);
+            }
+            break;
+
+        case GLRequestType::grant:
+        case GLRequestType::revoke:
+            check_args(request, 2);
+            check_id(args[0], "user ID");
+            check_permission(args[1]);
+            break;
+    }
+}
+
+static void check_id(const std::string& value, const std::string& what) {
+    if ( value.empty() || value.size() > 18 ||
+         !std::all_of(value.begin(), value.end(), [](const char c) {
+                 return c >= '0' && c <= '9';
+         }) ) {
+        throw GLProtocolException("bad " + what + " '" + value + "'");
+    }
+}
+
+static void check_text(const std::string& value, const std::string& what,
+                       bool (*allowed)(const char)) {
+    for ( const char c : value ) {
+        const unsigned char u = static_cast<unsigned char>(c);
+        const bool ok = allowed ? allowed(c) :
+                        u >= 0x20 && u != 0x7f && c != '\'' && c != '\\';
+        if ( !ok ) {
+            throw GLProtocolException("bad character in " + what);
+        }
+    }
+}
+
+static bool username_char(const char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) ||
+           c == '.' || c == '_' || c == '-';
+}
+
+static bool crypt_char(const char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) ||
+           c == '.' || c == '/';
+}
+
+static void check_crypt(const std::string& value, const std::string& what) {
+    auto all_of = [](const std::string& s, bool (*allowed)(const char)) {
+        return !s.empty() && std::all_of(s.begin(), s.end(), allowed);
+    };
+    auto digit = [](const char c) { return c >= '0' && c <= '9'; };
+    auto alnum = [](const char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) != 0;
+    };
+
+    bool ok;
+    if ( value.empty() || value[0] != '$' ) {
+        ok = (value.size() == 2 || value.size() == 13) &&
+             all_of(value, crypt_char);
+    }
+    else {
+        std::vector<std::string> fields;
+        size_t start = 1;
+        for ( size_t end; (end = value.find('$', start)) !=
+                          std::string::npos; start = end + 1 ) {
+            fields.push_back(value.substr(start, end - start));
+        }
+        fields.push_back(value.substr(start));
+
+        size_t salt = 1;
+        static const std::string rounds{"rounds="};
+        if ( fields.size() > 1 && fields[1].compare(0, rounds.size(),
+                                                    rounds) == 0 ) {
+            const std::string n = fields[1].substr(rounds.size());
+            ok = n.size() <= 9 && all_of(n, digit);
+            ++salt;
+        }
+        else {
+            ok = true;
+        }
+
+        ok = ok && all_of(fields[0], alnum) && fields.size() > salt &&
+             fields.size() <= salt + 2;
+        for ( size_t i = salt; ok && i < fields.size(); ++i ) {
+            ok = all_of(fields[i], crypt_char);
+        }
+    }
+
+    if ( !ok ) {
+        throw GLProtocolException("bad " + what);
+    }
+}
+
+static void check_account(GLDatabase& gdb, const std::string& account) {
+    uint32_t id;
+    if ( account_symbols().find(account, id) ) {
+        return;
+    }
+
+    const bool well_formed = !account.empty() &&
+        std::all_of(account.begin(), account.end(), [](const char c) {
+                return std::isalnum(static_cast<unsigned char>(c)) ||
+                       c == '-' || c == '_';
+        });
+    if ( !well_formed || !gdb.account_exists(account) ) {
+        throw GLProtocolException("unknown account '" + account + "'");
+    }
+    account_symbols().intern(account);
+}
+
+static void check_permission(const std::string& perm) {
+    uint32_t id;
+    if ( !permission_symbols().find(perm, id) ) {
+        throw GLProtocolException("unknown permission '" + perm + "'");
+    }
+}
+
+static void set_timeouts(const int fd) {
+    timeval timeout{gl_server_receive_timeout, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
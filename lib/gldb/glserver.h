@@ -0,0 +1,154 @@
+/*!
+ * \file            glserver.h
+ * \brief           Interface to General Ledger server class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_GL_SERVER_H
+#define PG_GENERAL_LEDGER_GL_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "gldatabasepool.h"
+#include "glprotocol.h"
+
+namespace genleg {
+
+/*!
+ * \brief           Seconds a server waits for the rest of a request once
+ * it has begun, before dropping the client.
+ * \ingroup         gldatabase
+ */
+const int gl_server_receive_timeout = 5;
+
+/*!
+ * \brief           General ledger server class.
+ * \details         Serves report, posting and user requests from
+ * \c GLClient connections on a Unix-domain socket, using a pool of open
+ * database connections so that no request pays for connecting or logging
+ * in. The thread calling \c run() watches every open client connection,
+ * and hands each request, as it arrives, to one of \c pool.size() worker
+ * threads, which leases a database connection, answers the request and
+ * hands the client connection back to be watched. An idle client
+ * therefore holds no worker, and a client which stalls part way through
+ * sending a request is dropped after \c gl_server_receive_timeout
+ * seconds.
+ * \ingroup         gldatabase
+ */
+class GLServer {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \details         Creates the socket, readable and writable only by
+         * the owner. A stale socket left by a server which has exited is
+         * replaced.
+         * \param pool      The database connection pool.
+         * \param path      The path of the socket.
+         * \throws          GLProtocolException if the socket could not be
+         * created, or another server is listening on it.
+         */
+        GLServer (GLDatabasePool& pool, const std::string& path);
+
+        /*!  Destructor, closing and removing the socket  */
+        ~GLServer ();
+
+        /*!  Deleted copy constructor  */
+        GLServer (const GLServer&) = delete;
+
+        /*!  Deleted copy assignment operator  */
+        GLServer& operator=(const GLServer&) = delete;
+
+        /*!
+         * \brief           Serves requests until \c stop() is called.
+         * \details         Open client connections are closed once any
+         * request being answered is answered.
+         */
+        void run();
+
+        /*!
+         * \brief           Asks \c run() to return.
+         * \details         Only sets a flag, so may be called from another
+         * thread or a signal handler.
+         */
+        void stop() { m_stopping = true; }
+
+        /*!
+         * \brief           Returns the number of requests served.
+         * \returns         The number of requests served.
+         */
+        size_t requests_served() const { return m_served; }
+
+        /*!
+         * \brief           Runs a single request.
+         * \param gdb       The database connection.
+         * \param request   The request.
+         * \returns         The response, with the error message if the
+         * request failed.
+         */
+        static GLResponse handle(GLDatabase& gdb, const GLRequest& request);
+
+    private:
+
+        /*!  The database connection pool  */
+        GLDatabasePool& m_pool;
+
+        /*!  The path of the socket  */
+        std::string m_path;
+
+        /*!  The listening socket  */
+        int m_listen_fd;
+
+        /*!  Set when the server should stop  */
+        std::atomic<bool> m_stopping;
+
+        /*!  The number of requests served  */
+        std::atomic<size_t> m_served;
+
+        /*!  Pipe written to by workers to wake \c run() from \c poll()  */
+        int m_wake_fds[2];
+
+        /*!  Mutex guarding the pending and returned connections  */
+        std::mutex m_mutex;
+
+        /*!  Signalled when a request arrives or the server stops  */
+        std::condition_variable m_cond;
+
+        /*!  Connections with a request waiting for a worker  */
+        std::deque<int> m_pending;
+
+        /*!  Connections whose request has been answered, to be watched
+         *   for the next                                               */
+        std::vector<int> m_returned;
+
+        /*!
+         * \brief           Worker thread function.
+         */
+        void worker();
+
+        /*!
+         * \brief           Serves one request on a connection.
+         * \param fd        The connection.
+         * \returns         \c false if the client closed the connection or
+         * it failed, and \c true if it should be watched for another
+         * request.
+         */
+        bool serve(const int fd);
+
+        /*!
+         * \brief           Closes every connection not in use by a worker.
+         * \param watched   The connections being watched.
+         */
+        void close_connections(std::vector<int>& watched);
+
+};              //  class GLServer
+
+}               //  namespace genleg
+
+#endif          //  PG_GENERAL_LEDGER_GL_SERVER_H
@@ -26,15 +26,18 @@ class GLStandingData {
          * \param period        The current accounting period.
          * \param year          The current accounting year.
          * \param num_periods   The number of accounting periods in a year.
+         * \param version       The ledger version.
          */
         GLStandingData (const std::string& organization,
                         const int period,
                         const int year,
-                        const int num_periods) :
+                        const int num_periods,
+                        const unsigned long long version = 0) :
             m_org{organization},
             m_period{period},
             m_year{year},
-            m_num_periods{num_periods}
+            m_num_periods{num_periods},
+            m_version{version}
         {}
 
         /*!
@@ -61,6 +64,14 @@ class GLStandingData {
          */
         int num_periods() const { return m_num_periods; }
 
+        /*!
+         * \brief           Returns the ledger version.
+         * \details         The ledger version is incremented whenever a
+         * journal entry is posted or users or permissions are changed.
+         * \returns         The ledger version.
+         */
+        unsigned long long ledger_version() const { return m_version; }
+
     private:
 
         /*!  Overall organization  */
@@ -75,6 +86,9 @@ class GLStandingData {
         /*!  Number of periods per year  */
         int m_num_periods;
 
+        /*!  Ledger version  */
+        unsigned long long m_version;
+
 };              //  class GLStandingData
 
 }               //  namespace genleg
@@ -24,6 +24,25 @@ GLUser::GLUser(const std::string& id,
     m_lastname(lastname),
     m_pass_hash(pass_hash),
     m_pass_salt(pass_salt),
+    m_perms(genleg::permission_set(perms)),
+    m_enabled(enabled)
+{
+}
+
+GLUser::GLUser(const std::string& id,
+               const std::string& username,
+               const std::string& firstname,
+               const std::string& lastname,
+               const std::string& pass_hash,
+               const std::string& pass_salt,
+               const GLPermissionSet& perms,
+               const bool enabled) :
+    m_id(id),
+    m_username(username),
+    m_firstname(firstname),
+    m_lastname(lastname),
+    m_pass_hash(pass_hash),
+    m_pass_salt(pass_salt),
     m_perms(perms),
     m_enabled(enabled)
 {
@@ -56,10 +75,20 @@ const std::string& GLUser::pass_salt() const {
     return m_pass_salt;
 }
 
-const std::vector<std::string>& GLUser::permissions() const {
+std::vector<std::string> GLUser::permissions() const {
+    return permission_names(m_perms);
+}
+
+const GLPermissionSet& GLUser::permission_set() const {
     return m_perms;
 }
 
+bool GLUser::has_permission(const std::string& perm) const {
+    uint32_t bit;
+    return permission_symbols().find(perm, bit) &&
+           bit < max_gl_permissions && m_perms.test(bit);
+}
+
 bool GLUser::enabled() const {
     return m_enabled;
 }
@@ -11,11 +11,20 @@
 
 #include <vector>
 #include <string>
+#include "glpermission.h"
 
 namespace genleg {
 
+/*!
+ * \brief           Default number of password hashing rounds.
+ * \ingroup         gldatabase
+ */
+constexpr unsigned int default_hash_rounds = 5000;
+
 /*!
  * \brief           General ledger user class
+ * \details         Permissions are held as a \c GLPermissionSet, so
+ * checking one is a single bit test.
  * \ingroup         gldatabase
  */
 class GLUser {
@@ -29,8 +38,10 @@ class GLUser {
          * \param lastname  Last name
          * \param pass_hash The hashed password
          * \param pass_salt The salt for the hashed password
-         * \param perms     Vector of user permissions
+         * \param perms     Vector of user permission names
          * \param enabled   `true` if user is enabled, `false` otherwise.
+         * \throws          GLDBException If there are too many distinct
+         * permissions.
          */
         GLUser (const std::string& id,
                 const std::string& username,
@@ -41,6 +52,26 @@ class GLUser {
                 std::vector<std::string>&& perms,
                 const bool enabled);
 
+        /*!
+         * \brief           Constructor.
+         * \param id        User ID
+         * \param username  Username
+         * \param firstname First name
+         * \param lastname  Last name
+         * \param pass_hash The hashed password
+         * \param pass_salt The salt for the hashed password
+         * \param perms     Set of user permissions
+         * \param enabled   `true` if user is enabled, `false` otherwise.
+         */
+        GLUser (const std::string& id,
+                const std::string& username,
+                const std::string& firstname,
+                const std::string& lastname,
+                const std::string& pass_hash,
+                const std::string& pass_salt,
+                const GLPermissionSet& perms,
+                const bool enabled);
+
         /*!  Destructor  */
         ~GLUser ();
 
@@ -83,9 +114,33 @@ class GLUser {
         /*!
          * \brief               Returns the permissions for a user.
          * \returns             A vector of strings containing the names of
-         * the permissions held by the user.
+         * the permissions held by the user, sorted.
+         */
+        std::vector<std::string> permissions() const;
+
+        /*!
+         * \brief               Returns the permissions for a user.
+         * \returns             The set of permissions held by the user.
+         */
+        const GLPermissionSet& permission_set() const;
+
+        /*!
+         * \brief               Checks whether a user holds a permission.
+         * \param perm          The permission.
+         * \returns             `true` if the user holds the permission,
+         * `false` otherwise.
+         */
+        bool has_permission(const GLPermission perm) const {
+            return m_perms.test(static_cast<size_t>(perm));
+        }
+
+        /*!
+         * \brief               Checks whether a user holds a permission.
+         * \param perm          The name of the permission.
+         * \returns             `true` if the user holds the permission,
+         * `false` otherwise, including if no user has it.
          */
-        const std::vector<std::string>& permissions() const;
+        bool has_permission(const std::string& perm) const;
 
         /*!
          * \brief           Returns the user's enabled status.
@@ -119,9 +174,15 @@ class GLUser {
 
         /*!
          * \brief               Sets a user's password hash and salt.
+         * \details             The password is hashed with SHA-512 crypt
+         * and a new random salt. May be called for different users from
+         * different threads.
          * \param new_pass      The new password, must be > 8 characters.
+         * \param rounds        The number of hashing rounds, from 1000 to
+         * 999999999, which sets how slow the hash is to compute.
          */
-        void set_password(const std::string& new_pass);
+        void set_password(const std::string& new_pass,
+                          const unsigned int rounds = default_hash_rounds);
 
         /*!
          * \brief               Checks a password against the user's hash.
@@ -151,14 +212,31 @@ class GLUser {
         /*!  User's password salt  */
         std::string m_pass_salt;
 
-        /*!  List of permissions  */
-        const std::vector<std::string> m_perms;
+        /*!  Set of permissions  */
+        const GLPermissionSet m_perms;
 
         /*!  User's enabled status  */
         bool m_enabled;
 
 };              //  class GLUser
 
+/*!
+ * \brief           Sets the passwords of many users at once.
+ * \details         Each hash is deliberately slow, so they are spread over
+ * a pool of threads.
+ * \ingroup         gldatabase
+ * \param users     The users.
+ * \param passwords The new password for each user, in the same order.
+ * \param threads   The number of threads to use.
+ * \param rounds    The number of hashing rounds.
+ * \throws          std::runtime_error if a password is too short, in
+ * which case some users may already have new passwords.
+ */
+void set_passwords(std::vector<GLUser>& users,
+                   const std::vector<std::string>& passwords,
+                   const size_t threads,
+                   const unsigned int rounds = default_hash_rounds);
+
 }               //  namespace genleg
 
 #endif          //  PG_GENERAL_LEDGER_GL_USER_H
@@ -1,9 +1,10 @@
 /*!
  * \file            gluser_pass.cpp
  * \brief           Implementation of password functions for user class
- * \todo            Implement a better form of password encryption. In
- * particular, these functions are not re-entrant, and only use the first
- * 8 characters of the password.
+ * \details         Passwords are hashed with SHA-512 crypt, using
+ * \c crypt_r() where it is available so that hashing is re-entrant, and
+ * otherwise \c crypt() under a lock. Hashes made by the earlier
+ * two-character DES salts are still checked correctly.
  * \author          Paul Griffiths
  * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
@@ -12,50 +13,144 @@
 /*!  UNIX feature test macro  */
 #define _XOPEN_SOURCE 600
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <random>
-#include <functional>
 #include <stdexcept>
+#include <thread>
 #include <unistd.h>
+#ifdef __linux__
+#include <crypt.h>
+#endif
 #include "gluser.h"
 
 using namespace genleg;
 
 /*!
- * \brief           Generates a random two-character salt for crypt()
- * \returns         The two-character salt.
+ * \brief           Generates a random SHA-512 crypt setting.
+ * \param rounds    The number of hashing rounds.
+ * \returns         The setting, with the rounds and a 16-character salt.
  */
-static std::string generate_salt();
+static std::string generate_salt(const unsigned int rounds);
 
-void GLUser::set_password(const std::string& new_pass) {
-    m_pass_salt = generate_salt();
+/*!
+ * \brief           Hashes a password.
+ * \param pass      The password.
+ * \param setting   The salt, or a setting giving the method, rounds and
+ * salt.
+ * \returns         The hashed password.
+ * \throws          std::runtime_error if the setting is not valid, or
+ * gives SHA-512 and the password could not be hashed with it.
+ */
+static std::string hash_password(const std::string& pass,
+                                 const std::string& setting);
+
+void GLUser::set_password(const std::string& new_pass,
+                          const unsigned int rounds) {
     if ( new_pass.length() < 8 ) {
         throw std::runtime_error("Password too short");
     }
-    m_pass_hash = crypt(new_pass.c_str(), m_pass_salt.c_str());
+    m_pass_salt = generate_salt(rounds);
+    m_pass_hash = hash_password(new_pass, m_pass_salt);
 }
 
 bool GLUser::check_password(const std::string& check_pass) {
     if ( check_pass.length() < 8 ) {
         throw std::runtime_error("Password too short");
     }
-    const std::string check_hash = crypt(check_pass.c_str(),
-                                         m_pass_salt.c_str());
-    return check_hash == m_pass_hash;
+    return hash_password(check_pass, m_pass_salt) == m_pass_hash;
+}
+
+void genleg::set_passwords(std::vector<GLUser>& users,
+                           const std::vector<std::string>& passwords,
+                           const size_t threads,
+                           const unsigned int rounds) {
+    if ( users.size() != passwords.size() ) {
+        throw std::runtime_error("Need one password for each user");
+    }
+
+    /*  Workers take the next user from a shared counter, so a slow
+     *  hash never holds up the others. The first failure stops them.  */
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        size_t i;
+        while ( !failed && (i = next++) < users.size() ) {
+            try {
+                users[i].set_password(passwords[i], rounds);
+            }
+            catch ( ... ) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if ( !error ) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    const size_t num_threads = std::min(std::max(threads, size_t{1}),
+                                        users.size());
+    for ( size_t t = 1; t < num_threads; ++t ) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for ( auto& thread : pool ) {
+        thread.join();
+    }
+
+    if ( error ) {
+        std::rethrow_exception(error);
+    }
 }
 
-static std::string generate_salt() {
+static std::string generate_salt(const unsigned int rounds) {
     static const char c[] = "abcdefghijklmnopqrstuvwxyz"
                             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
                             "0123456789./";
 
-    std::default_random_engine re(std::random_device{}());
+    thread_local std::mt19937 re(std::random_device{}());
     std::uniform_int_distribution<int> ud{0, sizeof c - 2};
     static_assert((sizeof c - 2) == 63, "Range upper bound incorrect");
-    auto gen = std::bind(ud, re);
-                    
-    std::string salt;
-    salt += c[gen()];
-    salt += c[gen()];
+
+    std::string salt{"$6$rounds=" + std::to_string(rounds) + "$"};
+    for ( int i = 0; i < 16; ++i ) {
+        salt += c[ud(re)];
+    }
     return salt;
 }
 
+static std::string hash_password(const std::string& pass,
+                                 const std::string& setting) {
+#ifdef __linux__
+    std::unique_ptr<struct crypt_data> data{new struct crypt_data()};
+    const char * hash = crypt_r(pass.c_str(), setting.c_str(), data.get());
+#else
+    static std::mutex crypt_mutex;
+    std::lock_guard<std::mutex> lock(crypt_mutex);
+    const char * hash = crypt(pass.c_str(), setting.c_str());
+#endif
+
+    /*  A crypt() without SHA-512 may fall back to DES, which silently
+     *  uses only the first eight characters of the password, rather
+     *  than failing, so a SHA-512 setting must give a SHA-512 hash.
+     *  Legacy DES settings are still accepted, to check old hashes.    */
+
+    static const char sha512[] = "$6$";
+    const size_t len = sizeof(sha512) - 1;
+    if ( !hash || hash[0] == '*' ||
+         (setting.compare(0, len, sha512) == 0 &&
+          std::strncmp(hash, sha512, len) != 0) ) {
+        throw std::runtime_error("Could not hash password");
+    }
+    return hash;
+}
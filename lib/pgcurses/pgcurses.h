@@ -12,6 +12,9 @@
 #include "tpgentypes.h"
 #include "tpfunctions.h"
 #include "tpexception.h"
+#include "tpcellbuffer.h"
+#include "tprowsource.h"
+#include "tprowcache.h"
 #include "termprogram.h"
 #include "tpwindows.h"
 
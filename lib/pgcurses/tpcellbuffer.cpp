@@ -0,0 +1,141 @@
+/*!
+ * \file            tpcellbuffer.cpp
+ * \brief           Implementation of off-screen window cell buffer class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include "tpcellbuffer.h"
+
+using namespace pgcurses;
+
+TPCellBuffer::TPCellBuffer(const Size sz) :
+    m_size{std::max(sz.width, 0), std::max(sz.height, 0)},
+    m_cursor{},
+    m_cells(m_size.width * m_size.height, ' '),
+    m_shown(m_cells),
+    m_first_dirty(m_size.height, m_size.width),
+    m_last_dirty(m_size.height, -1)
+{
+}
+
+void TPCellBuffer::write_char(const char ch)
+{
+    if ( ch == '\n' ) {
+        if ( m_cursor.y >= 0 && m_cursor.y < m_size.height ) {
+            for ( int x = std::max(m_cursor.x, 0); x < m_size.width; ++x ) {
+                set_cell(' ', Point{x, m_cursor.y});
+            }
+        }
+        m_cursor = Point{0, m_cursor.y + 1};
+        return;
+    }
+
+    if ( contains(m_cursor) ) {
+        set_cell(ch, m_cursor);
+    }
+
+    if ( ++m_cursor.x >= m_size.width ) {
+        m_cursor = Point{0, m_cursor.y + 1};
+    }
+}
+
+void TPCellBuffer::write_char(const char ch, const Point pt)
+{
+    m_cursor = pt;
+    write_char(ch);
+}
+
+void TPCellBuffer::write_str(const std::string& s)
+{
+    for ( const char ch : s ) {
+        write_char(ch);
+    }
+}
+
+void TPCellBuffer::write_str(const std::string& s, const Point pt)
+{
+    m_cursor = pt;
+    write_str(s);
+}
+
+char TPCellBuffer::cell(const Point pt) const
+{
+    return contains(pt) ? m_cells[pt.y * m_size.width + pt.x] : ' ';
+}
+
+Rectangle TPCellBuffer::damage() const
+{
+    int left = m_size.width, right = -1, top = -1, bottom = -1;
+    for ( int y = 0; y < m_size.height; ++y ) {
+        if ( m_last_dirty[y] >= 0 ) {
+            left = std::min(left, m_first_dirty[y]);
+            right = std::max(right, m_last_dirty[y]);
+            if ( top < 0 ) {
+                top = y;
+            }
+            bottom = y;
+        }
+    }
+
+    if ( top < 0 ) {
+        return Rectangle{};
+    }
+    return Rectangle{Size{right - left + 1, bottom - top + 1},
+                     Point{left, top}};
+}
+
+std::vector<CellRun> TPCellBuffer::flush()
+{
+    std::vector<CellRun> runs;
+    for ( int y = 0; y < m_size.height; ++y ) {
+        const int row = y * m_size.width;
+        const int last = m_last_dirty[y];
+        int x = m_first_dirty[y];
+
+        while ( x <= last ) {
+            if ( m_cells[row + x] == m_shown[row + x] ) {
+                ++x;
+                continue;
+            }
+
+            /*  Extend the run over short gaps of unchanged cells  */
+
+            int end = x;
+            for ( int i = x + 1; i <= last && i - end <= max_run_gap + 1;
+                  ++i ) {
+                if ( m_cells[row + i] != m_shown[row + i] ) {
+                    end = i;
+                }
+            }
+
+            runs.push_back(CellRun{Point{x, y},
+                    std::string(m_cells.begin() + row + x,
+                                m_cells.begin() + row + end + 1)});
+            std::copy(m_cells.begin() + row + x,
+                      m_cells.begin() + row + end + 1,
+                      m_shown.begin() + row + x);
+            x = end + 1;
+        }
+
+        m_first_dirty[y] = m_size.width;
+        m_last_dirty[y] = -1;
+    }
+    return runs;
+}
+
+void TPCellBuffer::invalidate()
+{
+    std::fill(m_shown.begin(), m_shown.end(), '\0');
+    std::fill(m_first_dirty.begin(), m_first_dirty.end(), 0);
+    std::fill(m_last_dirty.begin(), m_last_dirty.end(), m_size.width - 1);
+}
+
+void TPCellBuffer::set_cell(const char ch, const Point pt)
+{
+    m_cells[pt.y * m_size.width + pt.x] = ch;
+    m_first_dirty[pt.y] = std::min(m_first_dirty[pt.y], pt.x);
+    m_last_dirty[pt.y] = std::max(m_last_dirty[pt.y], pt.x);
+}
@@ -0,0 +1,171 @@
+/*!
+ * \file            tpcellbuffer.h
+ * \brief           Interface to off-screen window cell buffer class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_PGCURSES_TPCELLBUFFER_H
+#define PG_PGCURSES_TPCELLBUFFER_H
+
+#include <string>
+#include <vector>
+#include "tpgentypes.h"
+
+namespace pgcurses {
+
+/*!
+ * \brief               A run of cells on one row to be written out.
+ * \ingroup             pgcurses
+ */
+struct CellRun {
+
+    /*!  The first cell of the run  */
+    Point origin;
+
+    /*!  The contents of the cells  */
+    std::string text;
+};
+
+/*!
+ * \brief               Off-screen window cell buffer class.
+ * \details             Holds the contents a window should show, and the
+ * contents last written out, and tracks which span of each row has been
+ * written to since. \c flush() then returns only the cells which differ,
+ * so any number of writes between two frames costs one pass over the
+ * damaged area, and rewriting a cell with what is already shown costs
+ * nothing. Writes outside the buffer are clipped.
+ * \ingroup             pgcurses
+ */
+class TPCellBuffer {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \details         Every cell starts, and is taken to be shown, as
+         * a space, as in a new curses window.
+         * \param sz        The size of the buffer.
+         */
+        explicit TPCellBuffer (const Size sz);
+
+        /*!
+         * \brief           Returns the size of the buffer.
+         * \returns         The size of the buffer.
+         */
+        Size size() const { return m_size; }
+
+        /*!
+         * \brief           Returns the current position.
+         * \returns         The current position.
+         */
+        Point position() const { return m_cursor; }
+
+        /*!
+         * \brief           Writes a character to the current position.
+         * \details         The position moves on to the next cell,
+         * wrapping at the end of a row. A newline clears the rest of the
+         * row, as in curses, and moves to the start of the next row.
+         * \param ch        The character to write.
+         */
+        void write_char(const char ch);
+
+        /*!
+         * \brief           Writes a character to a specified position.
+         * \param ch        The character to write.
+         * \param pt        The point at which to write.
+         */
+        void write_char(const char ch, const Point pt);
+
+        /*!
+         * \brief           Writes a string to the current position.
+         * \param s         The string to write.
+         */
+        void write_str(const std::string& s);
+
+        /*!
+         * \brief           Writes a string to a specified position.
+         * \param s         The string to write.
+         * \param pt        The point at which to write.
+         */
+        void write_str(const std::string& s, const Point pt);
+
+        /*!
+         * \brief           Returns the contents of a cell.
+         * \param pt        The cell.
+         * \returns         The character to be shown, or a space for a
+         * cell outside the buffer.
+         */
+        char cell(const Point pt) const;
+
+        /*!
+         * \brief           Returns the area written to since the last
+         * flush.
+         * \returns         The smallest rectangle holding every cell
+         * written to, which is empty if there is none.
+         */
+        Rectangle damage() const;
+
+        /*!
+         * \brief           Returns the cells which differ from those last
+         * written out, and marks them as written out.
+         * \details         Changed cells on a row separated by only a few
+         * unchanged ones are returned as one run, since rewriting a short
+         * gap is cheaper than moving the terminal cursor over it.
+         * \returns         The runs, in order of row and then column.
+         */
+        std::vector<CellRun> flush();
+
+        /*!
+         * \brief           Marks every cell as needing to be written out,
+         * as after the screen has been cleared.
+         */
+        void invalidate();
+
+    private:
+
+        /*!  Most unchanged cells inside one run  */
+        static const int max_run_gap = 3;
+
+        /*!  The size of the buffer  */
+        Size m_size;
+
+        /*!  The current position  */
+        Point m_cursor;
+
+        /*!  The cells to be shown, row by row  */
+        std::vector<char> m_cells;
+
+        /*!  The cells as last written out, row by row  */
+        std::vector<char> m_shown;
+
+        /*!  The first column written to on each row, or the width if
+         *   none has been  */
+        std::vector<int> m_first_dirty;
+
+        /*!  The last column written to on each row, or -1 if none has
+         *   been  */
+        std::vector<int> m_last_dirty;
+
+        /*!
+         * \brief           Checks whether a point is inside the buffer.
+         * \param pt        The point.
+         * \returns         \c true if the point is inside the buffer.
+         */
+        bool contains(const Point pt) const {
+            return pt.x >= 0 && pt.y >= 0 &&
+                   pt.x < m_size.width && pt.y < m_size.height;
+        }
+
+        /*!
+         * \brief           Sets a cell and marks it as written to.
+         * \param ch        The character.
+         * \param pt        The cell, which must be inside the buffer.
+         */
+        void set_cell(const char ch, const Point pt);
+
+};              //  class TPCellBuffer
+
+}               //  namespace pgcurses
+
+#endif          //  PG_PGCURSES_TPCELLBUFFER_H
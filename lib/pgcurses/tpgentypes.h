@@ -103,7 +103,11 @@ struct Key {
         Up,
         Left,
         Down,
-        Right
+        Right,
+        PageUp,
+        PageDown,
+        Home,
+        End
     };
 
     enum KeyValue value;
@@ -0,0 +1,150 @@
+/*!
+ * \file            tpgrid.cpp
+ * \brief           Implementation of grid control class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include <sstream>
+#include "tpgrid.h"
+#include "tpexception.h"
+
+using namespace pgcurses;
+
+TPGrid::TPGrid(const Rectangle rect, TPRowSource& source) :
+    TPControl{rect},
+    m_size{rect.size},
+    m_cache{source},
+    m_current{0},
+    m_top{0}
+{
+    if ( m_size.height < 3 || m_size.width < 1 ) {
+        throw TPException("Grid is too small");
+    }
+}
+
+void TPGrid::move(const long delta)
+{
+    if ( delta < 0 ) {
+        const size_t up = static_cast<size_t>(-delta);
+        move_to(up > m_current ? 0 : m_current - up);
+    }
+    else {
+        const size_t down = static_cast<size_t>(delta);
+        move_to(m_current + std::min(down, m_cache.num_rows()));
+    }
+}
+
+void TPGrid::move_to(const size_t idx)
+{
+    const size_t num_rows = m_cache.num_rows();
+    if ( num_rows == 0 ) {
+        m_current = m_top = 0;
+        return;
+    }
+
+    m_current = std::min(idx, num_rows - 1);
+    if ( m_current < m_top ) {
+        m_top = m_current;
+    }
+    else if ( m_current >= m_top + visible_rows() ) {
+        m_top = m_current - visible_rows() + 1;
+    }
+}
+
+bool TPGrid::handle_key(const Key key)
+{
+    const long page = static_cast<long>(visible_rows());
+
+    switch ( key.value ) {
+        case Key::KeyValue::Up:
+            move(-1);
+            return true;
+
+        case Key::KeyValue::Down:
+            move(1);
+            return true;
+
+        case Key::KeyValue::PageUp:
+            move(-page);
+            return true;
+
+        case Key::KeyValue::PageDown:
+            move(page);
+            return true;
+
+        case Key::KeyValue::Home:
+            move_to(0);
+            return true;
+
+        case Key::KeyValue::End:
+            move_to(m_cache.num_rows());
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void TPGrid::render()
+{
+    const size_t num_rows = m_cache.num_rows();
+
+    /*  Fetch the pages in view before formatting anything, since
+     *  fetching rows may widen the columns  */
+
+    const size_t end = std::min(m_top + visible_rows(), num_rows);
+    if ( end > m_top ) {
+        m_cache.row(m_top);
+        m_cache.row(end - 1);
+    }
+
+    write_str(format_row(m_cache.headers(), ' '), Point{0, 0});
+    for ( size_t i = 0; i < visible_rows(); ++i ) {
+        const size_t idx = m_top + i;
+        const Point pt{0, static_cast<int>(i) + 1};
+        if ( idx < end ) {
+            write_str(format_row(m_cache.row(idx),
+                                 idx == m_current ? '>' : ' '), pt);
+        }
+        else {
+            write_str(std::string(m_size.width, ' '), pt);
+        }
+    }
+
+    std::ostringstream ss;
+    if ( num_rows == 0 ) {
+        ss << "No rows";
+    }
+    else {
+        ss << "Row " << m_current + 1 << " of " << num_rows;
+    }
+    std::string status = ss.str();
+    status.resize(m_size.width, ' ');
+    write_str(status, Point{0, m_size.height - 1});
+
+    draw();
+}
+
+void TPGrid::refresh()
+{
+    m_cache.refresh();
+    move_to(m_current);
+}
+
+std::string TPGrid::format_row(const TPRow& row, const char marker) const
+{
+    const std::vector<size_t>& widths = m_cache.column_widths();
+
+    std::string line{marker};
+    for ( size_t i = 0; i < widths.size(); ++i ) {
+        std::string field = i < row.size() ? row[i] : std::string{};
+        field.resize(widths[i], ' ');
+        line += ' ';
+        line += field;
+    }
+    line.resize(m_size.width, ' ');
+    return line;
+}
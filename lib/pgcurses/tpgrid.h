@@ -0,0 +1,140 @@
+/*!
+ * \file            tpgrid.h
+ * \brief           Interface to grid control class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_PGCURSES_TPGRID_H
+#define PG_PGCURSES_TPGRID_H
+
+#include <cstddef>
+#include <string>
+#include "tpgentypes.h"
+#include "tpcontrol.h"
+#include "tprowsource.h"
+#include "tprowcache.h"
+
+namespace pgcurses {
+
+/*!
+ * \brief               Grid control class.
+ * \details             Shows rows from a \c TPRowSource under a line of
+ * column headings, with a status line below them, and scrolls through
+ * them with a current row. Only the rows in view are written, and rows
+ * are fetched a page at a time through a \c TPRowCache, so scrolling
+ * costs the same however many rows the source has.
+ * \ingroup             pgcurses
+ */
+class TPGrid : public TPControl {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \param rect      The grid's rectangle, which must be at least
+         * three rows high.
+         * \param source    The row source, which must outlive the grid.
+         * \throws          TPException on failure.
+         */
+        TPGrid (const Rectangle rect, TPRowSource& source);
+
+        /*!  Destructor  */
+        virtual ~TPGrid () {};
+
+        /*!  Deleted copy constructor  */
+        TPGrid(const TPGrid& tp) = delete;
+
+        /*!  Deleted move constructor  */
+        TPGrid(TPGrid&& tp) = delete;
+
+        /*!  Deleted copy assignment operator  */
+        TPGrid& operator=(const TPGrid& tp) = delete;
+
+        /*!  Deleted move assignment operator  */
+        TPGrid& operator=(TPGrid&& tp) = delete;
+
+        /*!
+         * \brief           Returns the current row.
+         * \returns         The index of the current row.
+         */
+        size_t current_row() const { return m_current; }
+
+        /*!
+         * \brief           Returns the first row in view.
+         * \returns         The index of the first row in view.
+         */
+        size_t top_row() const { return m_top; }
+
+        /*!
+         * \brief           Moves the current row, scrolling to keep it in
+         * view.
+         * \details         The move stops at the first or last row.
+         * \param delta     The number of rows to move, negative to move
+         * up.
+         */
+        void move(const long delta);
+
+        /*!
+         * \brief           Makes a row the current row, scrolling to keep
+         * it in view.
+         * \param idx       The index of the row, which is moved to the
+         * last row if it is beyond it.
+         */
+        void move_to(const size_t idx);
+
+        /*!
+         * \brief           Moves the current row for a navigation key.
+         * \param key       The key.
+         * \returns         \c true if the key was a navigation key,
+         * \c false otherwise.
+         */
+        bool handle_key(const Key key);
+
+        /*!
+         * \brief           Writes the rows in view and draws the grid.
+         */
+        void render();
+
+        /*!
+         * \brief           Drops every fetched row, so the rows in view
+         * are fetched again at the next \c render().
+         */
+        void refresh();
+
+    private:
+
+        /*!  The size of the grid  */
+        const Size m_size;
+
+        /*!  The fetched rows  */
+        TPRowCache m_cache;
+
+        /*!  The index of the current row  */
+        size_t m_current;
+
+        /*!  The index of the first row in view  */
+        size_t m_top;
+
+        /*!
+         * \brief           Returns the number of rows in view.
+         * \returns         The number of rows between the headings and
+         * the status line.
+         */
+        size_t visible_rows() const {
+            return static_cast<size_t>(m_size.height - 2);
+        }
+
+        /*!
+         * \brief           Formats a row into columns.
+         * \param row       The row.
+         * \param marker    The character to show before the row.
+         * \returns         The line, padded or cut to the grid's width.
+         */
+        std::string format_row(const TPRow& row, const char marker) const;
+
+};              //  class TPGrid
+
+}               //  namespace pgcurses
+
+#endif          //  PG_PGCURSES_TPGRID_H
@@ -0,0 +1,105 @@
+/*!
+ * \file            tprowcache.cpp
+ * \brief           Implementation of grid row page cache class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include "tprowcache.h"
+#include "tpexception.h"
+
+using namespace pgcurses;
+
+const size_t TPRowCache::max_column_width;
+
+TPRowCache::TPRowCache(TPRowSource& source,
+                       const size_t page_rows,
+                       const size_t max_pages,
+                       const size_t sample_rows) :
+    m_source(source),
+    m_page_rows{page_rows},
+    m_max_pages{max_pages},
+    m_sample_rows{sample_rows},
+    m_sampled{0},
+    m_fetches{0},
+    m_counted{false},
+    m_num_rows{0},
+    m_headers{source.headers()},
+    m_widths{},
+    m_pages{}
+{
+    if ( m_page_rows == 0 || m_max_pages == 0 ) {
+        throw TPException("Row cache needs a page size and page count");
+    }
+    for ( const auto& heading : m_headers ) {
+        m_widths.push_back(std::min(heading.size(), max_column_width));
+    }
+}
+
+size_t TPRowCache::num_rows()
+{
+    if ( !m_counted ) {
+        m_num_rows = m_source.num_rows();
+        m_counted = true;
+    }
+    return m_num_rows;
+}
+
+const TPRow& TPRowCache::row(const size_t idx)
+{
+    const size_t page = idx / m_page_rows;
+    const size_t offset = idx % m_page_rows;
+
+    auto found = m_pages.find(page);
+    const std::vector<TPRow>& rows = found == m_pages.end() ?
+        fetch_page(page) : found->second;
+
+    if ( offset >= rows.size() ) {
+        throw TPException("Row " + std::to_string(idx) + " does not exist");
+    }
+    return rows[offset];
+}
+
+void TPRowCache::refresh()
+{
+    m_pages.clear();
+    m_counted = false;
+}
+
+const std::vector<TPRow>& TPRowCache::fetch_page(const size_t page)
+{
+    if ( m_pages.size() >= m_max_pages ) {
+
+        /*  Drop whichever of the first and last held pages is further
+         *  away, which keeps the pages around a scrolling viewport.  */
+
+        const size_t first = m_pages.begin()->first;
+        const size_t last = m_pages.rbegin()->first;
+        const size_t below = page > first ? page - first : first - page;
+        const size_t above = page > last ? page - last : last - page;
+        m_pages.erase(below > above ? first : last);
+    }
+
+    std::vector<TPRow> rows = m_source.fetch(page * m_page_rows,
+                                             m_page_rows);
+    ++m_fetches;
+    sample(rows);
+    return m_pages.emplace(page, std::move(rows)).first->second;
+}
+
+void TPRowCache::sample(const std::vector<TPRow>& rows)
+{
+    for ( const auto& row : rows ) {
+        if ( m_sampled >= m_sample_rows ) {
+            return;
+        }
+        for ( size_t i = 0; i < row.size() && i < m_widths.size(); ++i ) {
+            m_widths[i] = std::max(m_widths[i],
+                                   std::min(row[i].size(),
+                                            max_column_width));
+        }
+        ++m_sampled;
+    }
+}
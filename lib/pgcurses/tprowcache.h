@@ -0,0 +1,151 @@
+/*!
+ * \file            tprowcache.h
+ * \brief           Interface to grid row page cache class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_PGCURSES_TPROWCACHE_H
+#define PG_PGCURSES_TPROWCACHE_H
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include "tprowsource.h"
+
+namespace pgcurses {
+
+/*!
+ * \brief               Grid row page cache class.
+ * \details             Fetches rows from a \c TPRowSource a page at a
+ * time as they are asked for, and holds a few pages, dropping those
+ * furthest from the page last asked for. Column widths are taken from the
+ * headings and the first rows fetched, rather than from every row, so
+ * neither memory nor time grows with the size of the source.
+ * \ingroup             pgcurses
+ */
+class TPRowCache {
+    public:
+
+        /*!
+         * \brief               Constructor.
+         * \param source        The row source, which must outlive the
+         * cache.
+         * \param page_rows     The number of rows in a page.
+         * \param max_pages     The most pages to hold.
+         * \param sample_rows   The number of rows from which to take
+         * column widths.
+         * \throws              TPException if \c page_rows or
+         * \c max_pages is zero.
+         */
+        explicit TPRowCache (TPRowSource& source,
+                             const size_t page_rows = 128,
+                             const size_t max_pages = 8,
+                             const size_t sample_rows = 256);
+
+        /*!  Deleted copy constructor  */
+        TPRowCache(const TPRowCache& cache) = delete;
+
+        /*!  Deleted copy assignment operator  */
+        TPRowCache& operator=(const TPRowCache& cache) = delete;
+
+        /*!
+         * \brief           Returns the column headings.
+         * \returns         The column headings.
+         */
+        const TPRow& headers() const { return m_headers; }
+
+        /*!
+         * \brief           Returns the number of rows.
+         * \details         The source is asked only once, until the next
+         * \c refresh().
+         * \returns         The number of rows.
+         */
+        size_t num_rows();
+
+        /*!
+         * \brief           Returns a row, fetching its page if needed.
+         * \param idx       The index of the row.
+         * \returns         A reference to the row, valid until the next
+         * call to \c row() or \c refresh().
+         * \throws          TPException if the row does not exist.
+         */
+        const TPRow& row(const size_t idx);
+
+        /*!
+         * \brief           Returns the width of each column.
+         * \returns         The widths, in the order of the headings.
+         */
+        const std::vector<size_t>& column_widths() const { return m_widths; }
+
+        /*!
+         * \brief           Returns the number of pages fetched.
+         * \returns         The number of pages fetched from the source.
+         */
+        size_t pages_fetched() const { return m_fetches; }
+
+        /*!
+         * \brief           Drops every held page and the row count, so
+         * they are fetched again.
+         */
+        void refresh();
+
+    private:
+
+        /*!  Widest a column is made  */
+        static const size_t max_column_width = 40;
+
+        /*!  The row source  */
+        TPRowSource& m_source;
+
+        /*!  The number of rows in a page  */
+        const size_t m_page_rows;
+
+        /*!  The most pages to hold  */
+        const size_t m_max_pages;
+
+        /*!  The number of rows from which to take column widths  */
+        const size_t m_sample_rows;
+
+        /*!  The number of rows column widths have been taken from  */
+        size_t m_sampled;
+
+        /*!  The number of pages fetched  */
+        size_t m_fetches;
+
+        /*!  `true` if \c m_num_rows is known  */
+        bool m_counted;
+
+        /*!  The number of rows  */
+        size_t m_num_rows;
+
+        /*!  The column headings  */
+        TPRow m_headers;
+
+        /*!  The width of each column  */
+        std::vector<size_t> m_widths;
+
+        /*!  The held pages, by page number  */
+        std::map<size_t, std::vector<TPRow>> m_pages;
+
+        /*!
+         * \brief           Fetches a page, dropping another if too many
+         * are held.
+         * \param page      The page number.
+         * \returns         A reference to the page.
+         */
+        const std::vector<TPRow>& fetch_page(const size_t page);
+
+        /*!
+         * \brief           Widens the columns to fit some rows, until
+         * enough rows have been sampled.
+         * \param rows      The rows.
+         */
+        void sample(const std::vector<TPRow>& rows);
+
+};              //  class TPRowCache
+
+}               //  namespace pgcurses
+
+#endif          //  PG_PGCURSES_TPROWCACHE_H
@@ -0,0 +1,63 @@
+/*!
+ * \file            tprowsource.h
+ * \brief           Interface to grid row source abstract class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_PGCURSES_TPROWSOURCE_H
+#define PG_PGCURSES_TPROWSOURCE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace pgcurses {
+
+/*!
+ * \brief               A row of a grid, one string for each column.
+ * \ingroup             pgcurses
+ */
+using TPRow = std::vector<std::string>;
+
+/*!
+ * \brief               Grid row source abstract class.
+ * \details             Supplies the rows a \c TPGrid shows, a page at a
+ * time, so a source may hold them in memory or fetch each page from a
+ * database as it is needed.
+ * \ingroup             pgcurses
+ */
+class TPRowSource {
+    public:
+
+        /*!  Destructor  */
+        virtual ~TPRowSource () {}
+
+        /*!
+         * \brief           Returns the column headings.
+         * \returns         The column headings.
+         */
+        virtual TPRow headers() = 0;
+
+        /*!
+         * \brief           Returns the number of rows.
+         * \returns         The number of rows.
+         */
+        virtual size_t num_rows() = 0;
+
+        /*!
+         * \brief           Returns a page of rows.
+         * \param first     The index of the first row to return.
+         * \param count     The number of rows to return.
+         * \returns         The rows, which are fewer than \c count only at
+         * the end of the source.
+         */
+        virtual std::vector<TPRow> fetch(const size_t first,
+                                         const size_t count) = 0;
+
+};              //  class TPRowSource
+
+}               //  namespace pgcurses
+
+#endif          //  PG_PGCURSES_TPROWSOURCE_H
@@ -53,6 +53,18 @@ Key TPWindow::get_key()
         case KEY_RIGHT:
             return Key(Key::KeyValue::Right);
 
+        case KEY_PPAGE:
+            return Key(Key::KeyValue::PageUp);
+
+        case KEY_NPAGE:
+            return Key(Key::KeyValue::PageDown);
+
+        case KEY_HOME:
+            return Key(Key::KeyValue::Home);
+
+        case KEY_END:
+            return Key(Key::KeyValue::End);
+
         default:
             return Key(Key::KeyValue::Value, kv);
     }
@@ -78,6 +90,11 @@ void TPWindow::write_str(const std::string& s, const Point pt)
     m_imp->write_str(s, pt);
 }
 
+void TPWindow::stage()
+{
+    m_imp->stage();
+}
+
 void TPWindow::draw()
 {
     m_imp->draw();
@@ -88,3 +105,7 @@ void TPWindow::redraw()
     m_imp->redraw();
 }
 
+void TPWindow::update_screen()
+{
+    TPWindowImp::update_screen();
+}
@@ -87,8 +87,18 @@ class TPWindow {
          */
         void write_str(const std::string& s, const Point pt);
 
+        /*!
+         * \brief           Prepares the window for the next screen update,
+         * without updating the screen.
+         * \details         Staging several windows and then calling
+         * \c update_screen() draws them all in one terminal update.
+         */
+        void stage();
+
         /*!
          * \brief           Draws the window.
+         * \details         Only the cells changed since the window was last
+         * drawn are sent to the terminal.
          */
         void draw();
 
@@ -97,6 +107,11 @@ class TPWindow {
          */
         void redraw();
 
+        /*!
+         * \brief           Updates the screen with every staged window.
+         */
+        static void update_screen();
+
     private:
         
         /*!  Pointer to implementation  */
@@ -44,13 +44,15 @@ WINDOW * make_new_window(const Rectangle rect)
 TPWindowImp::TPWindowImp(const Point origin, const Size sz) :
     m_win{::make_new_window(Rectangle{sz, origin})},
     m_origin{origin},
-    m_size{sz}
+    m_size{sz},
+    m_cells{sz}
 {}
 
 TPWindowImp::TPWindowImp(const Rectangle rect) :
     m_win{::make_new_window(rect)},
     m_origin{rect.origin},
-    m_size{rect.size}
+    m_size{rect.size},
+    m_cells{rect.size}
 {}
 
 TPWindowImp::~TPWindowImp()
@@ -60,37 +62,60 @@ TPWindowImp::~TPWindowImp()
 
 int TPWindowImp::get_char()
 {
+    draw();
     return wgetch(m_win);
 }
 
 void TPWindowImp::write_char(const char ch)
 {
-    waddch(m_win, ch);
+    m_cells.write_char(ch);
 }
 
 void TPWindowImp::write_char(const char ch, const Point pt)
 {
-    mvwaddch(m_win, pt.y, pt.x, ch);
+    m_cells.write_char(ch, pt);
 }
 
 void TPWindowImp::write_str(const std::string& s)
 {
-    waddstr(m_win, s.c_str());
+    m_cells.write_str(s);
 }
 
 void TPWindowImp::write_str(const std::string& s, const Point pt)
 {
-    mvwaddstr(m_win, pt.y, pt.x, s.c_str());
+    m_cells.write_str(s, pt);
+}
+
+void TPWindowImp::stage()
+{
+    for ( const auto& run : m_cells.flush() ) {
+        mvwaddnstr(m_win, run.origin.y, run.origin.x,
+                   run.text.c_str(), run.text.size());
+    }
+
+    /*  Leave the curses cursor where the next write would go, rather than
+     *  after the last run written. This fails harmlessly if the position
+     *  has wrapped past the bottom of the window.                         */
+
+    const Point pos = m_cells.position();
+    wmove(m_win, pos.y, pos.x);
+    wnoutrefresh(m_win);
 }
 
 void TPWindowImp::draw()
 {
-    wrefresh(m_win);
+    stage();
+    update_screen();
 }
 
 void TPWindowImp::redraw()
 {
+    m_cells.invalidate();
     touchwin(m_win);
-    wrefresh(m_win);
+    draw();
 }
 
+void TPWindowImp::update_screen()
+{
+    doupdate();
+}
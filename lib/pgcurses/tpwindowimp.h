@@ -13,11 +13,14 @@
 #include <string>
 #include <curses.h>
 #include "tpgentypes.h"
+#include "tpcellbuffer.h"
 
 namespace pgcurses {
 
 /*!
  * \brief               Terminal program window implementation class.
+ * \details             Writes go to an off-screen cell buffer, and only
+ * reach curses when the window is drawn, as the cells which changed.
  * \ingroup             pgcurses
  */
 class TPWindowImp {
@@ -55,6 +58,8 @@ class TPWindowImp {
 
         /*!
          * \brief           Gets a character.
+         * \details         Draws the window first, so everything written
+         * is shown while waiting.
          * \returns         The character.
          */
         int get_char();
@@ -85,16 +90,34 @@ class TPWindowImp {
          */
         void write_str(const std::string& s, const Point pt);
 
+        /*!
+         * \brief           Writes the changed cells to curses and stages
+         * the window for the next screen update, without updating the
+         * screen.
+         * \details         The curses cursor is left at the current
+         * position.
+         */
+        void stage();
+
         /*!
          * \brief           Draws the window.
+         * \details         Stages the window and updates the screen.
          */
         void draw();
 
         /*!
          * \brief           Forces a redraw of the window.
+         * \details         Every cell is written to curses again, and the
+         * whole window to the screen, so anything which overwrote either
+         * is repaired.
          */
         void redraw();
 
+        /*!
+         * \brief           Updates the screen with every staged window.
+         */
+        static void update_screen();
+
     private:
 
         /*!  Pointer to curses WINDOW  */
@@ -106,6 +129,9 @@ class TPWindowImp {
         /*!  The window's size  */
         Size m_size;
 
+        /*!  The window's contents  */
+        TPCellBuffer m_cells;
+
 };              //  class TPWindowImp
 
 }               //  namespace pgcurses
@@ -13,6 +13,7 @@
 #include "tpmainwindow.h"
 #include "tpcontrol.h"
 #include "tpinputfield.h"
+#include "tpgrid.h"
 
 #endif          //  PG_CURSES_AGGREGATE_TPWINDOWS_H
 
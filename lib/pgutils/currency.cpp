@@ -6,6 +6,7 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <iomanip>
 #include <vector>
 #include <sstream>
 #include "currency.h"
@@ -15,8 +16,12 @@ using namespace pgutils;
 
 std::string Currency::string() const
 {
+    const int64_t cents = expand();
+    const uint64_t magnitude = cents < 0 ? -static_cast<uint64_t>(cents) :
+                                           cents;
     std::ostringstream ss;
-    ss << m_int << "." << m_frac;
+    ss << (cents < 0 ? "-" : "") << magnitude / 100 << "."
+       << std::setw(2) << std::setfill('0') << magnitude % 100;
     return ss.str();
 }
 
@@ -91,7 +96,7 @@ try
         throw CurrencyException("Invalid integral part of currency");
     }
 
-    const uint64_t frac_part = vec.size() > 1 ? stoull(vec[1], &i) : 0;
+    uint64_t frac_part = vec.size() > 1 ? stoull(vec[1], &i) : 0;
     if ( vec.size() > 1 && (vec[1][i] != '\0') ) {
         throw CurrencyException("Invalid fractional part of currency");
     }
@@ -100,6 +105,18 @@ try
         throw CurrencyException("Fractional part is too large");
     }
 
+    /*  A single digit is in tenths, as in "12.5"  */
+
+    if ( vec.size() > 1 && vec[1].length() == 1 ) {
+        frac_part *= 10;
+    }
+
+    /*  The sign of amounts such as "-0.50" is only in the string  */
+
+    if ( int_part == 0 && vec[0].find('-') != std::string::npos ) {
+        return Currency::from_cents(-static_cast<int64_t>(frac_part));
+    }
+
     return Currency{int_part, static_cast<uint8_t>(frac_part)};
 }
 catch ( const std::invalid_argument& e ) {
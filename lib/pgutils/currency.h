@@ -59,6 +59,24 @@ class Currency {
          */
         uint8_t frac_part() const { return m_frac > 0 ? m_frac : -m_frac; }
 
+        /*!
+         * \brief           Returns the currency amount in cents.
+         * \returns         The currency amount as a whole number of cents.
+         */
+        int64_t cents() const { return expand(); }
+
+        /*!
+         * \brief           Creates a currency amount from a number of cents.
+         * \param cents     The amount as a whole number of cents.
+         * \returns         The currency amount.
+         */
+        static Currency from_cents(const int64_t cents) {
+            Currency c;
+            c.m_int = cents / 100;
+            c.m_frac = cents % 100;
+            return c;
+        }
+
         /*!
          * \brief           Returns a string representation of the amount.
          * \returns         A string representation of the amount.
@@ -11,6 +11,8 @@
 
 #include "stringhelp.h"
 #include "currency.h"
+#include "smallvector.h"
+#include "symboltable.h"
 
 #endif      //  PG_UTILS_H
 
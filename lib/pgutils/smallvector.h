@@ -0,0 +1,277 @@
+/*!
+ * \file            smallvector.h
+ * \brief           Interface to small vector class template
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_UTILS_SMALL_VECTOR_H
+#define PG_UTILS_SMALL_VECTOR_H
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace pgutils {
+
+/*!
+ * \brief           Vector of trivially copyable elements with inline storage.
+ * \details         The first \c N elements are stored inside the object
+ * itself, so small vectors need no heap allocation. Once the inline
+ * storage is full, the elements are moved to a contiguous heap block.
+ * Elements are always contiguous, so the contents can be processed as a
+ * flat array.
+ * \ingroup         utils
+ */
+template<typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SmallVector elements must be trivially copyable");
+    static_assert(N > 0, "SmallVector inline capacity must be non-zero");
+
+    public:
+
+        /*!  Alias for iterator  */
+        using iterator = T *;
+
+        /*!  Alias for const iterator  */
+        using const_iterator = const T *;
+
+        /*!
+         * \brief           Constructor.
+         */
+        SmallVector () :
+            m_data{inline_data()}, m_size{0}, m_capacity{N}
+        {}
+
+        /*!
+         * \brief           Copy constructor.
+         * \param other     The vector to copy.
+         */
+        SmallVector (const SmallVector& other) :
+            m_data{inline_data()}, m_size{0}, m_capacity{N}
+        {
+            reserve(other.m_size);
+            std::memcpy(m_data, other.m_data, other.m_size * sizeof(T));
+            m_size = other.m_size;
+        }
+
+        /*!
+         * \brief           Move constructor.
+         * \param other     The vector to move from.
+         */
+        SmallVector (SmallVector&& other) noexcept :
+            m_data{inline_data()}, m_size{0}, m_capacity{N}
+        {
+            take(other);
+        }
+
+        /*!
+         * \brief           Destructor.
+         */
+        ~SmallVector () { release(); }
+
+        /*!
+         * \brief           Copy assignment operator.
+         * \param other     The vector to copy.
+         * \returns         A reference to this vector.
+         */
+        SmallVector& operator=(const SmallVector& other) {
+            if ( this != &other ) {
+                m_size = 0;
+                reserve(other.m_size);
+                std::memcpy(m_data, other.m_data, other.m_size * sizeof(T));
+                m_size = other.m_size;
+            }
+            return *this;
+        }
+
+        /*!
+         * \brief           Move assignment operator.
+         * \param other     The vector to move from.
+         * \returns         A reference to this vector.
+         */
+        SmallVector& operator=(SmallVector&& other) noexcept {
+            if ( this != &other ) {
+                release();
+                take(other);
+            }
+            return *this;
+        }
+
+        /*!
+         * \brief           Returns the number of elements.
+         * \returns         The number of elements.
+         */
+        size_t size() const { return m_size; }
+
+        /*!
+         * \brief           Checks if the vector is empty.
+         * \retval true     If the vector contains no elements.
+         * \retval false    If the vector contains elements.
+         */
+        bool empty() const { return m_size == 0; }
+
+        /*!
+         * \brief           Returns the number of elements storable
+         * without reallocating.
+         * \returns         The capacity of the vector.
+         */
+        size_t capacity() const { return m_capacity; }
+
+        /*!
+         * \brief           Checks if the elements are in inline storage.
+         * \retval true     If the elements are stored inside the object.
+         * \retval false    If the elements are stored on the heap.
+         */
+        bool is_inline() const { return m_data == inline_data(); }
+
+        /*!
+         * \brief           Returns a pointer to the first element.
+         * \returns         A pointer to the first element.
+         */
+        T * data() { return m_data; }
+
+        /*!
+         * \brief           Returns a const pointer to the first element.
+         * \returns         A const pointer to the first element.
+         */
+        const T * data() const { return m_data; }
+
+        /*!
+         * \brief           Index operator.
+         * \param i         The index.
+         * \returns         A reference to the element at index \c i.
+         */
+        T& operator[](const size_t i) { return m_data[i]; }
+
+        /*!
+         * \brief           Const index operator.
+         * \param i         The index.
+         * \returns         A const reference to the element at index \c i.
+         */
+        const T& operator[](const size_t i) const { return m_data[i]; }
+
+        /*!
+         * \brief           Appends an element.
+         * \param value     The element to append.
+         */
+        void push_back(const T& value) {
+            if ( m_size == m_capacity ) {
+                reserve(m_capacity * 2);
+            }
+            m_data[m_size++] = value;
+        }
+
+        /*!
+         * \brief           Removes all elements, retaining the capacity.
+         */
+        void clear() { m_size = 0; }
+
+        /*!
+         * \brief           Ensures storage for at least \c n elements.
+         * \param n         The number of elements to reserve storage for.
+         */
+        void reserve(const size_t n) {
+            if ( n <= m_capacity ) {
+                return;
+            }
+            T * new_data = static_cast<T *>(::operator new(n * sizeof(T)));
+            std::memcpy(new_data, m_data, m_size * sizeof(T));
+            release();
+            m_data = new_data;
+            m_capacity = n;
+        }
+
+        /*!
+         * \brief           Returns an iterator to the first element.
+         * \returns         An iterator to the first element.
+         */
+        iterator begin() { return m_data; }
+
+        /*!
+         * \brief           Returns an iterator to one past the last element.
+         * \returns         An iterator to one past the last element.
+         */
+        iterator end() { return m_data + m_size; }
+
+        /*!
+         * \brief           Returns a const iterator to the first element.
+         * \returns         A const iterator to the first element.
+         */
+        const_iterator begin() const { return m_data; }
+
+        /*!
+         * \brief           Returns a const iterator to one past the last
+         * element.
+         * \returns         A const iterator to one past the last element.
+         */
+        const_iterator end() const { return m_data + m_size; }
+
+    private:
+
+        /*!  Pointer to the elements, either inline or on the heap  */
+        T * m_data;
+
+        /*!  Number of elements  */
+        size_t m_size;
+
+        /*!  Number of elements storable without reallocating  */
+        size_t m_capacity;
+
+        /*!  Inline element storage  */
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type m_inline[N];
+
+        /*!
+         * \brief           Returns a pointer to the inline storage.
+         * \returns         A pointer to the inline storage.
+         */
+        T * inline_data() {
+            return reinterpret_cast<T *>(m_inline);
+        }
+
+        /*!
+         * \brief           Returns a const pointer to the inline storage.
+         * \returns         A const pointer to the inline storage.
+         */
+        const T * inline_data() const {
+            return reinterpret_cast<const T *>(m_inline);
+        }
+
+        /*!
+         * \brief           Frees heap storage, if any.
+         */
+        void release() {
+            if ( !is_inline() ) {
+                ::operator delete(m_data);
+                m_data = inline_data();
+                m_capacity = N;
+            }
+        }
+
+        /*!
+         * \brief           Takes the elements of another vector, leaving
+         * it empty.
+         * \param other     The vector to take elements from.
+         */
+        void take(SmallVector& other) {
+            if ( other.is_inline() ) {
+                std::memcpy(m_data, other.m_data, other.m_size * sizeof(T));
+            }
+            else {
+                m_data = other.m_data;
+                m_capacity = other.m_capacity;
+                other.m_data = other.inline_data();
+                other.m_capacity = N;
+            }
+            m_size = other.m_size;
+            other.m_size = 0;
+        }
+
+};              //  class SmallVector
+
+}               //  namespace pgutils
+
+#endif          //  PG_UTILS_SMALL_VECTOR_H
@@ -0,0 +1,62 @@
+/*!
+ * \file            symboltable.cpp
+ * \brief           Implementation of string interning symbol table class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include "symboltable.h"
+
+using namespace pgutils;
+
+uint32_t SymbolTable::intern(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_ids.find(name);
+    if ( found != m_ids.end() ) {
+        return found->second;
+    }
+
+    const size_t id = m_size.load(std::memory_order_relaxed);
+    if ( id == chunk_size * max_chunks ) {
+        throw SymbolTableException("Symbol table is full");
+    }
+
+    std::unique_ptr<std::string[]>& chunk = m_chunks[id / chunk_size];
+    if ( !chunk ) {
+        chunk.reset(new std::string[chunk_size]);
+    }
+    chunk[id % chunk_size] = name;
+    m_ids.emplace(name, static_cast<uint32_t>(id));
+
+    /*  Publishing the new size makes the name visible to readers  */
+
+    m_size.store(id + 1, std::memory_order_release);
+    return static_cast<uint32_t>(id);
+}
+
+bool SymbolTable::find(const std::string& name, uint32_t& id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_ids.find(name);
+    if ( found == m_ids.end() ) {
+        return false;
+    }
+
+    id = found->second;
+    return true;
+}
+
+const std::string& SymbolTable::name(const uint32_t id) const
+{
+    if ( id >= m_size.load(std::memory_order_acquire) ) {
+        throw SymbolTableException("Unknown symbol ID");
+    }
+    return m_chunks[id / chunk_size][id % chunk_size];
+}
+
+size_t SymbolTable::size() const
+{
+    return m_size.load(std::memory_order_acquire);
+}
@@ -0,0 +1,116 @@
+/*!
+ * \file            symboltable.h
+ * \brief           Interface to string interning symbol table class
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_UTILS_SYMBOL_TABLE_H
+#define PG_UTILS_SYMBOL_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace pgutils {
+
+/*!
+ * \brief           Symbol table exception class.
+ * \ingroup         utils
+ */
+class SymbolTableException : public std::runtime_error {
+    public:
+        /*!
+         * \brief           Constructor
+         * \param msg       Error message
+         */
+        explicit SymbolTableException(const std::string& msg) :
+            std::runtime_error(msg) {};
+};
+
+/*!
+ * \brief           String interning symbol table class.
+ * \details         Maps strings to dense unsigned integer IDs, allocated
+ * in order of first appearance starting from zero. Interned names are
+ * never removed, so references returned by \c name() remain valid for
+ * the lifetime of the table. All member functions are thread-safe.
+ * Interning and \c find() take a lock, but \c name() and \c size() do
+ * not: names are stored in fixed chunks which never move, and each name
+ * is published by an atomic count once it is in place, so lookups by ID
+ * on hot paths never wait for a writer.
+ * \ingroup         utils
+ */
+class SymbolTable {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         */
+        SymbolTable () : m_mutex{}, m_size{0}, m_chunks{}, m_ids{} {}
+
+        /*!  Deleted copy constructor  */
+        SymbolTable (const SymbolTable&) = delete;
+
+        /*!  Deleted copy assignment operator  */
+        SymbolTable& operator=(const SymbolTable&) = delete;
+
+        /*!
+         * \brief           Returns the ID for a name, interning it if needed.
+         * \param name      The name to intern.
+         * \returns         The ID of the name.
+         * \throws          SymbolTableException if the table is full.
+         */
+        uint32_t intern(const std::string& name);
+
+        /*!
+         * \brief           Looks up the ID for a name without interning it.
+         * \param name      The name to look up.
+         * \param id        Set to the ID of the name, if it is interned.
+         * \returns         `true` if the name is interned.
+         */
+        bool find(const std::string& name, uint32_t& id) const;
+
+        /*!
+         * \brief           Returns the name for an ID.
+         * \param id        The ID.
+         * \returns         A reference to the interned name.
+         * \throws          SymbolTableException if \c id is not a valid ID.
+         */
+        const std::string& name(const uint32_t id) const;
+
+        /*!
+         * \brief           Returns the number of interned names.
+         * \returns         The number of interned names.
+         */
+        size_t size() const;
+
+    private:
+
+        /*!  Number of names in each chunk  */
+        static constexpr size_t chunk_size = 1024;
+
+        /*!  Most chunks in a table  */
+        static constexpr size_t max_chunks = 4096;
+
+        /*!  Mutex guarding interning and the map of names to IDs  */
+        mutable std::mutex m_mutex;
+
+        /*!  Number of names published to \c name()  */
+        std::atomic<size_t> m_size;
+
+        /*!  Interned names indexed by ID, in chunks allocated as needed  */
+        std::unique_ptr<std::string[]> m_chunks[max_chunks];
+
+        /*!  Map of names to IDs  */
+        std::unordered_map<std::string, uint32_t> m_ids;
+
+};              //  class SymbolTable
+
+}               //  namespace pgutils
+
+#endif          //  PG_UTILS_SYMBOL_TABLE_H
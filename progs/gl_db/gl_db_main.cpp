@@ -6,10 +6,15 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "gldb/gldb.h"
 #include "config/config.h"
+#include "pgutils/pgutils.h"
 
 using namespace genleg;
 
@@ -19,6 +24,24 @@ using namespace genleg;
  */
 static const char * progname = "gl_db";
 
+/*!
+ * \brief           Earliest accounting year allowed.
+ * \ingroup         gl_db
+ */
+static const unsigned long long min_year = 1000;
+
+/*!
+ * \brief           Latest accounting year allowed.
+ * \ingroup         gl_db
+ */
+static const unsigned long long max_year = 9999;
+
+/*!
+ * \brief           Most keys or chunks allowed for a migration.
+ * \ingroup         gl_db
+ */
+static const unsigned long long max_migration_count = 1000000000;
+
 /*!
  * \brief           Sets program configuration options.
  * \ingroup         gl_db
@@ -45,6 +68,52 @@ static bool check_help_and_version(const Config& config);
  */
 static bool check_db_parameters(const Config& config);
 
+/*!
+ * \brief           Creates the database structure.
+ * \details         The journal entry tables are partitioned by year if
+ * the \c partitioned option is set.
+ * \ingroup         gl_db
+ * \param config    Reference to a Config object.
+ * \param gdb       Reference to database object.
+ */
+static void create_structure(const Config& config, GLDatabase& gdb);
+
+/*!
+ * \brief           Migrates the database schema, or shows what migrating
+ * would do if the \c dryrun option is set.
+ * \details         Backfills run in chunks of \c chunksize keys, and at
+ * most \c maxchunks chunks are run if it is set.
+ * \ingroup         gl_db
+ * \param config    Reference to a Config object.
+ * \param gdb       Reference to database object.
+ */
+static void migrate(const Config& config, GLDatabase& gdb);
+
+/*!
+ * \brief           Posts a journal entry from a file.
+ * \ingroup         gl_db
+ * \param filename  The name of the journal entry file.
+ * \param ledger    The database, or a client of a running \c gl_server.
+ */
+template <typename Ledger>
+static void post_journal(const std::string& filename, Ledger& ledger);
+
+/*!
+ * \brief           Parses a number given as an option value.
+ * \ingroup         gl_db
+ * \param option    The name of the option.
+ * \param value     The option value.
+ * \param min       The smallest number allowed.
+ * \param max       The largest number allowed.
+ * \returns         The number.
+ * \throws          ConfigBadOption if the value is not a number from
+ * \c min to \c max.
+ */
+static unsigned long long parse_number(const std::string& option,
+                                       const std::string& value,
+                                       const unsigned long long min,
+                                       const unsigned long long max);
+
 /*!
  * \brief           Prints a program usage message.
  * \ingroup         gl_db
@@ -86,22 +155,53 @@ int main(int argc, char *argv[]) try {
         return 0;
     }
 
+    if ( config.is_set("slowquery") ) {
+        GLDatabase::set_slow_query_threshold(config["slowquery"]);
+    }
+    if ( config.is_set("stats") ) {
+        GLDatabase::report_query_stats_at_exit();
+    }
+
+    if ( config.is_set("server") ) {
+        if ( !config.is_set("post") ) {
+            std::cerr << progname << ": only --post may be sent to a server."
+                      << std::endl;
+            return 1;
+        }
+        GLClient client{config["server"]};
+        post_journal(config["post"], client);
+        return 0;
+    }
+
     if ( !check_db_parameters(config) ) {
         return 1;
     }
 
+    if ( config.is_set("backend") ) {
+        GLDatabase::select_backend(config["backend"]);
+    }
+    if ( config.is_set("replay") ) {
+        GLDatabase::replay_queries(config["replay"],
+                                   config.is_set("replaytimed"));
+    }
+    else if ( config.is_set("record") ) {
+        GLDatabase::record_queries(config["record"]);
+    }
+
     std::string passwd;
     if ( config.is_set("password") ) {
         passwd = config["password"];
     }
-    passwd = login();
+    else {
+        passwd = login();
+    }
 
     GLDatabase gdb(config["database"], config["hostname"],
                     config["username"], passwd);
 
     if ( config.is_set("create") ) {
         std::cout << "Creating database structure..." << std::endl;
-        gdb.create_structure();
+        create_structure(config, gdb);
         std::cout << "...success." << std::endl;
     }
     else if ( config.is_set("delete") ) {
@@ -109,6 +209,48 @@ int main(int argc, char *argv[]) try {
         gdb.destroy_structure();
         std::cout << "...success." << std::endl;
     }
+    else if ( config.is_set("indexes") ) {
+        std::cout << "Creating secondary indexes..." << std::endl;
+        gdb.create_indexes();
+        std::cout << "...success." << std::endl;
+    }
+    else if ( config.is_set("migrate") ) {
+        migrate(config, gdb);
+    }
+    else if ( config.is_set("migratestatus") ) {
+        std::cout << gdb.migration_status();
+    }
+    else if ( config.is_set("explain") ) {
+        std::cout << gdb.explain_statements();
+    }
+    else if ( config.is_set("addpartition") ) {
+        int year;
+        if ( config["addpartition"].empty() ) {
+            year = gdb.get_standing_data().year() + 1;
+        }
+        else {
+            year = parse_number("addpartition", config["addpartition"],
+                                min_year, max_year);
+        }
+        std::cout << "Adding partition for " << year << "..." << std::endl;
+        gdb.add_year_partition(year);
+        std::cout << "...success." << std::endl;
+    }
+    else if ( config.is_set("archive") ) {
+        const int year = parse_number("archive", config["archive"],
+                                      min_year, max_year);
+        std::cout << "Archiving partition for " << year << "..." << std::endl;
+        gdb.archive_year_partition(year);
+        std::cout << "...success." << std::endl;
+    }
+    else if ( config.is_set("build-cube") ) {
+        std::cout << "Building balance cube..." << std::endl;
+        gdb.build_cube(config["build-cube"]);
+        std::cout << "...success." << std::endl;
+    }
+    else if ( config.is_set("post") ) {
+        post_journal(config["post"], gdb);
+    }
     else if ( config.is_set("loadsample") ) {
         std::cout << "Loading sample data..." << std::endl;
         gdb.load_sample_data(config["loadsample"]);
@@ -120,7 +262,7 @@ int main(int argc, char *argv[]) try {
         std::cout << "...success." << std::endl;
 
         std::cout << "Creating database structure..." << std::endl;
-        gdb.create_structure();
+        create_structure(config, gdb);
         std::cout << "...success." << std::endl;
 
         std::cout << "Loading sample data..." << std::endl;
@@ -165,8 +307,27 @@ static void set_configuration(Config& config, int argc, char *argv[]) {
     config.add_cmdline_option("hostname", Argument::REQ_ARG);
     config.add_cmdline_option("username", Argument::REQ_ARG);
     config.add_cmdline_option("password", Argument::REQ_ARG);
+    config.add_cmdline_option("backend", Argument::REQ_ARG);
+    config.add_cmdline_option("stats", Argument::NO_ARG);
+    config.add_cmdline_option("slowquery", Argument::REQ_ARG);
+    config.add_cmdline_option("record", Argument::REQ_ARG);
+    config.add_cmdline_option("replay", Argument::REQ_ARG);
+    config.add_cmdline_option("replaytimed", Argument::NO_ARG);
     config.add_cmdline_option("create", Argument::NO_ARG);
     config.add_cmdline_option("delete", Argument::NO_ARG);
+    config.add_cmdline_option("indexes", Argument::NO_ARG);
+    config.add_cmdline_option("explain", Argument::NO_ARG);
+    config.add_cmdline_option("server", Argument::REQ_ARG);
+    config.add_cmdline_option("post", Argument::REQ_ARG);
+    config.add_cmdline_option("migrate", Argument::NO_ARG);
+    config.add_cmdline_option("migratestatus", Argument::NO_ARG);
+    config.add_cmdline_option("dryrun", Argument::NO_ARG);
+    config.add_cmdline_option("chunksize", Argument::REQ_ARG);
+    config.add_cmdline_option("maxchunks", Argument::REQ_ARG);
+    config.add_cmdline_option("partitioned", Argument::REQ_ARG);
+    config.add_cmdline_option("addpartition", Argument::OPT_ARG);
+    config.add_cmdline_option("archive", Argument::REQ_ARG);
+    config.add_cmdline_option("build-cube", Argument::REQ_ARG);
     config.add_cmdline_option("loadsample", Argument::REQ_ARG);
     config.add_cmdline_option("reinit", Argument::REQ_ARG);
     config.populate_from_file("conf_files/gl_db_conf.conf");
@@ -206,6 +367,78 @@ static bool check_db_parameters(const Config& config) {
     }
 }
 
+static void create_structure(const Config& config, GLDatabase& gdb) {
+    if ( !config.is_set("partitioned") ) {
+        gdb.create_structure();
+        return;
+    }
+
+    const std::vector<std::string> years =
+        pgutils::split(config["partitioned"], ':');
+    if ( years.size() != 2 ) {
+        throw ConfigBadOption("partitioned");
+    }
+    gdb.create_structure(parse_number("partitioned", years[0],
+                                      min_year, max_year),
+                         parse_number("partitioned", years[1],
+                                      min_year, max_year));
+}
+
+static void migrate(const Config& config, GLDatabase& gdb) {
+    const unsigned long long chunk_rows = config.is_set("chunksize") ?
+        parse_number("chunksize", config["chunksize"], 1,
+                     max_migration_count) : 10000;
+    const size_t max_chunks = config.is_set("maxchunks") ?
+        parse_number("maxchunks", config["maxchunks"], 0,
+                     max_migration_count) : 0;
+
+    if ( config.is_set("dryrun") ) {
+        std::cout << gdb.migration_plan(chunk_rows);
+        return;
+    }
+
+    std::cout << "Migrating database schema..." << std::endl;
+    const bool finished = gdb.migrate(chunk_rows, max_chunks,
+            [](const std::string& msg) { std::cout << msg << std::endl; });
+    if ( finished ) {
+        std::cout << "...success." << std::endl;
+    }
+    else {
+        std::cout << "...stopped after " << max_chunks << " chunks. "
+                  << "Run again to continue." << std::endl;
+    }
+}
+
+template <typename Ledger>
+static void post_journal(const std::string& filename, Ledger& ledger) {
+    std::ifstream ifs{filename};
+    if ( !ifs ) {
+        throw std::runtime_error("could not open journal entry file '" +
+                                 filename + "'");
+    }
+
+    std::cout << "Posting journal entry..." << std::endl;
+    ledger.post_journal(journal_from_stream(ifs));
+    std::cout << "...success." << std::endl;
+}
+
+static unsigned long long parse_number(const std::string& option,
+                                       const std::string& value,
+                                       const unsigned long long min,
+                                       const unsigned long long max) {
+    if ( value.empty() || value.size() > 18 ||
+         !std::all_of(value.begin(), value.end(), [](const char c) {
+                 return c >= '0' && c <= '9';
+         }) ) {
+        throw ConfigBadOption(option);
+    }
+    const unsigned long long n = std::stoull(value);
+    if ( n < min || n > max ) {
+        throw ConfigBadOption(option);
+    }
+    return n;
+}
+
 static void print_usage_message() {
     std::cout << "Usage: " << progname << " [options]\n";
 }
@@ -216,13 +449,45 @@ static void print_help_message() {
         << "  --help                Display this information\n"
         << "  --version             Display version information\n"
         << "\nDatabase options:\n"
+        << "  --stats               Show query statistics on exit\n"
+        << "  --slowquery=<msecs>   Log queries taking at least <msecs>\n"
         << "  --create              Create database structure\n"
         << "  --delete              Delete database structure\n"
+        << "  --indexes             Create secondary indexes on an existing\n"
+        << "                                     database structure\n"
+        << "  --explain             Show execution plans and flag full\n"
+        << "                                     table scans\n"
+        << "  --migrate             Migrate the database structure to the\n"
+        << "                                     latest schema version\n"
+        << "  --migratestatus       Show the state of each schema version\n"
+        << "  --dryrun              With --migrate, show the statements\n"
+        << "                                     without running them\n"
+        << "  --chunksize=<rows>    With --migrate, update at most <rows>\n"
+        << "                                     keys per transaction,\n"
+        << "                                     default 10000\n"
+        << "  --maxchunks=<n>       With --migrate, stop after <n> chunks\n"
+        << "                                     and resume on the next\n"
+        << "                                     run\n"
         << "  --loadsample=<dir>    Load database with sample data\n"
         << "                                     from directory <dir>\n"
         << "  --reinit=<dir>        Delete and create database structure\n"
         << "                                     and load sample data\n"
-        << "                                     from directory <dir>\n";
+        << "                                     from directory <dir>\n"
+        << "  --partitioned=<first>:<last>\n"
+        << "                        With --create or --reinit, partition\n"
+        << "                                     journal entries by year\n"
+        << "  --addpartition[=<year>]\n"
+        << "                        Add a partition for <year>, or for\n"
+        << "                                     the next accounting year\n"
+        << "  --archive=<year>      Move the partition for <year> to\n"
+        << "                                     archive tables\n"
+        << "  --build-cube=<file>   Write balances by entity, account and\n"
+        << "                                     period to a balance cube\n"
+        << "                                     <file> for gl_report\n"
+        << "  --post=<file>         Post the journal entry in <file>\n"
+        << "  --server=<path>       With --post, send the journal entry to\n"
+        << "                                     the gl_server listening\n"
+        << "                                     on socket <path>\n";
 }
 
 static void print_version_message() {
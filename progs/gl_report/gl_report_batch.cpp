@@ -0,0 +1,158 @@
+/*!
+ * \file            gl_report_batch.cpp
+ * \brief           Implementation of batch mode for gl_report program.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include "gl_report_batch.h"
+#include "database_imp/backends.h"
+
+using namespace genleg;
+
+/*!
+ * \brief           Outcome of a single report request.
+ * \ingroup         gl_report
+ */
+struct BatchResult {
+    /*!  "OK", or the error message if the report failed  */
+    std::string status;
+
+    /*!  The time taken to run and write the report, in milliseconds  */
+    long long millis;
+};
+
+/*!
+ * \brief           Runs a single report request.
+ * \ingroup         gl_report
+ * \param gdb       The database connection.
+ * \param request   The report request.
+ * \returns         The outcome of the request.
+ */
+static BatchResult run_request(GLDatabase& gdb, const BatchRequest& request);
+
+std::vector<BatchRequest> read_batch_file(const std::string& filename)
+{
+    std::ifstream ifs{filename};
+    if ( !ifs ) {
+        throw std::runtime_error("could not open batch file '" +
+                                 filename + "'");
+    }
+
+    std::vector<std::vector<std::string>> lines;
+    pgutils::split_lines(lines, ifs, ':');
+
+    std::vector<BatchRequest> requests;
+    for ( auto& line : lines ) {
+        for ( auto& field : line ) {
+            pgutils::trim(field);
+        }
+        if ( line.size() < 3 || line.size() > 4 ||
+             line[0].empty() || line[2].empty() ) {
+            throw std::runtime_error("malformed line in batch file '" +
+                                     filename + "'");
+        }
+        requests.push_back(BatchRequest{line[0], line[1], line[2],
+                           line.size() == 4 ? line[3] : "text"});
+    }
+
+    return requests;
+}
+
+GLReport run_batch(GLDatabasePool& pool,
+                   const std::vector<BatchRequest>& requests,
+                   size_t& failed)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<BatchResult> results(requests.size());
+    std::atomic<size_t> next{0};
+
+    auto worker = [&] {
+        const gldb::BackendThread backend_thread;
+        for ( size_t i; (i = next++) < requests.size(); ) {
+            GLDatabasePool::Lease gdb = pool.acquire();
+            results[i] = run_request(*gdb, requests[i]);
+        }
+    };
+
+    const clock::time_point start = clock::now();
+    std::vector<std::thread> threads;
+    for ( size_t i = 0; i < pool.size(); ++i ) {
+        threads.emplace_back(worker);
+    }
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            clock::now() - start).count();
+
+    gldb::Table summary{gldb::TableRow{"Report", "Argument", "Output",
+                                       "Format", "Status", "Time (ms)"}};
+    failed = 0;
+    for ( size_t i = 0; i < requests.size(); ++i ) {
+        if ( results[i].status != "OK" ) {
+            ++failed;
+        }
+        summary.append_record(gldb::TableRow{requests[i].report,
+                                             requests[i].arg,
+                                             requests[i].output,
+                                             requests[i].format,
+                                             results[i].status,
+                                        std::to_string(results[i].millis)});
+    }
+
+    GLReport report{"Batch Summary Report", std::move(summary)};
+    report.add_header("Reports", std::to_string(requests.size()));
+    report.add_header("Failed", std::to_string(failed));
+    report.add_header("Connections", std::to_string(pool.size()));
+    report.add_header("Elapsed time (ms)", std::to_string(elapsed));
+    return report;
+}
+
+static BatchResult run_request(GLDatabase& gdb, const BatchRequest& request)
+{
+    using clock = std::chrono::steady_clock;
+
+    const clock::time_point start = clock::now();
+    std::string status{"OK"};
+
+    try {
+        std::unique_ptr<gldb::TableWriter> writer;
+        if ( request.format != "text" ) {
+            writer = gldb::make_table_writer(request.format);
+        }
+
+        const GLReport report = gdb.report(request.report, request.arg);
+
+        std::ofstream out{request.output, std::ios::binary};
+        if ( !out ) {
+            throw std::runtime_error("could not open output file");
+        }
+        if ( writer ) {
+            report.write(out, *writer);
+        }
+        else {
+            out << report;
+        }
+
+        out.close();
+        if ( !out ) {
+            throw std::runtime_error("could not write output file");
+        }
+    }
+    catch ( const std::exception& e ) {
+        status = e.what();
+    }
+
+    const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            clock::now() - start).count();
+    return BatchResult{status, millis};
+}
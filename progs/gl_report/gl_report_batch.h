@@ -0,0 +1,65 @@
+/*!
+ * \file            gl_report_batch.h
+ * \brief           Interface to batch mode for gl_report program.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_GL_REPORT_BATCH_H
+#define PG_GENERAL_LEDGER_GL_REPORT_BATCH_H
+
+#include <string>
+#include <vector>
+#include "gldb/gldb.h"
+
+/*!
+ * \brief           A single report request in a batch.
+ * \ingroup         gl_report
+ */
+struct BatchRequest {
+    /*!  The report name, as accepted by \c GLDatabase::report()  */
+    std::string report;
+
+    /*!  The report argument, which may be empty  */
+    std::string arg;
+
+    /*!  The path of the file to which to write the report  */
+    std::string output;
+
+    /*!  The output format, "text" or a \c gldb::make_table_writer() name  */
+    std::string format;
+};
+
+/*!
+ * \brief           Reads a batch file.
+ * \details         Each content line of the file is of the form
+ * \c report:arg:output[:format], where \c arg may be empty and \c format
+ * defaults to \c text. Blank lines and lines beginning with \c '#' are
+ * ignored.
+ * \ingroup         gl_report
+ * \param filename  The name of the batch file.
+ * \returns         A vector of report requests.
+ * \throws          std::runtime_error if the file could not be opened or
+ * contains a malformed line.
+ */
+std::vector<BatchRequest> read_batch_file(const std::string& filename);
+
+/*!
+ * \brief           Runs a batch of reports concurrently.
+ * \details         Requests are handed out to \c pool.size() worker threads,
+ * each of which runs its reports on a connection leased from the pool and
+ * writes each to its own output file. A failed report does not stop the
+ * rest of the batch.
+ * \ingroup         gl_report
+ * \param pool      The database connection pool.
+ * \param requests  The report requests.
+ * \param failed    Set to the number of failed requests.
+ * \returns         A report summarizing the status and run time of each
+ * request.
+ */
+genleg::GLReport run_batch(genleg::GLDatabasePool& pool,
+                           const std::vector<BatchRequest>& requests,
+                           size_t& failed);
+
+#endif          //  PG_GENERAL_LEDGER_GL_REPORT_BATCH_H
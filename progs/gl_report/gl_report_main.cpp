@@ -7,9 +7,11 @@
  */
 
 #include <iostream>
+#include <memory>
 
 #include "gldb/gldb.h"
 #include "config/config.h"
+#include "gl_report_batch.h"
 
 using namespace genleg;
 
@@ -19,6 +21,12 @@ using namespace genleg;
  */
 static const char * progname = "gl_report";
 
+/*!
+ * \brief           Default number of concurrent connections in batch mode.
+ * \ingroup         gl_report
+ */
+static const size_t default_jobs = 4;
+
 /*!
  * \brief           Sets program configuration options.
  * \ingroup         gl_report
@@ -45,6 +53,65 @@ static bool check_help_and_version(const Config& config);
  */
 static bool check_db_parameters(const Config& config);
 
+/*!
+ * \brief           Runs the reports in a batch file.
+ * \ingroup         gl_report
+ * \param config    Reference to a Config object.
+ * \param passwd    The database password.
+ * \returns         Exit status code.
+ */
+static int run_batch_mode(const Config& config, const std::string& passwd);
+
+/*!
+ * \brief           Runs a report from a balance cube file.
+ * \ingroup         gl_report
+ * \param config    Reference to a Config object.
+ * \param writer    The table writer for a machine-readable format, or an
+ * empty pointer for a text report.
+ * \returns         Exit status code.
+ */
+static int run_cube_mode(const Config& config,
+                         const std::unique_ptr<gldb::TableWriter>& writer);
+
+/*!
+ * \brief           Runs the report selected on the command line.
+ * \ingroup         gl_report
+ * \param config    Reference to a Config object.
+ * \param ledger    The database, or a client of a running \c gl_server.
+ * \param writer    The table writer for a machine-readable format, or an
+ * empty pointer for a text report.
+ * \returns         Exit status code.
+ */
+template <typename Ledger>
+static int run_report(const Config& config, Ledger& ledger,
+                      const std::unique_ptr<gldb::TableWriter>& writer);
+
+/*!
+ * \brief           Builds the trial balance report filter argument.
+ * \ingroup         gl_report
+ * \param config    Reference to a Config object.
+ * \returns         The report argument string.
+ */
+static std::string tb_filter_args(const Config& config);
+
+/*!
+ * \brief           Builds the comparative trial balance report argument.
+ * \ingroup         gl_report
+ * \param config    Reference to a Config object.
+ * \returns         The report argument string.
+ */
+static std::string compare_args(const Config& config);
+
+/*!
+ * \brief           Outputs a report.
+ * \ingroup         gl_report
+ * \param report    The report to output.
+ * \param writer    The table writer for a machine-readable format, or an
+ * empty pointer for a text report.
+ */
+static void output_report(const GLReport& report,
+                          const std::unique_ptr<gldb::TableWriter>& writer);
+
 /*!
  * \brief           Prints a program usage message.
  * \ingroup         gl_report
@@ -86,41 +153,62 @@ int main(int argc, char *argv[]) try {
         return 0;
     }
 
+    if ( config.is_set("slowquery") ) {
+        GLDatabase::set_slow_query_threshold(config["slowquery"]);
+    }
+    if ( config.is_set("stats") ) {
+        GLDatabase::report_query_stats_at_exit();
+    }
+
+    std::unique_ptr<gldb::TableWriter> writer;
+    if ( config.is_set("format") && config["format"] != "text" ) {
+        writer = gldb::make_table_writer(config["format"]);
+    }
+
+    if ( config.is_set("cube") ) {
+        return run_cube_mode(config, writer);
+    }
+
+    if ( config.is_set("server") ) {
+        GLClient client{config["server"]};
+        return run_report(config, client, writer);
+    }
+
     if ( !check_db_parameters(config) ) {
         return 1;
     }
 
+    if ( config.is_set("backend") ) {
+        GLDatabase::select_backend(config["backend"]);
+    }
+    if ( config.is_set("replay") ) {
+        GLDatabase::replay_queries(config["replay"],
+                                   config.is_set("replaytimed"));
+    }
+    else if ( config.is_set("record") ) {
+        GLDatabase::record_queries(config["record"]);
+    }
+
     std::string passwd;
     if ( config.is_set("password") ) {
         passwd = config["password"];
     }
-    passwd = login();
+    else {
+        passwd = login();
+    }
+
+    if ( config.is_set("batch") ) {
+        return run_batch_mode(config, passwd);
+    }
 
     GLDatabase gdb(config["database"], config["hostname"],
                     config["username"], passwd);
-
-    if ( config.is_set("currenttb") ) {
-        if ( config.is_set("entity") ) {
-            std::cout << gdb.report("currenttb", config["entity"]);
-        }
-        else {
-            std::cout << gdb.report("currenttb");
-        }
-    }
-    else if ( config.is_set("listusers") ) {
-        std::cout << gdb.report("listusers");
-    }
-    else if ( config.is_set("je") ) {
-        std::cout << gdb.report("je", config["je"]);
-    }
-    else if ( config.is_set("standing") ) {
-        std::cout << gdb.report("standingdata");
-    }
-    else {
-        std::cerr << progname << ": no options selected." << std::endl;
+    if ( config.is_set("cachedir") ) {
+        gdb.set_report_cache(std::make_shared<GLReportCache>(
+                    config["cachedir"]));
     }
 
-    return 0;
+    return run_report(config, gdb, writer);
 }
 catch ( const ConfigBadOption& e ) {
     std::cerr << progname << ": Invalid command line options" << std::endl;
@@ -147,6 +235,122 @@ catch (...) {
     std::cerr << progname << ": unknown error" << std::endl;
 }
 
+static int run_batch_mode(const Config& config, const std::string& passwd) {
+    const long long n = config.snapshot()->get_int("jobs", default_jobs);
+    if ( n < 1 ) {
+        throw ConfigBadOption("jobs");
+    }
+
+    const std::vector<BatchRequest> requests =
+        read_batch_file(config["batch"]);
+    if ( requests.empty() ) {
+        std::cerr << progname << ": batch file contains no reports."
+                  << std::endl;
+        return 1;
+    }
+
+    size_t jobs = static_cast<size_t>(n);
+    if ( jobs > requests.size() ) {
+        jobs = requests.size();
+    }
+
+    GLDatabasePool pool(config["database"], config["hostname"],
+                        config["username"], passwd, jobs);
+    pool.set_report_cache(std::make_shared<GLReportCache>(
+            config.is_set("cachedir") ? config["cachedir"] : ""));
+    size_t failed = 0;
+    std::cout << run_batch(pool, requests, failed);
+
+    return failed == 0 ? 0 : 1;
+}
+
+static int run_cube_mode(const Config& config,
+                         const std::unique_ptr<gldb::TableWriter>& writer) {
+    const GLCube cube{config["cube"]};
+
+    if ( config.is_set("currenttb") ) {
+        output_report(cube.report("currenttb", tb_filter_args(config)),
+                      writer);
+    }
+    else if ( config.is_set("rollup") ) {
+        output_report(cube.report("rollup", tb_filter_args(config)), writer);
+    }
+    else if ( config.is_set("compare") ) {
+        output_report(cube.report("comparetb", compare_args(config)),
+                      writer);
+    }
+    else {
+        std::cerr << progname << ": no balance cube report selected."
+                  << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+template <typename Ledger>
+static int run_report(const Config& config, Ledger& ledger,
+                      const std::unique_ptr<gldb::TableWriter>& writer) {
+    if ( config.is_set("currenttb") ) {
+        output_report(ledger.report("currenttb", tb_filter_args(config)),
+                      writer);
+    }
+    else if ( config.is_set("compare") ) {
+        output_report(ledger.report("comparetb", compare_args(config)),
+                      writer);
+    }
+    else if ( config.is_set("listusers") ) {
+        output_report(ledger.report("listusers"), writer);
+    }
+    else if ( config.is_set("je") ) {
+        output_report(ledger.report("je", config["je"]), writer);
+    }
+    else if ( config.is_set("standing") ) {
+        output_report(ledger.report("standingdata"), writer);
+    }
+    else {
+        std::cerr << progname << ": no options selected." << std::endl;
+    }
+
+    return 0;
+}
+
+static std::string tb_filter_args(const Config& config) {
+    std::string args;
+    for ( const auto& key : {"entity", "from", "to", "threshold", "top"} ) {
+        if ( config.is_set(key) ) {
+            args += std::string{key} + "=" + config[key] + ";";
+        }
+    }
+    if ( config.is_set("nonzero") ) {
+        args += "nonzero=yes;";
+    }
+    return args;
+}
+
+static std::string compare_args(const Config& config) {
+    std::string args;
+    if ( !config["compare"].empty() ) {
+        args += "columns=" + config["compare"] + ";";
+    }
+    for ( const auto& key : {"entity", "year", "period"} ) {
+        if ( config.is_set(key) ) {
+            args += std::string{key} + "=" + config[key] + ";";
+        }
+    }
+    return args;
+}
+
+static void output_report(const GLReport& report,
+                          const std::unique_ptr<gldb::TableWriter>& writer) {
+    if ( writer ) {
+        report.write(std::cout, *writer);
+    }
+    else {
+        std::cout << report;
+    }
+}
+
 static void set_configuration(Config& config, int argc, char *argv[]) {
     config.add_cmdline_option("help", genleg::Argument::NO_ARG);
     config.add_cmdline_option("version", genleg::Argument::NO_ARG);
@@ -154,11 +358,32 @@ static void set_configuration(Config& config, int argc, char *argv[]) {
     config.add_cmdline_option("hostname", genleg::Argument::REQ_ARG);
     config.add_cmdline_option("username", genleg::Argument::REQ_ARG);
     config.add_cmdline_option("password", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("backend", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("stats", genleg::Argument::NO_ARG);
+    config.add_cmdline_option("slowquery", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("record", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("replay", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("replaytimed", genleg::Argument::NO_ARG);
+    config.add_cmdline_option("server", genleg::Argument::REQ_ARG);
     config.add_cmdline_option("standing", genleg::Argument::NO_ARG);
     config.add_cmdline_option("currenttb", genleg::Argument::NO_ARG);
     config.add_cmdline_option("listusers", genleg::Argument::NO_ARG);
     config.add_cmdline_option("je", genleg::Argument::REQ_ARG);
     config.add_cmdline_option("entity", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("compare", genleg::Argument::OPT_ARG);
+    config.add_cmdline_option("from", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("to", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("threshold", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("nonzero", genleg::Argument::NO_ARG);
+    config.add_cmdline_option("top", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("year", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("period", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("format", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("batch", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("jobs", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("cachedir", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("cube", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("rollup", genleg::Argument::NO_ARG);
     config.populate_from_file("conf_files/gl_report_conf.conf");
     config.populate_from_cmdline(argc, argv);
 }
@@ -210,13 +435,61 @@ static void print_help_message() {
         << "  --hostname=<hostname> Specify database hostname\n"
         << "  --username=<username> Specify username for database\n"
         << "  --password=<password> Specify password for database\n"
+        << "  --backend=<backend>   Load a database backend plugin, by name\n"
+        << "                               or path\n"
+        << "  --stats               Show query statistics on exit\n"
+        << "  --slowquery=<msecs>   Log queries taking at least <msecs>\n"
+        << "  --record=<file>       Record queries and results to <file>\n"
+        << "  --replay=<file>       Replay recorded results from <file>\n"
+        << "                               instead of using the database\n"
+        << "  --replaytimed         With --replay, take the recorded time\n"
+        << "                               over each query\n"
+        << "  --server=<path>       Send the report request to the gl_server\n"
+        << "                               listening on socket <path>,\n"
+        << "                               instead of using the database\n"
         << "\nReporting options:\n"
-        << "  --entity=<entity>     Specifies an entity\n"
+        << "  --entity=<entity>     Specifies an entity, or with\n"
+        << "                               --currenttb a comma-separated\n"
+        << "                               list of entities\n"
         << "  --listusers           Show a list of users\n"
         << "  --je=<id>             Show a single journal entry with id <id>\n"
         << "  --standing            Show the standing data\n"
         << "  --currenttb           Show a current trial balance\n"
-        << "                               (optionally for <entity>)\n";
+        << "                               (optionally for <entity>)\n"
+        << "  --from=<account>      With --currenttb, the first account\n"
+        << "  --to=<account>        With --currenttb, the last account\n"
+        << "  --threshold=<amount>  With --currenttb, show only balances of\n"
+        << "                               at least <amount> either way\n"
+        << "  --nonzero             With --currenttb, hide zero balances\n"
+        << "  --top=<n>             With --currenttb, show only the <n>\n"
+        << "                               largest balances either way\n"
+        << "  --compare[=<columns>] Show a comparative trial balance\n"
+        << "                               (optionally for <entity>) with\n"
+        << "                               comma-separated <columns> from\n"
+        << "                               current, prior, prioryear, ytd\n"
+        << "                               and priorytd\n"
+        << "  --year=<year>         With --compare, the reporting year\n"
+        << "  --period=<period>     With --compare, the reporting period\n"
+        << "  --rollup              With --cube, show a consolidated trial\n"
+        << "                               balance (optionally for <entity>\n"
+        << "                               and its descendants), with the\n"
+        << "                               same filters as --currenttb\n"
+        << "\nBalance cube options:\n"
+        << "  --cube=<file>         Run --currenttb, --rollup or --compare\n"
+        << "                               from a balance cube built by\n"
+        << "                               gl_db --build-cube, without\n"
+        << "                               connecting to the database\n"
+        << "\nOutput options:\n"
+        << "  --format=<format>     Output format: text (default), csv,\n"
+        << "                               jsonl or columnar\n"
+        << "  --cachedir=<dir>      Reuse reports cached in <dir> if the\n"
+        << "                               ledger has not changed\n"
+        << "\nBatch options:\n"
+        << "  --batch=<file>        Run the reports listed in <file>, one\n"
+        << "                               per line as\n"
+        << "                               report:arg:output[:format]\n"
+        << "  --jobs=<n>            Run up to <n> reports concurrently\n"
+        << "                               (default 4)\n";
 }
 
 static void print_version_message() {
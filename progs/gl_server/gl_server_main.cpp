@@ -0,0 +1,383 @@
+/*!
+ * \file            gl_server_main.cpp
+ * \brief           Main functionality for gl_server program.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "gldb/gldb.h"
+#include "config/config.h"
+#include "config/liveconfig.h"
+
+using namespace genleg;
+
+/*!
+ * \brief           Static variable for program name.
+ * \ingroup         gl_server
+ */
+static const char * progname = "gl_server";
+
+/*!
+ * \brief           Default path of the server socket.
+ * \ingroup         gl_server
+ */
+static const char * default_socket = "gl_server.sock";
+
+/*!
+ * \brief           Default number of database connections and worker
+ * threads.
+ * \ingroup         gl_server
+ */
+static const size_t default_threads = 4;
+
+/*!
+ * \brief           Default number of reports held in the report cache.
+ * \ingroup         gl_server
+ */
+static const long long default_cache_size = 256;
+
+/*!
+ * \brief           How often to check for a stop or reload request.
+ * \ingroup         gl_server
+ */
+static const std::chrono::milliseconds check_interval{200};
+
+/*!
+ * \brief           Set by the signal handler to stop the server.
+ * \ingroup         gl_server
+ */
+static volatile std::sig_atomic_t stop_requested = 0;
+
+/*!
+ * \brief           The reloadable configuration, for the signal handler.
+ * \ingroup         gl_server
+ */
+static LiveConfig * live_config = nullptr;
+
+/*!
+ * \brief           Sets program configuration options.
+ * \ingroup         gl_server
+ * \param config    Reference to a Config object.
+ * \param argc      \c argc passed to \c main().
+ * \param argv      \c argv passed to \c main().
+ */
+static void set_configuration(Config& config, int argc, char *argv[]);
+
+/*!
+ * \brief           Prints help or version messages if requested.
+ * \ingroup         gl_server
+ * \param config    Reference to a Config object.
+ * \returns         `true` if the help or version message was requested,
+ * `false` otherwise.
+ */
+static bool check_help_and_version(const Config& config);
+
+/*!
+ * \brief           Checks if database, hostname and username were provided.
+ * \ingroup         gl_server
+ * \param config    Reference to a Config object.
+ * \returns         `true` if the information was provided, `false` otherwise.
+ */
+static bool check_db_parameters(const Config& config);
+
+/*!
+ * \brief           Applies the options which may change while running.
+ * \ingroup         gl_server
+ * \param options   The options.
+ * \param cache     The report cache.
+ * \param threads   The number of threads the server is running.
+ */
+static void apply_options(const ConfigSnapshot& options,
+                          GLReportCache& cache, const size_t threads);
+
+/*!
+ * \brief           Stops the server on SIGINT or SIGTERM, and reloads the
+ * configuration on SIGHUP.
+ * \ingroup         gl_server
+ * \param signum    The signal number.
+ */
+static void handle_signal(int signum);
+
+/*!
+ * \brief           Prints a program usage message.
+ * \ingroup         gl_server
+ */
+static void print_usage_message();
+
+/*!
+ * \brief           Prints a program version message.
+ * \ingroup         gl_server
+ */
+static void print_version_message();
+
+/*!
+ * \brief           Prints a program help message.
+ * \ingroup         gl_server
+ */
+static void print_help_message();
+
+/*!
+ * \brief           Gets a password from the terminal.
+ * \ingroup         gl_server
+ * \returns         The password.
+ */
+static std::string login(void);
+
+
+/*!
+ * \brief           Main function
+ * \ingroup         gl_server
+ * \param argc      Number of command line arguments.
+ * \param argv      Command line arguments.
+ * \returns         Exit status code.
+ */
+int main(int argc, char *argv[]) try {
+    Config config;
+    set_configuration(config, argc, argv);
+
+    if ( check_help_and_version(config) ) {
+        return 0;
+    }
+
+    if ( config.is_set("stats") ) {
+        GLDatabase::report_query_stats_at_exit();
+    }
+
+    if ( !check_db_parameters(config) ) {
+        return 1;
+    }
+
+    if ( config.is_set("backend") ) {
+        GLDatabase::select_backend(config["backend"]);
+    }
+
+    LiveConfig live{config};
+    const std::shared_ptr<const ConfigSnapshot> options = live.current();
+    const long long threads = options->get_int("threads", default_threads);
+    if ( threads < 1 ) {
+        throw ConfigBadOption("threads");
+    }
+
+    std::string passwd;
+    if ( config.is_set("password") ) {
+        passwd = config["password"];
+    }
+    else {
+        passwd = login();
+    }
+
+    GLDatabasePool pool(config["database"], config["hostname"],
+                        config["username"], passwd, threads);
+    const auto cache = std::make_shared<GLReportCache>(
+            options->get_string("cachedir", ""));
+    pool.set_report_cache(cache);
+    apply_options(*options, *cache, threads);
+
+    for ( const auto& perm : pool.acquire()->sync_permissions() ) {
+        std::cerr << progname << ": permission '" << perm
+                  << "' is missing from the perms table." << std::endl;
+    }
+
+    const std::string path = options->get_string("socket", default_socket);
+    GLServer server{pool, path};
+    live_config = &live;
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+    std::signal(SIGHUP, handle_signal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << progname << ": listening on '" << path << "' with "
+              << threads << " connections." << std::endl;
+    std::thread thread{&GLServer::run, &server};
+
+    while ( !stop_requested ) {
+        std::this_thread::sleep_for(check_interval);
+        try {
+            if ( live.check() ) {
+                apply_options(*live.current(), *cache, threads);
+                std::cout << progname << ": configuration reloaded."
+                          << std::endl;
+            }
+        }
+        catch ( const std::runtime_error& e ) {
+            std::cerr << progname << ": could not reload configuration - "
+                      << e.what() << std::endl;
+        }
+    }
+
+    server.stop();
+    thread.join();
+    live_config = nullptr;
+    std::cout << progname << ": stopped after serving "
+              << server.requests_served() << " requests." << std::endl;
+
+    return 0;
+}
+catch ( const ConfigBadOption& e ) {
+    std::cerr << progname << ": Invalid command line options" << std::endl;
+}
+catch ( const ConfigOptionNotSet& e ) {
+    std::cerr << progname << ": Request for value of missing option '"
+              << e.what() << "'" << std::endl;
+}
+catch ( const ConfigCouldNotOpenFile& e ) {
+    std::cerr << progname << ": could not open configuration file '"
+              << e.what() << "'" << std::endl;
+}
+catch ( const ConfigBadConfigFile& e ) {
+    std::cerr << progname << ": configuration file '" << e.what()
+              << "' is badly formed." << std::endl;
+}
+catch (const GLDBException& e) {
+    std::cerr << progname << ": database error - " << e.what() << std::endl;
+}
+catch (const std::runtime_error& e) {
+    std::cerr << progname << ": error - " << e.what() << std::endl;
+}
+catch (...) {
+    std::cerr << progname << ": unknown error" << std::endl;
+}
+
+static void set_configuration(Config& config, int argc, char *argv[]) {
+    config.add_cmdline_option("help", Argument::NO_ARG);
+    config.add_cmdline_option("version", Argument::NO_ARG);
+    config.add_cmdline_option("database", Argument::REQ_ARG);
+    config.add_cmdline_option("hostname", Argument::REQ_ARG);
+    config.add_cmdline_option("username", Argument::REQ_ARG);
+    config.add_cmdline_option("password", Argument::REQ_ARG);
+    config.add_cmdline_option("backend", Argument::REQ_ARG);
+    config.add_cmdline_option("stats", Argument::NO_ARG);
+    config.add_cmdline_option("slowquery", Argument::REQ_ARG);
+    config.add_cmdline_option("socket", Argument::REQ_ARG);
+    config.add_cmdline_option("threads", Argument::REQ_ARG);
+    config.add_cmdline_option("cachedir", Argument::REQ_ARG);
+    config.add_cmdline_option("cachesize", Argument::REQ_ARG);
+    config.populate_from_file("conf_files/gl_server_conf.conf");
+    config.populate_from_cmdline(argc, argv);
+}
+
+static bool check_help_and_version(const Config& config) {
+    if ( config.is_set("help") ) {
+        print_help_message();
+        return true;
+    }
+    else if ( config.is_set("version") ) {
+        print_version_message();
+        return true;
+    }
+    return false;
+}
+
+static bool check_db_parameters(const Config& config) {
+    if ( !config.is_set("database") ) {
+        print_usage_message();
+        std::cerr << progname << ": database name not provided" << std::endl;
+        return false;
+    }
+    else if ( !config.is_set("hostname") ) {
+        print_usage_message();
+        std::cerr << progname << ": hostname not provided" << std::endl;
+        return false;
+    }
+    else if ( !config.is_set("username") ) {
+        print_usage_message();
+        std::cerr << progname << ": username not provided" << std::endl;
+        return false;
+    }
+    else {
+        return true;
+    }
+}
+
+static void apply_options(const ConfigSnapshot& options,
+                          GLReportCache& cache, const size_t threads) {
+    if ( options.is_set("slowquery") ) {
+        GLDatabase::set_slow_query_threshold(options["slowquery"]);
+    }
+
+    const long long cache_size = options.get_int("cachesize",
+                                                 default_cache_size);
+    if ( cache_size < 0 ) {
+        throw ConfigBadOption("cachesize");
+    }
+    cache.set_max_entries(cache_size);
+
+    if ( options.get_int("threads", threads) !=
+         static_cast<long long>(threads) ) {
+        std::cerr << progname << ": a change in threads takes effect "
+                  << "on restart." << std::endl;
+    }
+}
+
+static void handle_signal(int signum) {
+    if ( signum == SIGHUP ) {
+        if ( live_config ) {
+            live_config->request_reload();
+        }
+    }
+    else {
+        stop_requested = 1;
+    }
+}
+
+static void print_usage_message() {
+    std::cout << "Usage: " << progname << " [options]\n";
+}
+
+static void print_help_message() {
+    print_usage_message();
+    std::cout << "General options:\n"
+        << "  --help                Display this information\n"
+        << "  --version             Display version information\n"
+        << "\nDatabase options:\n"
+        << "  --database=<database> Specify database name\n"
+        << "  --hostname=<hostname> Specify database hostname\n"
+        << "  --username=<username> Specify username for database\n"
+        << "  --password=<password> Specify password for database\n"
+        << "  --backend=<backend>   Load a database backend plugin, by name\n"
+        << "                               or path\n"
+        << "  --stats               Show query statistics on exit\n"
+        << "  --slowquery=<msecs>   Log queries taking at least <msecs>\n"
+        << "\nServer options:\n"
+        << "  --socket=<path>       Listen on the Unix-domain socket <path>\n"
+        << "                               (default gl_server.sock)\n"
+        << "  --threads=<n>         Serve up to <n> clients at once, each\n"
+        << "                               with its own database\n"
+        << "                               connection (default 4)\n"
+        << "  --cachedir=<dir>      Also save cached reports in <dir>\n"
+        << "  --cachesize=<n>       Hold up to <n> reports in memory\n"
+        << "                               (default 256)\n"
+        << "\nThe configuration file is reloaded on SIGHUP, or when it\n"
+        << "changes, and a new --slowquery or --cachesize takes effect\n"
+        << "without a restart.\n";
+}
+
+static void print_version_message() {
+    std::cout << progname << " v0.1 (experimental)\n"
+              << "Copyright (C) 2014 Paul Griffiths\n"
+              << "Compiled with " << GLDatabase::backend()
+              << " database support.\n"
+              << "This is free software; see the source for copying"
+              << " conditions. There is NO\n"
+              << "warranty; not even for MERCHANTABILITY or FITNESS FOR A "
+              << "PARTICULAR PURPOSE.\n";
+}
+
+static std::string login(void) {
+    std::cout << "Enter password (*WILL BE VISIBLE*): " << std::flush;
+    std::string passwd;
+
+    if ( !std::getline(std::cin, passwd) ) {
+        std::cout << std::endl;
+        throw std::runtime_error("Couldn't get password");
+    }
+
+    return passwd;
+}
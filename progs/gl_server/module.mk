@@ -0,0 +1,7 @@
+local_dir  := progs/gl_server
+local_src  := $(wildcard $(local_dir)/*.cpp)
+local_objs := $(subst .cpp,.o,$(local_src))
+
+sources    += $(local_src)
+server_objects += $(local_objs)
+
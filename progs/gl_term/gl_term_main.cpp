@@ -96,10 +96,28 @@ int main(int argc, char *argv[]) try {
         return 0;
     }
 
+    if ( config.is_set("slowquery") ) {
+        GLDatabase::set_slow_query_threshold(config["slowquery"]);
+    }
+    if ( config.is_set("stats") ) {
+        GLDatabase::report_query_stats_at_exit();
+    }
+
     if ( !check_db_parameters(config) ) {
         return 1;
     }
 
+    if ( config.is_set("backend") ) {
+        GLDatabase::select_backend(config["backend"]);
+    }
+    if ( config.is_set("replay") ) {
+        GLDatabase::replay_queries(config["replay"],
+                                   config.is_set("replaytimed"));
+    }
+    else if ( config.is_set("record") ) {
+        GLDatabase::record_queries(config["record"]);
+    }
+
     std::string passwd;
     if ( config.is_set("password") ) {
         passwd = config["password"];
@@ -112,7 +130,8 @@ int main(int argc, char *argv[]) try {
     /*  Run terminal program  */
 
     TermProgram tp;
-    tp.set_main_window(std::unique_ptr<TPMainWindow>(new GLTermMainWin));
+    tp.set_main_window(
+            std::unique_ptr<TPMainWindow>(new GLTermMainWin(gdb)));
     tp.run();
 
     return 0;
@@ -149,6 +168,12 @@ static void set_configuration(Config& config, int argc, char *argv[]) {
     config.add_cmdline_option("hostname", Argument::REQ_ARG);
     config.add_cmdline_option("username", Argument::REQ_ARG);
     config.add_cmdline_option("password", Argument::REQ_ARG);
+    config.add_cmdline_option("backend", Argument::REQ_ARG);
+    config.add_cmdline_option("stats", Argument::NO_ARG);
+    config.add_cmdline_option("slowquery", Argument::REQ_ARG);
+    config.add_cmdline_option("record", Argument::REQ_ARG);
+    config.add_cmdline_option("replay", Argument::REQ_ARG);
+    config.add_cmdline_option("replaytimed", Argument::NO_ARG);
     config.populate_from_file("conf_files/gl_term_conf.conf");
     config.populate_from_cmdline(argc, argv);
 }
@@ -194,7 +219,10 @@ static void print_help_message() {
     print_usage_message();
     std::cout << "General options:\n"
         << "  --help                Display this information\n"
-        << "  --version             Display version information\n";
+        << "  --version             Display version information\n"
+        << "\nDatabase options:\n"
+        << "  --stats               Show query statistics on exit\n"
+        << "  --slowquery=<msecs>   Log queries taking at least <msecs>\n";
 }
 
 static void print_version_message() {
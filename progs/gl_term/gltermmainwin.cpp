@@ -7,57 +7,41 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
-#include <sstream>
-#include <unistd.h>
 #include "gltermmainwin.h"
 
 using namespace pgcurses;
 
+/*!
+ * \brief           Returns the rectangle for the journal entry line grid.
+ * \details         The grid fills the terminal between the two title rows
+ * and the help row.
+ * \returns         The rectangle.
+ */
+static Rectangle grid_rect();
+
+GLTermMainWin::GLTermMainWin(genleg::GLDatabase& gdb) :
+    TPMainWindow{},
+    m_jelines{gdb},
+    m_grid{grid_rect(), m_jelines}
+{
+}
+
 void GLTermMainWin::show() {
-    write_str("Sample Terminal Program", Point{28, 5});
-    write_str("=======================", Point{28, 6});
-    write_str("Press 'Q' to quit", Point{30, 8});
+    write_str("General Ledger - Journal Entry Lines", Point{0, 0});
+    write_str("Up/Down/PgUp/PgDn/Home/End to scroll, 'Q' to quit",
+              Point{0, terminal_size().height - 1});
     draw();
+
     Key key;
     do {
-        key = get_key();
-        write_str("You pressed: ", Point{28, 10});
-        switch ( key.value ) {
-            case Key::KeyValue::Enter:
-                write_str("<ENTER>    ", Point{41,10});
-                break;
-
-            case Key::KeyValue::Tab:
-                write_str("<TAB>      ", Point{41,10});
-                break;
-
-            case Key::KeyValue::Backspace:
-                write_str("<BACKSPACE>", Point{41,10});
-                break;
-
-            case Key::KeyValue::Up:
-                write_str("<UP>       ", Point{41,10});
-                break;
-
-            case Key::KeyValue::Left:
-                write_str("<LEFT>     ", Point{41,10});
-                break;
-
-            case Key::KeyValue::Down:
-                write_str("<DOWN>     ", Point{41,10});
-                break;
-
-            case Key::KeyValue::Right:
-                write_str("<RIGHT>    ", Point{41,10});
-                break;
-
-            case Key::KeyValue::Value:
-                std::ostringstream ss;
-                ss << "'" << static_cast<char>(key.char_value) << "'        ";
-                write_str(ss.str(), Point{41,10});
-                break;
-
-        }
-    } while ( key.char_value != 'Q' && key.char_value != 'q' );
+        m_grid.render();
+        key = m_grid.get_key();
+        m_grid.handle_key(key);
+    } while ( key.value != Key::KeyValue::Value ||
+              (key.char_value != 'Q' && key.char_value != 'q') );
 }
 
+static Rectangle grid_rect() {
+    const Size sz = terminal_size();
+    return Rectangle{Size{sz.width, sz.height - 3}, Point{0, 2}};
+}
@@ -11,16 +11,35 @@
 #ifndef PG_GENERAL_LEDGER_GLTERMMAINWIN_H
 #define PG_GENERAL_LEDGER_GLTERMMAINWIN_H
 
+#include "gldb/gldb.h"
 #include "pgcurses/pgcurses.h"
- 
+#include "gltermsources.h"
+
 /*!
  * \brief           gl_term main window class.
+ * \details         Browses the journal entry lines in a grid.
  * \ingroup         gl_term
  */
 class GLTermMainWin : public pgcurses::TPMainWindow {
     public:
+
+        /*!
+         * \brief           Constructor.
+         * \param gdb       The database, which must outlive the window.
+         * \throws          TPException on failure.
+         */
+        explicit GLTermMainWin (genleg::GLDatabase& gdb);
+
         virtual void show();
 
+    private:
+
+        /*!  The journal entry lines  */
+        JELineRowSource m_jelines;
+
+        /*!  The grid showing the journal entry lines  */
+        pgcurses::TPGrid m_grid;
+
 };              //  class GLTermMainWin
 
 #endif          //  PG_GENERAL_LEDGER_GLTERMMAINWIN_H
@@ -0,0 +1,91 @@
+/*!
+ * \file            gltermsources.cpp
+ * \brief           Implementation of gl_term grid row source classes
+ * \details         Implementation of gl_term grid row source classes
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <string>
+#include "gltermsources.h"
+
+using namespace genleg;
+using pgcurses::TPRow;
+
+JELineRowSource::JELineRowSource(GLDatabase& gdb) :
+    m_gdb(gdb),
+    m_ids{},
+    m_num_rows{0},
+    m_last_id{0}
+{
+}
+
+TPRow JELineRowSource::headers()
+{
+    return TPRow{"id", "je", "year", "account", "amount"};
+}
+
+size_t JELineRowSource::num_rows()
+{
+    unsigned long long last_id;
+    const size_t rows = m_gdb.jeline_count(last_id);
+
+    /*  Archiving lines moves the row indices, so the IDs seen are
+     *  forgotten whenever the lines change                          */
+
+    if ( rows != m_num_rows || last_id != m_last_id ) {
+        m_ids.clear();
+        m_num_rows = rows;
+        m_last_id = last_id;
+    }
+    return rows;
+}
+
+std::vector<TPRow> JELineRowSource::fetch(const size_t first,
+                                          const size_t count)
+{
+
+    /*  Find the nearest line seen before the first row, if any  */
+
+    unsigned long long after_id = 0;
+    size_t skip = first;
+    auto known = m_ids.lower_bound(first);
+    if ( known != m_ids.begin() ) {
+        --known;
+        after_id = known->second;
+        skip = first - known->first - 1;
+    }
+
+    /*  Find the nearest line seen after the last row, or else the end of
+     *  the lines as last counted, so lines posted since are not counted  */
+
+    const size_t end = std::min(first + count, m_num_rows);
+    unsigned long long before_id = m_last_id + 1;
+    size_t skip_back = end < m_num_rows ? m_num_rows - end : 0;
+    known = m_ids.lower_bound(end);
+    if ( known != m_ids.end() && known->first - end < skip_back ) {
+        before_id = known->second;
+        skip_back = known->first - end;
+    }
+
+    gldb::Table table{end > first && skip_back < skip ?
+        m_gdb.jelines_page_before(before_id, skip_back, end - first) :
+        m_gdb.jelines_page(after_id, skip, count)};
+
+    std::vector<TPRow> rows;
+    rows.reserve(table.num_records());
+    for ( size_t i = 0; i < table.num_records(); ++i ) {
+        TPRow row;
+        for ( size_t j = 0; j < table.num_fields(); ++j ) {
+            row.push_back(table[i][j].str());
+        }
+        rows.push_back(std::move(row));
+    }
+
+    if ( !rows.empty() ) {
+        m_ids[first] = std::stoull(rows.front()[0]);
+        m_ids[first + rows.size() - 1] = std::stoull(rows.back()[0]);
+    }
+    return rows;
+}
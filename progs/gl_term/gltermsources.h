@@ -0,0 +1,69 @@
+/*!
+ * \file            gltermsources.h
+ * \brief           Interface to gl_term grid row source classes
+ * \details         Interface to gl_term grid row source classes
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+
+#ifndef PG_GENERAL_LEDGER_GLTERMSOURCES_H
+#define PG_GENERAL_LEDGER_GLTERMSOURCES_H
+
+#include <map>
+#include "gldb/gldb.h"
+#include "pgcurses/pgcurses.h"
+
+/*!
+ * \brief           Journal entry line row source class.
+ * \details         Fetches each page of journal entry lines from the
+ * database as the grid asks for it. The IDs at both ends of every page
+ * fetched are kept, along with the last ID when the lines are counted, and
+ * each page is found through the primary key from whichever known ID is
+ * nearest, seeking back from an ID after the page where that is closer. So
+ * scrolling through the ledger never reads the rows before the page again,
+ * and jumping to the end reads only the rows after the page.
+ * \ingroup         gl_term
+ */
+class JELineRowSource : public pgcurses::TPRowSource {
+    public:
+
+        /*!
+         * \brief           Constructor.
+         * \param gdb       The database, which must outlive the source.
+         */
+        explicit JELineRowSource (genleg::GLDatabase& gdb);
+
+        /*!  Returns the column headings  */
+        virtual pgcurses::TPRow headers();
+
+        /*!  Returns the number of journal entry lines  */
+        virtual size_t num_rows();
+
+        /*!
+         * \brief           Returns a page of journal entry lines.
+         * \param first     The index of the first line to return.
+         * \param count     The number of lines to return.
+         * \returns         The lines, in ID order.
+         */
+        virtual std::vector<pgcurses::TPRow> fetch(const size_t first,
+                                                   const size_t count);
+
+    private:
+
+        /*!  The database  */
+        genleg::GLDatabase& m_gdb;
+
+        /*!  The ID of the line at each row index seen  */
+        std::map<size_t, unsigned long long> m_ids;
+
+        /*!  The number of lines when last counted  */
+        size_t m_num_rows;
+
+        /*!  The ID of the last line when last counted  */
+        unsigned long long m_last_id;
+
+};              //  class JELineRowSource
+
+#endif          //  PG_GENERAL_LEDGER_GLTERMSOURCES_H
@@ -6,7 +6,9 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
 
 #include "gldb/gldb.h"
 #include "database/database.h"
@@ -20,6 +22,24 @@ using namespace genleg;
  */
 static const char * progname = "gl_user";
 
+/*!
+ * \brief           Most hashing threads allowed for each core.
+ * \ingroup         gl_user
+ */
+static const unsigned long max_threads_per_core = 4;
+
+/*!
+ * \brief           Fewest hashing rounds allowed, as \c crypt() allows.
+ * \ingroup         gl_user
+ */
+static const unsigned long min_hash_rounds = 1000;
+
+/*!
+ * \brief           Most hashing rounds allowed, as \c crypt() allows.
+ * \ingroup         gl_user
+ */
+static const unsigned long max_hash_rounds = 999999999;
+
 /*!
  * \brief           Sets program configuration options.
  * \ingroup         gl_user
@@ -46,14 +66,48 @@ static bool check_help_and_version(const Config& config);
  */
 static bool check_db_parameters(const Config& config);
 
+/*!
+ * \brief           Checks the bulk user options.
+ * \ingroup         gl_user
+ * \param config    Reference to a Config object.
+ * \param threads   Set to the number of hashing threads.
+ * \param rounds    Set to the number of hashing rounds.
+ * \returns         `true` if the options are valid, `false` otherwise.
+ */
+static bool check_bulk_parameters(const Config& config, size_t& threads,
+                                  unsigned int& rounds);
+
+/*!
+ * \brief           Parses a count given on the command line.
+ * \ingroup         gl_user
+ * \param value     The option value.
+ * \param min       The smallest count allowed.
+ * \param max       The largest count allowed.
+ * \param count     Set to the count.
+ * \returns         `true` if the value is a number from \c min to \c max,
+ * `false` otherwise.
+ */
+static bool parse_count(const std::string& value, const unsigned long min,
+                        const unsigned long max, unsigned long& count);
+
+/*!
+ * \brief           Runs the user command selected on the command line.
+ * \ingroup         gl_user
+ * \param config    Program configurations object.
+ * \param gdb       The database, or a client of a running \c gl_server.
+ */
+template <typename Ledger>
+static void run_command(Config& config, Ledger& gdb);
+
 /*!
  * \brief           Returns a user from either an ID or a name.
  * \ingroup         gl_user
  * \param config    Program configurations object.
- * \param gdb       Database object.
+ * \param gdb       The database, or a client of a running \c gl_server.
  * \returns         The user.
  */
-GLUser get_user(Config& config, GLDatabase& gdb);
+template <typename Ledger>
+static GLUser get_user(Config& config, Ledger& gdb);
 
 /*!
  * \brief           Outputs details for a user.
@@ -67,20 +121,20 @@ static void show_user_details(const GLUser& user);
  * \ingroup         gl_user
  * \param user      Reference to user.
  * \param config    Reference to program configuration.
- * \param gdb       Reference to database object.
+ * \param gdb       The database, or a client of a running \c gl_server.
  */
-static void enable_user(GLUser& user, Config& config,
-                        GLDatabase& gdb);
+template <typename Ledger>
+static void enable_user(GLUser& user, Config& config, Ledger& gdb);
 
 /*!
  * \brief           Sets a user's password.
  * \ingroup         gl_user
  * \param user      Reference to user.
  * \param config    Reference to program configuration.
- * \param gdb       Reference to database object.
+ * \param gdb       The database, or a client of a running \c gl_server.
  */
-static void set_user_password(GLUser& user, Config& config,
-                              GLDatabase& gdb);
+template <typename Ledger>
+static void set_user_password(GLUser& user, Config& config, Ledger& gdb);
 
 /*!
  * \brief           Checks a user's password.
@@ -90,6 +144,21 @@ static void set_user_password(GLUser& user, Config& config,
  */
 static void check_user_password(GLUser& user, Config& config);
 
+/*!
+ * \brief           Adds the users listed in a file.
+ * \details         The file has the same form as the sample data files,
+ * with \c user_name, \c first_name, \c last_name and \c password
+ * columns. Passwords are hashed on a pool of threads, and the users are
+ * then added in batches in one transaction.
+ * \ingroup         gl_user
+ * \param config    Reference to program configuration options.
+ * \param gdb       The database.
+ * \param threads   The number of threads on which to hash passwords.
+ * \param rounds    The number of hashing rounds.
+ */
+static void add_bulk_users(Config& config, GLDatabase& gdb,
+                           const size_t threads, const unsigned int rounds);
+
 /*!
  * \brief           Prints a program usage message.
  * \ingroup         gl_user
@@ -131,10 +200,46 @@ int main(int argc, char *argv[]) try {
         return 0;
     }
 
+    if ( config.is_set("slowquery") ) {
+        GLDatabase::set_slow_query_threshold(config["slowquery"]);
+    }
+    if ( config.is_set("stats") ) {
+        GLDatabase::report_query_stats_at_exit();
+    }
+
+    if ( config.is_set("server") ) {
+        if ( config.is_set("bulk") ) {
+            std::cerr << progname << ": --bulk may not be sent to a server."
+                      << std::endl;
+            return 1;
+        }
+        GLClient client{config["server"]};
+        run_command(config, client);
+        return 0;
+    }
+
     if ( !check_db_parameters(config) ) {
         return 1;
     }
 
+    size_t threads;
+    unsigned int rounds;
+    if ( config.is_set("bulk") &&
+         !check_bulk_parameters(config, threads, rounds) ) {
+        return 1;
+    }
+
+    if ( config.is_set("backend") ) {
+        GLDatabase::select_backend(config["backend"]);
+    }
+    if ( config.is_set("replay") ) {
+        GLDatabase::replay_queries(config["replay"],
+                                   config.is_set("replaytimed"));
+    }
+    else if ( config.is_set("record") ) {
+        GLDatabase::record_queries(config["record"]);
+    }
+
     std::string passwd;
     if ( config.is_set("password") ) {
         passwd = config["password"];
@@ -143,7 +248,87 @@ int main(int argc, char *argv[]) try {
 
     GLDatabase gdb(config["database"], config["hostname"],
                     config["username"], passwd);
+    if ( config.is_set("bulk") ) {
+        add_bulk_users(config, gdb, threads, rounds);
+    }
+    else {
+        run_command(config, gdb);
+    }
 
+    return 0;
+}
+catch ( const ConfigBadOption& e ) {
+    std::cerr << progname << ": Invalid command line options" << std::endl;
+}
+catch ( const ConfigOptionNotSet& e ) {
+    std::cerr << progname << ": Request for value of missing option '"
+              << e.what() << "'" << std::endl;
+}
+catch ( const ConfigCouldNotOpenFile& e ) {
+    std::cerr << progname << ": could not open configuration file '"
+              << e.what() << "'" << std::endl;
+}
+catch ( const ConfigBadConfigFile& e ) {
+    std::cerr << progname << ": configuration file '" << e.what()
+              << "' is badly formed." << std::endl;
+}
+catch (const GLDBException& e) {
+    std::cerr << progname << ": database error - " << e.what() << std::endl;
+}
+catch (const std::runtime_error& e) {
+    std::cerr << progname << ": error - " << e.what() << std::endl;
+}
+catch (...) {
+    std::cerr << progname << ": unknown error" << std::endl;
+}
+
+static bool check_bulk_parameters(const Config& config, size_t& threads,
+                                  unsigned int& rounds) {
+    const unsigned long cores =
+        std::max(std::thread::hardware_concurrency(), 1u);
+    unsigned long count = cores;
+    if ( config.is_set("threads") &&
+         !parse_count(config["threads"], 1, cores * max_threads_per_core,
+                      count) ) {
+        print_usage_message();
+        std::cerr << progname << ": --threads must be from 1 to "
+                  << cores * max_threads_per_core << std::endl;
+        return false;
+    }
+    threads = count;
+
+    count = default_hash_rounds;
+    if ( config.is_set("rounds") &&
+         !parse_count(config["rounds"], min_hash_rounds, max_hash_rounds,
+                      count) ) {
+        print_usage_message();
+        std::cerr << progname << ": --rounds must be from "
+                  << min_hash_rounds << " to " << max_hash_rounds
+                  << std::endl;
+        return false;
+    }
+    rounds = static_cast<unsigned int>(count);
+    return true;
+}
+
+static bool parse_count(const std::string& value, const unsigned long min,
+                        const unsigned long max, unsigned long& count) {
+    if ( value.empty() || value.size() > 10 ||
+         !std::all_of(value.begin(), value.end(), [](const char c) {
+                 return c >= '0' && c <= '9';
+         }) ) {
+        return false;
+    }
+    const unsigned long long n = std::stoull(value);
+    if ( n < min || n > max ) {
+        return false;
+    }
+    count = static_cast<unsigned long>(n);
+    return true;
+}
+
+template <typename Ledger>
+static void run_command(Config& config, Ledger& gdb) {
     if ( config.is_set("show") ) {
         show_user_details(get_user(config, gdb));
     }
@@ -192,32 +377,6 @@ int main(int argc, char *argv[]) try {
     else {
         std::cerr << progname << ": no options selected." << std::endl;
     }
-
-    return 0;
-}
-catch ( const ConfigBadOption& e ) {
-    std::cerr << progname << ": Invalid command line options" << std::endl;
-}
-catch ( const ConfigOptionNotSet& e ) {
-    std::cerr << progname << ": Request for value of missing option '"
-              << e.what() << "'" << std::endl;
-}
-catch ( const ConfigCouldNotOpenFile& e ) {
-    std::cerr << progname << ": could not open configuration file '"
-              << e.what() << "'" << std::endl;
-}
-catch ( const ConfigBadConfigFile& e ) {
-    std::cerr << progname << ": configuration file '" << e.what()
-              << "' is badly formed." << std::endl;
-}
-catch (const GLDBException& e) {
-    std::cerr << progname << ": database error - " << e.what() << std::endl;
-}
-catch (const std::runtime_error& e) {
-    std::cerr << progname << ": error - " << e.what() << std::endl;
-}
-catch (...) {
-    std::cerr << progname << ": unknown error" << std::endl;
 }
 
 static void set_configuration(Config& config, int argc, char *argv[]) {
@@ -227,6 +386,13 @@ static void set_configuration(Config& config, int argc, char *argv[]) {
     config.add_cmdline_option("hostname", Argument::REQ_ARG);
     config.add_cmdline_option("username", Argument::REQ_ARG);
     config.add_cmdline_option("password", Argument::REQ_ARG);
+    config.add_cmdline_option("backend", Argument::REQ_ARG);
+    config.add_cmdline_option("stats", Argument::NO_ARG);
+    config.add_cmdline_option("slowquery", Argument::REQ_ARG);
+    config.add_cmdline_option("record", Argument::REQ_ARG);
+    config.add_cmdline_option("replay", Argument::REQ_ARG);
+    config.add_cmdline_option("replaytimed", Argument::NO_ARG);
+    config.add_cmdline_option("server", Argument::REQ_ARG);
     config.add_cmdline_option("show", Argument::NO_ARG);
     config.add_cmdline_option("enable", Argument::REQ_ARG);
     config.add_cmdline_option("setpass", Argument::REQ_ARG);
@@ -235,6 +401,9 @@ static void set_configuration(Config& config, int argc, char *argv[]) {
     config.add_cmdline_option("revoke", Argument::REQ_ARG);
     config.add_cmdline_option("id", Argument::REQ_ARG);
     config.add_cmdline_option("name", Argument::REQ_ARG);
+    config.add_cmdline_option("bulk", Argument::REQ_ARG);
+    config.add_cmdline_option("threads", Argument::REQ_ARG);
+    config.add_cmdline_option("rounds", Argument::REQ_ARG);
     config.populate_from_file("conf_files/gl_user_conf.conf");
     config.populate_from_cmdline(argc, argv);
 }
@@ -272,7 +441,8 @@ static bool check_db_parameters(const Config& config) {
     }
 }
 
-GLUser get_user(Config& config, GLDatabase& gdb) {
+template <typename Ledger>
+static GLUser get_user(Config& config, Ledger& gdb) {
     if ( config.is_set("id") ) {
         return gdb.get_user_by_id(config["id"]);
     }
@@ -301,8 +471,8 @@ static void show_user_details(const GLUser& user) {
     }
 }
 
-static void enable_user(GLUser& user, Config& config,
-                        GLDatabase& gdb) {
+template <typename Ledger>
+static void enable_user(GLUser& user, Config& config, Ledger& gdb) {
     if ( config["enable"] != "yes" && config["enable"] != "no" ) {
         throw ConfigBadOption("enable");
     }
@@ -327,8 +497,8 @@ static void enable_user(GLUser& user, Config& config,
     }
 }
 
-static void set_user_password(GLUser& user, Config& config,
-                              GLDatabase& gdb) {
+template <typename Ledger>
+static void set_user_password(GLUser& user, Config& config, Ledger& gdb) {
     std::cout << "Setting password for user '"
               << user.username() << "'..." << std::endl;
     user.set_password(config["setpass"]);
@@ -347,6 +517,26 @@ static void check_user_password(GLUser& user, Config& config) {
     }
 }
 
+static void add_bulk_users(Config& config, GLDatabase& gdb,
+                           const size_t threads, const unsigned int rounds) {
+    gldb::Table table{gldb::Table::create_from_file(config["bulk"], ':')};
+    std::vector<GLUser> users;
+    std::vector<std::string> passwords;
+    for ( size_t i = 0; i < table.num_records(); ++i ) {
+        users.emplace_back("", table.get_field("user_name", i),
+                           table.get_field("first_name", i),
+                           table.get_field("last_name", i),
+                           "", "", GLPermissionSet{}, true);
+        passwords.push_back(table.get_field("password", i));
+    }
+
+    std::cout << "Hashing passwords for " << users.size() << " users on "
+              << threads << " threads..." << std::endl;
+    set_passwords(users, passwords, threads, rounds);
+    gdb.add_users(users);
+    std::cout << "...added " << users.size() << " users." << std::endl;
+}
+
 static void print_usage_message() {
     std::cout << "Usage: " << progname << " [options]\n";
 }
@@ -357,6 +547,8 @@ static void print_help_message() {
         << "  --help                Display this information\n"
         << "  --version             Display version information\n"
         << "\nDatabase options:\n"
+        << "  --stats               Show query statistics on exit\n"
+        << "  --slowquery=<msecs>   Log queries taking at least <msecs>\n"
         << "  --show                Show details of a user\n"
         << "  --enable=<yes|no>     Enabled or disable a user\n"
         << "  --checkpass=<passwd>  Check a password against the user's\n"
@@ -364,7 +556,18 @@ static void print_help_message() {
         << "  --grant=<perm>        Grant a permission to a user\n"
         << "  --revoke=<perm>       Revoke a permission from a user\n"
         << "  --id=<id>             Specify a user by ID\n"
-        << "  --name=<name>         Specify a user by username\n";
+        << "  --name=<name>         Specify a user by username\n"
+        << "  --bulk=<file>         Add the users listed in <file>, with\n"
+        << "                               user_name, first_name,\n"
+        << "                               last_name and password\n"
+        << "                               columns\n"
+        << "  --threads=<n>         With --bulk, hash passwords on <n>\n"
+        << "                               threads (default one per core)\n"
+        << "  --rounds=<n>          With --bulk, hash passwords with <n>\n"
+        << "                               rounds (default 5000)\n"
+        << "  --server=<path>       Send the request to the gl_server\n"
+        << "                               listening on socket <path>,\n"
+        << "                               instead of using the database\n";
 }
 
 static void print_version_message() {
@@ -0,0 +1,152 @@
+/*
+ *  test_backends.cpp
+ *  =================
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Unit tests for database backend selection.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "database_imp/backends.h"
+#include "database_imp/database_imp.h"
+#include "dbsql/dbsql.h"
+
+using namespace gldb;
+using namespace genleg;
+
+namespace {
+
+/*
+ *  Selects the built-in backend again when destroyed.
+ */
+
+struct BuiltinBackendGuard {
+    ~BuiltinBackendGuard() { select_backend("builtin"); }
+};
+
+/*
+ *  Registers an SQL dialect, and restores the one it replaced when
+ *  destroyed.
+ */
+
+class SQLDialectGuard {
+    public:
+        SQLDialectGuard(const std::string& type,
+                        const SQLDialectFactory factory) :
+            m_type{type},
+            m_replaced{register_sql_dialect(type, factory)} {}
+
+        ~SQLDialectGuard() { register_sql_dialect(m_type, m_replaced); }
+
+        SQLDialectGuard(const SQLDialectGuard&) = delete;
+        SQLDialectGuard& operator=(const SQLDialectGuard&) = delete;
+
+    private:
+        const std::string m_type;
+        const SQLDialectFactory m_replaced;
+};
+
+/*
+ *  Returns the path of the plugin built for the built-in database, as
+ *  by make plugin database=name.
+ */
+
+std::string built_plugin_path() {
+    std::string name = get_database_type();
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    return "lib/database_imp/" + name + "/gldb_" + name + ".so";
+}
+
+}           //  namespace
+
+BOOST_AUTO_TEST_SUITE(backends_suite)
+
+BOOST_AUTO_TEST_CASE(test_backend_builtin) {
+    select_backend("builtin");
+    BOOST_CHECK_EQUAL(backend_database_type(), get_database_type());
+    BOOST_CHECK(get_sql_object());
+
+    select_backend("");
+    BOOST_CHECK_EQUAL(backend_database_type(), get_database_type());
+}
+
+BOOST_AUTO_TEST_CASE(test_backend_bad_plugin) {
+    BOOST_CHECK_THROW(select_backend("no_such_backend"),
+                      DBConnCouldNotLoadBackend);
+    BOOST_CHECK_THROW(select_backend("./no_such_backend.so"),
+                      DBConnCouldNotLoadBackend);
+
+    /*  A failed load leaves the previous backend selected  */
+
+    BOOST_CHECK_EQUAL(backend_database_type(), get_database_type());
+}
+
+BOOST_AUTO_TEST_CASE(test_backend_built_plugin) {
+    BuiltinBackendGuard guard;
+    select_backend(built_plugin_path());
+    BOOST_CHECK_EQUAL(backend_database_type(), get_database_type());
+
+    /*  The thread set up and tear down come from the plugin too  */
+
+    {
+        const BackendThread backend_thread;
+    }
+
+    /*  A plugin is loaded once, however often it is selected  */
+
+    select_backend("builtin");
+    select_backend(built_plugin_path());
+    BOOST_CHECK_EQUAL(backend_database_type(), get_database_type());
+
+    if ( get_database_type() == "SQLite" ) {
+        DBConn dbc{backend_connection(":memory:", "", "", "")};
+        BOOST_CHECK_EQUAL(dbc.select("SELECT 6 * 7 AS n").get_field("n", 0),
+                          "42");
+    }
+
+    /*  The plugin provides its own dialect, so needs none registered  */
+
+    SQLDialectGuard dialect_guard{get_database_type(), nullptr};
+    BOOST_CHECK(get_sql_object());
+    select_backend("builtin");
+    BOOST_CHECK_THROW(get_sql_object(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_sql_dialect_registry) {
+
+    /*  Replaces the compiled-in dialect with one which returns the same
+     *  object each time, so the replacement is seen, and the guard
+     *  restores the original for the other tests.                      */
+
+    static std::shared_ptr<const DBSQLStatements> saved;
+    saved = get_sql_object();
+    {
+        SQLDialectGuard guard{get_database_type(),
+                              []() { return saved; }};
+        BOOST_CHECK(get_sql_object() == saved);
+        BOOST_CHECK(get_sql_object() == get_sql_object());
+    }
+    BOOST_CHECK(get_sql_object() != saved);
+
+    /*  A dialect may be added for a new database type and removed  */
+
+    {
+        SQLDialectGuard guard{"NEWTYPE", []() { return saved; }};
+        BOOST_CHECK(register_sql_dialect("NEWTYPE", nullptr));
+    }
+    BOOST_CHECK(!register_sql_dialect("NEWTYPE", nullptr));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
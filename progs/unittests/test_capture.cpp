@@ -0,0 +1,151 @@
+/*
+ *  test_capture.cpp
+ *  ================
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Unit tests for query capture and replay classes.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "database/database.h"
+
+using namespace gldb;
+
+/*
+ *  Connection implementation which returns its query and a counter from
+ *  every select, and fails any statement containing "FAIL".
+ */
+
+class CountingConn : public DBConnImp {
+    public:
+        CountingConn() : m_count(0) {}
+
+        virtual void query(const std::string& sql_query) {
+            run(sql_query);
+        }
+
+        virtual Table select(const std::string& query) {
+            run(query);
+            Table table{TableRow{"query", "count"}};
+            table.append_record(TableRow{query, std::to_string(m_count)});
+            table.append_record(TableRow{"", std::string("a\0b", 3)});
+            return table;
+        }
+
+        virtual void begin_transaction() { run("BEGIN"); }
+        virtual void rollback_transaction() { run("ROLLBACK"); }
+        virtual void commit_transaction() { run("COMMIT"); }
+        virtual unsigned long long last_auto_increment() {
+            return 1000 + m_count;
+        }
+
+    private:
+        unsigned long long m_count;
+
+        void run(const std::string& sql) {
+            if ( sql.find("FAIL") != std::string::npos ) {
+                throw DBConnCouldNotQuery("Failed: " + sql);
+            }
+            ++m_count;
+        }
+};
+
+BOOST_AUTO_TEST_SUITE(capture_suite)
+
+BOOST_AUTO_TEST_CASE(test_capture_replay) {
+    const std::string filename = "test_capture.cap";
+    std::vector<Table> recorded;
+    {
+        auto writer = std::make_shared<CaptureWriter>(filename, "Test");
+        DBConn conn{new DBConnRecorder(new CountingConn, writer)};
+        conn.begin_transaction();
+        recorded.push_back(conn.select("SELECT 1"));
+        conn.query("INSERT INTO x VALUES (1)");
+        BOOST_CHECK_EQUAL(conn.last_auto_increment(), 1003);
+        recorded.push_back(conn.select("SELECT 1"));
+        BOOST_CHECK_THROW(conn.query("FAIL"), DBConnCouldNotQuery);
+        try {
+            conn.query_batch(std::vector<std::string>{"A", "FAIL B", "C"});
+            BOOST_FAIL("Batch did not fail");
+        }
+        catch ( const DBConnBatchFailed& e ) {
+            BOOST_CHECK_EQUAL(e.index(), 1);
+        }
+        conn.commit_transaction();
+    }
+
+    auto library = std::make_shared<CaptureLibrary>(filename);
+    boost::filesystem::remove(filename);
+    BOOST_CHECK_EQUAL(library->database_type(), "Test");
+    BOOST_CHECK_EQUAL(library->remaining(), 8);
+
+    DBConn conn{new DBConnReplay(library, false)};
+    conn.begin_transaction();
+    const Table first{conn.select("SELECT 1")};
+    BOOST_CHECK_EQUAL(first.get_headers()[1].str(), "count");
+    BOOST_CHECK_EQUAL(first[0][1].str(), recorded[0][0][1].str());
+    BOOST_CHECK_EQUAL(first[1][1].str(), std::string("a\0b", 3));
+    conn.query("INSERT INTO x VALUES (1)");
+    BOOST_CHECK_EQUAL(conn.last_auto_increment(), 1003);
+    BOOST_CHECK_EQUAL(conn.select("SELECT 1")[0][1].str(),
+                      recorded[1][0][1].str());
+    BOOST_CHECK_THROW(conn.query("FAIL"), DBConnCouldNotQuery);
+    try {
+        conn.query_batch(std::vector<std::string>{"A", "FAIL B", "C"});
+        BOOST_FAIL("Batch did not fail");
+    }
+    catch ( const DBConnBatchFailed& e ) {
+        BOOST_CHECK_EQUAL(e.index(), 1);
+    }
+    conn.commit_transaction();
+    BOOST_CHECK_EQUAL(library->remaining(), 0);
+
+    BOOST_CHECK_THROW(conn.select("SELECT 1"), DBCaptureException);
+}
+
+BOOST_AUTO_TEST_CASE(test_capture_bad_file) {
+    BOOST_CHECK_THROW(CaptureLibrary{"no_such_capture.cap"},
+                      DBCaptureException);
+
+    const std::string filename = "test_capture_bad.cap";
+    {
+        std::ofstream file(filename);
+        file << "GLDBCAP1\x04Test\x01\x80";
+    }
+    BOOST_CHECK_THROW(CaptureLibrary{filename}, DBCaptureException);
+
+    /*  Selects with more rows than the file holds, with and without
+     *  columns, are refused rather than filling memory                 */
+
+    const std::string select{"GLDBCAP1\x04Test\x02\x08SELECT 1\x05", 24};
+    const std::string huge{"\xff\xff\xff\xff\x0f"};
+    for ( const std::string& fields : {std::string(2, '\0'),
+                                       std::string{"\0\x01\x01" "a", 4}} ) {
+        {
+            std::ofstream file(filename, std::ios::binary);
+            file << select << fields << huge;
+        }
+        try {
+            CaptureLibrary library{filename};
+            BOOST_FAIL("Bad row count was accepted");
+        }
+        catch ( const DBCaptureException& e ) {
+            BOOST_CHECK(std::string{e.what()}.find("bad row count") !=
+                        std::string::npos);
+        }
+    }
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
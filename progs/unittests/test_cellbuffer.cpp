@@ -0,0 +1,109 @@
+/*
+ *  test_cellbuffer.cpp
+ *  ===================
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Unit tests for TPCellBuffer class.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include "pgcurses/pgcurses.h"
+
+using namespace pgcurses;
+
+BOOST_AUTO_TEST_SUITE(cellbuffer_suite)
+
+BOOST_AUTO_TEST_CASE(cellbuffer_write_and_clip) {
+    TPCellBuffer buf{Size{5, 2}};
+    buf.write_str("abcdefg", Point{2, 0});
+    BOOST_CHECK_EQUAL(buf.cell(Point{2, 0}), 'a');
+    BOOST_CHECK_EQUAL(buf.cell(Point{4, 0}), 'c');
+    BOOST_CHECK_EQUAL(buf.cell(Point{0, 1}), 'd');
+    BOOST_CHECK_EQUAL(buf.position().x, 4);
+    BOOST_CHECK_EQUAL(buf.position().y, 1);
+
+    buf.write_str("xyz", Point{3, 1});
+    BOOST_CHECK_EQUAL(buf.cell(Point{4, 1}), 'y');
+    buf.write_char('!', Point{-1, 0});
+    buf.write_char('!', Point{0, 7});
+    BOOST_CHECK_EQUAL(buf.cell(Point{0, 7}), ' ');
+}
+
+BOOST_AUTO_TEST_CASE(cellbuffer_newline_clears_row) {
+    TPCellBuffer buf{Size{6, 3}};
+    buf.write_str("abcdef", Point{0, 0});
+    buf.write_str("uvwxyz", Point{0, 1});
+    buf.flush();
+
+    buf.write_str("AB\nC", Point{0, 0});
+    BOOST_CHECK_EQUAL(buf.cell(Point{1, 0}), 'B');
+    BOOST_CHECK_EQUAL(buf.cell(Point{2, 0}), ' ');
+    BOOST_CHECK_EQUAL(buf.cell(Point{5, 0}), ' ');
+    BOOST_CHECK_EQUAL(buf.cell(Point{0, 1}), 'C');
+    BOOST_CHECK_EQUAL(buf.cell(Point{1, 1}), 'v');
+    BOOST_CHECK_EQUAL(buf.position().x, 1);
+    BOOST_CHECK_EQUAL(buf.position().y, 1);
+
+    const std::vector<CellRun> runs = buf.flush();
+    BOOST_REQUIRE_EQUAL(runs.size(), 2u);
+    BOOST_CHECK_EQUAL(runs[0].text, "AB    ");
+    BOOST_CHECK_EQUAL(runs[1].text, "C");
+}
+
+BOOST_AUTO_TEST_CASE(cellbuffer_damage_and_flush) {
+    TPCellBuffer buf{Size{20, 4}};
+    BOOST_CHECK_EQUAL(buf.damage().size.width, 0);
+    BOOST_CHECK(buf.flush().empty());
+
+    buf.write_str("hello", Point{3, 1});
+    buf.write_str("xx", Point{10, 2});
+    const Rectangle damage = buf.damage();
+    BOOST_CHECK_EQUAL(damage.origin.x, 3);
+    BOOST_CHECK_EQUAL(damage.origin.y, 1);
+    BOOST_CHECK_EQUAL(damage.size.width, 9);
+    BOOST_CHECK_EQUAL(damage.size.height, 2);
+
+    std::vector<CellRun> runs = buf.flush();
+    BOOST_REQUIRE_EQUAL(runs.size(), 2u);
+    BOOST_CHECK_EQUAL(runs[0].origin.x, 3);
+    BOOST_CHECK_EQUAL(runs[0].text, "hello");
+    BOOST_CHECK_EQUAL(runs[1].origin.y, 2);
+    BOOST_CHECK_EQUAL(runs[1].text, "xx");
+    BOOST_CHECK_EQUAL(buf.damage().size.height, 0);
+
+    //  Rewriting what is shown sends nothing
+
+    buf.write_str("hello", Point{3, 1});
+    BOOST_CHECK(buf.flush().empty());
+
+    //  Close changes are one run, distant ones are not
+
+    buf.write_str("jelly", Point{3, 1});
+    buf.write_char('!', Point{19, 1});
+    runs = buf.flush();
+    BOOST_REQUIRE_EQUAL(runs.size(), 2u);
+    BOOST_CHECK_EQUAL(runs[0].text, "jelly");
+    BOOST_CHECK_EQUAL(runs[1].origin.x, 19);
+
+    buf.write_char('J', Point{3, 1});
+    buf.write_char('Y', Point{7, 1});
+    runs = buf.flush();
+    BOOST_REQUIRE_EQUAL(runs.size(), 1u);
+    BOOST_CHECK_EQUAL(runs[0].text, "JellY");
+
+    buf.invalidate();
+    runs = buf.flush();
+    BOOST_REQUIRE_EQUAL(runs.size(), 4u);
+    BOOST_CHECK_EQUAL(runs[1].text.size(), 20u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
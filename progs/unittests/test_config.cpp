@@ -13,11 +13,15 @@
  */
 
 #include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
 
+#include <ctime>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <memory>
 #include "config/config.h"
+#include "config/liveconfig.h"
 
 BOOST_AUTO_TEST_SUITE(config_suite)
 
@@ -146,5 +150,80 @@ BOOST_AUTO_TEST_CASE(config_test_cmdline_multiple_options) {
     BOOST_CHECK_EQUAL(config["opt15"], empty_string);
 }
 
+BOOST_AUTO_TEST_CASE(config_test_snapshot_typed_values) {
+    char arg1[] = "ut";
+    char arg2[] = "--threads=8";
+    char arg3[] = "--verbose";
+    char arg4[] = "--cache=off";
+    char arg5[] = "--name=carrot";
+    char * const argv[] = {arg1, arg2, arg3, arg4, arg5, nullptr};
+
+    genleg::Config config;
+    config.add_cmdline_option("threads", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("verbose", genleg::Argument::NO_ARG);
+    config.add_cmdline_option("cache", genleg::Argument::REQ_ARG);
+    config.add_cmdline_option("name", genleg::Argument::REQ_ARG);
+    config.populate_from_cmdline(5, argv);
+
+    const auto options = config.snapshot();
+    BOOST_CHECK_EQUAL(options->get_int("threads", 4), 8);
+    BOOST_CHECK_EQUAL(options->get_int("jobs", 4), 4);
+    BOOST_CHECK(options->get_bool("verbose", false));
+    BOOST_CHECK(!options->get_bool("cache", true));
+    BOOST_CHECK_EQUAL(options->get_string("name", ""), "carrot");
+    BOOST_CHECK_EQUAL((*options)["threads"], "8");
+    BOOST_CHECK_THROW(options->get_int("name", 0), genleg::ConfigBadOption);
+    BOOST_CHECK_THROW(options->get_bool("name", false),
+                      genleg::ConfigBadOption);
+    BOOST_CHECK_THROW((*options)["jobs"], genleg::ConfigOptionNotSet);
+}
+
+BOOST_AUTO_TEST_CASE(config_test_live_reload) {
+    namespace fs = boost::filesystem;
+    const std::string filename = (fs::temp_directory_path() /
+            fs::unique_path("gl_config_test_%%%%-%%%%.conf")).string();
+    {
+        std::ofstream ofs{filename};
+        ofs << "threads = 4\ncachesize = 100\n";
+    }
+
+    char arg1[] = "ut";
+    char arg2[] = "--cachesize=50";
+    char * const argv[] = {arg1, arg2, nullptr};
+
+    genleg::Config config;
+    config.add_cmdline_option("cachesize", genleg::Argument::REQ_ARG);
+    config.populate_from_file(filename);
+    config.populate_from_cmdline(2, argv);
+
+    genleg::LiveConfig live{config};
+    const auto before = live.current();
+    BOOST_CHECK(!live.check());
+    BOOST_CHECK_EQUAL(before->get_int("threads", 0), 4);
+    BOOST_CHECK_EQUAL(before->get_int("cachesize", 0), 50);
+
+    {
+        std::ofstream ofs{filename};
+        ofs << "threads = 6\ncachesize = 100\n";
+    }
+    fs::last_write_time(filename, std::time(nullptr) + 10);
+    BOOST_CHECK(live.check());
+    BOOST_CHECK_EQUAL(live.current()->get_int("threads", 0), 6);
+    BOOST_CHECK_EQUAL(live.current()->get_int("cachesize", 0), 50);
+    BOOST_CHECK_EQUAL(live.current()->generation(), 1u);
+    BOOST_CHECK_EQUAL(before->get_int("threads", 0), 4);
+
+    {
+        std::ofstream ofs{filename};
+        ofs << "threads = 6 = 7\n";
+    }
+    live.request_reload();
+    BOOST_CHECK_THROW(live.check(), genleg::ConfigBadConfigFile);
+    BOOST_CHECK_EQUAL(live.current()->get_int("threads", 0), 6);
+    BOOST_CHECK_EQUAL(config["threads"], "6");
+
+    fs::remove(filename);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
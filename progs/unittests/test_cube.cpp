@@ -0,0 +1,192 @@
+/*
+ *  test_cube.cpp
+ *  =============
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Unit tests for balance cube classes.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "gldb/gldb.h"
+#include "database/database.h"
+
+using namespace gldb;
+using namespace genleg;
+
+/*
+ *  Returns a temporary file name for a cube.
+ */
+
+static std::string cube_file_name() {
+    namespace fs = boost::filesystem;
+    return (fs::temp_directory_path() /
+            fs::unique_path("gl_cube_test_%%%%-%%%%.glc")).string();
+}
+
+/*
+ *  Writes a small sample cube, with entity 2 a child of entity 1, for
+ *  year 2014 period 2 of 12.
+ */
+
+static void write_sample_cube(const std::string& filename) {
+    GLCubeBuilder builder{GLStandingData{"Apollo Group", 2, 2014, 12, 7}};
+    builder.add_entity(1, "Apollo Group", 1);
+    builder.add_entity(2, "Apollo Retail", 1);
+    builder.add_entity(3, "Zeus Holdings", 3);
+    builder.add_account("1000", "Cash");
+    builder.add_account("2000", "Payables");
+    builder.add_account("4000", "Sales");
+
+    builder.add_balance(1, "1000", 2013, 12, "100.00");
+    builder.add_balance(1, "4000", 2013, 12, "-100.00");
+    builder.add_balance(1, "1000", 2014, 1, "50.5");
+    builder.add_balance(1, "2000", 2014, 1, "-50.50");
+    builder.add_balance(1, "1000", 2014, 2, "-0.25");
+    builder.add_balance(1, "2000", 2014, 2, "0.25");
+    builder.add_balance(2, "1000", 2014, 2, "10.00");
+    builder.add_balance(2, "4000", 2014, 2, "-10.00");
+    builder.add_balance(3, "1000", 2014, 2, "3.00");
+    builder.add_balance(3, "1000", 2014, 2, "-3.00");
+    builder.write(filename);
+}
+
+/*
+ *  Returns a report table as CSV.
+ */
+
+static std::string csv(const GLReport& report) {
+    std::ostringstream ss;
+    CSVTableWriter writer;
+    report.write(ss, writer);
+    return ss.str();
+}
+
+BOOST_AUTO_TEST_SUITE(cube_suite)
+
+BOOST_AUTO_TEST_CASE(test_cube_trial_balance) {
+    const std::string filename = cube_file_name();
+    write_sample_cube(filename);
+    {
+        const GLCube cube{filename};
+        BOOST_CHECK_EQUAL(cube.ledger_version(), 7);
+        BOOST_CHECK_EQUAL(cube.num_cells(), 9);
+
+        BOOST_CHECK_EQUAL(csv(cube.report("currenttb")),
+                "Entity,A/C No.,Description,Balance\n"
+                "1,1000,Cash,150.25\n"
+                "1,2000,Payables,-50.25\n"
+                "1,4000,Sales,-100.00\n"
+                "2,1000,Cash,10.00\n"
+                "2,4000,Sales,-10.00\n"
+                "3,1000,Cash,0.00\n");
+
+        BOOST_CHECK_EQUAL(csv(cube.report("currenttb", "2")),
+                "Entity,A/C No.,Description,Balance\n"
+                "2,1000,Cash,10.00\n"
+                "2,4000,Sales,-10.00\n");
+
+        BOOST_CHECK_EQUAL(csv(cube.report("currenttb",
+                        "entity=1,3;from=1000;to=2000;nonzero=yes")),
+                "Entity,A/C No.,Description,Balance\n"
+                "1,1000,Cash,150.25\n"
+                "1,2000,Payables,-50.25\n");
+
+        BOOST_CHECK_EQUAL(csv(cube.report("currenttb", "top=2")),
+                "Entity,A/C No.,Description,Balance\n"
+                "1,1000,Cash,150.25\n"
+                "1,4000,Sales,-100.00\n");
+
+        BOOST_CHECK_EQUAL(csv(cube.report("currenttb", "threshold=50.25")),
+                "Entity,A/C No.,Description,Balance\n"
+                "1,1000,Cash,150.25\n"
+                "1,2000,Payables,-50.25\n"
+                "1,4000,Sales,-100.00\n");
+
+        BOOST_CHECK_THROW(cube.report("currenttb", "9"), GLDBException);
+        BOOST_CHECK_THROW(cube.report("listusers"), GLDBException);
+    }
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(test_cube_rollup) {
+    const std::string filename = cube_file_name();
+    write_sample_cube(filename);
+    {
+        const GLCube cube{filename};
+        BOOST_CHECK_EQUAL(csv(cube.report("rollup", "1")),
+                "A/C No.,Description,Balance\n"
+                "1000,Cash,160.25\n"
+                "2000,Payables,-50.25\n"
+                "4000,Sales,-110.00\n");
+
+        BOOST_CHECK_EQUAL(csv(cube.report("rollup", "3")),
+                "A/C No.,Description,Balance\n"
+                "1000,Cash,0.00\n");
+
+        BOOST_CHECK_EQUAL(csv(cube.report("rollup", "nonzero=yes")),
+                "A/C No.,Description,Balance\n"
+                "1000,Cash,160.25\n"
+                "2000,Payables,-50.25\n"
+                "4000,Sales,-110.00\n");
+    }
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(test_cube_comparative) {
+    const std::string filename = cube_file_name();
+    write_sample_cube(filename);
+    {
+        const GLCube cube{filename};
+        BOOST_CHECK_EQUAL(csv(cube.report("comparetb", "entity=1")),
+                "Entity,A/C No.,Description,2014 P2,2014 P1,2013 P2,"
+                "2014 YTD P2\n"
+                "1,1000,Cash,-0.25,50.50,0.00,50.25\n"
+                "1,2000,Payables,0.25,-50.50,0.00,-50.25\n"
+                "1,4000,Sales,0.00,0.00,0.00,0.00\n");
+
+        BOOST_CHECK_EQUAL(csv(cube.report("comparetb",
+                        "columns=current,prior;year=2014;period=1")),
+                "Entity,A/C No.,Description,2014 P1,2013 P12\n"
+                "1,1000,Cash,50.50,100.00\n"
+                "1,2000,Payables,-50.50,0.00\n"
+                "1,4000,Sales,0.00,-100.00\n"
+                "2,1000,Cash,0.00,0.00\n"
+                "2,4000,Sales,0.00,0.00\n"
+                "3,1000,Cash,0.00,0.00\n");
+
+        BOOST_CHECK_THROW(cube.report("comparetb", "period=13"),
+                          GLDBException);
+    }
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(test_cube_bad_file) {
+    const std::string filename = cube_file_name();
+    BOOST_CHECK_THROW(GLCube{filename}, GLDBException);
+
+    {
+        std::ofstream ofs{filename};
+        ofs << "not a balance cube, but long enough to hold a header\n";
+    }
+    BOOST_CHECK_THROW(GLCube{filename}, GLDBException);
+    boost::filesystem::remove(filename);
+
+    GLCubeBuilder builder{GLStandingData{"Apollo Group", 1, 2014, 12}};
+    BOOST_CHECK_THROW(builder.add_balance(1, "1000", 2014, 1, "1.234"),
+                      GLDBException);
+    BOOST_CHECK_THROW(builder.add_balance(1, "1000", 2014, 1, "abc"),
+                      GLDBException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
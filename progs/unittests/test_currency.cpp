@@ -366,6 +366,20 @@ BOOST_AUTO_TEST_CASE(test_currency_from_string_4) {
     BOOST_CHECK_EQUAL(c.frac_part(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(test_currency_from_string_5) {
+    BOOST_CHECK_EQUAL(currency_from_string("12.5").cents(), 1250);
+    BOOST_CHECK_EQUAL(currency_from_string("-12.05").cents(), -1205);
+    BOOST_CHECK_EQUAL(currency_from_string("-0.50").cents(), -50);
+}
+
+BOOST_AUTO_TEST_CASE(test_currency_string) {
+    BOOST_CHECK_EQUAL(Currency::from_cents(1205).string(), "12.05");
+    BOOST_CHECK_EQUAL(Currency::from_cents(-1205).string(), "-12.05");
+    BOOST_CHECK_EQUAL(Currency::from_cents(-50).string(), "-0.50");
+    BOOST_CHECK_EQUAL(Currency::from_cents(100000000).string(),
+                      "1000000.00");
+}
+
 BOOST_AUTO_TEST_CASE(test_currency_from_string_except_1) {
     const std::string s{"-123.102"};
     BOOST_CHECK_THROW(currency_from_string(s), CurrencyException);
@@ -401,5 +415,17 @@ BOOST_AUTO_TEST_CASE(test_currency_from_string_except_7) {
     BOOST_CHECK_THROW(currency_from_string(s), CurrencyException);
 }
 
+BOOST_AUTO_TEST_CASE(test_currency_cents_round_trip) {
+    Currency c1{1000, 15};
+    BOOST_CHECK_EQUAL(c1.cents(), 100015);
+    BOOST_CHECK(Currency::from_cents(100015) == c1);
+
+    Currency c2{-2500, 50};
+    BOOST_CHECK_EQUAL(c2.cents(), -250050);
+    BOOST_CHECK(Currency::from_cents(-250050) == c2);
+
+    BOOST_CHECK(Currency::from_cents(0) == Currency{});
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
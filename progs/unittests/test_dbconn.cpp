@@ -0,0 +1,180 @@
+/*
+ *  test_dbconn.cpp
+ *  ===============
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Unit tests for database connection class.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <future>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "database/database.h"
+
+using namespace gldb;
+
+/*
+ *  Connection implementation which records its statements, taking a
+ *  little time over each, and fails any statement containing "FAIL".
+ */
+
+class RecordingConn : public DBConnImp {
+    public:
+        explicit RecordingConn(std::vector<std::string>& log) :
+            m_log(log) {}
+
+        virtual void query(const std::string& sql_query) {
+            run(sql_query);
+        }
+
+        virtual Table select(const std::string& query) {
+            run(query);
+            Table table{TableRow{"query", "thread"}};
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            table.append_record(TableRow{query, ss.str()});
+            return table;
+        }
+
+        virtual void begin_transaction() { run("BEGIN"); }
+        virtual void rollback_transaction() { run("ROLLBACK"); }
+        virtual void commit_transaction() { run("COMMIT"); }
+        virtual unsigned long long last_auto_increment() {
+            return m_log.size();
+        }
+
+    private:
+        std::vector<std::string>& m_log;
+
+        void run(const std::string& sql) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            if ( sql.find("FAIL") != std::string::npos ) {
+                throw DBConnCouldNotQuery("Failed: " + sql);
+            }
+            m_log.push_back(sql);
+        }
+};
+
+BOOST_AUTO_TEST_SUITE(dbconn_suite)
+
+BOOST_AUTO_TEST_CASE(test_dbconn_async_order) {
+    std::vector<std::string> log;
+    {
+        DBConn conn{new RecordingConn(log)};
+        conn.query("ONE");
+
+        std::future<Table> two = conn.select_async("TWO");
+        std::future<void> three = conn.query_async("THREE");
+        conn.begin_transaction();
+        std::future<void> four = conn.query_async("FOUR");
+        conn.commit_transaction();
+        BOOST_CHECK_EQUAL(conn.last_auto_increment(), 6);
+
+        /*  The commit was queued behind the insert  */
+
+        BOOST_CHECK(four.wait_for(std::chrono::seconds(0)) ==
+                    std::future_status::ready);
+
+        Table result = two.get();
+        BOOST_CHECK_EQUAL(result.get_field("query", 0), "TWO");
+        std::ostringstream ss;
+        ss << std::this_thread::get_id();
+        BOOST_CHECK(result.get_field("thread", 0) != ss.str());
+
+        conn.query_async("FIVE");
+    }
+
+    /*  Destroying the connection finishes the queued statements  */
+
+    const std::vector<std::string> expected{
+        "ONE", "TWO", "THREE", "BEGIN", "FOUR", "COMMIT", "FIVE"
+    };
+    BOOST_CHECK(log == expected);
+}
+
+BOOST_AUTO_TEST_CASE(test_dbconn_async_exceptions) {
+    std::vector<std::string> log;
+    DBConn conn{new RecordingConn(log)};
+
+    std::future<Table> bad = conn.select_async("FAIL ONE");
+    std::future<void> good = conn.query_async("TWO");
+    BOOST_CHECK_THROW(bad.get(), DBConnCouldNotQuery);
+    BOOST_CHECK_NO_THROW(good.get());
+
+    BOOST_CHECK_THROW(conn.query("FAIL THREE"), DBConnCouldNotQuery);
+    BOOST_CHECK_EQUAL(conn.select("FOUR").get_field("query", 0), "FOUR");
+}
+
+BOOST_AUTO_TEST_CASE(test_dbconn_async_threads) {
+    std::vector<std::string> log;
+    DBConn conn{new RecordingConn(log)};
+
+    /*  Several threads queueing at once share one I/O thread  */
+
+    std::vector<std::future<Table>> results(12);
+    std::vector<std::thread> threads;
+    for ( size_t t = 0; t < 3; ++t ) {
+        threads.emplace_back([&conn, &results, t]() {
+            for ( size_t i = t; i < results.size(); i += 3 ) {
+                results[i] = conn.select_async("Q" + std::to_string(i));
+            }
+        });
+    }
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+    for ( size_t i = 0; i < results.size(); ++i ) {
+        BOOST_CHECK_EQUAL(results[i].get().get_field("query", 0),
+                          "Q" + std::to_string(i));
+    }
+    BOOST_CHECK_EQUAL(log.size(), results.size());
+
+    /*  The I/O thread stops once its queue is empty, after which
+     *  synchronous statements run on the calling thread again        */
+
+    std::ostringstream ss;
+    ss << std::this_thread::get_id();
+    std::string thread_id;
+    for ( int tries = 0; tries < 100 && thread_id != ss.str(); ++tries ) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        thread_id = conn.select("SYNC").get_field("thread", 0);
+    }
+    BOOST_CHECK_EQUAL(thread_id, ss.str());
+
+    BOOST_CHECK_EQUAL(conn.select_async("AGAIN").get().get_field("query", 0),
+                      "AGAIN");
+}
+
+BOOST_AUTO_TEST_CASE(test_dbconn_batch) {
+    std::vector<std::string> log;
+    DBConn conn{new RecordingConn(log)};
+
+    conn.query_batch({"ONE", "TWO"});
+    try {
+        conn.query_batch({"THREE", "FOUR", "FAIL FIVE", "SIX"});
+        BOOST_ERROR("Batch did not fail");
+    }
+    catch ( const DBConnBatchFailed& e ) {
+        BOOST_CHECK_EQUAL(e.index(), 2);
+        BOOST_CHECK_EQUAL(e.what(), std::string{"Failed: FAIL FIVE"});
+    }
+
+    const std::vector<std::string> expected{"ONE", "TWO", "THREE", "FOUR"};
+    BOOST_CHECK(log == expected);
+
+    BOOST_CHECK_THROW(conn.query_batch({"FAIL SEVEN"}), DBConnCouldNotQuery);
+    BOOST_CHECK_NO_THROW(conn.query_batch({}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+/*
+ *  test_dbsql.cpp
+ *  ==============
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *  
+ *  Unit tests for SQL statement generation.
+ *
+ *  Uses Boost unit testing framework.
+ *  
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include "dbsql/dbsql.h"
+
+using namespace genleg;
+
+/*
+ *  Checks if a string contains a substring.
+ */
+
+static bool contains(const std::string& s, const std::string& sub) {
+    return s.find(sub) != std::string::npos;
+}
+
+BOOST_AUTO_TEST_SUITE(dbsql_suite)
+
+BOOST_AUTO_TEST_CASE(test_currenttb_filtered_none) {
+    DBSQLStatements sql;
+    TBFilter filter{{}, "", "", "", false, 0};
+    const std::string q = sql.currenttb_filtered(filter);
+    BOOST_CHECK(!contains(q, "WHERE"));
+    BOOST_CHECK(!contains(q, "HAVING"));
+    BOOST_CHECK(!contains(q, "LIMIT"));
+    BOOST_CHECK(contains(q, "ORDER BY j.entity ASC, a.num ASC"));
+}
+
+BOOST_AUTO_TEST_CASE(test_currenttb_filtered_all) {
+    DBSQLStatements sql;
+    TBFilter filter{{"1", "3"}, "1000", "1999", "500.00", true, 10};
+    const std::string q = sql.currenttb_filtered(filter);
+    BOOST_CHECK(contains(q, "WHERE j.entity IN (1, 3)"));
+    BOOST_CHECK(contains(q, "AND l.account >= '1000'"));
+    BOOST_CHECK(contains(q, "AND l.account <= '1999'"));
+    BOOST_CHECK(contains(q, "HAVING sum(l.amount) <> 0"));
+    BOOST_CHECK(contains(q, "AND abs(sum(l.amount)) >= 500.00"));
+    BOOST_CHECK(contains(q, "ORDER BY abs(sum(l.amount)) DESC"));
+    BOOST_CHECK(contains(q, "LIMIT 10"));
+    BOOST_CHECK(q.find("WHERE") < q.find("GROUP BY"));
+    BOOST_CHECK(q.find("GROUP BY") < q.find("HAVING"));
+}
+
+BOOST_AUTO_TEST_CASE(test_comparativetb) {
+    DBSQLStatements sql;
+    const std::vector<TBColumn> columns{{"2014 P6", 2014, 6, 6},
+                                        {"2013 P6", 2013, 6, 6},
+                                        {"2014 YTD P6", 2014, 1, 6}};
+    const std::string q = sql.comparativetb(columns, "2");
+    BOOST_CHECK(contains(q, "j.year = 2014 AND j.period BETWEEN 1 AND 6"));
+    BOOST_CHECK(contains(q, "AS '2013 P6'"));
+    BOOST_CHECK(contains(q, "WHERE j.year BETWEEN 2013 AND 2014"));
+    BOOST_CHECK(contains(q, "AND j.entity = 2"));
+}
+
+BOOST_AUTO_TEST_CASE(test_schema_registry) {
+    static_assert(schema_def(SchemaTable::jelines).depends &
+                  schema_bit(SchemaTable::jes),
+                  "Journal entry lines reference journal entries");
+
+    DBSQLStatements sql;
+    BOOST_CHECK(contains(sql.create_table(SchemaTable::users),
+                         "CREATE TABLE users ("));
+    BOOST_CHECK_EQUAL(sql.drop_table(SchemaTable::jelines),
+                      "DROP TABLE jelines");
+    BOOST_CHECK(contains(sql.create_view(SchemaView::check_total),
+                         "    sum(Balance) AS 'Check Total'"));
+    BOOST_CHECK_EQUAL(sql.drop_index(SchemaIndex::jelines_je_account_idx),
+                      "DROP INDEX jelines_je_account_idx ON jelines");
+    BOOST_CHECK(contains(sql.create_partitioned_table(SchemaTable::jes,
+                                                      2013, 2014),
+                         "PRIMARY KEY (id, year)) PARTITION BY RANGE"));
+    BOOST_CHECK_EQUAL(sql.create_partitioned_table(SchemaTable::users,
+                                                   2013, 2014),
+                      sql.create_table(SchemaTable::users));
+
+    /*  Every table is created after the tables it references  */
+
+    for ( size_t i = 0; i < num_schema_tables; ++i ) {
+        const std::string ddl = sql.create_table(schema_tables[i].id);
+        for ( size_t j = i + 1; j < num_schema_tables; ++j ) {
+            const std::string ref =
+                std::string{"REFERENCES "} + schema_tables[j].name + "(";
+            BOOST_CHECK(!contains(ddl, ref));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
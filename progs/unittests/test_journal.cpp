@@ -79,5 +79,25 @@ BOOST_AUTO_TEST_CASE(je_create_from_file) {
     BOOST_CHECK(j[2].amount() == c3);
 }
 
+BOOST_AUTO_TEST_CASE(je_lines_interned) {
+    GLJournal j{1, 6, 2014, "MANUAL", "Test journal entry"};
+    for ( int i = 0; i < 20; ++i ) {
+        j.add_line("1000", Currency{10, 50});
+        j.add_line("2000", Currency{-10, 50});
+    }
+    BOOST_CHECK_EQUAL(j.num_lines(), 40);
+    BOOST_CHECK(j.balances());
+
+    BOOST_CHECK_EQUAL(j[0].account_id(), j[38].account_id());
+    BOOST_CHECK(j[0].account_id() != j[1].account_id());
+    BOOST_CHECK_EQUAL(j[39].account(), std::string{"2000"});
+    BOOST_CHECK_EQUAL(j.lines()[2].cents(), 1050);
+    BOOST_CHECK(j[1].amount() == (Currency{-10, 50}));
+
+    j.add_line(account_symbols().intern("3000"), 1);
+    BOOST_CHECK_EQUAL(j[40].account(), std::string{"3000"});
+    BOOST_CHECK(!j.balances());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
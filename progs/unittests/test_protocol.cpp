@@ -0,0 +1,107 @@
+/*
+ *  test_protocol.cpp
+ *  =================
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Unit tests for the general ledger server protocol.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "gldb/gldb.h"
+
+using namespace genleg;
+
+BOOST_AUTO_TEST_SUITE(protocol_suite)
+
+BOOST_AUTO_TEST_CASE(test_protocol_messages) {
+    const GLRequest request{GLRequestType::report,
+                            {"je", std::string("a\0b", 3), ""}};
+    const GLRequest decoded = decode_request(encode_request(request));
+    BOOST_CHECK(decoded.type == GLRequestType::report);
+    BOOST_CHECK(decoded.args == request.args);
+
+    const GLResponse response = decode_response(encode_response(
+                GLResponse{GLResponseStatus::error, "No such report"}));
+    BOOST_CHECK(response.status == GLResponseStatus::error);
+    BOOST_CHECK_EQUAL(response.body, "No such report");
+
+    const std::string payload = encode_request(request);
+    BOOST_CHECK_THROW(decode_request(""), GLProtocolException);
+    BOOST_CHECK_THROW(decode_request(std::string(1, '\x7f') +
+                                     payload.substr(1)),
+                      GLProtocolException);
+    BOOST_CHECK_THROW(decode_request(payload.substr(0, payload.size() - 1)),
+                      GLProtocolException);
+    BOOST_CHECK_THROW(decode_request(payload + "x"), GLProtocolException);
+}
+
+BOOST_AUTO_TEST_CASE(test_protocol_user_and_journal) {
+    const GLUser user{"7", "jsmith", "John", "Smith", "hash", "salt",
+                      {"post", "report"}, true};
+    const GLUser copy = user_from_strings(user_to_strings(user));
+    BOOST_CHECK_EQUAL(copy.id(), "7");
+    BOOST_CHECK_EQUAL(copy.username(), "jsmith");
+    BOOST_CHECK_EQUAL(copy.pass_salt(), "salt");
+    BOOST_CHECK(copy.enabled());
+    BOOST_CHECK(copy.permissions() == user.permissions());
+
+    GLJournal journal{1, 4, 2014, "MANUAL", "Test journal entry"};
+    journal.add_line("1000", pgutils::Currency{1000, 15});
+    journal.add_line("3000", pgutils::Currency{-1000, 15});
+    const GLJournal je = journal_from_strings(journal_to_strings(journal));
+    BOOST_CHECK_EQUAL(je.entity(), 1u);
+    BOOST_CHECK_EQUAL(je.period(), 4);
+    BOOST_CHECK_EQUAL(je.year(), 2014);
+    BOOST_CHECK_EQUAL(je.memo(), "Test journal entry");
+    BOOST_REQUIRE_EQUAL(je.num_lines(), 2u);
+    BOOST_CHECK_EQUAL(je[1].account(), "3000");
+    BOOST_CHECK_EQUAL(je[1].cents(), -100015);
+
+    std::vector<std::string> bad = journal_to_strings(journal);
+    bad.back() = "12x";
+    BOOST_CHECK_THROW(journal_from_strings(bad), GLProtocolException);
+    bad.pop_back();
+    BOOST_CHECK_THROW(journal_from_strings(bad), GLProtocolException);
+
+    /*  Accounts from a client are never added to the symbol table  */
+
+    const size_t symbols = account_symbols().size();
+    bad = journal_to_strings(journal);
+    bad[bad.size() - 2] = "not an interned account";
+    BOOST_CHECK_THROW(journal_from_strings(bad), GLProtocolException);
+    BOOST_CHECK_EQUAL(account_symbols().size(), symbols);
+}
+
+BOOST_AUTO_TEST_CASE(test_protocol_frames) {
+    int fds[2];
+    BOOST_REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    write_frame(fds[0], "hello");
+    write_frame(fds[0], "");
+    std::string payload;
+    BOOST_CHECK(read_frame(fds[1], payload));
+    BOOST_CHECK_EQUAL(payload, "hello");
+    BOOST_CHECK(read_frame(fds[1], payload));
+    BOOST_CHECK(payload.empty());
+
+    const char partial[] = {0, 0, 0, 9, 'a', 'b'};
+    BOOST_REQUIRE(::write(fds[0], partial, sizeof(partial)) ==
+                  static_cast<ssize_t>(sizeof(partial)));
+    ::close(fds[0]);
+    BOOST_CHECK_THROW(read_frame(fds[1], payload), GLProtocolException);
+    BOOST_CHECK(!read_frame(fds[1], payload));
+    ::close(fds[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
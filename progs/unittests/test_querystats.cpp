@@ -0,0 +1,159 @@
+/*
+ *  test_querystats.cpp
+ *  ===================
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Unit tests for query statistics classes.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "database/database.h"
+
+using namespace gldb;
+
+/*
+ *  Connection implementation which returns one row for any query, and
+ *  reports a fixed result size.
+ */
+
+class SizedConn : public DBConnImp {
+    public:
+        virtual void query(const std::string&) {}
+
+        virtual Table select(const std::string& query) {
+            Table table{TableRow{"query"}};
+            table.append_record(TableRow{query});
+            return table;
+        }
+
+        virtual unsigned long long last_result_bytes() const { return 42; }
+
+        virtual void begin_transaction() {}
+        virtual void rollback_transaction() {}
+        virtual void commit_transaction() {}
+        virtual unsigned long long last_auto_increment() { return 0; }
+};
+
+BOOST_AUTO_TEST_SUITE(querystats_suite)
+
+BOOST_AUTO_TEST_CASE(test_histogram_buckets) {
+    for ( uint64_t v = 0; v < 32; ++v ) {
+        BOOST_CHECK_EQUAL(LatencyHistogram::bucket(v), v);
+    }
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucket(32), 32);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucket(33), 32);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucket(34), 33);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucket_high(32), 33);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucket(~uint64_t{0}),
+                      LatencyHistogram::num_buckets - 1);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucket_high(
+                          LatencyHistogram::num_buckets - 1),
+                      ~uint64_t{0});
+
+    /*  Every value is within 1/16 of the top of its bucket  */
+
+    for ( uint64_t v = 1; v < 10000000; v = v * 3 + 1 ) {
+        const uint64_t high =
+            LatencyHistogram::bucket_high(LatencyHistogram::bucket(v));
+        BOOST_CHECK(high >= v);
+        BOOST_CHECK(high - v <= v / 16);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_histogram_percentiles) {
+    LatencyHistogram hist;
+    BOOST_CHECK_EQUAL(hist.percentile(50), 0);
+
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < 4; ++t ) {
+        threads.emplace_back([&hist]() {
+            for ( uint64_t v = 1; v <= 250; ++v ) {
+                hist.record(v * 4);
+            }
+        });
+    }
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(hist.count(), 1000);
+    BOOST_CHECK_EQUAL(hist.max(), 1000);
+    BOOST_CHECK_EQUAL(hist.total(), 4 * 4 * 250 * 251 / 2);
+    BOOST_CHECK(hist.percentile(50) >= 500 && hist.percentile(50) <= 531);
+    BOOST_CHECK(hist.percentile(99) >= 988 && hist.percentile(99) <= 1000);
+    BOOST_CHECK_EQUAL(hist.percentile(100), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(test_query_classify) {
+    BOOST_CHECK_EQUAL(QueryStats::classify("SELECT * FROM jes WHERE id = 1"),
+                      "select jes");
+    BOOST_CHECK_EQUAL(QueryStats::classify(
+                "SELECT 'from x' AS a FROM users AS u"), "select users");
+    BOOST_CHECK_EQUAL(QueryStats::classify(
+                "INSERT INTO jelines (je) VALUES (1)"), "insert jelines");
+    BOOST_CHECK_EQUAL(QueryStats::classify("UPDATE standing_data SET x=1"),
+                      "update standing_data");
+    BOOST_CHECK_EQUAL(QueryStats::classify("DROP VIEW IF EXISTS all_jes"),
+                      "drop view all_jes");
+    BOOST_CHECK_EQUAL(QueryStats::classify("  commit"), "commit");
+    BOOST_CHECK_EQUAL(QueryStats::classify(""), "empty");
+}
+
+BOOST_AUTO_TEST_CASE(test_query_stats_record) {
+    QueryStats& stats = QueryStats::instance();
+    std::ostringstream log;
+    stats.set_slow_query_log(&log, 5000);
+
+    stats.record("SELECT a, b FROM test_stats_table", 10, 1, 3, false);
+    stats.record("SELECT a, b FROM test_stats_table", 7000, 0, 0, true);
+    stats.set_slow_query_log(nullptr, 0);
+
+    const StatementStats * found = stats.find("select test_stats_table");
+    BOOST_REQUIRE(found != nullptr);
+    BOOST_CHECK_EQUAL(found->latency.count(), 2);
+    BOOST_CHECK_EQUAL(found->errors.load(), 1);
+    BOOST_CHECK_EQUAL(found->rows.load(), 1);
+    BOOST_CHECK_EQUAL(found->bytes.load(), 3);
+
+    BOOST_CHECK_EQUAL(log.str(), "Slow query: select test_stats_table: "
+            "7.0 ms (failed): SELECT a, b FROM test_stats_table\n");
+    BOOST_CHECK(stats.table().has_field("p99"));
+}
+
+BOOST_AUTO_TEST_CASE(test_query_stats_only_when_enabled) {
+    QueryStats& stats = QueryStats::instance();
+    DBConn dbc{new SizedConn};
+
+    dbc.select("SELECT query FROM test_stats_gate");
+    BOOST_CHECK(stats.find("select test_stats_gate") == nullptr);
+
+    /*  Setting a slow query log enables recording  */
+
+    std::ostringstream log;
+    stats.set_slow_query_log(&log, 60000000);
+    dbc.select("SELECT query FROM test_stats_gate");
+    dbc.query_batch({"INSERT INTO test_stats_gate VALUES (1)",
+                     "INSERT INTO test_stats_gate VALUES (2)"});
+    stats.set_slow_query_log(nullptr, 0);
+
+    const StatementStats * found = stats.find("select test_stats_gate");
+    BOOST_REQUIRE(found != nullptr);
+    BOOST_CHECK_EQUAL(found->latency.count(), 1);
+    BOOST_CHECK_EQUAL(found->rows.load(), 1);
+    BOOST_CHECK_EQUAL(found->bytes.load(), 42);
+    BOOST_CHECK(stats.find("batch insert test_stats_gate") != nullptr);
+    BOOST_CHECK(log.str().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
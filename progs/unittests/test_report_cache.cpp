@@ -0,0 +1,130 @@
+/*
+ *  test_report_cache.cpp
+ *  =====================
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *  
+ *  Unit tests for report saving and report cache class.
+ *
+ *  Uses Boost unit testing framework.
+ *  
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "gldb/gldb.h"
+#include "database/database.h"
+
+using namespace gldb;
+using namespace genleg;
+
+/*
+ *  Returns a small sample table report.
+ */
+
+static GLReport sample_report() {
+    Table table{TableRow{"Account", "Amount"}};
+    table.append_record(TableRow{"1000", "12.50"});
+    table.append_record(TableRow{"2000", "-12.50"});
+    GLReport report{"Sample Report", std::move(table)};
+    report.add_header("Entity", "Apollo Group [1]");
+    return report;
+}
+
+/*
+ *  Returns the printed form of a report.
+ */
+
+static std::string printed(const GLReport& report) {
+    std::ostringstream ss;
+    ss << report;
+    return ss.str();
+}
+
+BOOST_AUTO_TEST_SUITE(report_cache_suite)
+
+BOOST_AUTO_TEST_CASE(test_report_save_load) {
+    const GLReport table_report = sample_report();
+    std::stringstream ts;
+    table_report.save(ts);
+    BOOST_CHECK_EQUAL(printed(GLReport::load(ts)), printed(table_report));
+
+    GLReport text_report{"Text Report", ""};
+    text_report.add_header("Organization", "Apollo Group");
+    std::stringstream xs;
+    text_report.save(xs);
+    BOOST_CHECK_EQUAL(printed(GLReport::load(xs)), printed(text_report));
+
+    std::stringstream bad{"not a report"};
+    BOOST_CHECK_THROW(GLReport::load(bad), GLDBException);
+
+    /*  A corrupt title length fails at the end of the input  */
+
+    std::string huge = ts.str().substr(0, 8);
+    huge += std::string(7, '\xff') + '\x7f';
+    huge += "short";
+    std::stringstream hs{huge};
+    BOOST_CHECK_THROW(GLReport::load(hs), GLDBException);
+}
+
+BOOST_AUTO_TEST_CASE(test_report_cache_memory) {
+    GLReportCache cache;
+    BOOST_CHECK(!cache.find("currenttb", "", 1));
+
+    cache.store("currenttb", "", 1, sample_report());
+    cache.store("currenttb", "2", 1, sample_report());
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+
+    auto found = cache.find("currenttb", "", 1);
+    BOOST_CHECK(found);
+    BOOST_CHECK_EQUAL(printed(*found), printed(sample_report()));
+    BOOST_CHECK(!cache.find("currenttb", "3", 1));
+
+    BOOST_CHECK(!cache.find("currenttb", "", 2));
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_report_cache_disk) {
+    namespace fs = boost::filesystem;
+    const fs::path dir = fs::temp_directory_path() /
+                         fs::unique_path("gl_cache_test_%%%%-%%%%");
+
+    {
+        GLReportCache writer{dir.string()};
+        writer.store("je", "17", 5, sample_report());
+
+        GLReportCache reader{dir.string()};
+        auto found = reader.find("je", "17", 5);
+        BOOST_CHECK(found);
+        if ( found ) {
+            BOOST_CHECK_EQUAL(printed(*found), printed(sample_report()));
+        }
+        BOOST_CHECK(!reader.find("je", "17", 6));
+
+        writer.store("je", "17", 6, sample_report());
+        GLReportCache late_reader{dir.string()};
+        BOOST_CHECK(!late_reader.find("je", "17", 5));
+        BOOST_CHECK(late_reader.find("je", "17", 6));
+
+        /*  A corrupt file is a miss, and is removed  */
+
+        for ( fs::directory_iterator itr{dir}, end; itr != end; ++itr ) {
+            std::ofstream ofs{itr->path().string(),
+                              std::ios::binary | std::ios::trunc};
+            ofs << "GLRPT1" << '\0' << '\0' << std::string(8, '\xff');
+        }
+        GLReportCache corrupt_reader{dir.string()};
+        BOOST_CHECK(!corrupt_reader.find("je", "17", 6));
+        BOOST_CHECK(fs::is_empty(dir));
+    }
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -14,6 +14,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <cstring>
+#include <limits>
+#include <sstream>
 #include "gldb/gldb.h"
 #include "database/database.h"
 
@@ -57,5 +60,151 @@ BOOST_AUTO_TEST_CASE(test_decorated_report) {
     BOOST_CHECK_EQUAL(test_report, control_report);
 }
 
+BOOST_AUTO_TEST_CASE(test_table_report_output) {
+    TableRow headers{"h1", "h2"};
+    Table table{headers};
+    table.append_record(TableRow{"a", "abc"});
+
+    GLReport report{"Title", std::move(table)};
+    report.add_header("Name", "Value");
+
+    std::ostringstream ss;
+    ss << report;
+    const std::string control_report{"Title\n"
+                                     "=====\n"
+                                     "Name: Value\n"
+                                     "\n"
+                                     "+----+-----+\n"
+                                     "| h1 | h2  |\n"
+                                     "+----+-----+\n"
+                                     "| a  | abc |\n"
+                                     "+----+-----+\n"};
+
+    BOOST_CHECK_EQUAL(ss.str(), control_report);
+}
+
+BOOST_AUTO_TEST_CASE(test_csv_output) {
+    Table table{TableRow{"Account", "Memo"}};
+    table.append_record(TableRow{"1000", "plain"});
+    table.append_record(TableRow{"2000", "has, comma"});
+    table.append_record(TableRow{"3000", "has \"quotes\""});
+
+    std::ostringstream ss;
+    CSVTableWriter{}.write(ss, table);
+    const std::string control{"Account,Memo\n"
+                              "1000,plain\n"
+                              "2000,\"has, comma\"\n"
+                              "3000,\"has \"\"quotes\"\"\"\n"};
+
+    BOOST_CHECK_EQUAL(ss.str(), control);
+}
+
+BOOST_AUTO_TEST_CASE(test_jsonl_output) {
+    Table table{TableRow{"Account", "Count", "Amount"}};
+    table.append_record(TableRow{"0100", "3", "12.50"});
+    table.append_record(TableRow{"0200", "-4", "-0.25"});
+
+    std::ostringstream ss;
+    JSONLinesTableWriter{}.write(ss, table);
+    const std::string control{
+        "{\"Account\":\"0100\",\"Count\":3,\"Amount\":12.50}\n"
+        "{\"Account\":\"0200\",\"Count\":-4,\"Amount\":-0.25}\n"};
+
+    BOOST_CHECK_EQUAL(ss.str(), control);
+}
+
+BOOST_AUTO_TEST_CASE(test_column_type_inference) {
+    Table table{TableRow{"a", "b", "c", "d", "e"}};
+    table.append_record(TableRow{"0100", "1", "1.00", "1.0", "0"});
+    table.append_record(TableRow{"0200", "-12", "-0.50", "2.00", "-0"});
+
+    const std::vector<ColumnInfo> columns = infer_column_types(table);
+    BOOST_CHECK(columns[0].type == ColumnType::text);
+    BOOST_CHECK(columns[1].type == ColumnType::integer);
+    BOOST_CHECK(columns[2].type == ColumnType::decimal);
+    BOOST_CHECK_EQUAL(columns[2].scale, 2);
+    BOOST_CHECK(columns[3].type == ColumnType::text);
+    BOOST_CHECK(columns[4].type == ColumnType::text);
+}
+
+BOOST_AUTO_TEST_CASE(test_columnar_round_trip) {
+    Table table{TableRow{"Account", "Count", "Amount"}};
+    table.append_record(TableRow{"0100", "3", "12.50"});
+    table.append_record(TableRow{"", "-4", "-0.25"});
+    table.append_record(TableRow{"Cash, petty", "0", "0.00"});
+
+    std::stringstream ss;
+    ColumnarTableWriter{}.write(ss, table);
+    BOOST_CHECK_EQUAL(ss.str().size() % 8, 0);
+
+    const Table read_table = read_columnar_table(ss);
+    BOOST_CHECK_EQUAL(read_table.num_records(), 3);
+    BOOST_CHECK_EQUAL(decorated_report_from_table(read_table),
+                      decorated_report_from_table(table));
+}
+
+BOOST_AUTO_TEST_CASE(test_columnar_bad_input) {
+    std::stringstream ss{"not a columnar file"};
+    BOOST_CHECK_THROW(read_columnar_table(ss), TableBadInputFile);
+    BOOST_CHECK_THROW(make_table_writer("xml"), TableException);
+
+    Table table{TableRow{"Account", "Amount"}};
+    table.append_record(TableRow{"Cash", "12.50"});
+    std::stringstream good;
+    ColumnarTableWriter{}.write(good, table);
+    const std::string file = good.str();
+
+    /*  A row count far beyond the input is refused before reserving  */
+
+    std::string huge{file};
+    const uint64_t rows = uint64_t{1} << 60;
+    std::memcpy(&huge[16], &rows, sizeof(rows));
+    std::stringstream huge_ss{huge};
+    BOOST_CHECK_THROW(read_columnar_table(huge_ss), TableBadInputFile);
+
+    for ( size_t length = 8; length < file.size(); length += 8 ) {
+        std::stringstream short_ss{file.substr(0, length)};
+        BOOST_CHECK_THROW(read_columnar_table(short_ss), TableBadInputFile);
+    }
+
+    /*  So is a scale wider than any stored number  */
+
+    std::string wide{file};
+    const uint32_t scale = 4000000000u;
+    std::memcpy(&wide[28], &scale, sizeof(scale));
+    std::stringstream wide_ss{wide};
+    BOOST_CHECK_THROW(read_columnar_table(wide_ss), TableBadInputFile);
+}
+
+BOOST_AUTO_TEST_CASE(test_columnar_extreme_values) {
+
+    /*  The most negative stored value is read without overflowing  */
+
+    Table table{TableRow{"Amount"}};
+    table.append_record(TableRow{"1.00"});
+    std::stringstream good;
+    ColumnarTableWriter{}.write(good, table);
+
+    std::string file = good.str();
+    const int64_t lowest = std::numeric_limits<int64_t>::min();
+    std::memcpy(&file[file.size() - 8], &lowest, sizeof(lowest));
+    std::stringstream ss{file};
+    const Table read_table = read_columnar_table(ss);
+    BOOST_REQUIRE_EQUAL(read_table.num_records(), 1);
+    BOOST_CHECK_EQUAL(read_table[0][0].str(), "-92233720368547758.08");
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_report_args) {
+    auto args = parse_report_args("entity=1; columns=current,ytd ;;year=2014");
+    BOOST_CHECK_EQUAL(args.size(), 3);
+    BOOST_CHECK_EQUAL(args["entity"], std::string{"1"});
+    BOOST_CHECK_EQUAL(args["columns"], std::string{"current,ytd"});
+    BOOST_CHECK_EQUAL(args["year"], std::string{"2014"});
+
+    BOOST_CHECK(parse_report_args("").empty());
+    BOOST_CHECK_THROW(parse_report_args("entity"), GLDBException);
+    BOOST_CHECK_THROW(parse_report_args("=1"), GLDBException);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
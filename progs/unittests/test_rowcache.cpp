@@ -0,0 +1,130 @@
+/*
+ *  test_rowcache.cpp
+ *  =================
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Unit tests for TPRowCache class.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include "pgcurses/pgcurses.h"
+
+using namespace pgcurses;
+
+namespace {
+
+/*  Row source of numbered rows which counts the calls made to it  */
+
+class CountingSource : public TPRowSource {
+    public:
+        explicit CountingSource(const size_t rows) :
+            fetches{0}, counts{0}, m_rows{rows} {}
+
+        virtual TPRow headers() { return TPRow{"n", "name"}; }
+
+        virtual size_t num_rows() {
+            ++counts;
+            return m_rows;
+        }
+
+        virtual std::vector<TPRow> fetch(const size_t first,
+                                         const size_t count) {
+            ++fetches;
+            std::vector<TPRow> rows;
+            for ( size_t i = first; i < first + count && i < m_rows; ++i ) {
+                rows.push_back(TPRow{std::to_string(i),
+                                     std::string(2 * (i % 7), 'x')});
+            }
+            return rows;
+        }
+
+        size_t fetches;
+        size_t counts;
+
+    private:
+        const size_t m_rows;
+};
+
+}           //  namespace
+
+BOOST_AUTO_TEST_SUITE(rowcache_suite)
+
+BOOST_AUTO_TEST_CASE(rowcache_fetches_pages_on_demand) {
+    CountingSource source{1000000};
+    TPRowCache cache{source, 10, 3, 20};
+
+    BOOST_CHECK_EQUAL(cache.num_rows(), 1000000u);
+    BOOST_CHECK_EQUAL(cache.num_rows(), 1000000u);
+    BOOST_CHECK_EQUAL(source.counts, 1u);
+    BOOST_CHECK_EQUAL(source.fetches, 0u);
+
+    BOOST_CHECK_EQUAL(cache.row(0)[0], "0");
+    BOOST_CHECK_EQUAL(cache.row(9)[0], "9");
+    BOOST_CHECK_EQUAL(cache.pages_fetched(), 1u);
+
+    BOOST_CHECK_EQUAL(cache.row(999995)[0], "999995");
+    BOOST_CHECK_EQUAL(cache.pages_fetched(), 2u);
+
+    BOOST_CHECK_THROW(cache.row(1000000), TPException);
+
+    cache.refresh();
+    BOOST_CHECK_EQUAL(cache.row(0)[0], "0");
+    BOOST_CHECK_EQUAL(cache.num_rows(), 1000000u);
+    BOOST_CHECK_EQUAL(source.counts, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(rowcache_evicts_furthest_page) {
+    CountingSource source{100};
+    TPRowCache cache{source, 10, 3, 20};
+
+    cache.row(0);
+    cache.row(10);
+    cache.row(20);
+    BOOST_CHECK_EQUAL(cache.pages_fetched(), 3u);
+
+    /*  Fetching page 3 drops page 0, so page 2 is still held  */
+
+    cache.row(30);
+    cache.row(20);
+    BOOST_CHECK_EQUAL(cache.pages_fetched(), 4u);
+    cache.row(0);
+    BOOST_CHECK_EQUAL(cache.pages_fetched(), 5u);
+
+    /*  Scrolling back up dropped page 3 and kept page 1  */
+
+    cache.row(10);
+    BOOST_CHECK_EQUAL(cache.pages_fetched(), 5u);
+    cache.row(30);
+    BOOST_CHECK_EQUAL(cache.pages_fetched(), 6u);
+}
+
+BOOST_AUTO_TEST_CASE(rowcache_samples_column_widths) {
+    CountingSource source{100};
+    TPRowCache cache{source, 4, 2, 5};
+
+    BOOST_CHECK_EQUAL(cache.headers().size(), 2u);
+    BOOST_CHECK_EQUAL(cache.column_widths()[0], 1u);
+    BOOST_CHECK_EQUAL(cache.column_widths()[1], 4u);
+
+    /*  Only rows 0 to 4 are sampled, so neither the wider names of rows
+     *  5 and 6 nor the wider numbers from row 10 count  */
+
+    cache.row(0);
+    cache.row(4);
+    cache.row(90);
+    BOOST_CHECK_EQUAL(cache.column_widths()[0], 1u);
+    BOOST_CHECK_EQUAL(cache.column_widths()[1], 8u);
+
+    BOOST_CHECK_THROW(TPRowCache(source, 0), TPException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
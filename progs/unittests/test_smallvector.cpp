@@ -0,0 +1,133 @@
+/*
+ *  test_smallvector.cpp
+ *  ====================
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *  
+ *  Unit tests for SmallVector class template and SymbolTable class.
+ *
+ *  Uses Boost unit testing framework.
+ *  
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <thread>
+#include <utility>
+#include "pgutils/pgutils.h"
+
+using namespace pgutils;
+
+BOOST_AUTO_TEST_SUITE(smallvector_suite)
+
+BOOST_AUTO_TEST_CASE(smallvector_inline) {
+    SmallVector<int, 4> v;
+    BOOST_CHECK(v.empty());
+    BOOST_CHECK_EQUAL(v.capacity(), 4);
+
+    for ( int i = 0; i < 4; ++i ) {
+        v.push_back(i * 10);
+    }
+    BOOST_CHECK_EQUAL(v.size(), 4);
+    BOOST_CHECK(v.is_inline());
+    BOOST_CHECK_EQUAL(v[0], 0);
+    BOOST_CHECK_EQUAL(v[3], 30);
+}
+
+BOOST_AUTO_TEST_CASE(smallvector_grow) {
+    SmallVector<int, 2> v;
+    for ( int i = 0; i < 100; ++i ) {
+        v.push_back(i);
+    }
+    BOOST_CHECK_EQUAL(v.size(), 100);
+    BOOST_CHECK(!v.is_inline());
+
+    int sum = 0;
+    for ( const auto& n : v ) {
+        sum += n;
+    }
+    BOOST_CHECK_EQUAL(sum, 4950);
+    BOOST_CHECK_EQUAL(v.data()[99], 99);
+}
+
+BOOST_AUTO_TEST_CASE(smallvector_copy_and_move) {
+    SmallVector<int, 2> small;
+    small.push_back(1);
+
+    SmallVector<int, 2> big;
+    for ( int i = 0; i < 10; ++i ) {
+        big.push_back(i);
+    }
+
+    SmallVector<int, 2> small_copy{small};
+    SmallVector<int, 2> big_copy{big};
+    BOOST_CHECK_EQUAL(small_copy.size(), 1);
+    BOOST_CHECK_EQUAL(small_copy[0], 1);
+    BOOST_CHECK_EQUAL(big_copy.size(), 10);
+    BOOST_CHECK_EQUAL(big_copy[9], 9);
+    BOOST_CHECK(big_copy.data() != big.data());
+
+    SmallVector<int, 2> moved{std::move(big)};
+    BOOST_CHECK_EQUAL(moved.size(), 10);
+    BOOST_CHECK_EQUAL(moved[5], 5);
+    BOOST_CHECK(big.empty());
+
+    moved = small;
+    BOOST_CHECK_EQUAL(moved.size(), 1);
+    BOOST_CHECK_EQUAL(moved[0], 1);
+
+    small_copy = std::move(big_copy);
+    BOOST_CHECK_EQUAL(small_copy.size(), 10);
+    BOOST_CHECK_EQUAL(small_copy[9], 9);
+}
+
+BOOST_AUTO_TEST_CASE(symboltable_intern) {
+    SymbolTable st;
+    const uint32_t a = st.intern("1000");
+    const uint32_t b = st.intern("2000");
+    BOOST_CHECK_EQUAL(a, 0);
+    BOOST_CHECK_EQUAL(b, 1);
+    BOOST_CHECK_EQUAL(st.intern("1000"), a);
+    BOOST_CHECK_EQUAL(st.size(), 2);
+    BOOST_CHECK_EQUAL(st.name(a), std::string{"1000"});
+    BOOST_CHECK_EQUAL(st.name(b), std::string{"2000"});
+    BOOST_CHECK_THROW(st.name(2), SymbolTableException);
+
+    uint32_t id = 99;
+    BOOST_CHECK(st.find("2000", id));
+    BOOST_CHECK_EQUAL(id, b);
+    BOOST_CHECK(!st.find("3000", id));
+    BOOST_CHECK_EQUAL(st.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(symboltable_read_while_interning) {
+    SymbolTable st;
+    const uint32_t count = 5000;
+
+    /*  Names looked up by ID while another thread interns more, across
+     *  several chunks, are always complete                             */
+
+    std::thread writer([&st, count]() {
+        for ( uint32_t i = 0; i < count; ++i ) {
+            st.intern(std::to_string(i));
+        }
+    });
+
+    bool all_match = true;
+    while ( st.size() < count ) {
+        const size_t n = st.size();
+        for ( size_t i = n > 100 ? n - 100 : 0; i < n; ++i ) {
+            all_match = all_match && st.name(i) == std::to_string(i);
+        }
+    }
+    writer.join();
+
+    BOOST_CHECK(all_match);
+    BOOST_CHECK_EQUAL(st.name(count - 1), std::to_string(count - 1));
+    BOOST_CHECK_THROW(st.name(count), SymbolTableException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,528 @@
+/*
+ *  test_sqlite.cpp
+ *  ===============
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Integration tests for the SQLite database backend. The tests do
+ *  nothing unless the application is built with database=sqlite.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "gldb/gldb.h"
+#include "database/database.h"
+#include "database_imp/backends.h"
+#include "pgutils/pgutils.h"
+
+using namespace gldb;
+using namespace genleg;
+using pgutils::Currency;
+
+/*
+ *  Removes a database file and its write-ahead log files.
+ */
+
+static void remove_database(const std::string& filename) {
+    boost::filesystem::remove(filename);
+    boost::filesystem::remove(filename + "-wal");
+    boost::filesystem::remove(filename + "-shm");
+}
+
+/*
+ *  Returns a report table as CSV.
+ */
+
+static std::string csv(const GLReport& report) {
+    std::ostringstream ss;
+    CSVTableWriter writer;
+    report.write(ss, writer);
+    return ss.str();
+}
+
+namespace {
+
+/*
+ *  Returns true if the application is built with the SQLite backend.
+ */
+
+bool sqlite_backend() {
+    return GLDatabase::backend() == "SQLite";
+}
+
+/*
+ *  Returns a unique path in the temporary directory.
+ */
+
+std::string temp_path(const std::string& model) {
+    namespace fs = boost::filesystem;
+    return (fs::temp_directory_path() / fs::unique_path(model)).string();
+}
+
+/*
+ *  Checks that journal entry 1 of the sample data shows its amounts with
+ *  two decimal places.
+ */
+
+void check_sample_je(const GLReport& report) {
+    BOOST_CHECK(csv(report).find("1000000.0\n") == std::string::npos);
+}
+
+/*
+ *  Temporary database file, removed with its write-ahead log files when
+ *  destroyed.
+ */
+
+struct TempDatabaseFile {
+    TempDatabaseFile() : name{temp_path("gl_sqlite_test_%%%%-%%%%.db")} {}
+    ~TempDatabaseFile() { remove_database(name); }
+    const std::string name;
+};
+
+/*
+ *  Fixture providing a new ledger database loaded with the sample data.
+ */
+
+struct SQLiteLedgerFixture {
+    SQLiteLedgerFixture() : file{}, db{file.name, "", "", ""} {
+        db.create_structure();
+        db.load_sample_data("sample_data");
+    }
+
+    TempDatabaseFile file;
+    GLDatabase db;
+};
+
+}           //  namespace
+
+/*  The suite is skipped unless built with database=sqlite  */
+
+BOOST_AUTO_TEST_SUITE(sqlite_suite,
+        * boost::unit_test::precondition([](boost::unit_test::test_unit_id) {
+            return sqlite_backend();
+        }))
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_sample_data, SQLiteLedgerFixture) {
+    const std::string tb = csv(db.report("currenttb", "1"));
+    BOOST_CHECK(tb.find("Entity,") == 0);
+    BOOST_CHECK(tb.find(".00") != std::string::npos);
+
+    check_sample_je(db.report("je", "1"));
+
+    GLJournal posted{1, 2, 2014, "SAMPLE", "Batch test"};
+    posted.add_line("10003000", Currency{12, 50});
+    posted.add_line("10001000", Currency{-12, 50});
+    db.post_journal(posted);
+
+    GLJournal bad{1, 2, 2014, "SAMPLE", "Bad account"};
+    bad.add_line("10003000", Currency{1, 0});
+    bad.add_line("99999999", Currency{-1, 0});
+    BOOST_CHECK_EXCEPTION(db.post_journal(bad), GLDBException,
+            [](const GLDBException& e) {
+                return std::string{e.what()}.find("line 2") !=
+                       std::string::npos;
+            });
+
+    const std::string plan = csv(db.explain_statements());
+    BOOST_CHECK(plan.find(",SEARCH,") != std::string::npos);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_pooled_je_report, SQLiteLedgerFixture) {
+    GLDatabasePool pool{file.name, "", "", "", 3};
+
+    /*  With two connections free the lines, entity and user queries run
+     *  on them, and with none free they run on the leased connection   */
+
+    {
+        GLDatabasePool::Lease lease = pool.acquire();
+        check_sample_je(lease->report("je", "1"));
+    }
+
+    GLDatabasePool::Lease first = pool.acquire();
+    GLDatabasePool::Lease second = pool.acquire();
+    GLDatabasePool::Lease third = pool.acquire();
+    BOOST_CHECK(!pool.try_acquire());
+    check_sample_je(third->report("je", "1"));
+}
+
+BOOST_AUTO_TEST_CASE(test_sqlite_batch) {
+    TempDatabaseFile file;
+    DBConn conn{backend_connection(file.name, "", "", "")};
+
+    conn.query_batch({"CREATE TABLE batch (n INTEGER)",
+                      "INSERT INTO batch VALUES (1)",
+                      "INSERT INTO batch VALUES (2)"});
+
+    /*  A failed batch names the statement, having run those before it  */
+
+    try {
+        conn.query_batch({"INSERT INTO batch VALUES (3)",
+                          "INSERT INTO nowhere VALUES (4)",
+                          "INSERT INTO batch VALUES (5)"});
+        BOOST_ERROR("Batch did not fail");
+    }
+    catch ( const DBConnBatchFailed& e ) {
+        BOOST_CHECK_EQUAL(e.index(), 1u);
+    }
+
+    /*  A batch made while a select is queued runs on the I/O thread  */
+
+    const std::string count = "SELECT COUNT(*) AS n FROM batch";
+    std::future<Table> pending = conn.select_async(count);
+    conn.query_batch({"INSERT INTO batch VALUES (6)"});
+    BOOST_CHECK_EQUAL(pending.get().get_field("n", 0), "3");
+    BOOST_CHECK_EQUAL(conn.select(count).get_field("n", 0), "4");
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_amounts_exact, SQLiteLedgerFixture) {
+    GLJournal zero{1, 2, 2014, "SAMPLE", "Cancelling cents"};
+    zero.add_line("20002000", Currency{0, 10});
+    zero.add_line("20002000", Currency{0, 20});
+    zero.add_line("20002000", Currency::from_cents(-30));
+    db.post_journal(zero);
+
+    GLJournal dimes{1, 2, 2014, "SAMPLE", "Ten dimes"};
+    for ( int i = 0; i < 10; ++i ) {
+        dimes.add_line("60001000", Currency{0, 10});
+    }
+    dimes.add_line("30003000", Currency{-1, 0});
+    db.post_journal(dimes);
+
+    /*  Floating point sums would leave the first account slightly off
+     *  zero, and the second slightly short of the threshold             */
+
+    const std::string nonzero = csv(db.report("currenttb",
+                "entity=1;from=20002000;to=20002000;nonzero=yes"));
+    BOOST_CHECK(nonzero.find("20002000") == std::string::npos);
+
+    const std::string dollar = csv(db.report("currenttb",
+                "entity=1;from=60001000;to=60001000;threshold=1.00"));
+    BOOST_CHECK(dollar.find("60001000,General and administrative expenses,"
+                            "1.00") != std::string::npos);
+
+    DBConn dbc{backend_connection(file.name, "", "", "")};
+    Table stored = dbc.select("SELECT COUNT(*) AS count FROM jelines"
+                              " WHERE typeof(amount) <> 'integer'");
+    BOOST_CHECK_EQUAL(stored.get_field("count", 0), "0");
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_migration, SQLiteLedgerFixture) {
+    BOOST_CHECK(db.migrate(100, 0, nullptr));
+
+    //  Take the database back to the schema before versioning
+
+    {
+        DBConn dbc{backend_connection(file.name, "", "", "")};
+        for ( const auto& view : schema_views ) {
+            dbc.query(std::string{"DROP VIEW "} + view.name);
+        }
+        for ( const auto& index : schema_indexes ) {
+            dbc.query(std::string{"DROP INDEX "} + index.name);
+        }
+        dbc.query("DROP TABLE schema_version");
+        dbc.query("ALTER TABLE jelines DROP COLUMN year");
+        dbc.query("ALTER TABLE standing_data DROP COLUMN ledger_version");
+        dbc.query("UPDATE jelines SET amount = amount / 100.0");
+    }
+
+    BOOST_CHECK(csv(db.migration_status()).find("Pending") !=
+                std::string::npos);
+    BOOST_CHECK(csv(db.migration_plan(2)).find("UPDATE jelines") !=
+                std::string::npos);
+
+    /*  SQLite does not enforce column sizes, so has no columns to widen  */
+
+    BOOST_CHECK(csv(db.migration_plan(2)).find("type of column users"
+                                               ".pass_hash not needed") !=
+                std::string::npos);
+    BOOST_CHECK_THROW(get_sql_object()->modify_column(SchemaTable::users,
+                                                      "pass_hash",
+                                                      "VARCHAR(128)"),
+                      std::runtime_error);
+
+    BOOST_CHECK(!db.migrate(2, 1, nullptr));
+    BOOST_CHECK(csv(db.migration_status()).find("In progress") !=
+                std::string::npos);
+    BOOST_CHECK(db.migrate(2, 0, nullptr));
+
+    const std::string after = csv(db.migration_status());
+    BOOST_CHECK(after.find("Pending") == std::string::npos);
+    BOOST_CHECK(after.find("In progress") == std::string::npos);
+
+    DBConn dbc{backend_connection(file.name, "", "", "")};
+    Table unfilled = dbc.select("SELECT COUNT(*) AS count FROM jelines"
+                                " WHERE year = 0");
+    BOOST_REQUIRE(unfilled.num_records() == 1);
+    BOOST_CHECK(unfilled[0][0].str() == "0");
+    Table inexact = dbc.select("SELECT COUNT(*) AS count FROM jelines"
+                               " WHERE typeof(amount) <> 'integer'");
+    BOOST_CHECK(inexact[0][0].str() == "0");
+
+    check_sample_je(db.report("je", "1"));
+    BOOST_CHECK(csv(db.report("je", "1")).find("1000000.00") !=
+                std::string::npos);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_archive_ledger_version,
+                        SQLiteLedgerFixture) {
+    db.set_report_cache(std::make_shared<GLReportCache>());
+    const unsigned long long loaded = db.ledger_version();
+    const std::string before = csv(db.report("currenttb", "1"));
+    BOOST_CHECK(before.find(".00") != std::string::npos);
+
+    /*  Archiving the only year empties the trial balance, so a report
+     *  cached before it must not be returned after it                  */
+
+    db.archive_year_partition(2014);
+    BOOST_CHECK_EQUAL(db.ledger_version(), loaded + 1);
+    BOOST_CHECK(csv(db.report("currenttb", "1")).find(".00") ==
+                std::string::npos);
+
+    BOOST_CHECK(db.migrate(100, 0, nullptr));
+    BOOST_CHECK_EQUAL(db.ledger_version(), loaded + 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_permissions, SQLiteLedgerFixture) {
+    BOOST_CHECK(db.sync_permissions().empty());
+
+    const GLUser admin = db.get_user_by_username("admin");
+    BOOST_CHECK_EQUAL(admin.permission_set().count(),
+                      num_gl_permissions);
+    BOOST_CHECK(admin.has_permission(GLPermission::close_year));
+
+    const GLUser john = db.get_user_by_id("2");
+    BOOST_CHECK(john.has_permission(GLPermission::create));
+    BOOST_CHECK(!john.has_permission(GLPermission::post));
+    db.revoke(john, "BASICRPTS");
+    db.revoke(john, "CREATE");
+    BOOST_CHECK(db.get_user_by_id("2").permission_set().none());
+    BOOST_CHECK_EQUAL(db.get_user_by_id("2").username(), "john");
+
+    DBConn dbc{backend_connection(file.name, "", "", "")};
+    dbc.query("DELETE FROM user_perms WHERE permid = 14");
+    dbc.query("DELETE FROM perms WHERE id = 14");
+    const std::vector<std::string> missing = db.sync_permissions();
+    BOOST_REQUIRE_EQUAL(missing.size(), 1u);
+    BOOST_CHECK_EQUAL(missing[0], "CLOSEYEAR");
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_bulk_users, SQLiteLedgerFixture) {
+    std::vector<GLUser> users;
+    std::vector<std::string> passwords;
+    for ( int i = 0; i < 5; ++i ) {
+        users.emplace_back("", "bulk" + std::to_string(i), "Bulk",
+                           "User", "", "", GLPermissionSet{}, true);
+        passwords.push_back("password" + std::to_string(i));
+    }
+    set_passwords(users, passwords, 2, 1000);
+    db.add_users(users, 2);
+
+    GLUser added = db.get_user_by_username("bulk4");
+    BOOST_CHECK(added.enabled());
+    BOOST_CHECK(added.check_password("password4"));
+    BOOST_CHECK(added.permission_set().none());
+
+    for ( auto& user : users ) {
+        user.set_username("re" + user.username());
+    }
+    users[4].set_username("admin");
+    BOOST_CHECK_THROW(db.add_users(users, 2), GLDBException);
+    BOOST_CHECK_THROW(db.get_user_by_username("rebulk0"),
+                      std::exception);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_jelines_paging, SQLiteLedgerFixture) {
+    const unsigned long long base = db.jeline_count();
+    for ( int i = 0; i < 5; ++i ) {
+        GLJournal posted{1, 2, 2014, "SAMPLE", "Paging test"};
+        posted.add_line("10003000", Currency{i + 1, 0});
+        posted.add_line("10001000", Currency{-(i + 1), 0});
+        db.post_journal(posted);
+    }
+    BOOST_CHECK_EQUAL(db.jeline_count(), base + 10);
+
+    Table first{db.jelines_page(0, base, 4)};
+    BOOST_REQUIRE_EQUAL(first.num_records(), 4u);
+    BOOST_CHECK_EQUAL(first.get_field("amount", 0), "1.00");
+
+    /*  Continuing after the last ID matches skipping past it  */
+
+    const unsigned long long last_id =
+        std::stoull(first.get_field("id", 3));
+    Table next{db.jelines_page(last_id, 2, 10)};
+    Table skipped{db.jelines_page(0, base + 6, 10)};
+    BOOST_REQUIRE_EQUAL(next.num_records(), 4u);
+    BOOST_REQUIRE_EQUAL(skipped.num_records(), 4u);
+    for ( size_t i = 0; i < 4; ++i ) {
+        BOOST_CHECK_EQUAL(next.get_field("id", i),
+                          skipped.get_field("id", i));
+    }
+
+    /*  Seeking back from the end, or from a known ID, matches too  */
+
+    unsigned long long end_id;
+    BOOST_CHECK_EQUAL(db.jeline_count(end_id), base + 10);
+    BOOST_CHECK_EQUAL(std::to_string(end_id), skipped.get_field("id", 3));
+
+    Table tail{db.jelines_page_before(0, 0, 4)};
+    Table back{db.jelines_page_before(end_id, 1, 2)};
+    BOOST_REQUIRE_EQUAL(tail.num_records(), 4u);
+    BOOST_REQUIRE_EQUAL(back.num_records(), 2u);
+    for ( size_t i = 0; i < 4; ++i ) {
+        BOOST_CHECK_EQUAL(tail.get_field("id", i),
+                          skipped.get_field("id", i));
+    }
+    BOOST_CHECK_EQUAL(back.get_field("id", 0), skipped.get_field("id", 0));
+    BOOST_CHECK_EQUAL(back.get_field("id", 1), skipped.get_field("id", 1));
+    BOOST_CHECK_EQUAL(back.get_field("amount", 1), "-4.00");
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_server, SQLiteLedgerFixture) {
+    const std::string socket = temp_path("gl_server_test_%%%%-%%%%.sock");
+    {
+        GLDatabasePool pool{file.name, "", "", "", 2};
+        GLServer server{pool, socket};
+        BOOST_CHECK_THROW(GLServer(pool, socket), GLProtocolException);
+        std::thread thread{&GLServer::run, &server};
+
+        try {
+            GLClient client{socket};
+            check_sample_je(client.report("je", "1"));
+            BOOST_CHECK_THROW(client.report("nosuchreport"), GLDBException);
+
+            const GLUser user = client.get_user_by_id("1");
+            const size_t perms = user.permissions().size();
+            client.revoke(user, "BASICRPTS");
+            BOOST_CHECK_EQUAL(client.get_user_by_username(user.username())
+                              .permissions().size(), perms - 1);
+            client.grant(user, "BASICRPTS");
+
+            GLJournal journal{1, 2, 2014, "SAMPLE", "Server test"};
+            journal.add_line("10003000", Currency{5, 0});
+            journal.add_line("10001000", Currency{-5, 0});
+            client.post_journal(journal);
+
+            GLClient second{socket};
+            BOOST_CHECK(csv(second.report("currenttb", "1")).find("Entity,") ==
+                        0);
+
+            /*  Arguments are checked before they reach any SQL, and
+             *  unknown accounts are not added to the symbol table     */
+
+            BOOST_CHECK_THROW(second.report("je", "1 OR 1 = 1"),
+                              GLDBException);
+            BOOST_CHECK_THROW(second.get_user_by_username("x' OR 'a' = 'a"),
+                              GLDBException);
+            BOOST_CHECK_THROW(second.get_user_by_id("1; DELETE FROM users"),
+                              GLDBException);
+            BOOST_CHECK_THROW(second.grant(user, "NOSUCHPERM"),
+                              GLDBException);
+        }
+        catch ( const std::exception& e ) {
+            BOOST_ERROR(e.what());
+        }
+
+        server.stop();
+        thread.join();
+
+        /*  Three reports, counting the failed one, two user lookups, two
+         *  permission changes, one journal posting, and four requests
+         *  refused for their arguments  */
+
+        const size_t requests_sent = 3 + 2 + 2 + 1 + 4;
+        BOOST_CHECK_EQUAL(server.requests_served(), requests_sent);
+    }
+    BOOST_CHECK(!boost::filesystem::exists(socket));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_server_unknown_account,
+                        SQLiteLedgerFixture) {
+
+    /*  The request is built from strings, as a client would send it,
+     *  since a GLJournal would intern the account in this process      */
+
+    GLJournal journal{1, 2, 2014, "SAMPLE", "Unknown account"};
+    journal.add_line("10003000", Currency{5, 0});
+    journal.add_line("10001000", Currency{-5, 0});
+    GLRequest request{GLRequestType::post_journal,
+                      journal_to_strings(journal)};
+    request.args[gl_journal_fields + 2] = "NOSUCHACCOUNT";
+
+    const size_t symbols = account_symbols().size();
+    const GLResponse response = GLServer::handle(db, request);
+    BOOST_CHECK(response.status == GLResponseStatus::error);
+    BOOST_CHECK(response.body.find("NOSUCHACCOUNT") != std::string::npos);
+    BOOST_CHECK_EQUAL(account_symbols().size(), symbols);
+
+    request.args[gl_journal_fields + 2] = "10001000";
+    BOOST_CHECK(GLServer::handle(db, request).status ==
+                GLResponseStatus::ok);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_server_update_user, SQLiteLedgerFixture) {
+    GLUser user = db.get_user_by_id("2");
+    user.set_password("new password", 1000);
+    BOOST_CHECK(user.pass_salt().find("rounds=") != std::string::npos);
+
+    GLRequest request{GLRequestType::update_user, user_to_strings(user)};
+    BOOST_CHECK(GLServer::handle(db, request).status ==
+                GLResponseStatus::ok);
+    BOOST_CHECK(db.get_user_by_id("2").check_password("new password"));
+
+    /*  Traditional salts are still accepted  */
+
+    request.args[5] = "XX";
+    BOOST_CHECK(GLServer::handle(db, request).status ==
+                GLResponseStatus::ok);
+
+    for ( const std::string bad : {"$6$rounds=5000$ab'cd",
+                                   "$6$rounds=x$abcd$efgh",
+                                   "$6$rounds=5000$",
+                                   "$6$ab$cd$ef", "X", "$"} ) {
+        request.args[4] = bad;
+        const GLResponse response = GLServer::handle(db, request);
+        BOOST_CHECK(response.status == GLResponseStatus::error);
+        BOOST_CHECK(response.body.find("password hash") !=
+                    std::string::npos);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sqlite_server_idle_clients, SQLiteLedgerFixture) {
+    const std::string socket = temp_path("gl_server_test_%%%%-%%%%.sock");
+    GLDatabasePool pool{file.name, "", "", "", 1};
+    GLServer server{pool, socket};
+    std::thread thread{&GLServer::run, &server};
+
+    /*  One worker serves clients which each stay connected between
+     *  requests, since it only holds a client while answering it      */
+
+    try {
+        GLClient first{socket};
+        GLClient second{socket};
+        GLClient third{socket};
+        for ( int i = 0; i < 2; ++i ) {
+            BOOST_CHECK_EQUAL(first.get_user_by_id("1").id(), "1");
+            BOOST_CHECK_EQUAL(second.get_user_by_id("1").id(), "1");
+            BOOST_CHECK_EQUAL(third.get_user_by_id("1").id(), "1");
+        }
+    }
+    catch ( const std::exception& e ) {
+        BOOST_ERROR(e.what());
+    }
+
+    server.stop();
+    thread.join();
+    BOOST_CHECK_EQUAL(server.requests_served(), 6u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,116 @@
+/*
+ *  test_synthetic.cpp
+ *  ==================
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Unit tests for synthetic table data generator.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include "database/database.h"
+
+using namespace gldb;
+
+BOOST_AUTO_TEST_SUITE(synthetic_suite)
+
+BOOST_AUTO_TEST_CASE(test_synthetic_defaults) {
+    const SyntheticGenerator gen;
+    BOOST_CHECK_EQUAL(gen.num_records(), 1000);
+    BOOST_CHECK_EQUAL(gen.num_fields(), 6);
+    BOOST_CHECK_EQUAL(gen.headers().record_string(),
+            "id,entity,account,date,description,amount");
+
+    const Table table = gen.table();
+    BOOST_CHECK_EQUAL(table.num_records(), 1000);
+    BOOST_CHECK_EQUAL(table[0][0].str(), "1");
+    BOOST_CHECK_EQUAL(table[999][0].str(), "1000");
+
+    for ( const auto& row : table ) {
+        BOOST_CHECK_EQUAL(row[1].str(), "1");
+        BOOST_CHECK(row[2].str() >= "1000" && row[2].str() <= "1099");
+        BOOST_CHECK_EQUAL(row[3].length(), 10);
+        BOOST_CHECK_EQUAL(row[3].str().substr(0, 5), "2014-");
+        const std::string& amount = row[5].str();
+        BOOST_CHECK_EQUAL(amount[amount.length() - 3], '.');
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_synthetic_deterministic) {
+    const SyntheticGenerator gen1{"seed=42;scale=3"};
+    const SyntheticGenerator gen2{"scale=3;seed=42"};
+    const SyntheticGenerator gen3{"scale=3;seed=43"};
+    BOOST_CHECK_EQUAL(gen1.num_records(), 3000);
+
+    const Table t1 = gen1.table();
+    const Table t2 = gen2.table();
+    const Table t3 = gen3.table();
+    size_t differ = 0;
+    for ( size_t i = 0; i < t1.num_records(); ++i ) {
+        BOOST_CHECK_EQUAL(t1[i].record_string(), t2[i].record_string());
+        differ += t1[i].record_string() != t3[i].record_string();
+    }
+    BOOST_CHECK(differ > 2900);
+
+    /*  Rows generated on their own match rows in the table  */
+
+    BOOST_CHECK_EQUAL(gen1.row(2500).record_string(),
+                      t1[2500].record_string());
+    const Table window = gen1.table(2990, 100);
+    BOOST_CHECK_EQUAL(window.num_records(), 10);
+    BOOST_CHECK_EQUAL(window[0].record_string(), t1[2990].record_string());
+
+    TableRow row;
+    gen1.fill_row(7, row);
+    BOOST_CHECK_EQUAL(row.record_string(), t1[7].record_string());
+    gen1.fill_row(8, row);
+    BOOST_CHECK_EQUAL(row.record_string(), t1[8].record_string());
+}
+
+BOOST_AUTO_TEST_CASE(test_synthetic_columns) {
+    const SyntheticGenerator gen{"rows=20000;scale=50;year=2016;"
+        "columns=n:integer,e:entity:skewed,d:date:skewed,m:money"};
+    BOOST_CHECK_EQUAL(gen.num_records(), 20000);
+    BOOST_CHECK_EQUAL(gen.headers().record_string(), "n,e,d,m");
+
+    size_t low_entities = 0, leap_days = 0, last_quarter = 0, negative = 0;
+    TableRow row;
+    for ( size_t i = 0; i < gen.num_records(); ++i ) {
+        gen.fill_row(i, row);
+        BOOST_CHECK(std::stoul(row[0].str()) < 1000000);
+        const unsigned long entity = std::stoul(row[1].str());
+        BOOST_CHECK(entity >= 1 && entity <= 50);
+        low_entities += entity <= 5;
+        leap_days += row[2].str() == "2016-02-29";
+        last_quarter += row[2].str() >= "2016-10-01";
+        negative += row[3][0] == '-';
+    }
+
+    /*  Skewed picks land in the first tenth about 46% of the time  */
+
+    BOOST_CHECK(low_entities > 8000 && low_entities < 11000);
+    BOOST_CHECK(last_quarter > 11000);
+    BOOST_CHECK(leap_days < 20);
+    BOOST_CHECK(negative > 9000 && negative < 11000);
+}
+
+BOOST_AUTO_TEST_CASE(test_synthetic_bad_spec) {
+    BOOST_CHECK_THROW(SyntheticGenerator{"scale=0"}, SyntheticBadSpec);
+    BOOST_CHECK_THROW(SyntheticGenerator{"scale=abc"}, SyntheticBadSpec);
+    BOOST_CHECK_THROW(SyntheticGenerator{"rows"}, SyntheticBadSpec);
+    BOOST_CHECK_THROW(SyntheticGenerator{"colour=red"}, SyntheticBadSpec);
+    BOOST_CHECK_THROW(SyntheticGenerator{"columns=a:float"},
+                      SyntheticBadSpec);
+    BOOST_CHECK_THROW(SyntheticGenerator{"columns=a:money:normal"},
+                      SyntheticBadSpec);
+    BOOST_CHECK_THROW(SyntheticGenerator{"columns="}, SyntheticBadSpec);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -54,6 +54,9 @@ BOOST_AUTO_TEST_CASE(table_get_field) {
     test_string = table.get_field("h4", 1);
     BOOST_CHECK_EQUAL(test_string, "d8");
 
+    BOOST_CHECK(table.has_field("h3"));
+    BOOST_CHECK(!table.has_field("h5"));
+
     BOOST_CHECK_THROW(table.get_field("h5", 0), TableNoSuchField);
     BOOST_CHECK_THROW(table.get_field("h3", 3), TableNoSuchRecord);
 
@@ -14,6 +14,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <string>
+#include <vector>
 #include "gldb/gldb.h"
 
 using namespace genleg;
@@ -37,5 +39,45 @@ BOOST_AUTO_TEST_CASE(user_password_check_bad) {
     BOOST_CHECK(!user.check_password(badpass));
 }
 
+BOOST_AUTO_TEST_CASE(user_password_sha512) {
+    std::vector<std::string> v;
+    GLUser user("", "", "", "", "", "", std::move(v), true);
+    user.set_password("a much longer passphrase", 1000);
+    BOOST_CHECK_EQUAL(user.pass_salt().find("$6$rounds=1000$"), 0u);
+    BOOST_CHECK_EQUAL(user.pass_hash().find(user.pass_salt()), 0u);
+    BOOST_CHECK(user.check_password("a much longer passphrase"));
+    BOOST_CHECK(!user.check_password("a much longer passphrasf"));
+    BOOST_CHECK_THROW(user.set_password("short"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(user_password_legacy_salt) {
+    GLUser user("", "", "", "", "XXq2wKiyI43A2", "XX",
+                std::vector<std::string>{}, true);
+    BOOST_CHECK(user.check_password("password"));
+    BOOST_CHECK(!user.check_password("passwore"));
+}
+
+BOOST_AUTO_TEST_CASE(user_password_parallel) {
+    std::vector<GLUser> users;
+    std::vector<std::string> passwords;
+    for ( int i = 0; i < 12; ++i ) {
+        users.emplace_back(std::to_string(i), "", "", "", "", "",
+                           GLPermissionSet{}, true);
+        passwords.push_back("password" + std::to_string(i));
+    }
+    set_passwords(users, passwords, 4, 1000);
+    for ( size_t i = 0; i < users.size(); ++i ) {
+        BOOST_CHECK(users[i].check_password(passwords[i]));
+    }
+    BOOST_CHECK(users[0].pass_salt() != users[1].pass_salt());
+
+    passwords[5] = "short";
+    BOOST_CHECK_THROW(set_passwords(users, passwords, 4, 1000),
+                      std::runtime_error);
+    passwords.pop_back();
+    BOOST_CHECK_THROW(set_passwords(users, passwords, 4, 1000),
+                      std::runtime_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,53 @@
+/*
+ *  test_user_permissions.cpp
+ *  =========================
+ *  Copyright 2013 Paul Griffiths
+ *  Email: mail@paulgriffiths.net
+ *
+ *  Unit tests for user permission functions.
+ *
+ *  Uses Boost unit testing framework.
+ *
+ *  Distributed under the terms of the GNU General Public License.
+ *  http://www.gnu.org/licenses/
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "gldb/gldb.h"
+
+using namespace genleg;
+
+BOOST_AUTO_TEST_SUITE(user_permissions_suite)
+
+BOOST_AUTO_TEST_CASE(user_permissions_builtin_bits) {
+    BOOST_CHECK_EQUAL(permission_bit("BASICRPTS"), 0u);
+    BOOST_CHECK_EQUAL(permission_bit("POST"),
+                      static_cast<size_t>(GLPermission::post));
+    BOOST_CHECK_EQUAL(permission_bit("CLOSEYEAR"), num_gl_permissions - 1);
+
+    const size_t extra = permission_bit("TESTPERM");
+    BOOST_CHECK(extra >= num_gl_permissions);
+    BOOST_CHECK_EQUAL(permission_bit("TESTPERM"), extra);
+}
+
+BOOST_AUTO_TEST_CASE(user_permissions_check) {
+    GLUser user("1", "jsmith", "", "", "", "",
+                {"POST", "BASICRPTS", "TESTPERM"}, true);
+    BOOST_CHECK(user.has_permission(GLPermission::post));
+    BOOST_CHECK(user.has_permission(GLPermission::basic_reports));
+    BOOST_CHECK(!user.has_permission(GLPermission::create));
+    BOOST_CHECK(user.has_permission("TESTPERM"));
+    BOOST_CHECK(!user.has_permission("CREATE"));
+    BOOST_CHECK(!user.has_permission("NOSUCHPERM"));
+    BOOST_CHECK_EQUAL(user.permission_set().count(), 3u);
+
+    const std::vector<std::string> expected{"BASICRPTS", "POST", "TESTPERM"};
+    BOOST_CHECK(user.permissions() == expected);
+
+    const GLUser copy("1", "jsmith", "", "", "", "",
+                      user.permission_set(), true);
+    BOOST_CHECK(copy.permissions() == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()